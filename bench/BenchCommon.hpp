@@ -0,0 +1,191 @@
+#pragma once
+
+// Shared helpers for the headless benchmarks: timing, latency summaries,
+// "--name value" argument parsing and synthetic test photos. Header-only;
+// benchmarks are single files.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double ElapsedUs(Clock::time_point start, Clock::time_point end = Clock::now())
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// Burn CPU for roughly `us` microseconds (simulated decode cost)
+inline void SpinFor(double us)
+{
+    if (us <= 0.0) return;
+    auto start = Clock::now();
+    while (ElapsedUs(start) < us) {}
+}
+
+// Collects samples (microseconds) and prints p50/p90/p99/max
+class LatencyRecorder {
+public:
+    void Add(double us) { samples_.push_back(us); }
+    size_t Count() const { return samples_.size(); }
+
+    double Percentile(double p)
+    {
+        if (samples_.empty()) return 0.0;
+        std::sort(samples_.begin(), samples_.end());
+        size_t idx = static_cast<size_t>(p / 100.0 * static_cast<double>(samples_.size() - 1));
+        return samples_[idx];
+    }
+
+    double Max()
+    {
+        if (samples_.empty()) return 0.0;
+        return *std::max_element(samples_.begin(), samples_.end());
+    }
+
+    double Mean() const
+    {
+        if (samples_.empty()) return 0.0;
+        double sum = 0.0;
+        for (double s : samples_) sum += s;
+        return sum / static_cast<double>(samples_.size());
+    }
+
+    void Print(const char* label)
+    {
+        std::printf("  %-28s n=%-8zu mean=%9.2fus p50=%9.2fus p90=%9.2fus p99=%9.2fus max=%9.2fus\n",
+                    label, Count(), Mean(), Percentile(50), Percentile(90),
+                    Percentile(99), Max());
+    }
+
+private:
+    std::vector<double> samples_;
+};
+
+// Minimal "--key value" parser; unknown keys are ignored
+class Args {
+public:
+    Args(int argc, char** argv) : argc_(argc), argv_(argv) {}
+
+    long long Get(const char* name, long long fallback) const
+    {
+        const char* v = Find(name);
+        return v ? std::atoll(v) : fallback;
+    }
+
+    double GetDouble(const char* name, double fallback) const
+    {
+        const char* v = Find(name);
+        return v ? std::atof(v) : fallback;
+    }
+
+    std::string GetString(const char* name, const std::string& fallback) const
+    {
+        const char* v = Find(name);
+        return v ? std::string(v) : fallback;
+    }
+
+private:
+    const char* Find(const char* name) const
+    {
+        for (int i = 1; i + 1 < argc_; ++i) {
+            if (argv_[i][0] == '-' && argv_[i][1] == '-' && std::strcmp(argv_[i] + 2, name) == 0) {
+                return argv_[i + 1];
+            }
+        }
+        return nullptr;
+    }
+
+    int argc_;
+    char** argv_;
+};
+
+struct SyntheticPhoto {
+    uint16_t width, height;
+    std::vector<uint8_t> bgra;
+};
+
+// Bilinear value noise in [0, 1) on a `cells` grid
+class ValueNoise {
+public:
+    ValueNoise(std::mt19937& rng, int cells) : cells_(cells), grid_((cells + 1) * (cells + 1))
+    {
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        for (float& v : grid_) v = dist(rng);
+    }
+
+    float At(float u, float v) const
+    {
+        float x = u * cells_, y = v * cells_;
+        int x0 = std::min(static_cast<int>(x), cells_ - 1), y0 = std::min(static_cast<int>(y), cells_ - 1);
+        float fx = x - x0, fy = y - y0;
+        auto g = [&](int gx, int gy) { return grid_[gy * (cells_ + 1) + gx]; };
+        float top = g(x0, y0) + (g(x0 + 1, y0) - g(x0, y0)) * fx;
+        float bottom = g(x0, y0 + 1) + (g(x0 + 1, y0 + 1) - g(x0, y0 + 1)) * fx;
+        return top + (bottom - top) * fy;
+    }
+
+private:
+    int cells_;
+    std::vector<float> grid_;
+};
+
+// Photo-like BGRA thumbnail for codec benchmarks: smooth multi-octave
+// luma/chroma fields with a few hard-edged shapes, a per-image texture
+// strength (most images smooth, a few foliage-like) and uniform grain of
+// +/- `noise` levels. Deterministic per seed.
+inline SyntheticPhoto MakeSyntheticPhoto(uint32_t seed, uint16_t width, uint16_t height, int noise)
+{
+    std::mt19937 rng(seed);
+    ValueNoise luma3(rng, 3), luma8(rng, 8), luma24(rng, 24), cb(rng, 2), cr(rng, 3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float texture = unit(rng) * unit(rng) * 0.5f;  // most images smooth, a few foliage-like
+
+    struct Ellipse { float cx, cy, rx, ry, y, cb, cr; };
+    std::vector<Ellipse> shapes(2 + rng() % 4);
+    for (auto& s : shapes) {
+        s = {unit(rng), unit(rng), 0.05f + unit(rng) * 0.3f, 0.05f + unit(rng) * 0.3f,
+             unit(rng), unit(rng) - 0.5f, unit(rng) - 0.5f};
+    }
+
+    SyntheticPhoto img{width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4)};
+    std::uniform_int_distribution<int> grain(-noise, noise);
+    for (uint16_t py = 0; py < height; ++py) {
+        for (uint16_t px = 0; px < width; ++px) {
+            float u = (px + 0.5f) / width, v = (py + 0.5f) / height;
+            float y = 0.55f * luma3.At(u, v) + 0.3f * luma8.At(u, v) + texture * (luma24.At(u, v) - 0.5f);
+            float b = 0.35f * (cb.At(u, v) - 0.5f), r = 0.35f * (cr.At(u, v) - 0.5f);
+            for (const auto& s : shapes) {
+                float dx = (u - s.cx) / s.rx, dy = (v - s.cy) / s.ry;
+                if (dx * dx + dy * dy < 1.0f) {
+                    y = 0.6f * y + 0.4f * s.y;
+                    b = s.cb * 0.4f;
+                    r = s.cr * 0.4f;
+                }
+            }
+            auto channel = [&](float value) {
+                int c = static_cast<int>(std::lround(value * 255.0f)) + (noise > 0 ? grain(rng) : 0);
+                return static_cast<uint8_t>(std::clamp(c, 0, 255));
+            };
+            uint8_t* out = img.bgra.data() + (static_cast<size_t>(py) * width + px) * 4;
+            out[0] = channel(y + 1.772f * b);
+            out[1] = channel(y - 0.344f * b - 0.714f * r);
+            out[2] = channel(y + 1.402f * r);
+            out[3] = 255;
+        }
+    }
+    return img;
+}
+
+} // namespace Bench
+} // namespace UltraImageViewer
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "core/EpochReclaimer.hpp"
+
+namespace UltraImageViewer {
+namespace Bench {
+
+/**
+ * Concurrent hash map split into independently locked shards. ThumbnailPipeline
+ * used it for Tier 1 before the ImageId-indexed IdTable; kept here as the
+ * middle column of cache_contention_bench.
+ *
+ * Keys are looked up by a caller-supplied 64-bit hash (computed once per
+ * request and reused across maps). The top bits pick the shard, the low bits
+ * the bucket. Readers (Visit/Contains) never lock: they traverse bucket chains
+ * under an EpochReclaimer::Guard, so the render thread cannot be blocked by a
+ * worker holding a shard. Writers serialize per shard and never modify a
+ * published node — replacing a value links a new node and retires the old one.
+ *
+ * The bucket array is fixed at construction; size it for the expected
+ * resident set (chains simply grow past it).
+ */
+template <typename Key, typename Value, typename KeyEqual = std::equal_to<Key>>
+class ShardedCache {
+public:
+    explicit ShardedCache(size_t expectedEntries = 16384, size_t shardCount = 64)
+    {
+        shardBits_ = 0;
+        while ((size_t{1} << shardBits_) < shardCount) ++shardBits_;
+        size_t shards = size_t{1} << shardBits_;
+
+        size_t perShard = 16;
+        while (perShard * shards < expectedEntries) perShard <<= 1;
+        bucketMask_ = perShard - 1;
+
+        shards_ = std::make_unique<Shard[]>(shards);
+        for (size_t i = 0; i < shards; ++i) {
+            shards_[i].buckets = std::make_unique<std::atomic<Node*>[]>(perShard);
+            for (size_t b = 0; b < perShard; ++b) {
+                shards_[i].buckets[b].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    ~ShardedCache()
+    {
+        // No readers can exist once the owner is being destroyed
+        for (size_t i = 0; i < ShardCount(); ++i) {
+            for (size_t b = 0; b <= bucketMask_; ++b) {
+                Node* n = shards_[i].buckets[b].load(std::memory_order_relaxed);
+                while (n) {
+                    Node* next = n->next.load(std::memory_order_relaxed);
+                    delete n;
+                    n = next;
+                }
+            }
+        }
+    }
+
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    // Lock-free lookup: calls fn(const Value&) while the node is protected.
+    // Returns false if the key is absent.
+    template <typename Fn>
+    bool Visit(uint64_t hash, const Key& key, Fn&& fn) const
+    {
+        Core::EpochReclaimer::Guard guard;
+        const Node* n = Find(hash, key);
+        if (!n) return false;
+        fn(n->value);
+        return true;
+    }
+
+    bool Contains(uint64_t hash, const Key& key) const
+    {
+        Core::EpochReclaimer::Guard guard;
+        return Find(hash, key) != nullptr;
+    }
+
+    // Insert, or replace the existing value for key. Value is constructed in place.
+    template <typename... Args>
+    void Emplace(uint64_t hash, const Key& key, Args&&... args)
+    {
+        Shard& shard = ShardFor(hash);
+        Node* node = new Node(hash, key, std::forward<Args>(args)...);
+
+        std::lock_guard lock(shard.writeMutex);
+        std::atomic<Node*>* link = &shard.buckets[hash & bucketMask_];
+        for (Node* n = link->load(std::memory_order_relaxed); n;
+             n = link->load(std::memory_order_relaxed)) {
+            if (n->hash == hash && equal_(n->key, key)) {
+                node->next.store(n->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                link->store(node, std::memory_order_release);
+                Retire(n);
+                return;
+            }
+            link = &n->next;
+        }
+        node->next.store(shard.buckets[hash & bucketMask_].load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+        shard.buckets[hash & bucketMask_].store(node, std::memory_order_release);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool Erase(uint64_t hash, const Key& key)
+    {
+        Shard& shard = ShardFor(hash);
+        std::lock_guard lock(shard.writeMutex);
+        std::atomic<Node*>* link = &shard.buckets[hash & bucketMask_];
+        for (Node* n = link->load(std::memory_order_relaxed); n;
+             n = link->load(std::memory_order_relaxed)) {
+            if (n->hash == hash && equal_(n->key, key)) {
+                link->store(n->next.load(std::memory_order_relaxed), std::memory_order_release);
+                shard.count.fetch_sub(1, std::memory_order_relaxed);
+                Retire(n);
+                return true;
+            }
+            link = &n->next;
+        }
+        return false;
+    }
+
+    // Visit every entry as fn(const Key&, const Value&). Holds one shard's
+    // write lock at a time, so concurrent writers to other shards proceed.
+    template <typename Fn>
+    void ForEach(Fn&& fn) const
+    {
+        for (size_t i = 0; i < ShardCount(); ++i) {
+            Shard& shard = shards_[i];
+            std::lock_guard lock(shard.writeMutex);
+            for (size_t b = 0; b <= bucketMask_; ++b) {
+                for (const Node* n = shard.buckets[b].load(std::memory_order_relaxed); n;
+                     n = n->next.load(std::memory_order_relaxed)) {
+                    fn(n->key, n->value);
+                }
+            }
+        }
+    }
+
+    void Clear()
+    {
+        for (size_t i = 0; i < ShardCount(); ++i) {
+            Shard& shard = shards_[i];
+            std::lock_guard lock(shard.writeMutex);
+            for (size_t b = 0; b <= bucketMask_; ++b) {
+                Node* n = shard.buckets[b].exchange(nullptr, std::memory_order_acq_rel);
+                while (n) {
+                    Node* next = n->next.load(std::memory_order_relaxed);
+                    Retire(n);
+                    n = next;
+                }
+            }
+            shard.count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t Size() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < ShardCount(); ++i) {
+            total += shards_[i].count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    size_t ShardCount() const { return size_t{1} << shardBits_; }
+
+private:
+    struct Node {
+        template <typename... Args>
+        Node(uint64_t h, const Key& k, Args&&... args)
+            : hash(h), key(k), value(std::forward<Args>(args)...) {}
+
+        std::atomic<Node*> next{nullptr};
+        const uint64_t hash;
+        const Key key;
+        Value value;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex writeMutex;
+        std::atomic<size_t> count{0};
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+
+    Shard& ShardFor(uint64_t hash) const
+    {
+        return shards_[shardBits_ ? (hash >> (64 - shardBits_)) : 0];
+    }
+
+    // Caller holds an EpochReclaimer::Guard
+    const Node* Find(uint64_t hash, const Key& key) const
+    {
+        const Shard& shard = ShardFor(hash);
+        for (const Node* n = shard.buckets[hash & bucketMask_].load(std::memory_order_acquire); n;
+             n = n->next.load(std::memory_order_acquire)) {
+            if (n->hash == hash && equal_(n->key, key)) return n;
+        }
+        return nullptr;
+    }
+
+    static void Retire(Node* n)
+    {
+        Core::EpochReclaimer::Instance().Retire(n, [](void* p) { delete static_cast<Node*>(p); });
+    }
+
+    std::unique_ptr<Shard[]> shards_;
+    uint32_t shardBits_ = 0;
+    size_t bucketMask_ = 0;
+    [[no_unique_address]] KeyEqual equal_;
+};
+
+} // namespace Bench
+} // namespace UltraImageViewer
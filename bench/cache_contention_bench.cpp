@@ -0,0 +1,276 @@
+// cache_contention_bench: render-thread Tier 1 lookup latency while pool
+// workers hammer the same maps, comparing the old layout (one std::mutex over
+// unordered_maps) with the sharded, epoch-protected ShardedCache that replaced
+// it (now only in bench/ShardedCache.hpp) and with the ImageId-indexed flat
+// table ThumbnailPipeline uses now.
+//
+// Workers mimic ThumbnailDecodeTask bookkeeping: Tier 1 contains-check plus a
+// pending-request erase/insert. The render thread looks up one screen of cells
+// per frame and replaces a few entries (uploads), as FlushReadyThumbnails does.
+//
+//   cache_contention_bench [--entries 20000] [--ms 400] [--lookups 200]
+//                          [--writes 16] [--work-us 2] [--workers 1,8,32]
+
+#include "BenchCommon.hpp"
+#include "ShardedCache.hpp"
+#include "core/EpochReclaimer.hpp"
+#include "core/IdTable.hpp"
+#include "core/ThumbnailPipeline.hpp"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <type_traits>
+#include <thread>
+#include <unordered_map>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+using Path = std::filesystem::path;
+
+struct PathEqual {
+    bool operator()(const Path& a, const Path& b) const { return a.native() == b.native(); }
+};
+
+struct Entry {
+    Entry(Core::TextureHandle t, uint32_t w, uint32_t h) : texture(std::move(t)), width(w), height(h) {}
+    Core::TextureHandle texture;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Pre-change layout: every map behind one mutex
+class MutexBackend {
+public:
+    static constexpr const char* kName = "single mutex";
+
+    Core::TextureHandle Lookup(uint64_t, const Path& p)
+    {
+        std::lock_guard lock(mutex_);
+        auto it = cache_.find(p);
+        return it != cache_.end() ? it->second.texture : nullptr;
+    }
+
+    void Insert(uint64_t, const Path& p, Core::TextureHandle t)
+    {
+        std::lock_guard lock(mutex_);
+        cache_.insert_or_assign(p, Entry(std::move(t), 160, 120));
+    }
+
+    void WorkerOp(uint64_t, const Path& p, uint64_t gen)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            if (cache_.contains(p)) pending_.erase(p);
+        }
+        std::lock_guard lock(mutex_);
+        pending_[p] = gen;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<Path, Entry> cache_;
+    std::unordered_map<Path, uint64_t> pending_;
+};
+
+class ShardedBackend {
+public:
+    static constexpr const char* kName = "sharded + epoch";
+
+    Core::TextureHandle Lookup(uint64_t h, const Path& p)
+    {
+        Core::TextureHandle t;
+        cache_.Visit(h, p, [&](const Entry& e) { t = e.texture; });
+        return t;
+    }
+
+    void Insert(uint64_t h, const Path& p, Core::TextureHandle t)
+    {
+        cache_.Emplace(h, p, std::move(t), 160u, 120u);
+    }
+
+    void WorkerOp(uint64_t h, const Path& p, uint64_t gen)
+    {
+        if (cache_.Contains(h, p)) pending_.Erase(h, p);
+        pending_.Emplace(h, p, gen);
+    }
+
+private:
+    ShardedCache<Path, Entry, PathEqual> cache_;
+    ShardedCache<Path, uint64_t, PathEqual> pending_{4096};
+};
+
+// Current layout: key is a dense id, slot holds an epoch-protected entry pointer
+class IdTableBackend {
+public:
+    static constexpr const char* kName = "id table + epoch";
+
+    ~IdTableBackend()
+    {
+        slots_.ForEach(slots_.kCapacity, [](Core::ImageId, Slot& s) {
+            delete s.entry.load(std::memory_order_relaxed);
+        });
+    }
+
+    Core::TextureHandle Lookup(Core::ImageId id, const Path&)
+    {
+        Core::EpochReclaimer::Guard guard;
+        const Slot* slot = slots_.Find(id);
+        const Entry* e = slot ? slot->entry.load(std::memory_order_acquire) : nullptr;
+        return e ? e->texture : nullptr;
+    }
+
+    void Insert(Core::ImageId id, const Path&, Core::TextureHandle t)
+    {
+        Entry* old = slots_[id].entry.exchange(new Entry(std::move(t), 160, 120),
+                                                std::memory_order_acq_rel);
+        if (old) {
+            Core::EpochReclaimer::Instance().Retire(old, [](void* p) {
+                delete static_cast<Entry*>(p);
+            });
+        }
+    }
+
+    void WorkerOp(Core::ImageId id, const Path& p, uint64_t gen)
+    {
+        Slot& slot = slots_[id];
+        if (Lookup(id, p)) slot.pending.store(0, std::memory_order_release);
+        slot.pending.store(gen + 1, std::memory_order_release);
+    }
+
+private:
+    struct Slot {
+        std::atomic<Entry*> entry{nullptr};
+        std::atomic<uint64_t> pending{0};
+    };
+    Core::IdTable<Slot> slots_;
+};
+
+struct Keys {
+    std::vector<Path> paths;
+    std::vector<uint64_t> hashes;  // path hash for map backends, ImageId for IdTableBackend
+    std::vector<uint64_t> ids;
+};
+
+uint64_t HashPath(const Path& path)
+{
+    // Same mixing the sharded cache relied on: top bits select the shard
+    uint64_t h = std::hash<Path::string_type>{}(path.native());
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+template <typename Backend>
+void Run(const Keys& baseKeys, int workers, double durationMs, int lookupsPerFrame,
+         int writesPerFrame, double workUs)
+{
+    // Map backends key on the path hash; the id table keys on the dense id
+    Keys keys = baseKeys;
+    if constexpr (std::is_same_v<Backend, IdTableBackend>) keys.hashes = keys.ids;
+
+    Backend backend;
+    auto texture = std::make_shared<int>(0);
+    for (size_t i = 0; i < keys.paths.size(); ++i) {
+        backend.Insert(keys.hashes[i], keys.paths[i], texture);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> workerOps{0};
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w] {
+            std::mt19937 rng(static_cast<uint32_t>(w * 7919 + 1));
+            std::uniform_int_distribution<size_t> pick(0, keys.paths.size() - 1);
+            uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                size_t k = pick(rng);
+                backend.WorkerOp(keys.hashes[k], keys.paths[k], ops);
+                SpinFor(workUs);
+                ++ops;
+            }
+            workerOps.fetch_add(ops);
+        });
+    }
+
+    LatencyRecorder lookupLat, frameLat;
+    size_t misses = 0;
+    size_t topCell = 0;
+    auto start = Clock::now();
+    while (ElapsedUs(start) < durationMs * 1000.0) {
+        auto f0 = Clock::now();
+        for (int i = 0; i < lookupsPerFrame; ++i) {
+            size_t k = (topCell + i) % keys.paths.size();
+            auto l0 = Clock::now();
+            if (!backend.Lookup(keys.hashes[k], keys.paths[k])) ++misses;
+            lookupLat.Add(ElapsedUs(l0));
+        }
+        for (int i = 0; i < writesPerFrame; ++i) {
+            size_t k = (topCell + lookupsPerFrame + i) % keys.paths.size();
+            backend.Insert(keys.hashes[k], keys.paths[k], texture);
+        }
+        frameLat.Add(ElapsedUs(f0));
+        topCell += 12;
+        std::this_thread::yield();
+    }
+
+    stop = true;
+    for (auto& t : threads) t.join();
+
+    char label[64];
+    std::printf("\n%s, %d worker(s): %llu worker ops, %zu misses\n", Backend::kName, workers,
+                static_cast<unsigned long long>(workerOps.load()), misses);
+    std::snprintf(label, sizeof(label), "lookup");
+    lookupLat.Print(label);
+    std::snprintf(label, sizeof(label), "frame (%d lookups)", lookupsPerFrame);
+    frameLat.Print(label);
+}
+
+std::vector<int> ParseList(const std::string& s)
+{
+    std::vector<int> out;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        out.push_back(std::atoi(s.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t entries   = static_cast<size_t>(args.Get("entries", 20000));
+    const double durationMs = args.GetDouble("ms", 400.0);
+    const int lookups      = static_cast<int>(args.Get("lookups", 200));
+    const int writes       = static_cast<int>(args.Get("writes", 16));
+    const double workUs    = args.GetDouble("work-us", 2.0);
+    const auto workerList  = ParseList(args.GetString("workers", "1,8,32"));
+
+    Keys keys;
+    for (size_t i = 0; i < entries; ++i) {
+        keys.paths.emplace_back("/synthetic/DCIM/Camera/IMG_2024" + std::to_string(100000 + i) + ".jpg");
+        keys.hashes.push_back(HashPath(keys.paths.back()));
+        keys.ids.push_back(i);
+    }
+
+    std::printf("cache_contention_bench: %zu entries, %d lookups + %d writes per frame, "
+                "worker work %.1fus, %u hardware threads\n",
+                entries, lookups, writes, workUs, std::thread::hardware_concurrency());
+
+    for (int w : workerList) {
+        Run<MutexBackend>(keys, w, durationMs, lookups, writes, workUs);
+        Run<ShardedBackend>(keys, w, durationMs, lookups, writes, workUs);
+        Run<IdTableBackend>(keys, w, durationMs, lookups, writes, workUs);
+    }
+    return 0;
+}
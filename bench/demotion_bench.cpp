@@ -0,0 +1,210 @@
+// demotion_bench: render-thread frame time while Tier 1 evictions demote
+// thumbnails to the compressed Tier 2 cache. Tier 1 is filled to
+// --resident photo-like thumbnails, then a 60 Hz scroll through unseen images
+// uploads up to 64 thumbnails per frame (Theme::MaxBitmapsPerFrame), each
+// forcing an eviction. The same scroll runs with Tier 2 compression on the
+// render thread (Config::asyncDemotion = false) and on a pool worker, and
+// the frame CPU time (flush + requests) is reported as a histogram.
+// Exits with status 1 if more than 1% of the worker run's frames reach
+// 16 ms (ctest runs it this way with a short scroll).
+//
+//   demotion_bench [--resident 2000] [--frames 600] [--thumb 160] [--unique 64]
+//                  [--columns 8] [--rows-per-frame 8] [--workers 0]
+
+#include "BenchCommon.hpp"
+#include "core/ThumbnailPipeline.hpp"
+#include <array>
+#include <thread>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+// Serves copies of a fixed set of synthetic photos (decode cost excluded)
+class PhotoPixelSource : public Core::PixelSource {
+public:
+    explicit PhotoPixelSource(const std::vector<SyntheticPhoto>& photos) : photos_(photos) {}
+
+    bool DecodeThumbnail(const std::filesystem::path& path, uint32_t, Core::PixelBuffer& out) override
+    {
+        const SyntheticPhoto& img = photos_[std::hash<std::string>{}(path.string()) % photos_.size()];
+        out.width = img.width;
+        out.height = img.height;
+        out.pixels = std::make_unique<uint8_t[]>(img.bgra.size());
+        std::memcpy(out.pixels.get(), img.bgra.data(), img.bgra.size());
+        return true;
+    }
+
+private:
+    const std::vector<SyntheticPhoto>& photos_;
+};
+
+class NullTextureSink : public Core::TextureSink {
+public:
+    Core::TextureHandle CreateTexture(uint32_t, uint32_t, const uint8_t*) override
+    {
+        return Core::TextureHandle(&token_, [](void*) {});
+    }
+
+private:
+    int token_ = 0;
+};
+
+// Frame counts per CPU-time bucket; the last bucket is a missed 60 Hz frame
+class FrameHistogram {
+public:
+    void Add(double us)
+    {
+        size_t b = 0;
+        while (b < kBounds.size() && us >= kBounds[b] * 1000.0) ++b;
+        ++counts_[b];
+        ++total_;
+    }
+
+    size_t Over(double ms) const
+    {
+        size_t n = 0;
+        for (size_t b = 0; b < kBounds.size(); ++b) {
+            if (kBounds[b] >= ms) n += counts_[b + 1];
+        }
+        return n;
+    }
+
+    void Print() const
+    {
+        double lo = 0.0;
+        for (size_t b = 0; b <= kBounds.size(); ++b) {
+            char label[32];
+            if (b < kBounds.size()) {
+                std::snprintf(label, sizeof(label), "%4.0f-%-3.0f ms", lo, kBounds[b]);
+            } else {
+                std::snprintf(label, sizeof(label), "%4.0f+    ms", lo);
+            }
+            size_t bar = total_ ? (counts_[b] * 50 + total_ - 1) / total_ : 0;
+            std::printf("    %s %6zu  %s\n", label, counts_[b], std::string(bar, '#').c_str());
+            if (b < kBounds.size()) lo = kBounds[b];
+        }
+    }
+
+private:
+    static constexpr std::array<double, 5> kBounds = {1.0, 2.0, 4.0, 8.0, 16.0};
+    std::array<size_t, 6> counts_{};
+    size_t total_ = 0;
+};
+
+void WaitIdle(Core::ThreadPool& pool, Core::ThumbnailPipeline& pipeline)
+{
+    for (;;) {
+        pipeline.FlushReadyThumbnails(64);
+        if (pool.PendingCount() == 0 && pool.ActiveCount() == 0 && !pipeline.HasPendingThumbnails() &&
+            pipeline.GetStats().tier2Pending == 0) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t resident   = static_cast<size_t>(args.Get("resident", 2000));
+    const size_t frames     = static_cast<size_t>(args.Get("frames", 600));
+    const uint16_t thumb    = static_cast<uint16_t>(args.Get("thumb", 160));
+    const size_t unique     = static_cast<size_t>(std::max<long long>(1, args.Get("unique", 64)));
+    const size_t columns    = static_cast<size_t>(args.Get("columns", 8));
+    const size_t rowsPerFrame = static_cast<size_t>(args.Get("rows-per-frame", 8));
+    const uint32_t workers  = static_cast<uint32_t>(args.Get("workers", 0));
+    constexpr int kMaxUploadsPerFrame = 64;  // Theme::MaxBitmapsPerFrame
+    const auto framePeriod = std::chrono::microseconds(16667);
+
+    std::vector<SyntheticPhoto> photos;
+    for (size_t i = 0; i < unique; ++i) {
+        photos.push_back(MakeSyntheticPhoto(static_cast<uint32_t>(i * 7919 + 1), thumb,
+                                            static_cast<uint16_t>(thumb * 3 / 4), 3));
+    }
+    const size_t thumbBytes = photos[0].bgra.size();
+
+    const size_t step = rowsPerFrame * columns;
+    const size_t imageCount = resident + frames * step;
+    Core::PathInterner interner;
+    std::vector<Core::ImageId> images;
+    images.reserve(imageCount);
+    for (size_t i = 0; i < imageCount; ++i) {
+        images.push_back(interner.Intern("/synthetic/DCIM/IMG_" + std::to_string(i) + ".jpg"));
+    }
+
+    PhotoPixelSource source(photos);
+    NullTextureSink sink;
+    auto compressor = std::shared_ptr<Core::PixelCompressor>(
+        Core::CreatePixelCompressor(Core::DefaultPixelCompressorKind()));
+
+    std::printf("demotion_bench: %zu resident %ux%u thumbnails, %zu frames at 60 Hz, "
+                "%zu new thumbnails requested per frame, compressor %s\n",
+                resident, photos[0].width, photos[0].height, frames, step, compressor->Name());
+
+    size_t workerSpikes = 0;
+    for (bool async : {false, true}) {
+        Core::ThreadPool pool(workers);
+        // `resident` thumbnails (texture + CPU copy) plus the default Tier 2
+        // reserve; nothing is persisted, so there is no save buffer
+        Core::ThumbnailPipeline::Config config;
+        config.memoryBudgetBytes = resident * thumbBytes * 2 + config.tier2ReserveBytes;
+        config.collectSaveBuffer = false;
+        config.tier2Compressor = compressor;
+        config.asyncDemotion = async;
+        Core::ThumbnailPipeline pipeline(&interner, &source, &sink, &pool, config);
+
+        for (size_t i = 0; i < resident; ++i) pipeline.RequestThumbnail(images[i], thumb);
+        WaitIdle(pool, pipeline);
+        auto filled = pipeline.GetStats();
+
+        FrameHistogram histogram;
+        LatencyRecorder frameLat;
+        std::vector<Core::ImageId> visible;
+        auto nextFrame = Clock::now();
+        for (size_t f = 0; f < frames; ++f) {
+            std::this_thread::sleep_until(nextFrame);
+            nextFrame += framePeriod;
+
+            auto start = Clock::now();
+            pipeline.FlushReadyThumbnails(kMaxUploadsPerFrame);
+            visible.clear();
+            for (size_t idx = resident + f * step; idx < resident + (f + 1) * step; ++idx) {
+                visible.push_back(images[idx]);
+                pipeline.RequestThumbnail(images[idx], thumb);
+            }
+            pipeline.SetVisibleRange(visible);
+            double us = ElapsedUs(start);
+            frameLat.Add(us);
+            histogram.Add(us);
+        }
+
+        auto drainStart = Clock::now();
+        WaitIdle(pool, pipeline);
+        double drainMs = ElapsedUs(drainStart) / 1000.0;
+        auto stats = pipeline.GetStats();
+
+        std::printf("\n%s demotion (%u workers)\n", async ? "Worker" : "Render-thread", pool.ThreadCount());
+        frameLat.Print("frame (CPU)");
+        histogram.Print();
+        std::printf("  frames >= 16 ms: %zu of %zu; evictions=%llu, tier2 %zu entries (%.1f MB), "
+                    "drained %.1f ms after the last frame\n",
+                    histogram.Over(16.0), frames,
+                    static_cast<unsigned long long>(stats.evictions - filled.evictions),
+                    stats.tier2Entries, stats.tier2Bytes / (1024.0 * 1024.0), drainMs);
+        if (async) workerSpikes = histogram.Over(16.0);
+
+        pool.PurgeAll();
+        pool.WaitIdle();
+    }
+
+    // One frame in a hundred is left for the scheduler
+    if (workerSpikes > frames / 100) {
+        std::printf("\nFAILED: %zu frames >= 16 ms with worker demotion\n", workerSpikes);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+// eviction_bench: worst-case FlushReadyThumbnails stall with a full Tier 1.
+// Fills the GPU tier to --resident thumbnails, then scrolls through fresh
+// images so every flush has to evict, and reports flush latency. For
+// reference it also times the previous policy's per-pass cost (collect every
+// entry, sort by last access) at the same cache size.
+//
+//   eviction_bench [--resident 50000] [--frames 2000] [--thumb-px 16]
+//                  [--columns 6] [--rows 5] [--rows-per-frame 2] [--workers 0]
+
+#include "BenchCommon.hpp"
+#include "core/ThumbnailPipeline.hpp"
+#include <numeric>
+#include <random>
+#include <thread>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+// Square, flat-filled thumbnails: decode cost is irrelevant here, only the
+// byte accounting matters, and small pixels keep the save buffer modest
+class FlatPixelSource : public Core::PixelSource {
+public:
+    explicit FlatPixelSource(uint32_t px) : px_(px) {}
+
+    bool DecodeThumbnail(const std::filesystem::path&, uint32_t, Core::PixelBuffer& out) override
+    {
+        out.width = px_;
+        out.height = px_;
+        size_t bytes = static_cast<size_t>(px_) * px_ * 4;
+        out.pixels = std::make_unique<uint8_t[]>(bytes);
+        std::memset(out.pixels.get(), 0x80, bytes);
+        return true;
+    }
+
+private:
+    uint32_t px_;
+};
+
+// Texture handles that own nothing: isolates the pipeline's own bookkeeping
+class NullTextureSink : public Core::TextureSink {
+public:
+    Core::TextureHandle CreateTexture(uint32_t, uint32_t, const uint8_t*) override
+    {
+        return Core::TextureHandle(&token_, [](void*) {});
+    }
+
+private:
+    int token_ = 0;
+};
+
+void DrainUploads(Core::ThreadPool& pool, Core::ThumbnailPipeline& pipeline,
+                  LatencyRecorder* flushLat)
+{
+    while (pool.PendingCount() > 0 || pool.ActiveCount() > 0 || pipeline.HasPendingThumbnails()) {
+        auto t0 = Clock::now();
+        int n = pipeline.FlushReadyThumbnails(64);
+        if (flushLat && n > 0) flushLat->Add(ElapsedUs(t0));
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t resident     = static_cast<size_t>(args.Get("resident", 50000));
+    const size_t frames       = static_cast<size_t>(args.Get("frames", 2000));
+    const uint32_t thumbPx    = static_cast<uint32_t>(args.Get("thumb-px", 16));
+    const int columns         = static_cast<int>(args.Get("columns", 6));
+    const int visibleRows     = static_cast<int>(args.Get("rows", 5));
+    const int rowsPerFrame    = static_cast<int>(args.Get("rows-per-frame", 2));
+    const uint32_t workers    = static_cast<uint32_t>(args.Get("workers", 0));
+    constexpr int kPrefetchScreens = 3;
+
+    const size_t step = static_cast<size_t>(rowsPerFrame) * columns;
+    const size_t imageCount = resident + frames * step +
+                              static_cast<size_t>(visibleRows) * columns * (kPrefetchScreens + 1);
+    const size_t thumbBytes = static_cast<size_t>(thumbPx) * thumbPx * 4;
+
+    Core::PathInterner interner;
+    std::vector<Core::ImageId> images;
+    images.reserve(imageCount);
+    for (size_t i = 0; i < imageCount; ++i) {
+        images.push_back(interner.Intern("/synthetic/DCIM/IMG_" + std::to_string(i) + ".jpg"));
+    }
+
+    FlatPixelSource source(thumbPx);
+    NullTextureSink sink;
+    Core::ThreadPool pool(workers);
+
+    // Exactly `resident` thumbnails fit: each costs its texture plus the CPU
+    // copy Tier 1 keeps. Nothing is persisted and Tier 2 is not under test.
+    Core::ThumbnailPipeline::Config config;
+    config.memoryBudgetBytes = resident * thumbBytes * 2;
+    config.tier2ReserveBytes = 0;
+    config.collectSaveBuffer = false;
+    Core::ThumbnailPipeline pipeline(&interner, &source, &sink, &pool, config);
+
+    std::printf("eviction_bench: %zu resident thumbnails (%ux%u, budget %.1f MB), "
+                "%zu scroll frames, %u workers\n",
+                resident, thumbPx, thumbPx, config.memoryBudgetBytes / (1024.0 * 1024.0),
+                frames, pool.ThreadCount());
+
+    // Fill Tier 1 to the budget
+    LatencyRecorder fillLat;
+    for (size_t i = 0; i < resident; ++i) {
+        pipeline.RequestThumbnail(images[i], thumbPx);
+        if ((i + 1) % 4096 == 0) DrainUploads(pool, pipeline, &fillLat);
+    }
+    DrainUploads(pool, pipeline, &fillLat);
+    auto filled = pipeline.GetStats();
+
+    // Steady scroll through unseen images: every upload now forces an eviction
+    LatencyRecorder flushLat, frameLat;
+    std::vector<Core::ImageId> visible;
+    for (size_t f = 0; f < frames; ++f) {
+        auto frameStart = Clock::now();
+
+        auto t0 = Clock::now();
+        pipeline.FlushReadyThumbnails(64);
+        flushLat.Add(ElapsedUs(t0));
+
+        size_t top = resident + f * step;
+        size_t first = top - static_cast<size_t>(visibleRows) * columns * kPrefetchScreens;
+        size_t last = top + static_cast<size_t>(visibleRows) * columns * (kPrefetchScreens + 1);
+        visible.clear();
+        for (size_t idx = first; idx < last; ++idx) {
+            bool onScreen = idx >= top && idx < top + static_cast<size_t>(visibleRows) * columns;
+            if (onScreen) visible.push_back(images[idx]);
+            pipeline.RequestThumbnail(images[idx], thumbPx);
+        }
+        pipeline.SetVisibleRange(visible);
+        frameLat.Add(ElapsedUs(frameStart));
+
+        // Let the workers keep up so each flush has a full batch to upload
+        while (pool.PendingCount() > 0 || pool.ActiveCount() > 0) std::this_thread::yield();
+    }
+    auto stats = pipeline.GetStats();
+
+    // Reference: one pass of the previous policy over the same number of
+    // entries (gather + sort by last access; eviction itself excluded)
+    LatencyRecorder sortLat;
+    {
+        struct Candidate { Core::ImageId id; int64_t lastAccess; };
+        std::mt19937_64 rng(42);
+        std::vector<int64_t> access(resident);
+        for (auto& a : access) a = static_cast<int64_t>(rng() >> 16);
+        std::vector<Candidate> candidates;
+        for (int pass = 0; pass < 20; ++pass) {
+            auto t0 = Clock::now();
+            candidates.clear();
+            candidates.reserve(resident);
+            for (size_t i = 0; i < resident; ++i) {
+                candidates.push_back({static_cast<Core::ImageId>(i), access[i]});
+            }
+            std::sort(candidates.begin(), candidates.end(),
+                      [](const Candidate& a, const Candidate& b) { return a.lastAccess < b.lastAccess; });
+            sortLat.Add(ElapsedUs(t0));
+            access[pass % resident] += 1;
+        }
+    }
+
+    std::printf("\nFill (%zu uploads, no eviction)\n", static_cast<size_t>(filled.uploads));
+    fillLat.Print("FlushReadyThumbnails");
+    std::printf("\nSteady scroll at budget (CLOCK eviction)\n");
+    flushLat.Print("FlushReadyThumbnails");
+    frameLat.Print("frame (CPU)");
+    std::printf("  evictions=%llu, resident %zu entries (%.1f MB)\n",
+                static_cast<unsigned long long>(stats.evictions - filled.evictions),
+                stats.gpuEntries, stats.gpuBytes / (1024.0 * 1024.0));
+    std::printf("\nReference: previous sort-all pass at %zu entries\n", resident);
+    sortLat.Print("gather + sort");
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Cold-scan thumbnail throughput with and without the embedded-preview fast
+// path (FindEmbeddedPreview / JpegPixelSource).
+//
+// Builds a directory of camera-like JPEGs: the main image, an EXIF APP1
+// whose IFD1 holds a 160x120 thumbnail, and an MPF APP2 pointing at a
+// quarter-size preview appended after the primary image (as Canon/Sony/
+// Nikon bodies write). `--unique` distinct images are encoded and copied
+// to `--images` files. Both passes run JpegPixelSource over every file on a
+// ThreadPool; on Linux the page cache is dropped for the corpus before each
+// pass (posix_fadvise DONTNEED), so reads come from storage.
+//
+//   exif_thumb_bench [--images 10000] [--unique 16] [--width 4000] [--height 3000]
+//                    [--target 160] [--threads N] [--keep 0]
+
+#include "BenchCommon.hpp"
+#include "core/ExifThumbnail.hpp"
+#include "core/JpegThumbnail.hpp"
+#include "core/Resampler.hpp"
+#include "core/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <jpeglib.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+using namespace UltraImageViewer::Core;
+
+namespace {
+
+std::vector<uint8_t> MakeRgb(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = rgb.data() + static_cast<size_t>(y) * width * 3;
+        for (uint32_t x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            uint32_t grain = state >> 30;
+            bool edge = ((x * 16 / width + seed) + (y * 12 / height)) & 1;
+            row[x * 3 + 0] = static_cast<uint8_t>((x * 200 / width) + grain + (edge ? 40 : 0));
+            row[x * 3 + 1] = static_cast<uint8_t>((y * 180 / height) + grain);
+            row[x * 3 + 2] = static_cast<uint8_t>(((x + y) * 120 / (width + height)) + (edge ? 90 : 10));
+        }
+    }
+    return rgb;
+}
+
+// Nearest-neighbour reduction is enough for preview content
+std::vector<uint8_t> Shrink(const std::vector<uint8_t>& rgb, uint32_t w, uint32_t h, uint32_t dw, uint32_t dh)
+{
+    std::vector<uint8_t> out(static_cast<size_t>(dw) * dh * 3);
+    for (uint32_t y = 0; y < dh; ++y) {
+        for (uint32_t x = 0; x < dw; ++x) {
+            const uint8_t* s = rgb.data() + (static_cast<size_t>(y) * h / dh * w + static_cast<size_t>(x) * w / dw) * 3;
+            std::copy(s, s + 3, out.data() + (static_cast<size_t>(y) * dw + x) * 3);
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> EncodeJpeg(const std::vector<uint8_t>& rgb, uint32_t width, uint32_t height, int quality)
+{
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr err;
+    cinfo.err = jpeg_std_error(&err);
+    jpeg_create_compress(&cinfo);
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < height) {
+        JSAMPROW row = const_cast<uint8_t*>(rgb.data() + static_cast<size_t>(cinfo.next_scanline) * width * 3);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    std::vector<uint8_t> out(buffer, buffer + size);
+    jpeg_destroy_compress(&cinfo);
+    std::free(buffer);
+    return out;
+}
+
+void Put16(std::vector<uint8_t>& v, uint32_t x) { v.push_back(uint8_t(x)); v.push_back(uint8_t(x >> 8)); }
+void Put32(std::vector<uint8_t>& v, uint32_t x) { Put16(v, x & 0xFFFF); Put16(v, x >> 16); }
+void PutEntry(std::vector<uint8_t>& v, uint16_t tag, uint16_t type, uint32_t count, uint32_t value)
+{
+    Put16(v, tag); Put16(v, type); Put32(v, count);
+    if (type == 3) { Put16(v, value); Put16(v, 0); } else { Put32(v, value); }
+}
+
+void PutSegment(std::vector<uint8_t>& file, uint8_t marker, const std::vector<uint8_t>& payload)
+{
+    file.push_back(0xFF);
+    file.push_back(marker);
+    file.push_back(uint8_t((payload.size() + 2) >> 8));
+    file.push_back(uint8_t(payload.size() + 2));
+    file.insert(file.end(), payload.begin(), payload.end());
+}
+
+// SOI, APP1 Exif (IFD0 -> Exif IFD with pixel size, IFD1 -> thumbnail),
+// APP2 MPF (primary + preview), rest of the primary, then the preview
+std::vector<uint8_t> BuildCameraJpeg(const std::vector<uint8_t>& main, uint32_t width, uint32_t height,
+                                     const std::vector<uint8_t>& thumb, const std::vector<uint8_t>& preview)
+{
+    std::vector<uint8_t> exif = {'E', 'x', 'i', 'f', 0, 0, 'I', 'I', 0x2A, 0, 8, 0, 0, 0};
+    // IFD0 @8 (1 entry, 18 bytes), Exif IFD @26 (2 entries, 30), IFD1 @56 (3 entries, 42), thumb @98
+    Put16(exif, 1); PutEntry(exif, 0x8769, 4, 1, 26); Put32(exif, 56);
+    Put16(exif, 2); PutEntry(exif, 0xA002, 4, 1, width); PutEntry(exif, 0xA003, 4, 1, height); Put32(exif, 0);
+    Put16(exif, 3); PutEntry(exif, 0x0103, 3, 1, 6); PutEntry(exif, 0x0201, 4, 1, 98);
+    PutEntry(exif, 0x0202, 4, 1, static_cast<uint32_t>(thumb.size())); Put32(exif, 0);
+    exif.insert(exif.end(), thumb.begin(), thumb.end());
+
+    // MPF: header @0, IFD @8 (2 entries, 30 bytes), MP entries @38 (2 x 16)
+    constexpr size_t kMpfPayload = 4 + 8 + 30 + 32;
+    const size_t mpfTiffStart = 2 + (4 + exif.size()) + 8;
+    const size_t previewOffset = 2 + (4 + exif.size()) + (4 + kMpfPayload) + (main.size() - 2);
+    std::vector<uint8_t> mpf = {'M', 'P', 'F', 0, 'I', 'I', 0x2A, 0, 8, 0, 0, 0};
+    Put16(mpf, 2); PutEntry(mpf, 0xB001, 4, 1, 2); PutEntry(mpf, 0xB002, 7, 32, 38); Put32(mpf, 0);
+    Put32(mpf, 0x20030000); Put32(mpf, static_cast<uint32_t>(main.size())); Put32(mpf, 0); Put32(mpf, 0);
+    Put32(mpf, 0x00010002); Put32(mpf, static_cast<uint32_t>(preview.size()));
+    Put32(mpf, static_cast<uint32_t>(previewOffset - mpfTiffStart)); Put32(mpf, 0);
+
+    std::vector<uint8_t> file = {0xFF, 0xD8};
+    PutSegment(file, 0xE1, exif);
+    PutSegment(file, 0xE2, mpf);
+    file.insert(file.end(), main.begin() + 2, main.end());
+    file.insert(file.end(), preview.begin(), preview.end());
+    return file;
+}
+
+void DropFromPageCache(const std::vector<std::filesystem::path>& files)
+{
+#if defined(__linux__)
+    ::sync();
+    for (const auto& path : files) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)files;
+#endif
+}
+
+// Bytes this process caused to be fetched from storage (Linux only)
+long long StorageReadBytes()
+{
+#if defined(__linux__)
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    long long value;
+    while (io >> key >> value) {
+        if (key == "read_bytes:") return value;
+    }
+#endif
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const int images = static_cast<int>(args.Get("images", 10000));
+    const int unique = static_cast<int>(std::max<long long>(1, args.Get("unique", 16)));
+    const uint32_t width = static_cast<uint32_t>(args.Get("width", 4000));
+    const uint32_t height = static_cast<uint32_t>(args.Get("height", 3000));
+    const uint32_t target = static_cast<uint32_t>(args.Get("target", 160));
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t threads = static_cast<uint32_t>(args.Get("threads", hw));
+    const bool keep = args.Get("keep", 0) != 0;
+
+    if (!JpegThumbnailAvailable()) {
+        std::printf("exif_thumb_bench: uiv_core was built without libjpeg\n");
+        return 1;
+    }
+
+    auto dir = std::filesystem::temp_directory_path() / "uiv_exif_thumb_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // 160x120-class EXIF thumbnail and quarter-size MPF preview, same aspect
+    uint32_t tw, th, pw, ph;
+    ThumbnailScaler::FitWithin(width, height, 160, tw, th);
+    ThumbnailScaler::FitWithin(width, height, std::max(width, height) / 4, pw, ph);
+
+    std::vector<std::vector<uint8_t>> bodies;
+    for (int u = 0; u < unique; ++u) {
+        auto rgb = MakeRgb(width, height, static_cast<uint32_t>(u + 1));
+        bodies.push_back(BuildCameraJpeg(EncodeJpeg(rgb, width, height, 90), width, height,
+                                         EncodeJpeg(Shrink(rgb, width, height, tw, th), tw, th, 85),
+                                         EncodeJpeg(Shrink(rgb, width, height, pw, ph), pw, ph, 85)));
+    }
+
+    std::vector<std::filesystem::path> files;
+    double totalBytes = 0.0;
+    for (int i = 0; i < images; ++i) {
+        auto path = dir / ("IMG_" + std::to_string(10000 + i) + ".JPG");
+        const auto& body = bodies[static_cast<size_t>(i) % bodies.size()];
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(body.data()),
+                                                    static_cast<std::streamsize>(body.size()));
+        totalBytes += static_cast<double>(body.size());
+        files.push_back(path);
+    }
+
+    EmbeddedPreview probe;
+    bool hasPreview = FindEmbeddedPreview(bodies[0].data(), bodies[0].size(), target, probe);
+    std::printf("exif_thumb_bench: %d files (%.2f MB avg, %ux%u), %u px thumbnails, %u threads\n",
+                images, totalBytes / images / 1e6, width, height, target, threads);
+    std::printf("  embedded: %ux%u EXIF thumbnail, %ux%u MPF preview; chosen for %u px: %s\n",
+                tw, th, pw, ph, target,
+                hasPreview ? (std::to_string(probe.width) + "x" + std::to_string(probe.height)).c_str() : "none");
+#if !defined(__linux__)
+    std::printf("  (page cache not dropped on this platform: passes run warm)\n");
+#endif
+
+    std::printf("\n  %-26s %10s %12s %14s %10s\n", "path", "seconds", "thumbs/s", "read KB/thumb", "failed");
+
+    ThreadPool pool(threads);
+    double baselineRate = 0.0;
+    for (bool embedded : {false, true}) {
+        JpegPixelSource source(nullptr, embedded);
+        DropFromPageCache(files);
+        std::atomic<int> failed{0};
+        long long readBefore = StorageReadBytes();
+
+        auto start = Clock::now();
+        for (const auto& path : files) {
+            pool.Submit([&source, &failed, &path, target] {
+                PixelBuffer out;
+                if (!source.DecodeThumbnail(path, target, out)) failed.fetch_add(1);
+            });
+        }
+        pool.WaitIdle();
+        double seconds = ElapsedUs(start) / 1e6;
+
+        long long readAfter = StorageReadBytes();
+        double readKb = readBefore >= 0 ? static_cast<double>(readAfter - readBefore) / 1024.0 / images : -1.0;
+        double rate = images / seconds;
+        if (!embedded) baselineRate = rate;
+        std::printf("  %-26s %10.2f %12.1f %14.1f %10d\n",
+                    embedded ? "embedded preview" : "DCT-scaled main image", seconds, rate, readKb,
+                    failed.load());
+        if (embedded) std::printf("\n  speedup: %.1fx\n", rate / baselineRate);
+    }
+
+    if (!keep) std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,360 @@
+// fling_bench: wasted thumbnail decodes during fling scrolls. Replays a
+// per-frame scroll trace through ThumbnailPipeline the way GalleryView
+// drives it (fast-scroll detection from the smoothed velocity, requests for
+// the prefetch zone, SetVisibleRange every frame) at 60 Hz in real time,
+// with decodes costing --decode-us on the pool's workers.
+//
+// A decode is wasted when its cell is never on screen again after it
+// finishes. Four scheduling policies:
+//   static:   Config::rerankRequests off; on-screen cells first, the rest in
+//             request order, dropped (all at once) only when a fast scroll
+//             starts
+//   rerank:   the same order, but re-ranked every frame and dropped once out
+//             of the prefetch zone
+//   distance: cell extents and scroll velocity passed in (SetViewport), so
+//             the closest cell ahead of the scroll is decoded first
+//   landing:  distance, plus while fast scrolling the rows around the
+//             spring's predicted rest point (GalleryView::PredictScrollLanding)
+//             are requested and decoded on High; the rows in between are not
+// Reports decodes, wasted decodes, cancellations, how many flings had a full
+// screen the frame they came to rest, and the time to fill the screen once
+// each fling drops below the fast-scroll threshold (requests resume) and
+// once it comes to rest.
+//
+// The default trace is --flings flings driven by the gallery's scroll spring
+// (released at --velocity, Theme::ScrollStiffness/ScrollDamping, rubber band
+// at the ends) separated by half-second pauses, then --steps page-by-page
+// moves (one screen at 1500 px/s, below the fast-scroll threshold, then
+// 0.4 s at rest); --trace FILE replays one scroll offset (px) per line, with
+// no spring to predict from (landing then behaves like distance).
+//
+//   fling_bench [--images 20000] [--columns 6] [--rows 5] [--cell-px 170]
+//               [--decode-us 2000] [--flings 4] [--velocity 12000]
+//               [--steps 0] [--workers 0] [--seed 1] [--trace FILE]
+
+#include "BenchCommon.hpp"
+#include "animation/SpringAnimation.hpp"
+#include "core/ThumbnailPipeline.hpp"
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+constexpr double kFrameSeconds = 1.0 / 60.0;
+constexpr float kFastScrollThreshold = 2000.0f;  // Theme::FastScrollThreshold
+constexpr float kPrefetchScreens = 3.0f;         // Theme::PrefetchScreens
+constexpr float kLandingScreens = 0.5f;          // Theme::LandingPrefetchScreens
+constexpr int kMaxUploadsPerFrame = 64;          // Theme::MaxBitmapsPerFrame
+constexpr Animation::SpringConfig kScrollSpring{150.0f, 22.0f, 1.0f, 0.5f};      // Theme::Scroll*
+constexpr Animation::SpringConfig kRubberBandSpring{400.0f, 30.0f, 1.0f, 0.5f};  // Theme::RubberBand*
+
+// Burns --decode-us per thumbnail and records which frame each decode
+// finished in
+class TimedPixelSource : public Core::PixelSource {
+public:
+    TimedPixelSource(const Core::PathInterner& interner, double decodeUs,
+                     const std::atomic<uint64_t>& frame)
+        : interner_(interner), decodeUs_(decodeUs), frame_(frame) {}
+
+    bool DecodeThumbnail(const std::filesystem::path& path, uint32_t, Core::PixelBuffer& out) override
+    {
+        SpinFor(decodeUs_);
+        out.width = 32;
+        out.height = 32;
+        out.pixels = std::make_unique<uint8_t[]>(32 * 32 * 4);
+        std::memset(out.pixels.get(), 0x80, 32 * 32 * 4);
+
+        std::lock_guard lock(mutex_);
+        decodes.emplace_back(interner_.Find(path), frame_.load(std::memory_order_relaxed));
+        return true;
+    }
+
+    std::mutex mutex_;
+    std::vector<std::pair<Core::ImageId, uint64_t>> decodes;  // (id, frame finished)
+
+private:
+    const Core::PathInterner& interner_;
+    double decodeUs_;
+    const std::atomic<uint64_t>& frame_;
+};
+
+class NullTextureSink : public Core::TextureSink {
+public:
+    Core::TextureHandle CreateTexture(uint32_t, uint32_t, const uint8_t*) override
+    {
+        return Core::TextureHandle(&token_, [](void*) {});
+    }
+
+private:
+    int token_ = 0;
+};
+
+// One frame of a trace: the scroll offset and, while a fling is moving, the
+// spring's predicted rest point (NaN otherwise)
+struct TraceFrame {
+    float y;
+    float landing;
+};
+
+// Flings the way GalleryView::OnMouseUp and Update run them: the spring is
+// retargeted 0.6 s of release velocity ahead (at most 80 px past an end) and
+// pulled back by the rubber band once it slows down in overscroll. Mostly
+// downwards, with half a second at rest between them.
+std::vector<TraceFrame> MakeFlingTrace(int flings, float velocity, float maxScroll, uint32_t seed)
+{
+    const float dt = static_cast<float>(kFrameSeconds);
+    const float none = std::numeric_limits<float>::quiet_NaN();
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(0.6f, 1.0f);
+    std::vector<TraceFrame> trace;
+    Animation::SpringAnimation spring(kScrollSpring);
+    spring.SnapToTarget();
+    for (int f = 0; f < flings; ++f) {
+        float v = velocity * jitter(rng) * ((f % 3 == 2) ? -1.0f : 1.0f);
+        float target = std::clamp(spring.GetValue() + v * 0.6f, -80.0f, maxScroll + 80.0f);
+        spring.SetConfig(kScrollSpring);
+        spring.SetTarget(target);
+        while (!spring.IsFinished()) {
+            float y = spring.Update(dt);
+            if (std::abs(spring.GetVelocity()) < 500.0f && (y < 0.0f || y > maxScroll)) {
+                spring.SetTarget(y < 0.0f ? 0.0f : maxScroll);
+                if (std::abs(spring.GetVelocity()) < 100.0f) spring.SetConfig(kRubberBandSpring);
+            }
+            float landing = spring.IsFinished()
+                ? none
+                : std::clamp(spring.PredictValue(spring.PredictSettleTime()), 0.0f, maxScroll);
+            trace.push_back({y, landing});
+        }
+        for (int i = 0; i < 30; ++i) trace.push_back({spring.GetValue(), none});
+    }
+    return trace;
+}
+
+// Page-by-page reading: one screen down at a steady 1500 px/s, then a pause
+void AppendSteps(std::vector<TraceFrame>& trace, int steps, float screen, float maxScroll)
+{
+    const float none = std::numeric_limits<float>::quiet_NaN();
+    float y = trace.empty() ? 0.0f : trace.back().y;
+    const float perFrame = 1500.0f * static_cast<float>(kFrameSeconds);
+    for (int s = 0; s < steps; ++s) {
+        float target = std::min(y + screen, maxScroll);
+        while (y < target) {
+            y = std::min(y + perFrame, target);
+            trace.push_back({y, none});
+        }
+        for (int i = 0; i < 24; ++i) trace.push_back({y, none});
+    }
+}
+
+struct Result {
+    uint64_t decodes = 0;
+    uint64_t wasted = 0;
+    uint64_t cancelled = 0;
+    double visibleReady = 0.0;  // share of on-screen cells drawn with a thumbnail
+    uint64_t stops = 0;          // times the scroll came to rest
+    uint64_t fullAtStop = 0;     // ... with every on-screen cell drawn
+    LatencyRecorder slowFill;    // us from fast scroll ending to a full screen
+    LatencyRecorder stopFill;    // us from the scroll coming to rest to a full screen
+};
+
+enum class Policy { Static, Rerank, Distance, Landing };
+
+Result Run(Policy policy, const std::vector<TraceFrame>& trace, size_t imageCount, int columns,
+           int rows, float cellPx, double decodeUs, uint32_t workers)
+{
+    Core::PathInterner interner;
+    std::vector<Core::ImageId> images;
+    for (size_t i = 0; i < imageCount; ++i) {
+        images.push_back(interner.Intern("/synthetic/DCIM/IMG_" + std::to_string(i) + ".jpg"));
+    }
+
+    std::atomic<uint64_t> frame{0};
+    TimedPixelSource source(interner, decodeUs, frame);
+    NullTextureSink sink;
+    Core::ThreadPool pool(workers);
+
+    Core::ThumbnailPipeline::Config config;
+    config.memoryBudgetBytes = 1024ULL * 1024 * 1024;  // no evictions: only scheduling differs
+    config.collectSaveBuffer = false;
+    config.rerankRequests = policy != Policy::Static;
+    Core::ThumbnailPipeline pipeline(&interner, &source, &sink, &pool, config);
+
+    const float viewHeight = rows * cellPx;
+    const size_t totalRows = (imageCount + columns - 1) / columns;
+    std::vector<uint64_t> lastOnScreen(imageCount, 0);  // frame + 1, 0 = never
+
+    Result result;
+    size_t visibleHits = 0, visibleTotal = 0;
+    float prevY = trace.empty() ? 0.0f : trace[0].y;
+    float smoothed = 0.0f;
+    bool fast = false;
+    bool moving = false;
+    int64_t slowAt = -1;  // frame fast scrolling ended, until the screen is full
+    int64_t stopAt = -1;  // frame the scroll came to rest, likewise
+
+    std::vector<Core::ImageId> visible;
+    for (size_t f = 0; f < trace.size(); ++f) {
+        auto frameStart = Clock::now();
+        frame.store(f, std::memory_order_relaxed);
+        const float y = trace[f].y;
+
+        // GalleryView::Update: fast-scroll detection
+        float velocity = (y - prevY) / static_cast<float>(kFrameSeconds);
+        smoothed = smoothed * 0.6f + std::abs(velocity) * 0.4f;
+        bool wasFast = fast;
+        fast = smoothed > kFastScrollThreshold;
+        if (fast && !wasFast) {
+            pipeline.InvalidateRequests();
+            slowAt = -1;
+        }
+        if (wasFast && !fast) slowAt = static_cast<int64_t>(f);
+        if (y != prevY) {
+            moving = true;
+            stopAt = -1;
+        } else if (moving) {
+            moving = false;
+            stopAt = static_cast<int64_t>(f);
+        }
+        prevY = y;
+
+        // RenderImageGrid: flush, then walk the prefetch zone
+        pipeline.FlushReadyThumbnails(kMaxUploadsPerFrame);
+        const float landing = trace[f].landing;
+        const bool predict = policy == Policy::Landing && fast && !std::isnan(landing);
+        if (predict) {
+            pipeline.SetViewport(viewHeight, velocity, landing - y);
+        } else {
+            pipeline.SetViewport(viewHeight, velocity);
+        }
+        float margin = viewHeight * kPrefetchScreens;
+        size_t firstRow = static_cast<size_t>(std::max(0.0f, (y - margin) / cellPx));
+        size_t lastRow = std::min(totalRows, static_cast<size_t>((y + viewHeight + margin) / cellPx) + 1);
+        visible.clear();
+        bool screenFull = true;
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            float cellY = row * cellPx - y;
+            bool onScreen = cellY + cellPx >= 0.0f && cellY <= viewHeight;
+            for (int col = 0; col < columns; ++col) {
+                size_t idx = row * columns + col;
+                if (idx >= imageCount) break;
+                Core::TextureHandle tex;
+                if (fast) {
+                    if (onScreen) tex = pipeline.GetCachedThumbnail(images[idx]);
+                } else if (policy == Policy::Distance || policy == Policy::Landing) {
+                    tex = pipeline.RequestThumbnail(images[idx], 256, cellY, cellY + cellPx);
+                } else {
+                    tex = pipeline.RequestThumbnail(images[idx], 256);
+                }
+                if (onScreen) {
+                    visible.push_back(images[idx]);
+                    lastOnScreen[idx] = f + 1;
+                    ++visibleTotal;
+                    if (tex) ++visibleHits;
+                    else screenFull = false;
+                }
+            }
+        }
+
+        // RequestLandingZone: the rows around the rest point, none in between
+        if (predict) {
+            float zoneTop = std::max(0.0f, landing - viewHeight * kLandingScreens);
+            float zoneBottom = landing + viewHeight * (1.0f + kLandingScreens);
+            size_t zoneLast = std::min(totalRows, static_cast<size_t>(zoneBottom / cellPx) + 1);
+            for (size_t row = static_cast<size_t>(zoneTop / cellPx); row < zoneLast; ++row) {
+                float cellY = row * cellPx - y;
+                for (int col = 0; col < columns; ++col) {
+                    size_t idx = row * columns + col;
+                    if (idx >= imageCount) break;
+                    pipeline.RequestThumbnail(images[idx], 256, cellY, cellY + cellPx);
+                }
+            }
+        }
+        pipeline.SetVisibleRange(visible);
+
+        if (stopAt == static_cast<int64_t>(f)) {
+            ++result.stops;
+            if (screenFull) ++result.fullAtStop;
+        }
+        if (screenFull) {
+            if (slowAt >= 0) result.slowFill.Add((f - slowAt) * kFrameSeconds * 1e6);
+            if (stopAt >= 0) result.stopFill.Add((f - stopAt) * kFrameSeconds * 1e6);
+            slowAt = stopAt = -1;
+        }
+
+        std::this_thread::sleep_until(frameStart +
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(kFrameSeconds)));
+    }
+    pool.WaitIdle();
+
+    std::lock_guard lock(source.mutex_);
+    for (auto [id, doneFrame] : source.decodes) {
+        ++result.decodes;
+        // Ids are interned in order, so id == index
+        if (id >= imageCount || lastOnScreen[id] < doneFrame + 1) ++result.wasted;
+    }
+    result.cancelled = pipeline.GetStats().cancelled;
+    result.visibleReady = visibleTotal ? 100.0 * visibleHits / visibleTotal : 0.0;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t imageCount = static_cast<size_t>(args.Get("images", 20000));
+    const int columns       = static_cast<int>(args.Get("columns", 6));
+    const int rows          = static_cast<int>(args.Get("rows", 5));
+    const float cellPx      = static_cast<float>(args.GetDouble("cell-px", 170.0));
+    const double decodeUs   = args.GetDouble("decode-us", 2000.0);
+    const int flings        = static_cast<int>(args.Get("flings", 4));
+    const float velocity    = static_cast<float>(args.GetDouble("velocity", 12000.0));
+    const int steps         = static_cast<int>(args.Get("steps", 0));
+    const uint32_t workers  = static_cast<uint32_t>(args.Get("workers", 0));
+    const uint32_t seed     = static_cast<uint32_t>(args.Get("seed", 1));
+    const std::string tracePath = args.GetString("trace", "");
+
+    const float maxScroll = ((imageCount + columns - 1) / columns) * cellPx - rows * cellPx;
+    std::vector<TraceFrame> trace;
+    if (!tracePath.empty()) {
+        std::ifstream in(tracePath);
+        for (float y; in >> y;) trace.push_back({y, std::numeric_limits<float>::quiet_NaN()});
+    } else {
+        trace = MakeFlingTrace(flings, velocity, maxScroll, seed);
+        AppendSteps(trace, steps, rows * cellPx, maxScroll);
+    }
+
+    std::printf("fling_bench: %zu images, %dx%d grid of %.0f px cells, decode=%.0fus, "
+                "%zu frames at 60 Hz (%s)\n",
+                imageCount, columns, rows, cellPx, decodeUs, trace.size(),
+                tracePath.empty() ? "synthetic flings" : tracePath.c_str());
+
+    const std::pair<Policy, const char*> policies[] = {
+        {Policy::Static,   "Static: visible first, drop all on fast scroll"},
+        {Policy::Rerank,   "Rerank: visible first, re-ranked and pruned per frame"},
+        {Policy::Distance, "Distance: closest to the viewport first, scroll-direction bias"},
+        {Policy::Landing,  "Landing: distance, plus the predicted rest point during flings"},
+    };
+    for (auto [policy, label] : policies) {
+        Result r = Run(policy, trace, imageCount, columns, rows, cellPx, decodeUs, workers);
+        std::printf("\n%s\n", label);
+        std::printf("  decodes %llu, wasted %llu (%.1f%%), cancelled before start %llu\n",
+                    static_cast<unsigned long long>(r.decodes),
+                    static_cast<unsigned long long>(r.wasted),
+                    r.decodes ? 100.0 * r.wasted / r.decodes : 0.0,
+                    static_cast<unsigned long long>(r.cancelled));
+        std::printf("  visible cells ready at draw: %.1f%%\n", r.visibleReady);
+        std::printf("  full screen the frame the scroll stopped: %llu of %llu\n",
+                    static_cast<unsigned long long>(r.fullAtStop),
+                    static_cast<unsigned long long>(r.stops));
+        r.slowFill.Print("slow-down -> full screen");
+        r.stopFill.Print("stop -> full screen");
+    }
+    return 0;
+}
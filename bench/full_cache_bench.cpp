@@ -0,0 +1,293 @@
+// full_cache_bench: replays ImageViewer navigation traces against the
+// full-size image cache policy and reports hit rates. Each step does what
+// ImageViewer::LoadCurrentPage does: pin page ± 1, fetch the page, then
+// prefetch both neighbours. A miss on the page itself is a visible re-decode.
+//
+// Policies: the previous one (evict unordered_map::begin(), i.e. arbitrary),
+// plain LRU with the same pins, and ArcCache.
+//
+// Traces are generated deterministically; --trace FILE replays a recorded
+// sequence instead (whitespace-separated page indices).
+//
+// Exits with status 1 if ARC loses the page it was just told to pin, or
+// has a lower page hit rate than the previous policy on any trace (ctest
+// runs it this way with a short --steps).
+//
+//   full_cache_bench [--images 400] [--steps 20000] [--cache-mb 256]
+//                    [--seed 1] [--trace FILE]
+
+#include "BenchCommon.hpp"
+#include "core/ArcCache.hpp"
+#include <fstream>
+#include <list>
+#include <random>
+#include <unordered_map>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+using Trace = std::vector<uint32_t>;
+
+// Previous ImagePipeline policy: evict begin() while over budget and size > 1.
+// With libstdc++ begin() tends to be the most recent insertion.
+class ArbitraryPolicy {
+public:
+    static constexpr const char* kName = "arbitrary (previous)";
+    explicit ArbitraryPolicy(size_t capacity) : capacity_(capacity) {}
+
+    bool Get(uint32_t id) { return map_.contains(id); }
+    void Pin(std::vector<uint32_t>) {}
+
+    void Put(uint32_t id, size_t bytes)
+    {
+        map_[id] = bytes;
+        used_ += bytes;
+        while (used_ > capacity_ && map_.size() > 1) {
+            used_ -= map_.begin()->second;
+            map_.erase(map_.begin());
+        }
+    }
+
+private:
+    size_t capacity_;
+    size_t used_ = 0;
+    std::unordered_map<uint32_t, size_t> map_;
+};
+
+class LruPolicy {
+public:
+    static constexpr const char* kName = "LRU + pins";
+    explicit LruPolicy(size_t capacity) : capacity_(capacity) {}
+
+    bool Get(uint32_t id)
+    {
+        auto it = index_.find(id);
+        if (it == index_.end()) return false;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return true;
+    }
+
+    void Pin(std::vector<uint32_t> ids) { pinned_ = std::move(ids); }
+
+    void Put(uint32_t id, size_t bytes)
+    {
+        if (Get(id)) return;
+        lru_.push_front({id, bytes});
+        index_[id] = lru_.begin();
+        used_ += bytes;
+        auto it = lru_.end();
+        while (used_ > capacity_ && it != lru_.begin()) {
+            --it;
+            if (it->first == id ||
+                std::find(pinned_.begin(), pinned_.end(), it->first) != pinned_.end()) continue;
+            used_ -= it->second;
+            index_.erase(it->first);
+            it = lru_.erase(it);
+        }
+    }
+
+private:
+    size_t capacity_;
+    size_t used_ = 0;
+    std::list<std::pair<uint32_t, size_t>> lru_;
+    std::unordered_map<uint32_t, std::list<std::pair<uint32_t, size_t>>::iterator> index_;
+    std::vector<uint32_t> pinned_;
+};
+
+class ArcPolicy {
+public:
+    static constexpr const char* kName = "ARC + pins";
+    explicit ArcPolicy(size_t capacity) : cache_(capacity) {}
+
+    bool Get(uint32_t id) { return cache_.Get(id) != nullptr; }
+    bool Contains(uint32_t id) const { return cache_.Contains(id); }
+    void Pin(std::vector<uint32_t> ids) { cache_.SetPinned(std::move(ids)); }
+    void Put(uint32_t id, size_t bytes) { cache_.Put(id, 1, bytes); }
+
+    Core::ArcCache<uint32_t, int>::Stats Stats() const { return cache_.GetStats(); }
+
+private:
+    Core::ArcCache<uint32_t, int> cache_;
+};
+
+// Mix of 12/20/24 MP photos (BGRA bytes), fixed per index
+size_t ImageBytes(uint32_t index)
+{
+    static constexpr size_t kPixels[] = {4000 * 3000, 5472 * 3648, 6000 * 4000};
+    return kPixels[(index * 2654435761u >> 7) % 3] * 4;
+}
+
+// Swiping forward, often stepping back a few pages to compare
+Trace BackAndForth(uint32_t images, size_t steps, std::mt19937& rng)
+{
+    Trace t;
+    std::uniform_int_distribution<int> roll(0, 99), back(1, 4);
+    int64_t pos = 0;
+    for (size_t i = 0; i < steps; ++i) {
+        int r = roll(rng);
+        if (r < 60) pos += 1;
+        else if (r < 90) pos -= back(rng);
+        else pos += back(rng);
+        pos = std::clamp<int64_t>(pos, 0, images - 1);
+        if (pos == images - 1) pos = 0;
+        t.push_back(static_cast<uint32_t>(pos));
+    }
+    return t;
+}
+
+// Culling a burst: walk a window, repeatedly returning to a few keepers
+Trace CompareKeepers(uint32_t images, size_t steps, std::mt19937& rng)
+{
+    Trace t;
+    std::uniform_int_distribution<int> roll(0, 99);
+    uint32_t base = 0;
+    std::vector<uint32_t> keepers{0};
+    uint32_t pos = 0;
+    for (size_t i = 0; i < steps; ++i) {
+        int r = roll(rng);
+        if (r < 45) {
+            pos = std::min(images - 1, pos + 1);
+        } else if (r < 80) {
+            pos = keepers[std::uniform_int_distribution<size_t>(0, keepers.size() - 1)(rng)];
+        } else if (r < 90) {
+            keepers.push_back(pos);
+            if (keepers.size() > 4) keepers.erase(keepers.begin());
+        } else if (r < 93) {
+            base = (base + 40) % images;
+            pos = base;
+            keepers.assign(1, pos);
+        } else {
+            pos = pos > 0 ? pos - 1 : 0;
+        }
+        t.push_back(pos);
+    }
+    return t;
+}
+
+// Opening photos from the gallery: Zipf-like favourites plus one-off views
+Trace GalleryJumps(uint32_t images, size_t steps, std::mt19937& rng)
+{
+    std::vector<double> weights(images);
+    for (uint32_t i = 0; i < images; ++i) weights[i] = 1.0 / (1.0 + i);
+    std::discrete_distribution<uint32_t> zipf(weights.begin(), weights.end());
+    std::vector<uint32_t> perm(images);
+    for (uint32_t i = 0; i < images; ++i) perm[i] = i;
+    std::shuffle(perm.begin(), perm.end(), rng);
+
+    Trace t;
+    std::uniform_int_distribution<int> roll(0, 99);
+    uint32_t pos = 0;
+    for (size_t i = 0; i < steps; ++i) {
+        int r = roll(rng);
+        if (r < 50) pos = perm[zipf(rng)];
+        else if (r < 80) pos = std::min(images - 1, pos + 1);
+        else pos = pos > 0 ? pos - 1 : 0;
+        t.push_back(pos);
+    }
+    return t;
+}
+
+struct ReplayResult {
+    double pageHitRate = 0.0;
+    size_t pinnedLost = 0;  // steps whose page was gone by the end of the step (ARC only)
+};
+
+template <typename Policy>
+ReplayResult Replay(const char* traceName, const Trace& trace, uint32_t images, size_t capacity)
+{
+    Policy policy(capacity);
+    size_t pageHits = 0, lookups = 0, hits = 0;
+    ReplayResult result;
+
+    auto fetch = [&](uint32_t id) {
+        ++lookups;
+        if (policy.Get(id)) { ++hits; return true; }
+        policy.Put(id, ImageBytes(id));
+        return false;
+    };
+
+    auto start = Clock::now();
+    for (uint32_t page : trace) {
+        std::vector<uint32_t> pins{page};
+        if (page > 0) pins.push_back(page - 1);
+        if (page + 1 < images) pins.push_back(page + 1);
+        policy.Pin(pins);
+
+        if (fetch(page)) ++pageHits;
+        if (page > 0) fetch(page - 1);
+        if (page + 1 < images) fetch(page + 1);
+        if constexpr (std::is_same_v<Policy, ArcPolicy>) {
+            if (!policy.Contains(page)) ++result.pinnedLost;
+        }
+    }
+    double us = ElapsedUs(start);
+    result.pageHitRate = 100.0 * pageHits / trace.size();
+
+    std::printf("  %-14s %-22s page hit %5.1f%%  all lookups %5.1f%%  decodes %7zu  (%.2fus/step)\n",
+                traceName, Policy::kName, 100.0 * pageHits / trace.size(),
+                100.0 * hits / lookups, lookups - hits, us / trace.size());
+    if constexpr (std::is_same_v<Policy, ArcPolicy>) {
+        auto s = policy.Stats();
+        std::printf("  %-14s %-22s evictions %llu, ghost hits %llu, p = %.0f MB\n", "", "",
+                    static_cast<unsigned long long>(s.evictions),
+                    static_cast<unsigned long long>(s.ghostHits),
+                    s.recencyTarget / (1024.0 * 1024.0));
+    }
+    return result;
+}
+
+// False if ARC dropped a pinned page or did worse than the previous policy
+bool ReplayAll(const char* name, const Trace& trace, uint32_t images, size_t capacity)
+{
+    ReplayResult previous = Replay<ArbitraryPolicy>(name, trace, images, capacity);
+    Replay<LruPolicy>(name, trace, images, capacity);
+    ReplayResult arc = Replay<ArcPolicy>(name, trace, images, capacity);
+
+    bool ok = arc.pinnedLost == 0 && arc.pageHitRate >= previous.pageHitRate;
+    if (!ok) {
+        std::printf("  %-14s FAILED: ARC lost the current page %zu times, page hit %.1f%% vs %.1f%%\n",
+                    name, arc.pinnedLost, arc.pageHitRate, previous.pageHitRate);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const uint32_t images = static_cast<uint32_t>(args.Get("images", 400));
+    const size_t steps    = static_cast<size_t>(args.Get("steps", 20000));
+    const size_t cacheMb  = static_cast<size_t>(args.Get("cache-mb", 256));
+    const uint32_t seed   = static_cast<uint32_t>(args.Get("seed", 1));
+    const std::string tracePath = args.GetString("trace", "");
+    const size_t capacity = cacheMb * 1024 * 1024;
+
+    std::printf("full_cache_bench: %u images (12-24 MP), cache %zu MB\n", images, cacheMb);
+
+    if (!tracePath.empty()) {
+        std::ifstream in(tracePath);
+        Trace trace;
+        uint32_t page = 0;
+        uint32_t maxPage = 0;
+        while (in >> page) {
+            trace.push_back(page);
+            maxPage = std::max(maxPage, page);
+        }
+        if (trace.empty()) {
+            std::fprintf(stderr, "empty or unreadable trace: %s\n", tracePath.c_str());
+            return 1;
+        }
+        std::printf("\nRecorded trace %s (%zu steps)\n", tracePath.c_str(), trace.size());
+        return ReplayAll("recorded", trace, maxPage + 1, capacity) ? 0 : 1;
+    }
+
+    std::mt19937 rng(seed);
+    std::printf("\n%zu steps per trace\n", steps);
+    bool ok = ReplayAll("back-and-forth", BackAndForth(images, steps, rng), images, capacity);
+    ok = ReplayAll("keepers", CompareKeepers(images, steps, rng), images, capacity) && ok;
+    ok = ReplayAll("gallery jumps", GalleryJumps(images, steps, rng), images, capacity) && ok;
+    return ok ? 0 : 1;
+}
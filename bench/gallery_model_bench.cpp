@@ -0,0 +1,378 @@
+// gallery_model_bench: a 500k-photo library scan shown in the gallery, from
+// the first file found to the last photo on screen.
+//
+// The library is --images photos in folders of about --per-folder, each
+// folder's photos taken within a month or two of 2005-2026; the scan finds
+// them folder by folder (in shuffled folder order, as the parallel walk
+// does) at --scan-rate files per second. The UI thread runs a frame every
+// 16.7 ms, or as soon as the previous frame's gallery work is done, and
+// hands the gallery whatever the scan found since its last frame, the way
+// Application::CheckScanProgress does. Scan times are modelled; gallery
+// work is measured on this thread.
+//
+//   one-shot   the gallery stays empty until the scan is done; then the
+//              result is sorted and SetImagesGrouped rebuilds the flat path
+//              and id lists, the month sections and the albums (before)
+//   rebuild    every frame with new photos re-sorts everything found so far
+//              and rebuilds as above (what streaming looked like before;
+//              ScanFolders' old doFlush additionally copied and re-sorted
+//              the whole result every 200 photos, estimated separately)
+//   stream     each frame's photos are sorted, merged into their month
+//              sections by GalleryModel::Insert and the albums re-listed;
+//              at the end GalleryModel::Sync checks the complete result
+//
+// Per strategy: when the first photo and the last are on screen (the scan
+// plus display time), gallery time on the UI thread, the per-frame cost of
+// the gallery work (the worst is the longest the UI stalls) and frames
+// over 16 ms.
+//
+//   gallery_model_bench [--images 500000] [--per-folder 100]
+//                       [--scan-rate 100000] [--seed 1]
+
+#include "BenchCommon.hpp"
+#include "core/GalleryModel.hpp"
+#include "core/PathInterner.hpp"
+#include <filesystem>
+#include <map>
+#include <numeric>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+constexpr double kFrameUs = 1e6 / 60.0;
+
+using NameString = std::filesystem::path::string_type;
+
+// The library in the order the scan finds it
+std::vector<Core::ScannedImage> MakeLibrary(size_t images, size_t perFolder, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    size_t folders = std::max<size_t>(1, images / std::max<size_t>(1, perFolder));
+    std::vector<size_t> order(folders);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::shuffle(order.begin(), order.end(), rng);
+
+    const std::filesystem::path root = "/library";
+    auto& interner = Core::PathInterner::Global();
+    std::vector<Core::ScannedImage> library;
+    library.reserve(images);
+    for (size_t f = 0; f < folders; ++f) {
+        size_t folder = order[f];
+        size_t begin = folder * images / folders, end = (folder + 1) * images / folders;
+        int monthIndex = static_cast<int>(rng() % (22 * 12));
+        auto dir = root / std::to_string(2005 + monthIndex / 12) /
+                   ("event_" + std::to_string(folder));
+        for (size_t i = begin; i < end; ++i) {
+            Core::ScannedImage img;
+            char name[32];
+            std::snprintf(name, sizeof(name), "IMG_%07zu.jpg", i);
+            img.path = dir / name;
+            img.id = interner.Intern(img.path);
+            img.sourceFolder = root;
+            int m = monthIndex + static_cast<int>(rng() % 3 == 0);  // some spill into the next month
+            img.year = 2005 + m / 12;
+            img.month = 1 + m % 12;
+            library.push_back(std::move(img));
+        }
+    }
+    return library;
+}
+
+// GalleryView before GalleryModel: SetImagesGrouped's full rebuild
+class RebuildGallery {
+public:
+    void Show(const std::vector<Core::ScannedImage>& sorted)
+    {
+        all_ = sorted;
+
+        images_.clear();
+        ids_.clear();
+        sections_.clear();
+        images_.reserve(all_.size());
+        ids_.reserve(all_.size());
+        int year = -1, month = -1;
+        for (const auto& img : all_) {
+            if (img.year != year || img.month != month) {
+                year = img.year;
+                month = img.month;
+                sections_.push_back({std::to_wstring(year) + L"/" + std::to_wstring(month),
+                                     images_.size(), 0});
+            }
+            images_.push_back(img.path);
+            ids_.push_back(img.id);
+            ++sections_.back().count;
+        }
+
+        std::map<NameString, Album> albumMap;
+        for (const auto& img : all_) {
+            auto parent = img.path.parent_path();
+            auto& album = albumMap[parent.native()];
+            if (album.count == 0) {
+                album.path = parent;
+                album.cover = img.id;
+            }
+            ++album.count;
+        }
+        albums_.clear();
+        for (auto& [_, album] : albumMap) albums_.push_back(std::move(album));
+        std::sort(albums_.begin(), albums_.end(),
+                  [](const Album& a, const Album& b) { return a.count > b.count; });
+    }
+
+    size_t Size() const { return images_.size(); }
+
+private:
+    struct Section {
+        std::wstring title;
+        size_t start = 0;
+        size_t count = 0;
+    };
+    struct Album {
+        std::filesystem::path path;
+        Core::ImageId cover = Core::kInvalidImageId;
+        size_t count = 0;
+    };
+
+    std::vector<Core::ScannedImage> all_;
+    std::vector<std::filesystem::path> images_;
+    std::vector<Core::ImageId> ids_;
+    std::vector<Section> sections_;
+    std::vector<Album> albums_;
+};
+
+// GalleryView on GalleryModel: the model plus the album list it lists
+class StreamGallery {
+public:
+    void Add(std::vector<Core::ScannedImage> batch)
+    {
+        model_.Insert(std::move(batch));
+        ListAlbums();
+        rows_ = model_.TotalRows(8);  // the grid's height for the scroll range
+    }
+
+    void Sync(const std::vector<Core::ScannedImage>& sorted)
+    {
+        model_.Sync(sorted);
+        ListAlbums();
+        rows_ = model_.TotalRows(8);
+    }
+
+    size_t Size() const { return model_.Size(); }
+    const Core::GalleryModel& Model() const { return model_; }
+
+private:
+    struct Album {
+        std::filesystem::path path;
+        std::wstring name;
+        std::filesystem::path cover;
+        Core::ImageId coverId;
+        size_t count;
+    };
+
+    // GalleryView::BuildFolderAlbums
+    void ListAlbums()
+    {
+        std::vector<const Core::GalleryModel::Folder*> folders;
+        folders.reserve(model_.Folders().size());
+        for (const auto& [_, folder] : model_.Folders()) folders.push_back(&folder);
+        std::sort(folders.begin(), folders.end(), [](const auto* a, const auto* b) {
+            if (a->ids.size() != b->ids.size()) return a->ids.size() > b->ids.size();
+            return a->path.native() < b->path.native();
+        });
+
+        auto& interner = Core::PathInterner::Global();
+        albums_.clear();
+        albums_.reserve(folders.size());
+        for (const auto* folder : folders) {
+            albums_.push_back({folder->path, folder->path.filename().wstring(),
+                               interner.Path(folder->cover), folder->cover, folder->ids.size()});
+        }
+    }
+
+    Core::GalleryModel model_;
+    std::vector<Album> albums_;
+    size_t rows_ = 0;
+};
+
+struct Result {
+    double firstShownUs = 0.0;  // from the scan starting
+    double allShownUs = 0.0;
+    double galleryUs = 0.0;     // gallery work on the UI thread
+    size_t slowFrames = 0;      // gallery work over 16 ms
+    LatencyRecorder frames;     // gallery work per frame that had any
+};
+
+void Print(const char* label, Result& r)
+{
+    std::printf("  %-10s first photo %8.1f ms  all shown %8.1f ms  gallery %8.1f ms"
+                "  frames %5zu  worst %7.2f ms  p99 %7.2f ms  >16ms %zu\n",
+                label, r.firstShownUs / 1000.0, r.allShownUs / 1000.0, r.galleryUs / 1000.0,
+                r.frames.Count(), r.frames.Max() / 1000.0, r.frames.Percentile(99) / 1000.0,
+                r.slowFrames);
+}
+
+void Record(Result& r, double us)
+{
+    r.frames.Add(us);
+    r.galleryUs += us;
+    if (us > 16000.0) ++r.slowFrames;
+}
+
+Result RunOneShot(const std::vector<Core::ScannedImage>& library, double scanUs)
+{
+    Result r;
+    RebuildGallery gallery;
+    auto start = Clock::now();
+    auto sorted = library;
+    std::sort(sorted.begin(), sorted.end(), Core::GalleryModel::DateOrder);
+    double sortUs = ElapsedUs(start);  // on the scan thread
+    start = Clock::now();
+    gallery.Show(sorted);
+    double showUs = ElapsedUs(start);
+    Record(r, showUs);
+    r.firstShownUs = r.allShownUs = scanUs + sortUs + showUs;
+    return r;
+}
+
+// Frames from the scan starting until `done` says the last photo is shown;
+// `frame(found)` gets everything found so far and returns whether it showed any
+template <typename Frame>
+void RunFrames(size_t total, double scanRate, Result& r, Frame&& frame)
+{
+    double now = 0.0;
+    for (;;) {
+        size_t found = std::min(total, static_cast<size_t>(now * scanRate / 1e6));
+        auto start = Clock::now();
+        bool showed = frame(found);
+        double us = ElapsedUs(start);
+        if (showed) {
+            Record(r, us);
+            if (r.firstShownUs == 0.0) r.firstShownUs = now + us;
+        }
+        now += std::max(kFrameUs, us);
+        if (found == total && showed) {
+            r.allShownUs = now - std::max(kFrameUs, us) + us;
+            return;
+        }
+    }
+}
+
+Result RunRebuild(const std::vector<Core::ScannedImage>& library, double scanRate)
+{
+    Result r;
+    RebuildGallery gallery;
+    size_t shown = 0;
+    RunFrames(library.size(), scanRate, r, [&](size_t found) {
+        if (found == shown) return false;
+        std::vector<Core::ScannedImage> sorted(library.begin(),
+                                               library.begin() + static_cast<ptrdiff_t>(found));
+        std::sort(sorted.begin(), sorted.end(), Core::GalleryModel::DateOrder);
+        gallery.Show(sorted);
+        shown = found;
+        return true;
+    });
+    return r;
+}
+
+Result RunStream(const std::vector<Core::ScannedImage>& library, double scanRate,
+                 const std::vector<Core::ScannedImage>& sorted, bool& matches)
+{
+    Result r;
+    StreamGallery gallery;
+    size_t shown = 0;
+    bool synced = false;
+    RunFrames(library.size(), scanRate, r, [&](size_t found) {
+        if (found > shown) {
+            gallery.Add(std::vector<Core::ScannedImage>(
+                library.begin() + static_cast<ptrdiff_t>(shown),
+                library.begin() + static_cast<ptrdiff_t>(found)));
+            shown = found;
+            return true;
+        }
+        if (found == library.size() && !synced) {
+            gallery.Sync(sorted);  // the scan's final result
+            synced = true;
+            return true;
+        }
+        return false;
+    });
+
+    // Same order as a full sort, with the sections matching it
+    const auto& model = gallery.Model();
+    matches = model.Size() == sorted.size();
+    size_t index = 0;
+    for (size_t s = 0; matches && s < model.SectionCount(); ++s) {
+        const auto& section = model.GetSection(s);
+        matches = model.SectionStart(s) == index;
+        for (size_t i = 0; matches && i < section.ids.size(); ++i, ++index) {
+            matches = section.ids[i] == sorted[index].id && section.year == sorted[index].year &&
+                      section.month == sorted[index].month;
+        }
+    }
+    return r;
+}
+
+// ScanFolders' old doFlush: a copy of the result sorted every 200 photos, on
+// the scan thread. Sort costs sampled at 10 sizes, summed over every flush.
+double EstimateDoFlush(const std::vector<Core::ScannedImage>& library)
+{
+    constexpr size_t kFlushInterval = 200;
+    constexpr size_t kSamples = 10;
+    std::vector<double> costs;  // us at n = (i + 1) * size / kSamples
+    for (size_t i = 0; i < kSamples; ++i) {
+        size_t n = (i + 1) * library.size() / kSamples;
+        auto start = Clock::now();
+        std::vector<Core::ScannedImage> sorted(library.begin(),
+                                               library.begin() + static_cast<ptrdiff_t>(n));
+        std::sort(sorted.begin(), sorted.end(), Core::GalleryModel::DateOrder);
+        costs.push_back(ElapsedUs(start));
+    }
+    double total = 0.0;
+    for (size_t n = kFlushInterval; n <= library.size(); n += kFlushInterval) {
+        double at = static_cast<double>(n) * kSamples / static_cast<double>(library.size()) - 1.0;
+        if (at <= 0.0) {
+            total += costs[0] * (at + 1.0);
+            continue;
+        }
+        size_t lo = std::min(kSamples - 2, static_cast<size_t>(at));
+        double frac = at - static_cast<double>(lo);
+        total += costs[lo] + (costs[lo + 1] - costs[lo]) * frac;
+    }
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    size_t images = static_cast<size_t>(args.Get("images", 500000));
+    size_t perFolder = static_cast<size_t>(args.Get("per-folder", 100));
+    double scanRate = args.GetDouble("scan-rate", 100000.0);
+    uint32_t seed = static_cast<uint32_t>(args.Get("seed", 1));
+    if (images == 0 || scanRate <= 0.0) return 1;
+
+    auto library = MakeLibrary(images, perFolder, seed);
+    auto sorted = library;
+    std::sort(sorted.begin(), sorted.end(), Core::GalleryModel::DateOrder);
+    double scanUs = static_cast<double>(images) / scanRate * 1e6;
+
+    std::printf("gallery_model_bench: %zu photos in %zu folders, scan %.0f files/s (%.0f ms)\n",
+                images, (images + perFolder - 1) / std::max<size_t>(1, perFolder), scanRate,
+                scanUs / 1000.0);
+
+    auto oneShot = RunOneShot(library, scanUs);
+    Print("one-shot", oneShot);
+    auto rebuild = RunRebuild(library, scanRate);
+    Print("rebuild", rebuild);
+    bool matches = false;
+    auto stream = RunStream(library, scanRate, sorted, matches);
+    Print("stream", stream);
+
+    std::printf("  old doFlush (copy + sort every 200 photos, scan thread): ~%.1f s\n",
+                EstimateDoFlush(library) / 1e6);
+    std::printf("  stream matches a full sort: %s\n", matches ? "yes" : "NO");
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+// grid_layout_bench: per-frame CPU of the gallery grid's layout work at the
+// bottom of a large library, walking from the top vs starting from the
+// layout index (GalleryModel::SectionAt).
+//
+// The library is --images photos over --months month sections, the oldest
+// (bottom) month holding --big of them, as a phone backup dumped into one
+// folder does. The view is --width x --height px, with GalleryView's grid
+// (cells of 200-400 px, Theme's gaps and section headers). Each frame
+// scrolls a little further through the last --screens screens and does
+// what RenderImageGrid does apart from drawing: find the cells in the
+// prefetch zone (PrefetchScreens above and below) and collect the ids of
+// those on screen. A HitTest at the middle of the view and the screen rect
+// of the cell under it (GetCellScreenRect, as the hero transition asks)
+// are timed per call.
+//
+//   walk    every section from the top, its SectionLayout, then its cells
+//           from the first, skipping those above the zone (before)
+//   index   GridPositionAt: the section and row at the top of the zone in
+//           O(log S), then cells from that row (after)
+//
+// Both must find the same cells. GalleryView's layout is mirrored here,
+// as it needs Direct2D.
+//
+//   grid_layout_bench [--images 200000] [--months 120] [--big 20000]
+//                     [--width 1280] [--height 800] [--screens 5]
+//                     [--frames 2000]
+
+#include "BenchCommon.hpp"
+#include "core/GalleryModel.hpp"
+#include "core/PathInterner.hpp"
+#include <filesystem>
+#include <optional>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+// Theme.hpp
+constexpr float kGalleryPadding = 24.0f;
+constexpr float kGalleryHeaderHeight = 100.0f;
+constexpr float kSectionHeaderHeight = 48.0f;
+constexpr float kSectionGap = 24.0f;
+constexpr float kThumbnailGap = 6.0f;
+constexpr float kMinCellSize = 200.0f;
+constexpr float kMaxCellSize = 400.0f;
+constexpr float kPrefetchScreens = 3.0f;
+
+struct GridLayout {
+    int columns;
+    float cellSize;
+    float gap;
+    float paddingX;
+};
+
+struct SectionLayoutInfo {
+    float headerY;
+    float contentY;
+    int rows;
+};
+
+struct GridPosition {
+    size_t section;
+    int row;
+};
+
+// GalleryView::CalculateGridLayout
+GridLayout CalculateGridLayout(float viewWidth)
+{
+    GridLayout grid = {};
+    grid.gap = kThumbnailGap;
+    grid.paddingX = kGalleryPadding;
+    float availableWidth = viewWidth - grid.paddingX * 2.0f;
+    grid.columns = std::max(1, static_cast<int>(availableWidth / (kMinCellSize + grid.gap)));
+    grid.cellSize = (availableWidth - grid.gap * (grid.columns - 1)) / grid.columns;
+    grid.cellSize = std::min(grid.cellSize, kMaxCellSize);
+    grid.columns = std::max(1, static_cast<int>((availableWidth + grid.gap) / (grid.cellSize + grid.gap)));
+    grid.cellSize = (availableWidth - grid.gap * (grid.columns - 1)) / grid.columns;
+    return grid;
+}
+
+// GalleryView::SectionLayout
+SectionLayoutInfo SectionLayout(const Core::GalleryModel& model, size_t section, const GridLayout& grid)
+{
+    float rowPitch = grid.cellSize + grid.gap;
+    SectionLayoutInfo layout = {};
+    layout.headerY = kGalleryHeaderHeight + kGalleryPadding +
+        static_cast<float>(section) * (kSectionHeaderHeight + kSectionGap) +
+        static_cast<float>(model.RowsBefore(section, grid.columns)) * rowPitch;
+    layout.contentY = layout.headerY + kSectionHeaderHeight;
+    if (section < model.SectionCount()) {
+        layout.rows = static_cast<int>(
+            (model.GetSection(section).ids.size() + grid.columns - 1) / grid.columns);
+    }
+    return layout;
+}
+
+// GalleryView::GridHeight
+float GridHeight(const Core::GalleryModel& model, const GridLayout& grid)
+{
+    float top = kGalleryHeaderHeight + kGalleryPadding;
+    size_t sections = model.SectionCount();
+    if (sections == 0) return top + kGalleryPadding;
+    return top + static_cast<float>(sections) * kSectionHeaderHeight +
+           static_cast<float>(sections - 1) * kSectionGap +
+           static_cast<float>(model.TotalRows(grid.columns)) * (grid.cellSize + grid.gap) +
+           kGalleryPadding;
+}
+
+// GalleryView::GridPositionAt
+GridPosition GridPositionAt(const Core::GalleryModel& model, float y, const GridLayout& grid)
+{
+    float top = kGalleryHeaderHeight + kGalleryPadding;
+    float rowPitch = grid.cellSize + grid.gap;
+    size_t section = model.SectionAt(y - top, kSectionHeaderHeight + kSectionGap,
+                                     rowPitch, grid.columns);
+    auto sl = SectionLayout(model, section, grid);
+    int row = std::max(0, static_cast<int>((y - sl.contentY) / rowPitch));
+    return {section, row};
+}
+
+// RenderImageGrid without the drawing: prefetch-zone ids into `zone`,
+// on-screen ones into `visible`
+void WalkGrid(const Core::GalleryModel& model, const GridLayout& grid, float scroll,
+              float contentHeight, bool useIndex,
+              std::vector<Core::ImageId>& zone, std::vector<Core::ImageId>& visible)
+{
+    zone.clear();
+    visible.clear();
+    float prefetchMargin = contentHeight * kPrefetchScreens;
+    GridPosition first = {0, 0};
+    if (useIndex) first = GridPositionAt(model, scroll - prefetchMargin, grid);
+
+    for (size_t s = first.section; s < model.SectionCount(); ++s) {
+        const auto& section = model.GetSection(s);
+        auto sl = SectionLayout(model, s, grid);
+        float sectionEndY = sl.contentY + sl.rows * (grid.cellSize + grid.gap);
+        if (sectionEndY - scroll < -prefetchMargin) continue;
+        if (sl.headerY - scroll > contentHeight + prefetchMargin) break;
+
+        size_t firstCell = (useIndex && s == first.section)
+            ? static_cast<size_t>(first.row) * grid.columns : 0;
+        for (size_t i = firstCell; i < section.ids.size(); ++i) {
+            int localRow = static_cast<int>(i) / grid.columns;
+            float cellY = sl.contentY + localRow * (grid.cellSize + grid.gap) - scroll;
+            if (cellY + grid.cellSize < -prefetchMargin) continue;
+            if (cellY > contentHeight + prefetchMargin) break;
+            zone.push_back(section.ids[i]);
+            if (cellY + grid.cellSize >= 0.0f && cellY <= contentHeight) visible.push_back(section.ids[i]);
+        }
+    }
+}
+
+// GalleryView::HitTest: the flat index of the cell at (x, y)
+std::optional<size_t> HitTest(const Core::GalleryModel& model, const GridLayout& grid,
+                              float scroll, float x, float y, bool useIndex)
+{
+    float worldY = y + scroll;
+    float rowPitch = grid.cellSize + grid.gap;
+    size_t begin = 0, end = model.SectionCount();
+    if (useIndex) {
+        begin = GridPositionAt(model, worldY, grid).section;
+        end = std::min(end, begin + 1);
+    }
+    for (size_t s = begin; s < end; ++s) {
+        auto sl = SectionLayout(model, s, grid);
+        if (worldY < sl.contentY || worldY >= sl.contentY + sl.rows * rowPitch) continue;
+        int row = static_cast<int>((worldY - sl.contentY) / rowPitch);
+        if (worldY - sl.contentY - row * rowPitch > grid.cellSize) continue;
+        for (int col = 0; col < grid.columns; ++col) {
+            float cellX = grid.paddingX + col * rowPitch;
+            if (x < cellX || x > cellX + grid.cellSize) continue;
+            size_t local = static_cast<size_t>(row) * grid.columns + col;
+            if (local >= model.GetSection(s).ids.size()) continue;
+            return model.SectionStart(s) + local;
+        }
+    }
+    return std::nullopt;
+}
+
+// GalleryView::GetCellScreenRect's top edge
+float CellTop(const Core::GalleryModel& model, const GridLayout& grid, float scroll, size_t index)
+{
+    auto [section, local] = model.Locate(index);
+    int row = static_cast<int>(local) / grid.columns;
+    return SectionLayout(model, section, grid).contentY + row * (grid.cellSize + grid.gap) - scroll;
+}
+
+Core::GalleryModel MakeLibrary(size_t images, size_t months, size_t big)
+{
+    months = std::max<size_t>(1, months);
+    big = std::min(big, images);
+    size_t rest = images - big;
+    auto& interner = Core::PathInterner::Global();
+    std::vector<Core::ScannedImage> library;
+    library.reserve(images);
+    for (size_t m = 0; m < months; ++m) {
+        bool last = m + 1 == months;
+        size_t count = last ? big + rest / months + rest % months : rest / months;
+        int monthIndex = static_cast<int>(26 * 12 - 1 - m);  // newest first
+        auto dir = std::filesystem::path("/library") / ("month_" + std::to_string(m));
+        for (size_t i = 0; i < count; ++i) {
+            Core::ScannedImage img;
+            char name[32];
+            std::snprintf(name, sizeof(name), "IMG_%07zu.jpg", i);
+            img.path = dir / name;
+            img.id = interner.Intern(img.path);
+            img.sourceFolder = "/library";
+            img.year = 2000 + monthIndex / 12;
+            img.month = 1 + monthIndex % 12;
+            library.push_back(std::move(img));
+        }
+    }
+    Core::GalleryModel model;
+    model.Assign(std::move(library));
+    return model;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    size_t images = static_cast<size_t>(args.Get("images", 200000));
+    size_t months = static_cast<size_t>(args.Get("months", 120));
+    size_t big = static_cast<size_t>(args.Get("big", 20000));
+    float width = static_cast<float>(args.GetDouble("width", 1280.0));
+    float height = static_cast<float>(args.GetDouble("height", 800.0));
+    float screens = static_cast<float>(args.GetDouble("screens", 5.0));
+    size_t frames = static_cast<size_t>(std::max<long long>(1, args.Get("frames", 2000)));
+
+    auto model = MakeLibrary(images, months, big);
+    auto grid = CalculateGridLayout(width);
+    float maxScroll = std::max(0.0f, GridHeight(model, grid) - height);
+
+    std::printf("grid_layout_bench: %zu photos, %zu sections (last %zu), %d columns of %.0f px, "
+                "%zu frames over the last %.0f screens\n",
+                model.Size(), model.SectionCount(),
+                model.SectionCount() ? model.GetSection(model.SectionCount() - 1).ids.size() : size_t{0},
+                grid.columns, grid.cellSize, frames, screens);
+
+    std::vector<float> scrolls;
+    for (size_t f = 0; f < frames; ++f) {
+        float t = frames > 1 ? static_cast<float>(f) / static_cast<float>(frames - 1) : 1.0f;
+        scrolls.push_back(std::max(0.0f, maxScroll - screens * height * (1.0f - t)));
+    }
+
+    bool matches = true;
+    std::vector<Core::ImageId> zone, visible, zoneIndex, visibleIndex;
+    size_t zoneCells = 0;
+    for (int useIndex = 0; useIndex < 2; ++useIndex) {
+        LatencyRecorder walk, hit, rect;
+        for (float scroll : scrolls) {
+            auto start = Clock::now();
+            WalkGrid(model, grid, scroll, height, useIndex != 0,
+                     useIndex ? zoneIndex : zone, useIndex ? visibleIndex : visible);
+            walk.Add(ElapsedUs(start));
+
+            start = Clock::now();
+            auto index = HitTest(model, grid, scroll, width * 0.5f, height * 0.5f, useIndex != 0);
+            hit.Add(ElapsedUs(start));
+
+            if (index) {
+                start = Clock::now();
+                volatile float top = CellTop(model, grid, scroll, *index);
+                (void)top;
+                rect.Add(ElapsedUs(start));
+            }
+            if (!useIndex) zoneCells += zone.size();
+        }
+        std::printf("%s\n", useIndex ? "index (after)" : "walk (before)");
+        walk.Print("grid walk per frame");
+        hit.Print("HitTest");
+        rect.Print("GetCellScreenRect");
+    }
+
+    // The same cells, frame by frame
+    for (float scroll : scrolls) {
+        WalkGrid(model, grid, scroll, height, false, zone, visible);
+        WalkGrid(model, grid, scroll, height, true, zoneIndex, visibleIndex);
+        auto a = HitTest(model, grid, scroll, width * 0.5f, height * 0.5f, false);
+        auto b = HitTest(model, grid, scroll, width * 0.5f, height * 0.5f, true);
+        if (zone != zoneIndex || visible != visibleIndex || a != b) matches = false;
+    }
+    std::printf("  prefetch-zone cells per frame: %.0f; both find the same cells: %s\n",
+                static_cast<double>(zoneCells) / static_cast<double>(frames), matches ? "yes" : "NO");
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+// incremental_scan_bench: library rescan with and without the persistent
+// DirectoryIndex, after a small part of a generated photo tree changed.
+//
+// The tree has --files files in directories of --per-dir, nested --fanout
+// wide (sparse photos over the 100 KB minimum plus icons and sidecars, as
+// in scan_bench). A first scan saves its index; then --changed percent of
+// the directories each gain a photo, lose one and have one renamed. Every
+// pass loads the saved index and rescans incrementally, then runs a full
+// scan without one, and checks both found exactly the same files. A last
+// row rescans again with nothing changed since the index was saved.
+//
+// The tree is left alone for DirectoryIndex::kRacyWindow after it is built
+// and after it is changed, so no record is distrusted for being too fresh.
+// Metadata is cached in every pass; on a network share each listing and
+// stat is a round trip, and the incremental scan does far fewer of them.
+//
+//   incremental_scan_bench [--files 300000] [--per-dir 50] [--fanout 16]
+//                          [--changed 1] [--workers 8] [--passes 3]
+//                          [--dir PATH] [--keep 0]
+
+#include "BenchCommon.hpp"
+#include "core/DirectoryScanner.hpp"
+#include "core/ThreadPool.hpp"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+constexpr uint64_t kMinImageSize = 100 * 1024;
+
+// Directory `index` of the tree: its base-fanout digits, one level each
+std::filesystem::path TreeDirectory(const std::filesystem::path& root, size_t index, size_t fanout)
+{
+    std::vector<size_t> digits;
+    do {
+        digits.push_back(index % fanout);
+        index /= fanout;
+    } while (index > 0);
+    std::filesystem::path dir = root;
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+        dir /= std::to_string(*it);
+    }
+    return dir;
+}
+
+void MakeFile(const std::filesystem::path& path, uint64_t size)
+{
+    std::ofstream(path, std::ios::binary).put('\0');
+    std::filesystem::resize_file(path, size);  // sparse
+}
+
+void BuildTree(const std::filesystem::path& root, size_t files, size_t perDir, size_t fanout)
+{
+    size_t dirs = (files + perDir - 1) / perDir;
+    size_t made = 0;
+    for (size_t d = 0; d < dirs; ++d) {
+        auto dir = TreeDirectory(root, d, fanout);
+        std::filesystem::create_directories(dir);
+        for (size_t i = 0; i < perDir && made < files; ++i, ++made) {
+            size_t kind = made % 20;
+            std::string stem = "IMG_" + std::to_string(made);
+            if (kind < 16) {
+                MakeFile(dir / (stem + ".jpg"), 150 * 1024);
+            } else if (kind < 17) {
+                MakeFile(dir / (stem + ".png"), 4 * 1024);  // icon-sized: filtered out
+            } else {
+                MakeFile(dir / (stem + ".xmp"), 2 * 1024);  // sidecar
+            }
+        }
+    }
+}
+
+// In each of `count` directories spread over the tree: one photo added,
+// one deleted, one renamed. Returns the number of directories changed.
+size_t ChangeTree(const std::filesystem::path& root, size_t dirs, size_t count, size_t fanout)
+{
+    size_t changed = 0;
+    size_t step = std::max<size_t>(1, dirs / std::max<size_t>(1, count));
+    for (size_t d = step / 2; d < dirs && changed < count; d += step, ++changed) {
+        auto dir = TreeDirectory(root, d, fanout);
+        std::vector<std::filesystem::path> photos;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".jpg") {
+                photos.push_back(entry.path());
+            }
+        }
+        std::sort(photos.begin(), photos.end());
+        MakeFile(dir / ("NEW_" + std::to_string(d) + ".jpg"), 200 * 1024);
+        if (photos.size() >= 2) {
+            std::filesystem::remove(photos[0]);
+            std::filesystem::rename(photos[1], dir / ("RENAMED_" + std::to_string(d) + ".jpg"));
+        }
+    }
+    return changed;
+}
+
+std::vector<std::pair<std::string, uint64_t>> Sorted(const std::vector<Core::ScanEntry>& entries)
+{
+    std::vector<std::pair<std::string, uint64_t>> files;
+    files.reserve(entries.size());
+    for (const auto& entry : entries) files.emplace_back(entry.path.string(), entry.size);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+void WaitOutRacyWindow()
+{
+    std::this_thread::sleep_for(std::chrono::nanoseconds(Core::DirectoryIndex::kRacyWindow) +
+                                std::chrono::milliseconds(100));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t files    = static_cast<size_t>(args.Get("files", 300000));
+    const size_t perDir   = static_cast<size_t>(std::max<long long>(1, args.Get("per-dir", 50)));
+    const size_t fanout   = static_cast<size_t>(std::max<long long>(2, args.Get("fanout", 16)));
+    const double changedPercent = static_cast<double>(args.Get("changed", 1));
+    const uint32_t workers = static_cast<uint32_t>(std::max<long long>(1, args.Get("workers", 8)));
+    const int passes      = static_cast<int>(std::max<long long>(1, args.Get("passes", 3)));
+    const bool keep       = args.Get("keep", 0) != 0;
+    const std::filesystem::path root =
+        args.GetString("dir", (std::filesystem::temp_directory_path() / "uiv_incremental_scan_bench").string());
+    const std::filesystem::path indexFile = root.string() + "_index.bin";
+
+    const size_t dirs = (files + perDir - 1) / perDir;
+    std::filesystem::remove_all(root);
+    auto buildStart = Clock::now();
+    BuildTree(root, files, perDir, fanout);
+    std::printf("incremental_scan_bench: %zu files in %zu directories (fanout %zu), "
+                "built in %.1f s, %u workers\n",
+                files, dirs, fanout, ElapsedUs(buildStart) / 1e6, workers);
+    WaitOutRacyWindow();
+
+    Core::DirectoryScanner::Config config;
+    config.extensions = {".jpg", ".jpeg", ".png", ".heic"};
+    config.skipDirs = {"cache", "thumbnails"};
+    config.minFileSize = kMinImageSize;
+    Core::ThreadPool pool(workers);
+    Core::DirectoryScanner scanner(&pool, config);
+    std::atomic<bool> cancel{false};
+    std::atomic<size_t> count{0};
+
+    // First scan: builds and saves the index
+    Core::DirectoryIndex index;
+    auto firstStart = Clock::now();
+    size_t firstFound = scanner.Scan({root}, cancel, count, nullptr, 200, &index).size();
+    double firstSeconds = ElapsedUs(firstStart) / 1e6;
+    auto saveStart = Clock::now();
+    bool saved = index.Save(indexFile);
+    double saveMs = ElapsedUs(saveStart) / 1e3;
+    std::error_code ec;
+    std::printf("  first scan: %zu photos in %.3f s; index %zu directories, %llu entries, "
+                "%.1f MB, saved in %.1f ms%s\n",
+                firstFound, firstSeconds, index.DirectoryCount(),
+                static_cast<unsigned long long>(index.EntryCount()),
+                static_cast<double>(std::filesystem::file_size(indexFile, ec)) / (1024.0 * 1024.0),
+                saveMs, saved ? "" : "  SAVE FAILED");
+
+    size_t toChange = static_cast<size_t>(static_cast<double>(dirs) * changedPercent / 100.0 + 0.5);
+    size_t changed = ChangeTree(root, dirs, toChange, fanout);
+    std::printf("  changed %zu directories (%.1f%%): one photo added, one deleted, one renamed in each\n",
+                changed, 100.0 * static_cast<double>(changed) / static_cast<double>(dirs));
+    WaitOutRacyWindow();
+
+    std::printf("\n  %-30s %10s %10s %10s %10s\n", "rescan", "seconds", "listed", "unchanged", "found");
+    double fullBest = 1e30, incrementalBest = 1e30, loadBest = 1e30;
+    size_t fullFound = 0, incrementalFound = 0, listed = 0, reused = 0;
+    bool match = true;
+    Core::DirectoryIndex updated;
+    for (int p = 0; p < passes; ++p) {
+        auto loadStart = Clock::now();
+        Core::DirectoryIndex loaded;
+        if (!loaded.Load(indexFile)) {
+            std::printf("  index failed to load\n");
+            return 1;
+        }
+        loadBest = std::min(loadBest, ElapsedUs(loadStart) / 1e6);
+
+        auto start = Clock::now();
+        auto incremental = scanner.Scan({root}, cancel, count, nullptr, 200, &loaded);
+        incrementalBest = std::min(incrementalBest, ElapsedUs(start) / 1e6);
+        incrementalFound = incremental.size();
+        listed = loaded.ListedDirectories();
+        reused = loaded.ReusedDirectories();
+
+        start = Clock::now();
+        auto full = scanner.Scan({root}, cancel, count);
+        fullBest = std::min(fullBest, ElapsedUs(start) / 1e6);
+        fullFound = full.size();
+
+        match = match && Sorted(incremental) == Sorted(full);
+        updated = std::move(loaded);
+    }
+
+    std::printf("  %-30s %10.3f %10zu %10d %10zu\n", "full (no index)", fullBest,
+                updated.DirectoryCount(), 0, fullFound);
+    std::printf("  %-30s %10.3f %10zu %10zu %10zu  %.1fx%s\n", "incremental (index)", incrementalBest,
+                listed, reused, incrementalFound, fullBest / incrementalBest,
+                match ? "" : "  MISMATCH");
+    std::printf("  %-30s %10.3f\n", "  + loading the index", loadBest);
+
+    // Nothing changed since `updated` was taken
+    double unchangedBest = 1e30;
+    size_t unchangedFound = 0;
+    for (int p = 0; p < passes; ++p) {
+        Core::DirectoryIndex copy = updated;
+        auto start = Clock::now();
+        unchangedFound = scanner.Scan({root}, cancel, count, nullptr, 200, &copy).size();
+        unchangedBest = std::min(unchangedBest, ElapsedUs(start) / 1e6);
+        listed = copy.ListedDirectories();
+        reused = copy.ReusedDirectories();
+    }
+    std::printf("  %-30s %10.3f %10zu %10zu %10zu  %.1fx%s\n", "incremental, nothing changed",
+                unchangedBest, listed, reused, unchangedFound, fullBest / unchangedBest,
+                unchangedFound == fullFound ? "" : "  MISMATCH");
+
+    if (!keep) {
+        std::filesystem::remove_all(root);
+        std::filesystem::remove(indexFile, ec);
+    }
+    return match ? 0 : 1;
+}
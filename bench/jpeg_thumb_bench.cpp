@@ -0,0 +1,159 @@
+// Cold-scan JPEG thumbnail cost: full-size decode + resample vs libjpeg
+// DCT-domain scaled decode (JpegPixelSource's fast path).
+//
+// Writes a corpus of synthetic camera-sized JPEGs (12 and 24 MP, 4:2:0,
+// quality 90) to a temp directory, then decodes each to a 160 px thumbnail
+// both ways through the file-mapped DecodeJpegThumbnail. Reports mean
+// ms/image, the speedup, and PSNR of the fast path against the full decode.
+//
+// Files are cached in the temp directory per size/grain/quality; --keep 1
+// leaves them for the next run.
+//
+//   jpeg_thumb_bench [--images 6] [--target 160] [--quality 90] [--grain 2] [--keep 0]
+
+#include "BenchCommon.hpp"
+#include "core/JpegThumbnail.hpp"
+#include "core/Platform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <jpeglib.h>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+using namespace UltraImageViewer::Core;
+
+namespace {
+
+// Smooth gradients and hard edges plus per-pixel sensor-like grain of
+// `grainBits` bits. Grain sets the entropy-coded size, which bounds how much
+// DCT scaling can save: Huffman decoding runs at full cost at any scale.
+std::vector<uint8_t> MakeRgb(uint32_t width, uint32_t height, uint32_t seed, int grainBits)
+{
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = rgb.data() + static_cast<size_t>(y) * width * 3;
+        for (uint32_t x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            uint32_t grain = grainBits > 0 ? (state >> (32 - grainBits)) : 0;
+            bool edge = ((x + seed * 131) / 211 + (y / 149)) & 1;
+            row[x * 3 + 0] = static_cast<uint8_t>((x * 200 / width) + grain + (edge ? 40 : 0));
+            row[x * 3 + 1] = static_cast<uint8_t>((y * 180 / height) + grain);
+            row[x * 3 + 2] = static_cast<uint8_t>(((x + y) * 120 / (width + height)) + (edge ? 90 : 10));
+        }
+    }
+    return rgb;
+}
+
+bool WriteJpeg(const std::filesystem::path& path, const std::vector<uint8_t>& rgb,
+               uint32_t width, uint32_t height, int quality)
+{
+    std::FILE* f = Platform::OpenFile(path, "wb");
+    if (!f) return false;
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr err;
+    cinfo.err = jpeg_std_error(&err);
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, f);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);  // 4:2:0 like most cameras
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < height) {
+        JSAMPROW row = const_cast<uint8_t*>(rgb.data() + static_cast<size_t>(cinfo.next_scanline) * width * 3);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    std::fclose(f);
+    return true;
+}
+
+double Psnr(const PixelBuffer& a, const PixelBuffer& b)
+{
+    if (a.width != b.width || a.height != b.height) return 0.0;
+    size_t n = static_cast<size_t>(a.width) * a.height * 4;
+    double se = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double d = static_cast<double>(a.pixels[i]) - b.pixels[i];
+        se += d * d;
+    }
+    if (se == 0.0) return 99.0;
+    return 10.0 * std::log10(255.0 * 255.0 / (se / static_cast<double>(n)));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const int imagesPerSize = static_cast<int>(args.Get("images", 6));
+    const uint32_t target = static_cast<uint32_t>(args.Get("target", 160));
+    const int quality = static_cast<int>(args.Get("quality", 90));
+    const int grain = static_cast<int>(std::clamp<long long>(args.Get("grain", 2), 0, 8));
+    const bool keep = args.Get("keep", 0) != 0;
+
+    if (!JpegThumbnailAvailable()) {
+        std::printf("jpeg_thumb_bench: uiv_core was built without libjpeg\n");
+        return 1;
+    }
+
+    auto dir = std::filesystem::temp_directory_path() / "uiv_jpeg_thumb_bench";
+    std::filesystem::create_directories(dir);
+
+    const struct { uint32_t w, h; const char* label; } sizes[] = {
+        {4000, 3000, "12 MP"}, {6000, 4000, "24 MP"},
+    };
+
+    std::printf("jpeg_thumb_bench: %d images per size, %u px thumbnails, quality %d, %d grain bits\n",
+                imagesPerSize, target, quality, grain);
+    std::printf("\n  %-8s %14s %14s %9s %9s %12s\n", "size", "full ms/img", "scaled ms/img",
+                "speedup", "PSNR", "file MB");
+
+    for (const auto& size : sizes) {
+        std::vector<std::filesystem::path> files;
+        double fileBytes = 0.0;
+        for (int i = 0; i < imagesPerSize; ++i) {
+            auto path = dir / ("img_" + std::to_string(size.w) + "_q" + std::to_string(quality) + "_g" +
+                               std::to_string(grain) + "_" + std::to_string(i) + ".jpg");
+            if (!std::filesystem::exists(path)) {
+                auto rgb = MakeRgb(size.w, size.h, static_cast<uint32_t>(i + 1), grain);
+                if (!WriteJpeg(path, rgb, size.w, size.h, quality)) {
+                    std::printf("failed to write %s\n", path.string().c_str());
+                    return 1;
+                }
+            }
+            fileBytes += static_cast<double>(std::filesystem::file_size(path));
+            files.push_back(path);
+        }
+
+        LatencyRecorder full, scaled;
+        double psnrSum = 0.0;
+        for (const auto& path : files) {
+            PixelBuffer a, b;
+            auto start = Clock::now();
+            bool okA = DecodeJpegThumbnail(path, target, a, false);
+            full.Add(ElapsedUs(start));
+            start = Clock::now();
+            bool okB = DecodeJpegThumbnail(path, target, b, true);
+            scaled.Add(ElapsedUs(start));
+            if (!okA || !okB) {
+                std::printf("decode failed: %s\n", path.string().c_str());
+                return 1;
+            }
+            psnrSum += Psnr(a, b);
+        }
+
+        double fullMs = full.Mean() / 1000.0, scaledMs = scaled.Mean() / 1000.0;
+        std::printf("  %-8s %14.2f %14.2f %8.1fx %9.2f %12.2f\n", size.label, fullMs, scaledMs,
+                    fullMs / scaledMs, psnrSum / files.size(), fileBytes / files.size() / 1e6);
+    }
+
+    if (!keep) std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,338 @@
+// Startup-to-first-thumbnail with a large persistent thumbnail cache
+// (scan_thumbs.bin), format v1 vs the indexed store ("v2": ThumbnailStore
+// with raw payloads; compressed payloads are measured by thumb_codec_bench).
+//
+// v1 is the previous layout and loader, reproduced here: sequential
+// variable-size entries, all parsed at load into a std::wstring each and
+// interned into an id-indexed table before any lookup. v2 is ThumbnailStore
+// driven through ThumbnailPipeline: LoadPersistent maps the file and
+// validates the index, then the first RequestThumbnail resolves its id on
+// demand. Paths are interned up front in both cases (the gallery does that
+// from the scan cache), so only cache work is timed. "First thumbnail" is
+// load + the first visible upload; "first screen" adds the rest of a
+// screenful. Runs warm, and cold with the file dropped from the page cache
+// (posix_fadvise, Linux only).
+//
+// Then the cost of saving `--new` freshly decoded thumbnails: v1 rewrites
+// the whole file, v2 appends a log segment (and compacts every
+// ThumbnailStore::kMaxSegments saves, also timed).
+//
+//   persist_cache_bench [--entries 100000] [--thumb 160] [--screen 48] [--new 1000]
+//                       [--trials 3] [--keep 0]
+
+#include "BenchCommon.hpp"
+#include "core/ThumbnailPipeline.hpp"
+#include "core/ThumbnailStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+using namespace UltraImageViewer::Core;
+
+namespace {
+
+class CopyTextureSink : public TextureSink {
+public:
+    TextureHandle CreateTexture(uint32_t width, uint32_t height, const uint8_t* bgra) override
+    {
+        size_t bytes = static_cast<size_t>(width) * height * 4;
+        auto* copy = new uint8_t[bytes];
+        std::memcpy(copy, bgra, bytes);
+        return TextureHandle(copy, [](void* p) { delete[] static_cast<uint8_t*>(p); });
+    }
+};
+
+struct Thumb {
+    std::filesystem::path path;
+    uint16_t width, height;
+    const uint8_t* pixels;
+};
+
+size_t PixelBytes(const Thumb& t)
+{
+    return static_cast<size_t>(t.width) * t.height * 4;
+}
+
+void DropFromPageCache(const std::filesystem::path& file)
+{
+#if defined(__linux__)
+    ::sync();
+    int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    (void)file;
+#endif
+}
+
+// --- v1: the previous format and loader ---
+
+struct V1Info {
+    const uint8_t* pixelData = nullptr;
+    uint16_t width = 0;
+    uint16_t height = 0;
+};
+
+template <typename GetEntry>
+bool WriteV1(const std::filesystem::path& file, size_t count, GetEntry&& get)
+{
+    std::FILE* f = Platform::OpenFile(file, "wb");
+    if (!f) return false;
+    uint8_t header[32] = {};
+    std::memcpy(header, "UIVT", 4);
+    uint32_t version = 1, entryCount = static_cast<uint32_t>(count);
+    std::memcpy(header + 4, &version, 4);
+    std::memcpy(header + 8, &entryCount, 4);
+    std::fwrite(header, 1, 32, f);
+    for (size_t i = 0; i < count; ++i) {
+        Thumb t = get(i);
+        std::wstring pathStr = t.path.wstring();
+        uint16_t pathLen = static_cast<uint16_t>(pathStr.size()), reserved = 0;
+        std::fwrite(&pathLen, 2, 1, f);
+        std::fwrite(&t.width, 2, 1, f);
+        std::fwrite(&t.height, 2, 1, f);
+        std::fwrite(&reserved, 2, 1, f);
+        std::fwrite(pathStr.data(), sizeof(wchar_t), pathLen, f);
+        std::fwrite(t.pixels, 1, static_cast<size_t>(t.width) * t.height * 4, f);
+    }
+    return std::fclose(f) == 0;
+}
+
+bool LoadV1(const std::filesystem::path& file, PathInterner& interner, Platform::FileMapping& mapping,
+            std::vector<V1Info>& index)
+{
+    if (!Platform::MapFileReadOnly(file, mapping)) return false;
+    const uint8_t* data = mapping.data;
+    size_t size = mapping.size;
+    uint32_t version, entryCount;
+    if (size < 32 || std::memcmp(data, "UIVT", 4) != 0) return false;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&entryCount, data + 8, 4);
+    if (version != 1) return false;
+
+    size_t offset = 32;
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        if (offset + 8 > size) break;
+        uint16_t pathLen, w, h;
+        std::memcpy(&pathLen, data + offset, 2);
+        std::memcpy(&w, data + offset + 2, 2);
+        std::memcpy(&h, data + offset + 4, 2);
+        offset += 8;
+        size_t pathBytes = static_cast<size_t>(pathLen) * sizeof(wchar_t);
+        if (offset + pathBytes > size) break;
+        std::wstring pathStr(pathLen, L'\0');
+        std::memcpy(pathStr.data(), data + offset, pathBytes);
+        offset += pathBytes;
+        uint32_t pixelSize = static_cast<uint32_t>(w) * h * 4;
+        if (offset + pixelSize > size) break;
+        ImageId id = interner.Intern(std::filesystem::path(std::move(pathStr)));
+        if (id != kInvalidImageId) {
+            if (id >= index.size()) index.resize(static_cast<size_t>(id) + 1);
+            index[id] = {data + offset, w, h};
+        }
+        offset += pixelSize;
+    }
+    return true;
+}
+
+struct StartupTimes {
+    double firstMs = 0.0;
+    double screenMs = 0.0;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t entries = static_cast<size_t>(args.Get("entries", 100000));
+    const uint32_t thumb = static_cast<uint32_t>(args.Get("thumb", 160));
+    const size_t screen = static_cast<size_t>(std::max<long long>(1, args.Get("screen", 48)));
+    const size_t fresh = static_cast<size_t>(args.Get("new", 1000));
+    const int trials = static_cast<int>(std::max<long long>(1, args.Get("trials", 3)));
+    const bool keep = args.Get("keep", 0) != 0;
+
+    // Landscape and portrait thumbnails, as ThumbnailScaler::FitWithin produces
+    const uint16_t longSide = static_cast<uint16_t>(thumb), shortSide = static_cast<uint16_t>(thumb * 3 / 4);
+    std::vector<uint8_t> pixels(static_cast<size_t>(thumb) * thumb * 4);
+    for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = static_cast<uint8_t>(i * 7 + (i >> 10));
+
+    std::vector<std::filesystem::path> paths;
+    paths.reserve(entries + fresh);
+    for (size_t i = 0; i < entries + fresh; ++i) {
+        paths.emplace_back("/home/user/Pictures/" + std::to_string(2010 + i % 15) + "/" +
+                           std::to_string(1 + (i / 15) % 12) + "/IMG_" + std::to_string(100000 + i) + ".JPG");
+    }
+    auto thumbAt = [&](size_t i) {
+        bool landscape = (i % 3) != 0;
+        return Thumb{paths[i], landscape ? longSide : shortSide, landscape ? shortSide : longSide, pixels.data()};
+    };
+
+    auto dir = std::filesystem::temp_directory_path() / "uiv_persist_cache_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const auto v1File = dir / "scan_thumbs_v1.bin";
+    const auto v2File = dir / "scan_thumbs.bin";
+
+    std::printf("persist_cache_bench: %zu entries, %ux%u thumbnails, first screen = %zu\n",
+                entries, longSide, shortSide, screen);
+
+    auto start = Clock::now();
+    WriteV1(v1File, entries, thumbAt);
+    double v1WriteS = ElapsedUs(start) / 1e6;
+
+    std::vector<ThumbnailStore::NewEntry> all;
+    std::vector<Thumb> thumbs;
+    thumbs.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) thumbs.push_back(thumbAt(i));
+    for (const auto& t : thumbs) all.push_back({&t.path, t.pixels, PixelBytes(t), t.width, t.height});
+    start = Clock::now();
+    ThumbnailStore().WriteCompacted(v2File, all);
+    double v2WriteS = ElapsedUs(start) / 1e6;
+
+    std::printf("  file size: v1 %.1f MB, v2 %.1f MB (full write %.1f s / %.1f s)\n",
+                std::filesystem::file_size(v1File) / 1e6, std::filesystem::file_size(v2File) / 1e6,
+                v1WriteS, v2WriteS);
+
+    // The gallery's first screen: the newest images, in display order
+    std::vector<size_t> visible;
+    for (size_t i = 0; i < screen && i < entries; ++i) visible.push_back(entries - 1 - i * 7 % entries);
+
+    auto runV1 = [&](bool cold) {
+        if (cold) DropFromPageCache(v1File);
+        PathInterner interner;
+        for (size_t i = 0; i < entries; ++i) interner.Intern(paths[i]);
+        CopyTextureSink sink;
+        Platform::FileMapping mapping;
+        std::vector<V1Info> index;
+        std::vector<TextureHandle> textures;
+        StartupTimes t;
+
+        auto begin = Clock::now();
+        LoadV1(v1File, interner, mapping, index);
+        for (size_t n = 0; n < visible.size(); ++n) {
+            ImageId id = interner.Find(paths[visible[n]]);
+            if (id < index.size() && index[id].pixelData) {
+                textures.push_back(sink.CreateTexture(index[id].width, index[id].height, index[id].pixelData));
+            }
+            if (n == 0) t.firstMs = ElapsedUs(begin) / 1000.0;
+        }
+        t.screenMs = ElapsedUs(begin) / 1000.0;
+        Platform::UnmapFile(mapping);
+        return t;
+    };
+
+    auto runV2 = [&](bool cold, size_t* hits) {
+        if (cold) DropFromPageCache(v2File);
+        PathInterner interner;
+        for (size_t i = 0; i < entries; ++i) interner.Intern(paths[i]);
+        std::vector<ImageId> visibleIds;
+        for (size_t v : visible) visibleIds.push_back(interner.Find(paths[v]));
+        CopyTextureSink sink;
+        ThumbnailPipeline::Config config;
+        config.persistSyncBudgetPerFrame = static_cast<int>(screen);
+        ThumbnailPipeline pipeline(&interner, nullptr, &sink, nullptr, config);
+        StartupTimes t;
+
+        auto begin = Clock::now();
+        pipeline.LoadPersistent(v2File);
+        pipeline.FlushReadyThumbnails(0);  // starts the frame: resets the Tier 3 budget
+        size_t found = 0;
+        for (size_t n = 0; n < visibleIds.size(); ++n) {
+            if (pipeline.RequestThumbnail(visibleIds[n], thumb)) ++found;
+            if (n == 0) t.firstMs = ElapsedUs(begin) / 1000.0;
+        }
+        t.screenMs = ElapsedUs(begin) / 1000.0;
+        if (hits) *hits = found;
+        return t;
+    };
+
+    size_t hits = 0;
+    runV2(false, &hits);
+    if (hits != visible.size()) {
+        std::printf("v2 lookup failed: %zu of %zu visible thumbnails found\n", hits, visible.size());
+        return 1;
+    }
+
+    std::printf("\n  %-22s %16s %16s\n", "startup (ms)", "first thumbnail", "first screen");
+    for (bool cold : {false, true}) {
+        for (int version : {1, 2}) {
+            StartupTimes sum;
+            for (int i = 0; i < trials; ++i) {
+                StartupTimes t = version == 1 ? runV1(cold) : runV2(cold, nullptr);
+                sum.firstMs += t.firstMs;
+                sum.screenMs += t.screenMs;
+            }
+            char label[64];
+            std::snprintf(label, sizeof(label), "v%d, %s", version, cold ? "cold" : "warm");
+            std::printf("  %-22s %16.2f %16.2f\n", label, sum.firstMs / trials, sum.screenMs / trials);
+        }
+    }
+#if !defined(__linux__)
+    std::printf("  (page cache not dropped on this platform: cold rows ran warm)\n");
+#endif
+
+    // Saving `fresh` new thumbnails after a session
+    std::printf("\n  save %zu new thumbnails:\n", fresh);
+    {
+        PathInterner interner;
+        Platform::FileMapping mapping;
+        std::vector<V1Info> index;
+        LoadV1(v1File, interner, mapping, index);
+        std::vector<Thumb> old;
+        for (size_t id = 0; id < index.size(); ++id) {
+            if (index[id].pixelData) {
+                old.push_back({interner.Path(static_cast<ImageId>(id)), index[id].width, index[id].height,
+                               index[id].pixelData});
+            }
+        }
+        auto tmp = v1File;
+        tmp += ".tmp";
+        start = Clock::now();
+        WriteV1(tmp, old.size() + fresh, [&](size_t i) { return i < fresh ? thumbAt(entries + i) : old[i - fresh]; });
+        double s = ElapsedUs(start) / 1e6;
+        Platform::UnmapFile(mapping);
+        std::printf("  %-34s %8.2f s %10.1f MB written\n", "v1 full rewrite", s,
+                    std::filesystem::file_size(tmp) / 1e6);
+        std::filesystem::remove(tmp);
+    }
+    {
+        std::vector<Thumb> added;
+        for (size_t i = 0; i < fresh; ++i) added.push_back(thumbAt(entries + i));
+        std::vector<ThumbnailStore::NewEntry> batch;
+        for (const auto& t : added) batch.push_back({&t.path, t.pixels, PixelBytes(t), t.width, t.height});
+
+        auto before = std::filesystem::file_size(v2File);
+        start = Clock::now();
+        bool ok = ThumbnailStore::AppendSegment(v2File, batch);
+        double s = ElapsedUs(start) / 1e6;
+        std::printf("  %-34s %8.2f s %10.1f MB written\n", "v2 append segment", s,
+                    (std::filesystem::file_size(v2File) - before) / 1e6);
+
+        ThumbnailStore store;
+        ThumbnailStore::View view;
+        if (!ok || !store.Open(v2File) || !store.Find(added.back().path, view) ||
+            !store.Find(paths[0], view)) {
+            std::printf("v2 append verification failed\n");
+            return 1;
+        }
+        auto tmp = v2File;
+        tmp += ".tmp";
+        start = Clock::now();
+        store.WriteCompacted(tmp, {});
+        s = ElapsedUs(start) / 1e6;
+        std::printf("  %-34s %8.2f s %10.1f MB written\n", "v2 compaction (every 8th save)", s,
+                    std::filesystem::file_size(tmp) / 1e6);
+    }
+
+    if (!keep) std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,185 @@
+// pipeline_bench: drives ThumbnailPipeline the way GalleryView does during a
+// steady scroll, against synthetic images, and reports render-thread latency
+// (RequestThumbnail / FlushReadyThumbnails) plus decode→upload throughput.
+//
+//   pipeline_bench [--images 6000] [--workers 0] [--decode-us 400]
+//                  [--columns 6] [--rows 5] [--rows-per-frame 2] [--fps 240]
+//                  [--budget-mb 128] [--cell-px 170]
+
+#include "BenchCommon.hpp"
+#include "core/ThumbnailPipeline.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+// Generates a 160px-long-edge gradient per path after a simulated decode cost
+class SyntheticPixelSource : public Core::PixelSource {
+public:
+    explicit SyntheticPixelSource(double decodeUs) : decodeUs_(decodeUs) {}
+
+    bool DecodeThumbnail(const std::filesystem::path& path, uint32_t targetSize,
+                         Core::PixelBuffer& out) override
+    {
+        SpinFor(decodeUs_);
+
+        size_t seed = std::hash<std::filesystem::path>{}(path);
+        bool landscape = (seed & 1) != 0;
+        out.width = landscape ? targetSize : targetSize * 3 / 4;
+        out.height = landscape ? targetSize * 3 / 4 : targetSize;
+        out.pixels = std::make_unique<uint8_t[]>(static_cast<size_t>(out.width) * out.height * 4);
+        uint8_t* p = out.pixels.get();
+        for (uint32_t y = 0; y < out.height; ++y) {
+            for (uint32_t x = 0; x < out.width; ++x) {
+                p[0] = static_cast<uint8_t>(x + seed);
+                p[1] = static_cast<uint8_t>(y + (seed >> 8));
+                p[2] = static_cast<uint8_t>(x ^ y);
+                p[3] = 0xFF;
+                p += 4;
+            }
+        }
+        return true;
+    }
+
+private:
+    double decodeUs_;
+};
+
+// Stands in for the GPU: copies the pixels (as CreateBitmap does) and counts bytes
+class CopyTextureSink : public Core::TextureSink {
+public:
+    Core::TextureHandle CreateTexture(uint32_t width, uint32_t height,
+                                      const uint8_t* bgra) override
+    {
+        size_t bytes = static_cast<size_t>(width) * height * 4;
+        auto* copy = new uint8_t[bytes];
+        std::memcpy(copy, bgra, bytes);
+        uploadedBytes += bytes;
+        return Core::TextureHandle(copy, [](void* p) { delete[] static_cast<uint8_t*>(p); });
+    }
+
+    uint64_t uploadedBytes = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t imageCount   = static_cast<size_t>(args.Get("images", 6000));
+    const uint32_t workers    = static_cast<uint32_t>(args.Get("workers", 0));
+    const double decodeUs     = args.GetDouble("decode-us", 400.0);
+    const int columns         = static_cast<int>(args.Get("columns", 6));
+    const int visibleRows     = static_cast<int>(args.Get("rows", 5));
+    const int rowsPerFrame    = static_cast<int>(args.Get("rows-per-frame", 2));
+    const double fps          = args.GetDouble("fps", 240.0);
+    const size_t budgetMb     = static_cast<size_t>(args.Get("budget-mb", 128));
+    const float cellPx        = static_cast<float>(args.GetDouble("cell-px", 170.0));
+    constexpr uint32_t kTargetPx = 160;
+    constexpr int kMaxUploadsPerFrame = 64;
+    constexpr int kPrefetchScreens = 3;
+
+    // Interned up front, as ScanFolders does
+    Core::PathInterner interner;
+    std::vector<Core::ImageId> images;
+    images.reserve(imageCount);
+    for (size_t i = 0; i < imageCount; ++i) {
+        images.push_back(interner.Intern("/synthetic/DCIM/IMG_" + std::to_string(i) + ".jpg"));
+    }
+
+    SyntheticPixelSource source(decodeUs);
+    CopyTextureSink sink;
+    Core::ThreadPool pool(workers);
+
+    Core::ThumbnailPipeline::Config config;
+    config.memoryBudgetBytes = budgetMb * 1024 * 1024;  // half Tier 1 textures, half their CPU copies
+    config.tier2ReserveBytes = 0;
+    config.collectSaveBuffer = false;
+    Core::ThumbnailPipeline pipeline(&interner, &source, &sink, &pool, config);
+
+    std::printf("pipeline_bench: %zu images, %u workers, decode=%.0fus, grid=%dx%d, "
+                "%d rows/frame @ %.0f fps, memory budget %zu MB\n",
+                imageCount, pool.ThreadCount(), decodeUs, columns, visibleRows,
+                rowsPerFrame, fps, budgetMb);
+
+    LatencyRecorder requestLat, flushLat, frameLat;
+    size_t visibleHits = 0, visibleTotal = 0;
+    const size_t totalRows = (imageCount + columns - 1) / columns;
+    const auto frameBudget = std::chrono::duration<double>(fps > 0 ? 1.0 / fps : 0.0);
+
+    auto benchStart = Clock::now();
+    std::vector<Core::ImageId> visible;
+    for (size_t topRow = 0; topRow < totalRows; topRow += rowsPerFrame) {
+        auto frameStart = Clock::now();
+
+        // Same order as RenderImageGrid: flush uploads, then walk the cells
+        auto t0 = Clock::now();
+        pipeline.FlushReadyThumbnails(kMaxUploadsPerFrame);
+        flushLat.Add(ElapsedUs(t0));
+        pipeline.SetViewport(visibleRows * cellPx,
+                             rowsPerFrame * cellPx * static_cast<float>(fps > 0 ? fps : 60.0));
+
+        size_t firstRow = topRow > static_cast<size_t>(visibleRows * kPrefetchScreens)
+                              ? topRow - visibleRows * kPrefetchScreens : 0;
+        size_t lastRow = std::min(totalRows, topRow + visibleRows * (kPrefetchScreens + 1));
+
+        visible.clear();
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            for (int col = 0; col < columns; ++col) {
+                size_t idx = row * columns + col;
+                if (idx >= imageCount) break;
+                bool onScreen = row >= topRow && row < topRow + visibleRows;
+                if (onScreen) visible.push_back(images[idx]);
+                float cellY = (static_cast<float>(row) - static_cast<float>(topRow)) * cellPx;
+
+                auto r0 = Clock::now();
+                auto tex = pipeline.RequestThumbnail(images[idx], kTargetPx, cellY, cellY + cellPx);
+                requestLat.Add(ElapsedUs(r0));
+
+                if (onScreen) {
+                    ++visibleTotal;
+                    if (tex) ++visibleHits;
+                }
+            }
+        }
+        pipeline.SetVisibleRange(visible);
+        frameLat.Add(ElapsedUs(frameStart));
+
+        if (fps > 0) {
+            std::this_thread::sleep_until(frameStart +
+                std::chrono::duration_cast<Clock::duration>(frameBudget));
+        }
+    }
+    double scrollUs = ElapsedUs(benchStart);
+
+    // Drain: let outstanding decodes finish and upload everything
+    auto drainStart = Clock::now();
+    while (pool.PendingCount() > 0 || pool.ActiveCount() > 0 || pipeline.HasPendingThumbnails()) {
+        pipeline.FlushReadyThumbnails(kMaxUploadsPerFrame);
+        std::this_thread::yield();
+    }
+    double drainUs = ElapsedUs(drainStart);
+    double totalUs = ElapsedUs(benchStart);
+
+    auto stats = pipeline.GetStats();
+    std::printf("\nRender thread\n");
+    requestLat.Print("RequestThumbnail");
+    flushLat.Print("FlushReadyThumbnails");
+    frameLat.Print("frame (CPU)");
+    std::printf("\nThroughput\n");
+    std::printf("  scroll %.1f ms + drain %.1f ms\n", scrollUs / 1000.0, drainUs / 1000.0);
+    std::printf("  decodes=%llu uploads=%llu (%.0f uploads/s, %.1f MB/s)\n",
+                static_cast<unsigned long long>(stats.decodes),
+                static_cast<unsigned long long>(stats.uploads),
+                stats.uploads / (totalUs / 1e6),
+                sink.uploadedBytes / (totalUs / 1e6) / (1024.0 * 1024.0));
+    std::printf("  visible cells ready at draw: %.1f%% (%zu/%zu)\n",
+                visibleTotal ? 100.0 * visibleHits / visibleTotal : 0.0,
+                visibleHits, visibleTotal);
+    std::printf("  resident: %zu GPU entries (%.1f MB), %zu tier-2 entries\n",
+                stats.gpuEntries, stats.gpuBytes / (1024.0 * 1024.0), stats.tier2Entries);
+    return 0;
+}
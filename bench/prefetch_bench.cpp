@@ -0,0 +1,197 @@
+// prefetch_bench: replays viewer navigation over a synthetic library through
+// AccessPredictor and a CacheManager-style LRU (same prefetch rules: up to 3
+// predictions per view, unused prefetches capped at a quarter of the cache),
+// and reports whether prediction pays for itself: demand misses avoided,
+// prediction hit rate and bytes decoded for nothing.
+//
+// Prefetch decodes are assumed to finish before the next view; the numbers
+// are an upper bound on what the predictor can save, not on timing.
+//
+//   prefetch_bench [--folders 12] [--per-folder 150] [--steps 20000]
+//                  [--cache-mb 512] [--seed 1]
+
+#include "BenchCommon.hpp"
+#include "core/AccessPredictor.hpp"
+#include <list>
+#include <random>
+#include <unordered_map>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+using Trace = std::vector<Core::ImageId>;
+
+struct Library {
+    Core::PathInterner interner;
+    std::vector<std::vector<Core::ImageId>> folders;
+};
+
+// Mix of 12/20/24 MP photos (BGRA bytes), fixed per id
+size_t ImageBytes(Core::ImageId id)
+{
+    static constexpr size_t kPixels[] = {4000 * 3000, 5472 * 3648, 6000 * 4000};
+    return kPixels[(id * 2654435761u >> 7) % 3] * 4;
+}
+
+// Viewing sessions: page through a folder with step-backs, return to a few
+// favourites, and switch folders (resuming where that folder was left)
+Trace MixedSessions(const Library& lib, size_t steps, std::mt19937& rng, bool newestFirst)
+{
+    Trace t;
+    std::uniform_int_distribution<int> roll(0, 99), back(1, 3);
+    std::uniform_int_distribution<size_t> pickFolder(0, lib.folders.size() - 1);
+    std::vector<size_t> resume(lib.folders.size(), 0);
+    std::vector<Core::ImageId> favourites;
+    size_t folder = 0, pos = newestFirst ? lib.folders[0].size() - 1 : 0;
+
+    for (size_t i = 0; i < steps; ++i) {
+        const auto& f = lib.folders[folder];
+        int r = roll(rng);
+        if (r < 62) {
+            pos = newestFirst ? (pos > 0 ? pos - 1 : 0) : std::min(f.size() - 1, pos + 1);
+        } else if (r < 80) {
+            size_t b = back(rng);
+            pos = newestFirst ? std::min(f.size() - 1, pos + b) : (pos > b ? pos - b : 0);
+        } else if (r < 88 && !favourites.empty()) {
+            t.push_back(favourites[std::uniform_int_distribution<size_t>(0, favourites.size() - 1)(rng)]);
+            continue;
+        } else if (r < 92) {
+            favourites.push_back(f[pos]);
+            if (favourites.size() > 5) favourites.erase(favourites.begin());
+        } else if (r < 97) {
+            // Habitual switches: mostly between neighbouring folders
+            resume[folder] = pos;
+            folder = roll(rng) < 70 ? (folder + 1) % lib.folders.size() : pickFolder(rng);
+            pos = resume[folder];
+            if (newestFirst && pos == 0) pos = f.size() - 1;
+        } else {
+            pos = std::uniform_int_distribution<size_t>(0, f.size() - 1)(rng);
+        }
+        t.push_back(lib.folders[folder][pos]);
+    }
+    return t;
+}
+
+enum class Mode { None, NextPage, Predictor };
+
+void Replay(const char* name, Mode mode, const Library& lib, const Trace& trace, size_t capacity)
+{
+    struct Entry { Core::ImageId id; size_t bytes; bool prefetched; };
+    std::list<Entry> lru;
+    std::unordered_map<Core::ImageId, std::list<Entry>::iterator> index;
+    size_t used = 0, unusedPrefetch = 0;
+    size_t misses = 0, prefetches = 0, predictionHits = 0, wasted = 0;
+
+    auto evictFor = [&](size_t bytes) {
+        while (used + bytes > capacity && !lru.empty()) {
+            auto& e = lru.back();
+            if (e.prefetched) {
+                unusedPrefetch -= e.bytes;
+                wasted += e.bytes;
+            }
+            used -= e.bytes;
+            index.erase(e.id);
+            lru.pop_back();
+        }
+    };
+    auto insert = [&](Core::ImageId id, bool prefetched) {
+        size_t bytes = ImageBytes(id);
+        evictFor(bytes);
+        lru.push_front({id, bytes, prefetched});
+        index[id] = lru.begin();
+        used += bytes;
+        if (prefetched) {
+            unusedPrefetch += bytes;
+            ++prefetches;
+        }
+    };
+
+    Core::AccessPredictor predictor(&lib.interner, Core::AccessPredictor::Config{});
+    LatencyRecorder predictLat;
+
+    for (Core::ImageId page : trace) {
+        auto it = index.find(page);
+        if (it == index.end()) {
+            ++misses;
+            insert(page, false);
+        } else {
+            lru.splice(lru.begin(), lru, it->second);
+            if (it->second->prefetched) {
+                it->second->prefetched = false;
+                unusedPrefetch -= it->second->bytes;
+                ++predictionHits;
+            }
+        }
+
+        std::vector<Core::ImageId> ahead;
+        if (mode == Mode::NextPage) {
+            if (page + 1 < lib.interner.Size()) ahead.push_back(page + 1);
+        } else if (mode == Mode::Predictor) {
+            auto t0 = Clock::now();
+            predictor.Record(page);
+            for (const auto& p : predictor.Predict(page, 3)) ahead.push_back(p.id);
+            predictLat.Add(ElapsedUs(t0));
+        }
+        for (Core::ImageId id : ahead) {
+            if (index.contains(id)) continue;
+            // Over the cap: drop unused prefetches no longer predicted (oldest
+            // first); if only current predictions remain, stop speculating
+            for (auto e = lru.end(); unusedPrefetch + ImageBytes(id) > capacity / 4 && e != lru.begin();) {
+                --e;
+                if (!e->prefetched || std::find(ahead.begin(), ahead.end(), e->id) != ahead.end()) continue;
+                unusedPrefetch -= e->bytes;
+                wasted += e->bytes;
+                used -= e->bytes;
+                index.erase(e->id);
+                e = lru.erase(e);
+            }
+            if (unusedPrefetch + ImageBytes(id) > capacity / 4) break;
+            insert(id, true);
+        }
+    }
+
+    std::printf("  %-16s page misses %6zu (%5.1f%%)  prefetched %6zu  used %5.1f%%  wasted %8.1f MB\n",
+                name, misses, 100.0 * misses / trace.size(), prefetches,
+                prefetches ? 100.0 * predictionHits / prefetches : 0.0,
+                wasted / (1024.0 * 1024.0));
+    if (mode == Mode::Predictor) predictLat.Print("Record + Predict");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t folderCount = static_cast<size_t>(args.Get("folders", 12));
+    const size_t perFolder   = static_cast<size_t>(args.Get("per-folder", 150));
+    const size_t steps       = static_cast<size_t>(args.Get("steps", 20000));
+    const size_t cacheMb     = static_cast<size_t>(args.Get("cache-mb", 512));
+    const uint32_t seed      = static_cast<uint32_t>(args.Get("seed", 1));
+
+    // Interned in scan order: folder by folder, photos sorted within each
+    Library lib;
+    for (size_t f = 0; f < folderCount; ++f) {
+        auto& ids = lib.folders.emplace_back();
+        for (size_t i = 0; i < perFolder; ++i) {
+            ids.push_back(lib.interner.Intern("/synthetic/Album" + std::to_string(f) +
+                                              "/IMG_" + std::to_string(i) + ".jpg"));
+        }
+    }
+
+    std::printf("prefetch_bench: %zu folders x %zu images (12-24 MP), %zu views, cache %zu MB\n",
+                folderCount, perFolder, steps, cacheMb);
+    const size_t capacity = cacheMb * 1024 * 1024;
+
+    for (bool newestFirst : {false, true}) {
+        std::mt19937 rng(seed);
+        Trace trace = MixedSessions(lib, steps, rng, newestFirst);
+        std::printf("\n%s\n", newestFirst ? "Paging newest-first (backwards in scan order)"
+                                          : "Paging oldest-first");
+        Replay("no prefetch", Mode::None, lib, trace, capacity);
+        Replay("next page", Mode::NextPage, lib, trace, capacity);
+        Replay("predictor", Mode::Predictor, lib, trace, capacity);
+    }
+    return 0;
+}
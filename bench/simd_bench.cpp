@@ -0,0 +1,318 @@
+// Core::Simd pixel kernels: correctness against the scalar reference and
+// per-kernel throughput at every instruction-set level this CPU supports.
+//
+// Correctness runs first: each level is forced with SetLevel and every
+// kernel is compared bit-for-bit with the scalar level over random buffers,
+// all lengths 0..100 (tails), large sizes, edge values (alpha 0/255, every
+// 16-bit sample, NaN/-0/out-of-range floats) and in-place calls. Any
+// mismatch is reported and the process exits with status 1.
+//
+//   simd_bench [--pixels N] [--iters N] [--seed N] [--check-only 1]
+
+#include "BenchCommon.hpp"
+#include "core/SimdUtils.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+namespace Simd = UltraImageViewer::Core::Simd;
+
+namespace {
+
+constexpr Simd::Level kAllLevels[] = {
+    Simd::Level::Scalar, Simd::Level::SSE41, Simd::Level::AVX2,
+    Simd::Level::AVX512, Simd::Level::NEON,
+};
+
+int g_failures = 0;
+
+template <typename T>
+bool SameBits(const std::vector<T>& a, const std::vector<T>& b, size_t count, const char* kernel,
+              Simd::Level level, size_t length)
+{
+    if (std::memcmp(a.data(), b.data(), count * sizeof(T)) == 0) return true;
+    size_t at = 0;
+    while (at < count && std::memcmp(&a[at], &b[at], sizeof(T)) == 0) ++at;
+    std::printf("  MISMATCH %-14s level=%-7s length=%zu first diff at element %zu\n",
+                kernel, Simd::LevelName(level), length, at);
+    ++g_failures;
+    return false;
+}
+
+std::vector<uint8_t> RandomBytes(std::mt19937& rng, size_t count)
+{
+    std::vector<uint8_t> v(count);
+    for (auto& b : v) b = static_cast<uint8_t>(rng());
+    return v;
+}
+
+// Pixels biased towards the alpha edge cases (0, 1, 255) the premultiply
+// kernels special-case or round differently
+std::vector<uint8_t> RandomPixels(std::mt19937& rng, size_t pixels)
+{
+    auto v = RandomBytes(rng, pixels * 4);
+    for (size_t i = 0; i < pixels; ++i) {
+        switch (rng() % 5) {
+        case 0: v[i * 4 + 3] = 0; break;
+        case 1: v[i * 4 + 3] = 255; break;
+        case 2: v[i * 4 + 3] = 1; break;
+        default: break;
+        }
+    }
+    return v;
+}
+
+std::vector<float> RandomFloats(std::mt19937& rng, size_t count)
+{
+    const float specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 2.0f, 0.5f / 255.0f, 1.5f / 255.0f,
+        std::numeric_limits<float>::quiet_NaN(),
+        -std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::denorm_min(),
+    };
+    std::uniform_real_distribution<float> dist(-0.25f, 1.25f);
+    std::vector<float> v(count);
+    for (auto& f : v) {
+        f = (rng() % 8 == 0) ? specials[rng() % std::size(specials)] : dist(rng);
+    }
+    return v;
+}
+
+// Runs `fn` at `level` and at scalar on copies of `src`, then compares.
+// For in-place kernels the same is repeated with dst == src.
+template <typename In, typename Out, typename Fn>
+void CheckKernel(const char* name, Simd::Level level, Fn fn, const std::vector<In>& src,
+                 size_t outCount, size_t length, bool inPlace)
+{
+    std::vector<Out> ref(outCount + 1, Out{}), got(outCount + 1, Out{});
+    Simd::SetLevel(Simd::Level::Scalar);
+    fn(src.data(), ref.data(), length);
+    Simd::SetLevel(level);
+    fn(src.data(), got.data(), length);
+    // One guard element past the end must stay untouched
+    if (!SameBits(ref, got, outCount + 1, name, level, length)) return;
+
+    if constexpr (std::is_same_v<In, Out>) {
+        if (inPlace) {
+            std::vector<In> buf = src;
+            fn(buf.data(), buf.data(), length);
+            SameBits(ref, buf, outCount, name, level, length);
+        }
+    }
+}
+
+void CheckLevel(Simd::Level level, std::mt19937& rng)
+{
+    std::vector<size_t> lengths;
+    for (size_t n = 0; n <= 100; ++n) lengths.push_back(n);
+    lengths.push_back(4093);
+    lengths.push_back(65536 + 7);
+
+    for (size_t n : lengths) {
+        auto px = RandomPixels(rng, n);
+        CheckKernel<uint8_t, uint8_t>("SwapRedBlue", level, Simd::SwapRedBlue, px, n * 4, n, true);
+        CheckKernel<uint8_t, uint8_t>("Premultiply", level, Simd::PremultiplyAlpha, px, n * 4, n, true);
+        CheckKernel<uint8_t, uint8_t>("Unpremultiply", level, Simd::UnpremultiplyAlpha, px, n * 4, n, true);
+
+        auto rgb = RandomBytes(rng, n * 3);
+        CheckKernel<uint8_t, uint8_t>("Rgb24ToBgra32", level, Simd::Rgb24ToBgra32, rgb, n * 4, n, false);
+        CheckKernel<uint8_t, uint8_t>("Bgr24ToBgra32", level, Simd::Bgr24ToBgra32, rgb, n * 4, n, false);
+
+        auto bytes = RandomBytes(rng, n);
+        CheckKernel<uint8_t, uint16_t>("Widen8To16", level, Simd::Widen8To16, bytes, n, n, false);
+        CheckKernel<uint8_t, float>("U8ToFloat", level, Simd::U8ToFloat, bytes, n, n, false);
+
+        std::vector<uint16_t> words(n);
+        for (auto& w : words) w = static_cast<uint16_t>(rng());
+        CheckKernel<uint16_t, uint8_t>("Narrow16To8", level, Simd::Narrow16To8, words, n, n, false);
+
+        auto floats = RandomFloats(rng, n);
+        CheckKernel<float, uint8_t>("FloatToU8", level, Simd::FloatToU8, floats, n, n, false);
+    }
+
+    // Exhaustive: every 16-bit sample, every (color, alpha) pair, every byte
+    std::vector<uint16_t> allWords(65536);
+    for (size_t i = 0; i < allWords.size(); ++i) allWords[i] = static_cast<uint16_t>(i);
+    CheckKernel<uint16_t, uint8_t>("Narrow16To8", level, Simd::Narrow16To8, allWords, 65536, 65536, false);
+
+    std::vector<uint8_t> allPairs(65536 * 4);
+    for (size_t i = 0; i < 65536; ++i) {
+        uint8_t c = static_cast<uint8_t>(i & 0xFF), a = static_cast<uint8_t>(i >> 8);
+        allPairs[i * 4 + 0] = c;
+        allPairs[i * 4 + 1] = static_cast<uint8_t>(255 - c);
+        allPairs[i * 4 + 2] = a;
+        allPairs[i * 4 + 3] = a;
+    }
+    CheckKernel<uint8_t, uint8_t>("Premultiply", level, Simd::PremultiplyAlpha, allPairs, 65536 * 4, 65536, true);
+    CheckKernel<uint8_t, uint8_t>("Unpremultiply", level, Simd::UnpremultiplyAlpha, allPairs, 65536 * 4, 65536, true);
+
+    std::vector<uint8_t> allBytes(256);
+    for (size_t i = 0; i < 256; ++i) allBytes[i] = static_cast<uint8_t>(i);
+    CheckKernel<uint8_t, float>("U8ToFloat", level, Simd::U8ToFloat, allBytes, 256, 256, false);
+    CheckKernel<uint8_t, uint16_t>("Widen8To16", level, Simd::Widen8To16, allBytes, 256, 256, false);
+
+    // Scalar results at the rounding boundaries k/255 +- 0.5/255
+    std::vector<float> boundaries;
+    for (int k = 0; k <= 256; ++k) {
+        float mid = (static_cast<float>(k) - 0.5f) / 255.0f;
+        boundaries.push_back(std::nextafter(mid, -1.0f));
+        boundaries.push_back(mid);
+        boundaries.push_back(std::nextafter(mid, 2.0f));
+    }
+    CheckKernel<float, uint8_t>("FloatToU8", level, Simd::FloatToU8, boundaries,
+                                boundaries.size(), boundaries.size(), false);
+}
+
+// Resampling convolutions with random windows and full-range int16 weights
+void CheckConvolve(Simd::Level level, std::mt19937& rng)
+{
+    const size_t tapCounts[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 32};
+    const size_t widths[] = {0, 1, 2, 3, 4, 5, 7, 17, 64, 255};
+    for (size_t taps : tapCounts) {
+        for (size_t dstPixels : widths) {
+            size_t srcPixels = dstPixels * 2 + taps;
+            auto src = RandomBytes(rng, srcPixels * 4);
+            std::vector<int32_t> starts(dstPixels);
+            std::vector<int16_t> weights(dstPixels * taps);
+            for (auto& st : starts) st = static_cast<int32_t>(rng() % (srcPixels - taps + 1));
+            for (auto& w : weights) w = static_cast<int16_t>(rng());
+            auto fn = [&](const uint8_t* in, uint8_t* out, size_t n) {
+                Simd::ConvolveHorizontal(in, out, n, starts.data(), weights.data(), taps);
+            };
+            CheckKernel<uint8_t, uint8_t>("ConvolveH", level, fn, src, dstPixels * 4, dstPixels, false);
+        }
+
+        for (size_t bytes : {size_t(0), size_t(1), size_t(15), size_t(16), size_t(31), size_t(33),
+                             size_t(100), size_t(4096 + 3)}) {
+            std::vector<std::vector<uint8_t>> rowData;
+            std::vector<const uint8_t*> rows;
+            for (size_t k = 0; k < taps; ++k) {
+                rowData.push_back(RandomBytes(rng, bytes));
+                rows.push_back(rowData.back().data());
+            }
+            std::vector<int16_t> weights(taps);
+            for (auto& w : weights) w = static_cast<int16_t>(rng());
+            std::vector<uint8_t> unused(1);
+            auto fn = [&](const uint8_t*, uint8_t* out, size_t n) {
+                Simd::ConvolveVertical(rows.data(), weights.data(), taps, out, n);
+            };
+            CheckKernel<uint8_t, uint8_t>("ConvolveV", level, fn, unused, bytes, bytes, false);
+        }
+    }
+}
+
+// ToLowerInPlace has its own AVX2/SSE2 dispatch; check it against a plain loop
+void CheckToLower(std::mt19937& rng)
+{
+    const wchar_t alphabet[] = L"AZaz@[`{09_/\\.MQ\u00C4\u0130\u212A";
+    for (size_t n = 0; n <= 200; ++n) {
+        std::wstring s(n, L' ');
+        for (auto& c : s) c = alphabet[rng() % (std::size(alphabet) - 1)];
+        std::wstring expected = s;
+        for (auto& c : expected) {
+            if (c >= L'A' && c <= L'Z') c = static_cast<wchar_t>(c + 32);
+        }
+        Simd::ToLowerInPlace(s);
+        if (s != expected) {
+            std::printf("  MISMATCH ToLowerInPlace length=%zu\n", n);
+            ++g_failures;
+        }
+    }
+}
+
+double GBps(size_t bytes, double us) { return us > 0.0 ? static_cast<double>(bytes) / (us * 1000.0) : 0.0; }
+
+// Best-of-iters throughput, counting bytes read + written
+template <typename In, typename Out, typename Fn>
+double Throughput(Fn fn, const std::vector<In>& src, std::vector<Out>& dst, size_t length,
+                  size_t bytesMoved, int iters)
+{
+    double best = 1e30;
+    for (int it = 0; it < iters; ++it) {
+        auto start = Clock::now();
+        fn(src.data(), dst.data(), length);
+        best = std::min(best, ElapsedUs(start));
+    }
+    return GBps(bytesMoved, best);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t pixels = static_cast<size_t>(args.Get("pixels", 1 << 20));
+    const int iters = static_cast<int>(args.Get("iters", 20));
+    const bool checkOnly = args.Get("check-only", 0) != 0;
+    std::mt19937 rng(static_cast<uint32_t>(args.Get("seed", 7)));
+
+    const Simd::Level detected = Simd::ActiveLevel();
+    std::printf("simd_bench: detected level %s\n", Simd::LevelName(detected));
+
+    std::vector<Simd::Level> levels;
+    for (Simd::Level level : kAllLevels) {
+        if (Simd::IsLevelSupported(level)) levels.push_back(level);
+    }
+
+    std::printf("\nCorrectness vs scalar reference\n");
+    CheckToLower(rng);
+    for (Simd::Level level : levels) {
+        if (level == Simd::Level::Scalar) continue;
+        int before = g_failures;
+        CheckLevel(level, rng);
+        CheckConvolve(level, rng);
+        std::printf("  %-8s %s\n", Simd::LevelName(level), g_failures == before ? "ok" : "FAILED");
+    }
+    Simd::SetLevel(detected);
+    if (g_failures > 0) {
+        std::printf("\n%d mismatches\n", g_failures);
+        return 1;
+    }
+    if (checkOnly) return 0;
+
+    // Throughput over --pixels pixels, counting bytes read + written per call
+    auto px = RandomPixels(rng, pixels);
+    auto rgb = RandomBytes(rng, pixels * 3);
+    auto bytes = RandomBytes(rng, pixels * 4);
+    std::vector<uint16_t> words(pixels * 4);
+    std::vector<float> floats(pixels * 4);
+    std::vector<uint8_t> out8(pixels * 4);
+    Simd::Widen8To16(bytes.data(), words.data(), words.size());
+    Simd::U8ToFloat(bytes.data(), floats.data(), floats.size());
+    const size_t n = pixels, s = pixels * 4;
+
+    std::printf("\nThroughput (GB/s, best of %d, %zu pixels)\n", iters, pixels);
+    std::printf("  %-16s", "kernel");
+    for (Simd::Level level : levels) std::printf(" %8s", Simd::LevelName(level));
+    std::printf("\n");
+
+    auto row = [&](const char* name, auto measure) {
+        std::printf("  %-16s", name);
+        for (Simd::Level level : levels) {
+            Simd::SetLevel(level);
+            std::printf(" %8.2f", measure());
+        }
+        std::printf("\n");
+    };
+
+    std::vector<uint16_t> out16(s);
+    std::vector<float> outF(s);
+    row("SwapRedBlue", [&] { return Throughput(Simd::SwapRedBlue, px, out8, n, n * 8, iters); });
+    row("Premultiply", [&] { return Throughput(Simd::PremultiplyAlpha, px, out8, n, n * 8, iters); });
+    row("Unpremultiply", [&] { return Throughput(Simd::UnpremultiplyAlpha, px, out8, n, n * 8, iters); });
+    row("Rgb24ToBgra32", [&] { return Throughput(Simd::Rgb24ToBgra32, rgb, out8, n, n * 7, iters); });
+    row("Bgr24ToBgra32", [&] { return Throughput(Simd::Bgr24ToBgra32, rgb, out8, n, n * 7, iters); });
+    row("Widen8To16", [&] { return Throughput(Simd::Widen8To16, bytes, out16, s, s * 3, iters); });
+    row("Narrow16To8", [&] { return Throughput(Simd::Narrow16To8, words, out8, s, s * 3, iters); });
+    row("U8ToFloat", [&] { return Throughput(Simd::U8ToFloat, bytes, outF, s, s * 5, iters); });
+    row("FloatToU8", [&] { return Throughput(Simd::FloatToU8, floats, out8, s, s * 5, iters); });
+
+    Simd::SetLevel(detected);
+    return 0;
+}
@@ -0,0 +1,374 @@
+// threadpool_bench: Core::ThreadPool against the previous single-mutex
+// three-lane pool (embedded below as MutexPool for reference).
+//
+//   * throughput of tiny tasks submitted one at a time from outside the
+//     pool (with a thumbnail decode's captures, then with a captured path),
+//     in batches (SubmitBatch), and spawned by tasks (fan-out tree), plus
+//     heap allocations per task and the latency of each Submit call
+//   * wake-up latency: submit to a parked pool, time until the task starts
+//   * SubmitFront latency for a High task behind a full Low lane
+//   * process CPU time burnt by an idle pool
+//
+//   threadpool_bench [--tasks 200000] [--work-ns 0] [--batch 64] [--depth 16]
+//                    [--wakeups 2000] [--idle-ms 500] [--workers 0]
+
+#include "BenchCommon.hpp"
+#include "core/Platform.hpp"
+#include "core/ThreadPool.hpp"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+// Count every heap allocation in the process (the pools' and the tasks')
+static std::atomic<uint64_t> g_allocs{0};
+
+void* operator new(size_t bytes)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// The previous ThreadPool: one mutex and condition variable over three
+// deques, spin -> CpuRelax -> sleep on the condition variable
+class MutexPool {
+public:
+    explicit MutexPool(uint32_t numThreads)
+    {
+        for (uint32_t i = 0; i < numThreads; ++i) {
+            threads_.emplace_back([this] { WorkerFunc(); });
+        }
+    }
+
+    ~MutexPool()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            shutdown_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    void Submit(std::function<void()> fn, Core::TaskPriority p = Core::TaskPriority::Normal)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            lanes_[static_cast<int>(p)].push_back(std::move(fn));
+        }
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+        cv_.notify_one();
+    }
+
+    void SubmitFront(std::function<void()> fn, Core::TaskPriority p = Core::TaskPriority::High)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            lanes_[static_cast<int>(p)].push_front(std::move(fn));
+        }
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+        cv_.notify_one();
+    }
+
+    void SubmitBatch(std::vector<std::function<void()>>& fns, Core::TaskPriority p)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            for (auto& fn : fns) lanes_[static_cast<int>(p)].push_back(std::move(fn));
+        }
+        pending_.fetch_add(static_cast<uint32_t>(fns.size()), std::memory_order_acq_rel);
+        cv_.notify_all();
+    }
+
+    void WaitIdle()
+    {
+        std::unique_lock lock(mutex_);
+        idleCV_.wait(lock, [this] {
+            return pending_.load(std::memory_order_acquire) == 0 &&
+                   active_.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+private:
+    bool TryDequeue(std::function<void()>& fn)
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& q : lanes_) {
+            if (!q.empty()) {
+                fn = std::move(q.front());
+                q.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Execute(std::function<void()>& fn)
+    {
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+        active_.fetch_add(1, std::memory_order_acq_rel);
+        fn();
+        active_.fetch_sub(1, std::memory_order_acq_rel);
+        if (pending_.load(std::memory_order_acquire) == 0 &&
+            active_.load(std::memory_order_acquire) == 0) {
+            std::lock_guard lock(mutex_);
+            idleCV_.notify_all();
+        }
+    }
+
+    void WorkerFunc()
+    {
+        std::function<void()> fn;
+        for (;;) {
+            bool found = false;
+            for (int spin = 0; spin < 64 && !found; ++spin) found = TryDequeue(fn);
+            for (int y = 0; y < 256 && !found; ++y) {
+                Core::Platform::CpuRelax();
+                found = TryDequeue(fn);
+            }
+            if (found) {
+                Execute(fn);
+                continue;
+            }
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] {
+                return shutdown_ || !lanes_[0].empty() || !lanes_[1].empty() || !lanes_[2].empty();
+            });
+            if (shutdown_) return;
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idleCV_;
+    std::deque<std::function<void()>> lanes_[3];
+    std::atomic<uint32_t> pending_{0};
+    std::atomic<uint32_t> active_{0};
+    bool shutdown_ = false;
+    std::vector<std::thread> threads_;
+};
+
+double ProcessCpuMs()
+{
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+    auto ticks = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) / 1e4;
+#else
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e3 +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e3;
+#endif
+}
+
+double g_workNs = 0.0;
+
+void Work()
+{
+    if (g_workNs > 0.0) SpinFor(g_workNs / 1000.0);
+}
+
+// Stands in for ThumbnailPipeline / CacheManager as the task's `this`
+struct Owner {
+    std::atomic<uint64_t>& done;
+
+    void Decode(uint32_t id, uint32_t size, uint64_t gen)
+    {
+        Work();
+        if (id != UINT32_MAX && size != 0 && gen != 0) done.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Prefetch(const std::filesystem::path& path)
+    {
+        Work();
+        if (!path.empty()) done.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// SubmitBatch takes std::function for the previous pool, TaskFunction now
+template <typename Pool>
+using TaskBatch = std::vector<std::conditional_t<std::is_same_v<Pool, MutexPool>,
+                                                 std::function<void()>, Core::TaskFunction>>;
+
+struct Settings {
+    size_t tasks;
+    size_t batch;
+    int depth;
+    size_t wakeups;
+    int idleMs;
+    uint32_t workers;
+};
+
+// Binary tree of tasks, each spawning its two children from inside the pool
+template <typename Pool>
+void Spawn(Pool& pool, int depth, std::atomic<uint64_t>& done)
+{
+    Work();
+    done.fetch_add(1, std::memory_order_relaxed);
+    if (depth == 0) return;
+    for (int i = 0; i < 2; ++i) {
+        pool.Submit([&pool, depth, &done] { Spawn(pool, depth - 1, done); });
+    }
+}
+
+template <typename Pool>
+void Run(const char* name, const Settings& s)
+{
+    std::printf("\n%s (%u workers)\n", name, s.workers);
+    Pool pool(s.workers);
+    std::atomic<uint64_t> done{0};
+
+    // Submit, one call per task, with the captures of a thumbnail decode
+    {
+        Owner owner{done};
+        LatencyRecorder lat;
+        uint64_t allocs0 = g_allocs.load();
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < s.tasks; ++i) {
+            auto c0 = Clock::now();
+            pool.Submit([o = &owner, id = static_cast<uint32_t>(i), size = 256u, gen = uint64_t{1}] {
+                o->Decode(id, size, gen);
+            });
+            lat.Add(ElapsedUs(c0));
+        }
+        pool.WaitIdle();
+        double us = ElapsedUs(t0);
+        uint64_t allocs = g_allocs.load() - allocs0;
+        std::printf("  Submit         %10.0f tasks/s  %10.0f allocs/s  %.2f allocs/task\n",
+                    s.tasks / us * 1e6, allocs / us * 1e6, static_cast<double>(allocs) / s.tasks);
+        lat.Print("Submit call");
+    }
+
+    // Submit with a captured path (full-image prefetch)
+    {
+        Owner owner{done};
+        std::vector<std::filesystem::path> paths;
+        for (size_t i = 0; i < 1024; ++i) {
+            paths.emplace_back("Photos/2024/Holiday/IMG_" + std::to_string(10000 + i) + ".jpg");
+        }
+        uint64_t allocs0 = g_allocs.load();
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < s.tasks; ++i) {
+            pool.Submit([o = &owner, path = paths[i % paths.size()]] { o->Prefetch(path); });
+        }
+        pool.WaitIdle();
+        double us = ElapsedUs(t0);
+        uint64_t allocs = g_allocs.load() - allocs0;
+        std::printf("  Submit (path)  %10.0f tasks/s  %10.0f allocs/s  %.2f allocs/task\n",
+                    s.tasks / us * 1e6, allocs / us * 1e6, static_cast<double>(allocs) / s.tasks);
+    }
+
+    // SubmitBatch
+    {
+        done = 0;
+        auto t0 = Clock::now();
+        TaskBatch<Pool> fns;
+        for (size_t i = 0; i < s.tasks; i += s.batch) {
+            fns.clear();
+            for (size_t j = i; j < std::min(s.tasks, i + s.batch); ++j) {
+                fns.emplace_back([&done] { Work(); done.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.SubmitBatch(fns, Core::TaskPriority::Normal);
+        }
+        pool.WaitIdle();
+        double us = ElapsedUs(t0);
+        std::printf("  SubmitBatch    %10.0f tasks/s  (batches of %zu)\n", done.load() / us * 1e6, s.batch);
+    }
+
+    // Fan-out from inside the pool
+    {
+        done = 0;
+        auto t0 = Clock::now();
+        pool.Submit([&pool, &done, depth = s.depth] { Spawn(pool, depth, done); });
+        pool.WaitIdle();
+        double us = ElapsedUs(t0);
+        std::printf("  Fan-out        %10.0f tasks/s  (%llu tasks, depth %d)\n",
+                    done.load() / us * 1e6, static_cast<unsigned long long>(done.load()), s.depth);
+    }
+
+    // Wake-up latency: let the workers park, then submit one task
+    {
+        LatencyRecorder lat;
+        std::mutex m;
+        for (size_t i = 0; i < s.wakeups; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            auto t0 = Clock::now();
+            pool.Submit([&lat, &m, t0] {
+                double us = ElapsedUs(t0);
+                std::lock_guard lock(m);
+                lat.Add(us);
+            });
+            pool.WaitIdle();
+        }
+        lat.Print("Wake-up (parked pool)");
+    }
+
+    // High task behind a full Low lane
+    {
+        LatencyRecorder lat;
+        for (int round = 0; round < 50; ++round) {
+            TaskBatch<Pool> fns;
+            for (int i = 0; i < 2000; ++i) fns.emplace_back([] { SpinFor(5.0); });
+            pool.SubmitBatch(fns, Core::TaskPriority::Low);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            auto t0 = Clock::now();
+            pool.SubmitFront([&lat, t0] { lat.Add(ElapsedUs(t0)); });
+            pool.WaitIdle();
+        }
+        lat.Print("SubmitFront behind 2000 Low");
+    }
+
+    // Idle cost
+    {
+        double cpu0 = ProcessCpuMs();
+        std::this_thread::sleep_for(std::chrono::milliseconds(s.idleMs));
+        double cpu = ProcessCpuMs() - cpu0;
+        std::printf("  Idle           %8.2f ms CPU over %d ms\n", cpu, s.idleMs);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    Settings s;
+    s.tasks = static_cast<size_t>(args.Get("tasks", 200000));
+    g_workNs = args.GetDouble("work-ns", 0.0);
+    s.batch = static_cast<size_t>(std::max<int64_t>(1, args.Get("batch", 64)));
+    s.depth = static_cast<int>(args.Get("depth", 16));
+    s.wakeups = static_cast<size_t>(args.Get("wakeups", 2000));
+    s.idleMs = static_cast<int>(args.Get("idle-ms", 500));
+    s.workers = static_cast<uint32_t>(args.Get("workers", 0));
+    if (s.workers == 0) {
+        uint32_t hw = std::thread::hardware_concurrency();
+        s.workers = (hw > 2) ? hw - 1 : 2;
+    }
+
+    std::printf("ThreadPool: %zu tasks of %.0f ns\n", s.tasks, g_workNs);
+    Run<MutexPool>("Previous pool (single mutex, three lanes)", s);
+    Run<Core::ThreadPool>("Work-stealing pool", s);
+    return 0;
+}
@@ -0,0 +1,202 @@
+// Persistent thumbnail cache codecs (PixelCodec): a store of `--entries`
+// photo-like thumbnails written once per codec, then `--reads` random
+// lookups done the way ThumbnailDecodeTask does them (Find, WillNeed,
+// allocate, DecodePixels), first with the file dropped from the page cache
+// and then warm. Reports file size and ratio, encode/decode cost per thumbnail, and
+// per pass thumbnails/s, page faults (major + minor) and storage KB read
+// per thumbnail. The store is reopened for each pass, as on an app restart.
+//
+// Thumbnails are MakeSyntheticPhoto images (`--noise`: sensor-like grain,
+// +/- levels). `--unique` distinct images are repeated across
+// the entries; each entry is still a separate payload. Cold passes and
+// fault/IO counters are Linux only.
+//
+//   thumb_codec_bench [--entries 100000] [--thumb 160] [--reads 5000] [--unique 64]
+//                     [--noise 3] [--keep 0]
+
+#include "BenchCommon.hpp"
+#include "core/PixelCodec.hpp"
+#include "core/ThumbnailStore.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+using namespace UltraImageViewer::Core;
+
+namespace {
+
+void DropFromPageCache(const std::filesystem::path& file)
+{
+#if defined(__linux__)
+    ::sync();
+    int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    (void)file;
+#endif
+}
+
+struct Counters {
+    long long majorFaults = -1;
+    long long minorFaults = -1;
+    long long readBytes = -1;
+};
+
+Counters ReadCounters()
+{
+    Counters c;
+#if defined(__linux__)
+    rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+        c.majorFaults = usage.ru_majflt;
+        c.minorFaults = usage.ru_minflt;
+    }
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    long long value;
+    while (io >> key >> value) {
+        if (key == "read_bytes:") c.readBytes = value;
+    }
+#endif
+    return c;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t entries = static_cast<size_t>(std::max<long long>(1, args.Get("entries", 100000)));
+    const uint16_t thumb = static_cast<uint16_t>(args.Get("thumb", 160));
+    const size_t reads = std::min(entries, static_cast<size_t>(args.Get("reads", 5000)));
+    const size_t unique = static_cast<size_t>(std::max<long long>(1, args.Get("unique", 64)));
+    const int noise = static_cast<int>(args.Get("noise", 3));
+    const bool keep = args.Get("keep", 0) != 0;
+
+    // Landscape and portrait, as ThumbnailScaler::FitWithin produces
+    std::vector<SyntheticPhoto> photos;
+    for (size_t i = 0; i < unique; ++i) {
+        bool landscape = (i % 3) != 0;
+        uint16_t shortSide = static_cast<uint16_t>(thumb * 3 / 4);
+        photos.push_back(MakeSyntheticPhoto(static_cast<uint32_t>(i * 7919 + 1), landscape ? thumb : shortSide,
+                                   landscape ? shortSide : thumb, noise));
+    }
+
+    std::vector<std::filesystem::path> paths;
+    paths.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) {
+        paths.emplace_back("/home/user/Pictures/" + std::to_string(2010 + i % 15) + "/IMG_" +
+                           std::to_string(100000 + i) + ".JPG");
+    }
+
+    // The same random lookups for every codec
+    std::vector<size_t> order(entries);
+    for (size_t i = 0; i < entries; ++i) order[i] = i;
+    std::mt19937 rng(42);
+    std::shuffle(order.begin(), order.end(), rng);
+    order.resize(reads);
+
+    auto dir = std::filesystem::temp_directory_path() / "uiv_thumb_codec_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    std::printf("thumb_codec_bench: %zu entries (%zu unique %u px photos, noise +/-%d), %zu random reads\n\n",
+                entries, unique, thumb, noise, reads);
+    std::printf("  %-11s %9s %6s %8s %8s | %-28s | %-28s\n", "", "", "", "encode", "decode",
+                "cold page cache", "warm page cache");
+    std::printf("  %-11s %9s %6s %8s %8s | %9s %9s %8s | %9s %9s %8s\n", "codec", "file MB", "ratio",
+                "us/thumb", "us/thumb", "thumbs/s", "faults/th", "KB/th", "thumbs/s", "faults/th", "KB/th");
+
+    for (PixelCodec codec : {PixelCodec::Raw, PixelCodec::Qoi, PixelCodec::PlaneDelta}) {
+        // Encode the unique photos once, verify the round trip, time both ways
+        std::vector<std::vector<uint8_t>> encoded(unique);
+        std::vector<PixelCodec> used(unique, codec);
+        double encodeUs = 0.0, decodeUs = 0.0;
+        for (size_t i = 0; i < unique; ++i) {
+            const SyntheticPhoto& img = photos[i];
+            auto start = Clock::now();
+            if (!EncodePixels(codec, img.bgra.data(), img.width, img.height, encoded[i])) {
+                encoded[i] = img.bgra;
+                used[i] = PixelCodec::Raw;
+            }
+            encodeUs += ElapsedUs(start);
+
+            std::vector<uint8_t> check(img.bgra.size());
+            start = Clock::now();
+            bool ok = DecodePixels(used[i], encoded[i].data(), encoded[i].size(), img.width, img.height,
+                                   check.data());
+            decodeUs += ElapsedUs(start);
+            if (!ok || check != img.bgra) {
+                std::printf("%s round trip failed on photo %zu\n", PixelCodecName(codec), i);
+                return 1;
+            }
+        }
+
+        std::vector<ThumbnailStore::NewEntry> batch(entries);
+        size_t rawBytes = 0;
+        for (size_t i = 0; i < entries; ++i) {
+            size_t p = i % unique;
+            batch[i] = {&paths[i], encoded[p].data(), encoded[p].size(), photos[p].width, photos[p].height, used[p]};
+            rawBytes += photos[p].bgra.size();
+        }
+        auto file = dir / (std::string("scan_thumbs_") + PixelCodecName(codec) + ".bin");
+        if (!ThumbnailStore().WriteCompacted(file, batch)) {
+            std::printf("failed to write %s\n", file.string().c_str());
+            return 1;
+        }
+        const double fileMb = std::filesystem::file_size(file) / 1e6;
+
+        std::printf("  %-11s %9.1f %5.2fx %8.1f %8.1f |", PixelCodecName(codec), fileMb,
+                    rawBytes / 1e6 / fileMb, encodeUs / unique, decodeUs / unique);
+
+        for (bool cold : {true, false}) {
+            if (cold) DropFromPageCache(file);
+            ThumbnailStore store;
+            Counters before = ReadCounters();
+            auto start = Clock::now();
+            if (!store.Open(file)) {
+                std::printf(" open failed\n");
+                return 1;
+            }
+            size_t found = 0;
+            for (size_t i : order) {
+                ThumbnailStore::View view;
+                if (!store.Find(paths[i], view)) continue;
+                store.WillNeed(view);
+                auto pixels = std::make_unique<uint8_t[]>(static_cast<size_t>(view.width) * view.height * 4);
+                if (DecodePixels(view.codec, view.data, view.bytes, view.width, view.height, pixels.get())) ++found;
+            }
+            double seconds = ElapsedUs(start) / 1e6;
+            Counters after = ReadCounters();
+            if (found != reads) {
+                std::printf(" %zu of %zu lookups failed\n", reads - found, reads);
+                return 1;
+            }
+            double faults = after.majorFaults >= 0
+                ? static_cast<double>(after.majorFaults - before.majorFaults + after.minorFaults - before.minorFaults) / reads
+                : -1.0;
+            double readKb = after.readBytes >= 0 ? (after.readBytes - before.readBytes) / 1024.0 / reads : -1.0;
+            std::printf(" %9.0f %9.2f %8.1f |", reads / seconds, faults, readKb);
+        }
+        std::printf("\n");
+        if (!keep) std::filesystem::remove(file);
+    }
+#if !defined(__linux__)
+    std::printf("  (page cache not dropped and counters unavailable on this platform)\n");
+#endif
+
+    if (!keep) std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Tier 2 RAM cache compressors (PixelCompressor): compress and decompress
+// cost per thumbnail, compression ratio, and how many thumbnails fit the
+// default 256 MB Tier 2 reserve, for every backend in this build with and without
+// the per-channel delta pre-filter. Every round trip is checked bit-exact.
+//
+// Thumbnails are MakeSyntheticPhoto images (`--noise`: grain, +/- levels);
+// each is compressed `--rounds` times and the mean is reported.
+//
+//   tier2_compress_bench [--unique 64] [--thumb 160] [--noise 3] [--rounds 20]
+
+#include "BenchCommon.hpp"
+#include "core/PixelCompressor.hpp"
+
+#include <memory>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+using namespace UltraImageViewer::Core;
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t unique = static_cast<size_t>(std::max<long long>(1, args.Get("unique", 64)));
+    const uint16_t thumb = static_cast<uint16_t>(args.Get("thumb", 160));
+    const int noise = static_cast<int>(args.Get("noise", 3));
+    const int rounds = static_cast<int>(std::max<long long>(1, args.Get("rounds", 20)));
+    const double budgetBytes = 256.0 * 1024 * 1024;  // ThumbnailPipeline::Config::tier2ReserveBytes
+
+    std::vector<SyntheticPhoto> photos;
+    size_t rawBytes = 0;
+    for (size_t i = 0; i < unique; ++i) {
+        bool landscape = (i % 3) != 0;
+        uint16_t shortSide = static_cast<uint16_t>(thumb * 3 / 4);
+        photos.push_back(MakeSyntheticPhoto(static_cast<uint32_t>(i * 7919 + 1), landscape ? thumb : shortSide,
+                                            landscape ? shortSide : thumb, noise));
+        rawBytes += photos.back().bgra.size();
+    }
+
+    std::printf("tier2_compress_bench: %zu photo-like %u px thumbnails (noise +/-%d), %d rounds; default: %s\n\n",
+                unique, thumb, noise, rounds, PixelCompressorName(DefaultPixelCompressorKind()));
+    std::printf("  %-12s %-6s %12s %12s %7s %14s\n", "backend", "delta", "compress us", "decompress us",
+                "ratio", "in 256 MB");
+    std::printf("  %-12s %-6s %12s %12s %7s %14.0f\n", "(raw)", "", "", "", "1.00",
+                budgetBytes / (static_cast<double>(rawBytes) / unique));
+
+    for (PixelCompressorKind kind : {PixelCompressorKind::Lz4, PixelCompressorKind::Zstd,
+                                     PixelCompressorKind::Xpress, PixelCompressorKind::PlaneDelta}) {
+        if (!IsPixelCompressorAvailable(kind)) {
+            std::printf("  %-12s (not in this build)\n", PixelCompressorName(kind));
+            continue;
+        }
+        const bool filterApplies = kind != PixelCompressorKind::PlaneDelta;
+        for (bool delta : {false, true}) {
+            if (!filterApplies && delta) continue;
+            auto compressor = CreatePixelCompressor(kind, delta);
+
+            std::vector<std::unique_ptr<uint8_t[]>> packed(unique);
+            std::vector<size_t> sizes(unique, 0);
+            std::vector<uint8_t> check;
+            double compressUs = 0.0, decompressUs = 0.0;
+            size_t packedBytes = 0, stored = 0;
+            for (int r = 0; r < rounds; ++r) {
+                for (size_t i = 0; i < unique; ++i) {
+                    const SyntheticPhoto& img = photos[i];
+                    auto start = Clock::now();
+                    bool ok = compressor->Compress(img.bgra.data(), img.width, img.height, packed[i], sizes[i]);
+                    compressUs += ElapsedUs(start);
+                    if (!ok) {
+                        sizes[i] = 0;
+                        continue;
+                    }
+
+                    check.assign(img.bgra.size(), 0);
+                    start = Clock::now();
+                    ok = compressor->Decompress(packed[i].get(), sizes[i], img.width, img.height, check.data());
+                    decompressUs += ElapsedUs(start);
+                    if (!ok || check != img.bgra) {
+                        std::printf("%s round trip failed on photo %zu\n", compressor->Name(), i);
+                        return 1;
+                    }
+                    if (r == 0) {
+                        packedBytes += sizes[i];
+                        ++stored;
+                    }
+                }
+            }
+            // Thumbnails a backend can't shrink are not demoted at all
+            const double ratio = stored ? static_cast<double>(rawBytes) * stored / unique / packedBytes : 0.0;
+            const double calls = static_cast<double>(rounds) * unique;
+            std::printf("  %-12s %-6s %12.1f %12.1f %6.2fx %14.0f", compressor->Name(),
+                        filterApplies ? (delta ? "on" : "off") : "-", compressUs / calls,
+                        stored ? decompressUs / (static_cast<double>(rounds) * stored) : 0.0, ratio,
+                        stored ? budgetBytes / (static_cast<double>(packedBytes) / stored) : 0.0);
+            if (stored < unique) std::printf("   (%zu of %zu not compressible)", unique - stored, unique);
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,347 @@
+// watch_bench: live library updates under a file storm, from each file
+// operation to its change being applied to a gallery-sized library model.
+//
+// A LibraryWatcher (inotify on Linux, ReadDirectoryChangesW on Windows)
+// watches a generated tree of --dirs directories. Every round then, spread
+// over the directories: creates --burst photos (sparse, over the 100 KB
+// minimum) and as many sidecar files the filters drop, renames a quarter
+// of the photos, and deletes them all; one round also moves a directory of
+// photos into the tree and out again. After each step the bench takes the
+// batches as they come and applies them the way GalleryView does (one merge
+// pass over --library images in date order, plus the changes), until every
+// operation has shown up.
+//
+// Latency is from the operation returning to the batch holding it being
+// applied, so it includes the watcher's settle time (--settle ms of quiet,
+// at most --max-delay ms after a burst starts) and the rest of the burst
+// still being written. At the end the model must match a fresh scan of the
+// tree. Overflows (lost events) are counted and answered with a rescan.
+//
+//   watch_bench [--dirs 200] [--burst 5000] [--rounds 3] [--library 200000]
+//               [--settle 100] [--max-delay 1000] [--dir PATH] [--keep 0]
+
+#include "BenchCommon.hpp"
+#include "core/DirectoryScanner.hpp"
+#include "core/LibraryWatcher.hpp"
+#include "core/ThreadPool.hpp"
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace UltraImageViewer;
+using namespace UltraImageViewer::Bench;
+
+namespace {
+
+using NameString = std::filesystem::path::string_type;
+
+constexpr uint64_t kMinImageSize = 100 * 1024;
+constexpr int64_t kMonth = 2629746;  // seconds
+
+void MakeFile(const std::filesystem::path& path, uint64_t size)
+{
+    std::ofstream(path, std::ios::binary).put('\0');
+    std::filesystem::resize_file(path, size);  // sparse
+}
+
+// GalleryView's order: newest month first, then by file name
+bool DateOrder(const Core::ScanEntry& a, const Core::ScanEntry& b)
+{
+    int64_t ma = a.modifiedTime / kMonth, mb = b.modifiedTime / kMonth;
+    if (ma != mb) return ma > mb;
+    return a.path.filename() < b.path.filename();
+}
+
+// The library as the gallery holds it, changed the way
+// GalleryView::ApplyLibraryChanges changes it
+class LibraryModel {
+public:
+    void Assign(std::vector<Core::ScanEntry> entries)
+    {
+        entries_ = std::move(entries);
+        std::sort(entries_.begin(), entries_.end(), DateOrder);
+    }
+
+    void Apply(std::vector<Core::ScanEntry> added, const std::vector<std::filesystem::path>& removed)
+    {
+        std::vector<NameString> removedKeys;
+        for (const auto& path : removed) removedKeys.push_back(path.native());
+        std::sort(removedKeys.begin(), removedKeys.end());
+        auto isRemoved = [&](const NameString& path) {
+            if (removedKeys.empty()) return false;
+            std::basic_string_view<NameString::value_type> prefix = path;
+            for (;;) {
+                if (std::binary_search(removedKeys.begin(), removedKeys.end(), prefix)) return true;
+                size_t slash = prefix.find_last_of(std::filesystem::path::preferred_separator);
+                if (slash == prefix.npos || slash == 0) return false;
+                prefix = prefix.substr(0, slash);
+            }
+        };
+        std::unordered_set<NameString> addedKeys;
+        for (const auto& entry : added) addedKeys.insert(entry.path.native());
+        std::sort(added.begin(), added.end(), DateOrder);
+
+        std::vector<Core::ScanEntry> merged;
+        merged.reserve(entries_.size() + added.size());
+        auto next = added.begin();
+        for (auto& entry : entries_) {
+            if (isRemoved(entry.path.native()) || addedKeys.contains(entry.path.native())) continue;
+            while (next != added.end() && DateOrder(*next, entry)) merged.push_back(std::move(*next++));
+            merged.push_back(std::move(entry));
+        }
+        for (; next != added.end(); ++next) merged.push_back(std::move(*next));
+        entries_ = std::move(merged);
+    }
+
+    // The entries under `root`, by path
+    std::vector<NameString> Below(const std::filesystem::path& root) const
+    {
+        std::vector<NameString> paths;
+        const NameString& prefix = root.native();
+        for (const auto& entry : entries_) {
+            if (entry.path.native().compare(0, prefix.size(), prefix) == 0) paths.push_back(entry.path.native());
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    size_t Size() const { return entries_.size(); }
+
+private:
+    std::vector<Core::ScanEntry> entries_;
+};
+
+struct Stats {
+    LatencyRecorder latency;  // operation -> applied, per file (or per directory move)
+    LatencyRecorder apply;    // one batch into the model
+    size_t batches = 0;
+    size_t overflows = 0;
+    size_t timedOut = 0;
+};
+
+class Harness {
+public:
+    Harness(const std::filesystem::path& root, const Core::DirectoryScanner::Config& config,
+            const Core::LibraryWatcher::Options& options, LibraryModel& model, Stats& stats)
+        : root_(root), config_(config), model_(model), stats_(stats)
+    {
+        watcher_ = std::make_unique<Core::LibraryWatcher>(
+            std::vector<std::filesystem::path>{root}, config,
+            [this] {
+                std::lock_guard lock(mutex_);
+                cv_.notify_one();
+            },
+            options);
+    }
+
+    bool Watching() const { return watcher_->IsWatching(); }
+
+    // An operation on `path` the model should show (present or gone)
+    void Expect(const std::filesystem::path& path)
+    {
+        pending_[path.native()] = Clock::now();
+    }
+
+    // Apply batches until every expected operation has shown up
+    void Drain(std::chrono::seconds timeout = std::chrono::seconds(10))
+    {
+        auto deadline = Clock::now() + timeout;
+        while (!pending_.empty() && Clock::now() < deadline) {
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait_until(lock, deadline, [this] { return watcher_->HasChanges(); });
+            }
+            if (!watcher_->HasChanges()) continue;
+            auto changes = watcher_->TakeChanges();
+            auto start = Clock::now();
+            ++stats_.batches;
+            if (changes.rescan) {
+                ++stats_.overflows;
+                Rescan();
+            } else {
+                model_.Apply(changes.added, changes.removed);
+            }
+            auto applied = Clock::now();
+            stats_.apply.Add(ElapsedUs(start, applied));
+
+            auto settle = [&](const NameString& path) {
+                auto it = pending_.find(path);
+                if (it == pending_.end()) return;
+                stats_.latency.Add(ElapsedUs(it->second, applied));
+                pending_.erase(it);
+            };
+            if (changes.rescan) {
+                std::vector<NameString> all;
+                for (const auto& [path, _] : pending_) all.push_back(path);
+                for (const auto& path : all) settle(path);
+            }
+            for (const auto& entry : changes.added) settle(entry.path.native());
+            for (const auto& path : changes.removed) settle(path.native());
+        }
+        stats_.timedOut += pending_.size();
+        pending_.clear();
+    }
+
+    void Rescan()
+    {
+        Core::ThreadPool pool(2);
+        Core::DirectoryScanner scanner(&pool, config_);
+        std::atomic<bool> cancel{false};
+        std::atomic<size_t> count{0};
+        std::vector<std::filesystem::path> gone{root_};
+        model_.Apply(scanner.Scan({root_}, cancel, count), gone);
+    }
+
+private:
+    std::filesystem::path root_;
+    Core::DirectoryScanner::Config config_;
+    LibraryModel& model_;
+    Stats& stats_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unordered_map<NameString, Clock::time_point> pending_;
+    std::unique_ptr<Core::LibraryWatcher> watcher_;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Args args(argc, argv);
+    const size_t dirs      = static_cast<size_t>(std::max<long long>(1, args.Get("dirs", 200)));
+    const size_t burst     = static_cast<size_t>(std::max<long long>(4, args.Get("burst", 5000)));
+    const int rounds       = static_cast<int>(std::max<long long>(1, args.Get("rounds", 3)));
+    const size_t library   = static_cast<size_t>(args.Get("library", 200000));
+    const bool keep        = args.Get("keep", 0) != 0;
+    const std::filesystem::path base =
+        args.GetString("dir", (std::filesystem::temp_directory_path() / "uiv_watch_bench").string());
+    const std::filesystem::path root = base / "library";
+    const std::filesystem::path outside = base / "outside";
+
+    Core::LibraryWatcher::Options options;
+    options.settle = std::chrono::milliseconds(args.Get("settle", 100));
+    options.maxDelay = std::chrono::milliseconds(args.Get("max-delay", 1000));
+
+    std::filesystem::remove_all(base);
+    std::vector<std::filesystem::path> dirPaths;
+    for (size_t d = 0; d < dirs; ++d) {
+        dirPaths.push_back(root / std::to_string(d / 16) / std::to_string(d));
+        std::filesystem::create_directories(dirPaths.back());
+    }
+    std::filesystem::create_directories(root / "cache");  // skipped by the filters
+    std::filesystem::create_directories(outside);
+
+    Core::DirectoryScanner::Config config;
+    config.extensions = {".jpg", ".jpeg", ".png", ".heic"};
+    config.skipDirs = {"cache", "thumbnails"};
+    config.minFileSize = kMinImageSize;
+
+    // The rest of the library: photos elsewhere, only in the model
+    LibraryModel model;
+    {
+        std::vector<Core::ScanEntry> entries(library);
+        for (size_t i = 0; i < library; ++i) {
+            entries[i].path = std::filesystem::path("/elsewhere") / std::to_string(i % 500) /
+                              ("IMG_" + std::to_string(i) + ".jpg");
+            entries[i].size = 200 * 1024;
+            entries[i].modifiedTime = 1600000000 + static_cast<int64_t>(i % 60) * kMonth;
+        }
+        model.Assign(std::move(entries));
+    }
+
+    Stats stats;
+    Harness harness(root, config, options, model, stats);
+    std::printf("watch_bench: %zu directories, bursts of %zu photos + %zu sidecars, %d rounds, "
+                "%zu images in the model, settle %lld ms (max %lld ms)%s\n",
+                dirs, burst, burst, rounds, library,
+                static_cast<long long>(options.settle.count()),
+                static_cast<long long>(options.maxDelay.count()),
+                harness.Watching() ? "" : "  NOT WATCHING");
+    if (!harness.Watching()) return 1;
+
+    std::vector<LatencyRecorder> byStep(4);
+    const char* stepNames[] = {"create", "rename", "delete", "directory move"};
+    // Runs one storm step and applies batches until it has all shown up
+    auto step = [&](size_t index, auto&& body) {
+        std::swap(stats.latency, byStep[index]);
+        body();
+        harness.Drain();
+        std::swap(stats.latency, byStep[index]);
+    };
+
+    auto totalStart = Clock::now();
+    size_t serial = 0;
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<std::filesystem::path> photos;
+        step(0, [&] {
+            for (size_t i = 0; i < burst; ++i, ++serial) {
+                const auto& dir = dirPaths[serial % dirs];
+                auto photo = dir / ("IMG_" + std::to_string(serial) + ".jpg");
+                MakeFile(photo, 150 * 1024);
+                harness.Expect(photo);
+                photos.push_back(photo);
+                MakeFile(dir / ("IMG_" + std::to_string(serial) + ".xmp"), 2 * 1024);  // dropped
+            }
+        });
+        step(1, [&] {
+            for (size_t i = 0; i < photos.size(); i += 4) {
+                auto renamed = photos[i].parent_path() / ("MOVED_" + photos[i].filename().string());
+                std::filesystem::rename(photos[i], renamed);
+                harness.Expect(renamed);
+                photos[i] = renamed;
+            }
+        });
+        step(2, [&] {
+            for (const auto& photo : photos) {
+                std::filesystem::remove(photo);
+                harness.Expect(photo);
+            }
+            for (const auto& dir : dirPaths) {
+                for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+                    std::filesystem::remove(entry.path());  // the sidecars
+                }
+            }
+        });
+    }
+
+    // A directory of photos moved in, then out again
+    auto album = outside / "album";
+    std::filesystem::create_directories(album);
+    for (size_t i = 0; i < 200; ++i) MakeFile(album / ("ALBUM_" + std::to_string(i) + ".jpg"), 150 * 1024);
+    step(3, [&] {
+        std::filesystem::rename(album, root / "album");
+        harness.Expect(root / "album" / "ALBUM_0.jpg");
+    });
+    bool movedIn = model.Below(root / "album").size() == 200;
+    step(3, [&] {
+        std::filesystem::rename(root / "album", album);
+        harness.Expect(root / "album");
+    });
+    double totalSeconds = ElapsedUs(totalStart) / 1e6;
+
+    // The model against a fresh scan of the tree
+    LibraryModel scanned;
+    {
+        Core::ThreadPool pool(2);
+        Core::DirectoryScanner scanner(&pool, config);
+        std::atomic<bool> cancel{false};
+        std::atomic<size_t> count{0};
+        scanned.Assign(scanner.Scan({root}, cancel, count));
+    }
+    bool match = movedIn && model.Below(root) == scanned.Below(root) && stats.timedOut == 0;
+
+    std::printf("\n  event -> applied latency\n");
+    for (size_t i = 0; i < byStep.size(); ++i) byStep[i].Print(stepNames[i]);
+    stats.apply.Print("apply one batch");
+    std::printf("\n  %zu batches, %zu overflows, %zu operations never seen, %.1f s in all, "
+                "model %zu images%s\n",
+                stats.batches, stats.overflows, stats.timedOut, totalSeconds, model.Size(),
+                match ? "" : "  MISMATCH");
+
+    if (!keep) std::filesystem::remove_all(base);
+    return match ? 0 : 1;
+}
@@ -33,6 +33,14 @@ public:
     // Snap to target immediately
     void SnapToTarget();
 
+    // Closed-form position `seconds` from now, assuming the target and
+    // config stay as they are (Update integrates the same trajectory)
+    float PredictValue(float seconds) const;
+
+    // Seconds until the motion's envelope decays below restThreshold, i.e.
+    // when PredictValue reaches the target for good (0 if already at rest)
+    float PredictSettleTime() const;
+
 private:
     float value_ = 0.0f;
     float velocity_ = 0.0f;
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "IdTable.hpp"
+#include "PathInterner.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Learns which image the user opens next from the sequence of views.
+ *
+ * Three models are blended:
+ *   - per-image successors: exact "after A comes B" counts (jump-backs,
+ *     favourites, habitual folder entry points), top few per image;
+ *   - paging deltas: a global histogram of id steps within a folder
+ *     (ids are assigned in scan order, so +1/-1 is next/previous photo);
+ *   - folder switches: folder → folder counts, predicting the image last
+ *     viewed in the destination folder.
+ * A per-image model with little evidence defers to the global ones. Counts
+ * halve once they grow large, so habits can change. Memory is bounded by the
+ * number of distinct images viewed times a small constant.
+ *
+ * Not thread-safe: the owner serializes access.
+ */
+class AccessPredictor {
+public:
+    struct Config {
+        int deltaRange = 8;           // paging steps tracked: [-deltaRange, deltaRange]
+        float minProbability = 0.20f; // predictions below this are dropped
+    };
+
+    struct Prediction {
+        ImageId id;
+        float probability;
+    };
+
+    AccessPredictor(const PathInterner* interner, const Config& config);
+
+    // The user opened `id` (after whatever was recorded before)
+    void Record(ImageId id);
+
+    // Most likely next images after `from`, highest probability first
+    std::vector<Prediction> Predict(ImageId from, size_t maxCount) const;
+
+    void Reset();
+
+private:
+    static constexpr size_t kMaxSuccessors = 4;
+    static constexpr uint32_t kDecayThreshold = 1024;
+    static constexpr uint32_t kNoFolder = 0;
+
+    struct Edge {
+        uint32_t to = 0;
+        uint32_t count = 0;
+    };
+
+    // Bounded successor set: the weakest edge is replaced when full
+    struct Successors {
+        Edge edges[kMaxSuccessors];
+        uint32_t total = 0;
+
+        void Add(uint32_t to);
+    };
+
+    uint32_t FolderOf(ImageId id);          // 1-based, interns the parent path
+    uint32_t FolderOfKnown(ImageId id) const;  // kNoFolder if never recorded
+
+    const PathInterner* interner_;
+    Config config_;
+
+    ImageId last_ = kInvalidImageId;
+
+    std::unordered_map<ImageId, Successors> imageSuccessors_;
+    std::vector<uint32_t> deltaCounts_;  // index delta + deltaRange
+    uint32_t deltaTotal_ = 0;            // in-folder transitions, including long jumps
+
+    std::unordered_map<uint32_t, Successors> folderSuccessors_;
+    std::unordered_map<uint32_t, ImageId> folderLastSeen_;
+    uint32_t switchCount_ = 0;           // folder changes among all transitions
+    uint32_t transitionCount_ = 0;
+
+    IdTable<uint32_t> folderOf_;         // ImageId → folder (0 = not yet seen)
+    std::unordered_map<std::filesystem::path::string_type, uint32_t> folderIds_;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
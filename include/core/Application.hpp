@@ -12,6 +12,7 @@
 #include "MemoryManager.hpp"
 #include "CacheManager.hpp"
 #include "ImagePipeline.hpp"
+#include "LibraryWatcher.hpp"
 #include "../rendering/Direct2DRenderer.hpp"
 #include "../animation/AnimationEngine.hpp"
 #include "../ui/ViewManager.hpp"
@@ -158,6 +159,7 @@ private:
     std::atomic<bool> scanDirty_{false};
     mutable std::mutex scanMutex_;
     std::vector<ScannedImage> scannedResults_;
+    std::vector<ScannedImage> scanBatches_;  // found since CheckScanProgress last took them
     size_t lastGalleryUpdateCount_ = 0;
     size_t lastDisplayedScanCount_ = 0;  // Avoid redundant SetScanningState calls
 
@@ -165,6 +167,16 @@ private:
     void CheckScanProgress();
     void RestoreScanGallery();
 
+    // Live library updates between scans. The scan thread starts the watcher
+    // before it walks, so nothing changed during the walk is missed; it is
+    // handed over (scannedWatcher_, guarded by scanMutex_) with the results.
+    std::unique_ptr<LibraryWatcher> libraryWatcher_;
+    std::unique_ptr<LibraryWatcher> scannedWatcher_;
+    std::vector<std::filesystem::path> watchedFolders_;  // its roots; ScanEntry::root indexes them
+    std::vector<std::filesystem::path> scannedFolders_;  // guarded by scanMutex_, with scannedWatcher_
+    bool scanCacheDirty_ = false;                        // live changes not yet in scan_cache.bin
+    void ApplyLibraryChanges(LibraryChanges changes);
+
     // Manual open state (Ctrl+O / drag-drop replaces gallery)
     bool inManualOpen_ = false;
 
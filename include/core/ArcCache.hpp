@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Byte-budgeted Adaptive Replacement Cache (Megiddo & Modha, ARC).
+ *
+ * Resident entries live in T1 (seen once recently) or T2 (seen at least
+ * twice). Evicted keys are remembered without their values in ghost lists
+ * B1/B2; a miss that hits a ghost moves the recency/frequency split `p`
+ * toward the list that would have kept it. Sizes are weighted by bytes, so a
+ * 20 MP bitmap counts for what it costs.
+ *
+ * Pinned keys are never evicted (the budget may be exceeded while they are
+ * the only candidates). Not thread-safe: the owner serializes access.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ArcCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t ghostHits = 0;   // misses that ARC had recently evicted
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t recencyTarget = 0; // p: bytes ARC wants in T1
+    };
+
+    explicit ArcCache(size_t capacityBytes) : capacity_(capacityBytes) {}
+
+    ArcCache(const ArcCache&) = delete;
+    ArcCache& operator=(const ArcCache&) = delete;
+
+    // Resident value or nullptr. A hit promotes the entry to T2's MRU end.
+    Value* Get(const Key& key)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end() || !IsResident(it->second.list)) {
+            ++misses_;
+            return nullptr;
+        }
+        ++hits_;
+        Move(it->second, kT2);
+        return &it->second.node->value;
+    }
+
+    // Resident lookup without touching recency or counters
+    bool Contains(const Key& key) const
+    {
+        auto it = index_.find(key);
+        return it != index_.end() && IsResident(it->second.list);
+    }
+
+    // Insert or replace, then evict down to the budget
+    void Put(const Key& key, Value value, size_t bytes)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            auto& list = lists_[kT1];
+            list.push_front(Node{key, std::move(value), bytes});
+            bytes_[kT1] += bytes;
+            it = index_.emplace(key, Loc{kT1, list.begin()}).first;
+        } else {
+            Loc& loc = it->second;
+            bool inB2 = loc.list == kB2;
+            if (loc.list == kB1 || inB2) {
+                // Ghost hit: adapt p toward the list that would have kept it
+                ++ghostHits_;
+                size_t b1 = std::max<size_t>(bytes_[kB1], 1);
+                size_t b2 = std::max<size_t>(bytes_[kB2], 1);
+                if (inB2) {
+                    size_t delta = std::max(bytes, bytes * b1 / b2);
+                    recencyTarget_ = recencyTarget_ > delta ? recencyTarget_ - delta : 0;
+                } else {
+                    size_t delta = std::max(bytes, bytes * b2 / b1);
+                    recencyTarget_ = std::min(capacity_, recencyTarget_ + delta);
+                }
+            }
+            bytes_[loc.list] -= loc.node->bytes;
+            loc.node->value = std::move(value);
+            loc.node->bytes = bytes;
+            bytes_[loc.list] += bytes;
+            Move(loc, kT2);
+        }
+        Replace(key);
+    }
+
+    void Erase(const Key& key)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end()) return;
+        Loc& loc = it->second;
+        bytes_[loc.list] -= loc.node->bytes;
+        lists_[loc.list].erase(loc.node);
+        index_.erase(it);
+    }
+
+    void Clear()
+    {
+        for (int i = 0; i < kListCount; ++i) {
+            lists_[i].clear();
+            bytes_[i] = 0;
+        }
+        index_.clear();
+        pinned_.clear();
+        recencyTarget_ = 0;
+    }
+
+    // Replace the pinned set (e.g. the viewer's current page and neighbours)
+    void SetPinned(std::vector<Key> keys) { pinned_ = std::move(keys); }
+
+    Stats GetStats() const
+    {
+        Stats s;
+        s.hits = hits_;
+        s.misses = misses_;
+        s.evictions = evictions_;
+        s.ghostHits = ghostHits_;
+        s.entries = lists_[kT1].size() + lists_[kT2].size();
+        s.bytes = bytes_[kT1] + bytes_[kT2];
+        s.recencyTarget = recencyTarget_;
+        return s;
+    }
+
+private:
+    enum ListId : uint8_t { kT1, kT2, kB1, kB2, kListCount };
+
+    struct Node {
+        Key key;
+        Value value;  // empty (moved-from/reset) while in a ghost list
+        size_t bytes;
+    };
+    using NodeIt = typename std::list<Node>::iterator;
+
+    struct Loc {
+        ListId list;
+        NodeIt node;
+    };
+
+    static bool IsResident(ListId list) { return list == kT1 || list == kT2; }
+
+    bool IsPinned(const Key& key) const
+    {
+        return std::find(pinned_.begin(), pinned_.end(), key) != pinned_.end();
+    }
+
+    // Splice to the MRU end of `to` (iterators stay valid)
+    void Move(Loc& loc, ListId to)
+    {
+        size_t bytes = loc.node->bytes;
+        bytes_[loc.list] -= bytes;
+        lists_[to].splice(lists_[to].begin(), lists_[loc.list], loc.node);
+        bytes_[to] += bytes;
+        loc.list = to;
+    }
+
+    // LRU-most unpinned entry of a resident list, skipping `keep`
+    NodeIt Victim(ListId list, const Key& keep)
+    {
+        auto& l = lists_[list];
+        for (auto it = l.end(); it != l.begin();) {
+            --it;
+            if (!(it->key == keep) && !IsPinned(it->key)) return it;
+        }
+        return l.end();
+    }
+
+    // ARC REPLACE: evict from T1 while it is over p, else from T2. Evicted
+    // entries drop their value and become ghosts. `justPut` is never evicted.
+    void Replace(const Key& justPut)
+    {
+        while (bytes_[kT1] + bytes_[kT2] > capacity_) {
+            ListId from = bytes_[kT1] > recencyTarget_ ? kT1 : kT2;
+            NodeIt victim = Victim(from, justPut);
+            if (victim == lists_[from].end()) {
+                from = from == kT1 ? kT2 : kT1;
+                victim = Victim(from, justPut);
+                if (victim == lists_[from].end()) break;  // everything left is pinned
+            }
+            Loc& loc = index_.find(victim->key)->second;
+            victim->value = Value{};
+            Move(loc, from == kT1 ? kB1 : kB2);
+            ++evictions_;
+        }
+
+        // Bound the ghost directories: |T1|+|B1| <= c and total <= 2c
+        while (bytes_[kT1] + bytes_[kB1] > capacity_ && !lists_[kB1].empty()) {
+            DropGhost(kB1);
+        }
+        size_t total = bytes_[kT1] + bytes_[kT2] + bytes_[kB1] + bytes_[kB2];
+        while (total > 2 * capacity_ && !lists_[kB2].empty()) {
+            total -= lists_[kB2].back().bytes;
+            DropGhost(kB2);
+        }
+    }
+
+    void DropGhost(ListId list)
+    {
+        Node& last = lists_[list].back();
+        bytes_[list] -= last.bytes;
+        index_.erase(last.key);
+        lists_[list].pop_back();
+    }
+
+    size_t capacity_;
+    size_t recencyTarget_ = 0;
+    std::list<Node> lists_[kListCount];
+    size_t bytes_[kListCount] = {};
+    std::unordered_map<Key, Loc, Hash> index_;
+    std::vector<Key> pinned_;
+
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t ghostHits_ = 0;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
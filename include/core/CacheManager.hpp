@@ -8,11 +8,12 @@
 #include <atomic>
 #include <chrono>
 #include <vector>
-#include <queue>
-#include <thread>
-#include <condition_variable>
+#include <unordered_set>
+#include <functional>
 #include <mutex>
 #include "ImageDecoder.hpp"
+#include "AccessPredictor.hpp"
+#include "ThreadPool.hpp"
 
 namespace UltraImageViewer {
 namespace Core {
@@ -20,6 +21,11 @@ namespace Core {
 /**
  * LRU Cache with predictive pre-fetching
  * Thread-safe implementation with read-write locks
+ *
+ * RecordAccess feeds an AccessPredictor; likely next images are decoded on
+ * the thread pool's Low lane into the LRU. Prefetched entries not yet used
+ * are capped at a fraction of the cache, and their fate (used vs evicted
+ * unused) is reported in CacheStats.
  */
 class CacheManager {
 public:
@@ -39,12 +45,18 @@ public:
         size_t hitCount = 0;
         size_t missCount = 0;
         size_t evictionCount = 0;
-        size_t prefetchCount = 0;
+        size_t prefetchCount = 0;        // prefetched entries inserted
+        size_t predictionHitCount = 0;   // prefetched entries later requested
+        size_t wastedPrefetchBytes = 0;  // prefetched bytes evicted unused
         size_t currentSizeBytes = 0;
         size_t maxSizeBytes = 0;
         double hitRate = 0.0;
+        double predictionHitRate = 0.0;  // predictionHitCount / prefetchCount
     };
 
+    // Decodes a full image for prefetch; called on pool workers
+    using PrefetchLoader = std::function<std::shared_ptr<DecodedImage>(const std::filesystem::path&)>;
+
     explicit CacheManager(size_t maxSizeBytes = 512 * 1024 * 1024); // 512MB default
     ~CacheManager();
 
@@ -75,18 +87,36 @@ public:
     // Enable/disable pre-fetching
     void SetPrefetchEnabled(bool enabled) { prefetchEnabled_ = enabled; }
 
-    // Access pattern prediction
+    // Where prefetch decodes run. Pass nullptr before the pool goes away.
+    void SetPrefetchExecutor(ThreadPool* pool, PrefetchLoader loader);
+
+    // Access pattern prediction: the user opened `path`. Learns the
+    // transition and queues decode-ahead for the likely next images.
     void RecordAccess(const std::filesystem::path& path);
 
 private:
     // LRU eviction
     void EvictIfNeeded();
 
-    // Predict next accesses based on history
+    // Predict next accesses based on history (mutex_ held)
     std::vector<std::filesystem::path> PredictNextAccesses(
         const std::filesystem::path& currentPath
     );
 
+    // Insert with the mutex held; prefetched entries count toward the prefetch cap
+    void PutLocked(const std::filesystem::path& path, std::shared_ptr<DecodedImage> image,
+                   bool prefetched);
+
+    // Evict unused prefetched entries not in `keep`, oldest first, until the
+    // unused prefetch bytes are under `limit` (mutex_ held). False if still over.
+    bool DropStalePrefetches(size_t limit, const std::vector<std::filesystem::path>& keep);
+
+    // Account for an entry leaving the cache (mutex_ held)
+    void OnEntryRemoved(const CacheEntry& entry);
+
+    // Decode-ahead body (pool worker)
+    void RunPrefetch(const std::filesystem::path& path);
+
     // Calculate entry size
     size_t CalculateEntrySize(const DecodedImage& image);
 
@@ -108,13 +138,15 @@ private:
     std::atomic<size_t> prefetchCount_{0};
 
     // Pre-fetching
+    static constexpr size_t kMaxPredictions = 3;
     bool prefetchEnabled_ = true;
-    std::unordered_map<std::filesystem::path, size_t> accessHistory_;
-
-    // Background pre-fetch thread
-    std::jthread prefetchThread_;
-    std::condition_variable_any prefetchCV_;
-    std::queue<std::filesystem::path> prefetchQueue_;
+    AccessPredictor predictor_;
+    ThreadPool* prefetchPool_ = nullptr;
+    PrefetchLoader prefetchLoader_;
+    std::unordered_set<std::filesystem::path> prefetchInFlight_;
+    size_t prefetchUnusedBytes_ = 0;  // prefetched entries not yet requested
+    std::atomic<size_t> predictionHitCount_{0};
+    std::atomic<size_t> wastedPrefetchBytes_{0};
 };
 
 } // namespace Core
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+// A file found by DirectoryScanner, with the metadata its directory listing
+// returned
+struct ScanEntry {
+    std::filesystem::path path;
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;  // last write, seconds since the Unix epoch (UTC)
+    uint32_t root = 0;         // index of the scan root it was found under
+};
+
+/**
+ * What one DirectoryScanner walk saw, per directory, so the next walk can
+ * leave unchanged directories unread (scan_index.bin next to the scan cache).
+ *
+ * Adding, removing or renaming an entry moves the mtime of the directory it
+ * is in, so a directory whose mtime still matches its record holds the same
+ * names: its files come from the record and its subdirectories are visited
+ * without a listing. A change further down moves only the mtime of the
+ * directory it happened in, so every directory still costs one stat; what a
+ * rescan skips is the listings and the per-file stats. A file rewritten in
+ * place doesn't touch its directory and keeps its recorded size and mtime
+ * until the directory is listed again. The exception is a file recorded
+ * below Config::minFileSize: growing it doesn't touch the directory either,
+ * so it is stat'ed again on every walk (a photo still being written when
+ * its directory was listed shows up once it is complete).
+ *
+ * A record taken within kRacyWindow of its directory's mtime isn't trusted
+ * (the directory may change again within the same timestamp step), nor is
+ * an index made under a different DirectoryScanner::Config.
+ */
+class DirectoryIndex {
+public:
+    using NameString = std::filesystem::path::string_type;
+
+    struct File {
+        NameString name;
+        uint64_t size = 0;
+        int64_t modifiedTime = 0;  // as ScanEntry
+        bool rejected = false;     // below minFileSize when last stat'ed
+    };
+
+    struct Directory {
+        int64_t modifiedTime = 0;         // the directory's own, ns since the Unix epoch
+        int64_t listedAt = 0;             // when it was last listed, same clock
+        uint32_t entryCount = 0;          // entries that listing returned, any kind
+        std::vector<NameString> subdirs;  // names not skipped by the Config
+        std::vector<File> files;          // names with a Config extension
+    };
+
+    // Timestamp step allowed for (FAT keeps mtimes in 2 s steps)
+    static constexpr int64_t kRacyWindow = 2'000'000'000;
+
+    // False (index left empty) when missing, from another version or corrupt
+    bool Load(const std::filesystem::path& file);
+    bool Save(const std::filesystem::path& file) const;
+
+    void Clear();
+
+    size_t DirectoryCount() const { return directories_.size(); }
+    size_t FileCount() const;
+    // Directory entries behind the records: what a full rescan reads again
+    uint64_t EntryCount() const;
+
+    // How the walk that built this index got its directories
+    size_t ListedDirectories() const { return listed_; }
+    size_t ReusedDirectories() const { return reused_; }
+
+private:
+    friend class DirectoryScanner;
+
+    std::unordered_map<NameString, Directory> directories_;  // by comparable path
+    uint64_t configHash_ = 0;
+    size_t listed_ = 0;
+    size_t reused_ = 0;
+};
+
+/**
+ * Parallel recursive directory walk for the library scan.
+ *
+ * Every directory is one pool task: it lists its entries once, submits a
+ * task per subdirectory (from a worker that lands on the worker's own deque,
+ * so idle workers steal whole subtrees) and appends its matching files to
+ * the worker's own buffer. The buffers are merged when the walk is done.
+ *
+ * Files are filtered by extension on the raw name before anything else.
+ * Size and mtime come from the listing itself where the OS returns them
+ * (FindFirstFileExW on Windows); on Linux getdents64 yields names and types,
+ * and only matching files cost a statx, relative to the open directory.
+ *
+ * A root inside an earlier root is dropped, and an earlier root inside a
+ * later one is not walked twice, so each file is reported once without a
+ * set of seen paths. Directory symlinks are not followed.
+ *
+ * Given a DirectoryIndex, a directory unchanged since that index was taken
+ * costs a stat instead of a listing (see DirectoryIndex).
+ */
+class DirectoryScanner {
+public:
+    struct Config {
+        std::vector<std::filesystem::path> extensions;  // lowercase, with the dot
+        std::vector<std::filesystem::path> skipDirs;    // directory names not descended into
+        bool skipDotDirs = true;                        // ... nor names starting with '.'
+        uint64_t minFileSize = 0;                       // smaller files are left out
+        TaskPriority priority = TaskPriority::Low;      // lane of the directory tasks
+    };
+
+    // The files found since the previous call, in no particular order
+    // (scanning thread)
+    using SnapshotCallback = std::function<void(const std::vector<ScanEntry>&)>;
+
+    DirectoryScanner(ThreadPool* pool, const Config& config);
+
+    DirectoryScanner(const DirectoryScanner&) = delete;
+    DirectoryScanner& operator=(const DirectoryScanner&) = delete;
+
+    // Walk `roots` on the pool, blocking until done or cancelFlag is set
+    // (then returns what was found so far). outCount follows the number of
+    // files found. `snapshot`, if set, is called from this thread with the
+    // new files each time snapshotInterval more have come in, and with the
+    // last of them when the walk completes, so a complete walk hands every
+    // file to it exactly once. Not for the pool's own workers. Results are
+    // in no particular order.
+    // With `index`, directories it shows unchanged are not listed again, and
+    // a walk that completes replaces `index` with its own (a cancelled one
+    // leaves it as it was).
+    std::vector<ScanEntry> Scan(const std::vector<std::filesystem::path>& roots,
+                                std::atomic<bool>& cancelFlag,
+                                std::atomic<size_t>& outCount,
+                                SnapshotCallback snapshot = nullptr,
+                                size_t snapshotInterval = 200,
+                                DirectoryIndex* index = nullptr);
+
+    // The Config's filters, for paths found some other way (LibraryWatcher):
+    // a file name kept at `size` bytes, a directory name not descended into
+    bool AcceptsFile(const std::filesystem::path& name, uint64_t size) const;
+    bool SkipsDirectory(const std::filesystem::path& name) const;
+
+private:
+    using NameString = std::filesystem::path::string_type;
+    using NameView = std::basic_string_view<std::filesystem::path::value_type>;
+
+    struct Walk;  // one Scan's shared state (DirectoryScanner.cpp)
+
+    // Pool task: list `dir` (or take its index record), queue its
+    // subdirectories, keep its matches
+    static void ScanDirectoryTask(Walk* walk, NameString dir, uint32_t root);
+    // Submits a task for `dir` unless it is walked as a root of its own
+    static void QueueDirectory(Walk* walk, NameString dir, uint32_t root);
+
+    bool MatchesExtension(NameView name) const;
+    bool SkipDirectory(NameView name) const;
+
+    ThreadPool* pool_;
+    Config config_;
+    std::unordered_set<NameString> extensions_;
+    std::unordered_set<NameString> skipDirs_;
+    size_t maxExtension_ = 0;  // longest entry of extensions_, in characters
+    uint64_t configHash_ = 0;  // tags the DirectoryIndex records this config makes
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Epoch-based memory reclamation for lock-free readers.
+ *
+ * Readers wrap every traversal in an EpochReclaimer::Guard (two atomic stores,
+ * no RMW, no lock). Writers unlink a node first and then Retire() it; the node
+ * is deleted only after every reader that might still hold it has left its
+ * guard (global epoch advanced twice past the retire epoch).
+ *
+ * One process-wide domain is shared by all concurrent containers so each
+ * thread registers a single reader slot.
+ */
+class EpochReclaimer {
+public:
+    static EpochReclaimer& Instance();
+
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    private:
+        std::atomic<uint64_t>* slot_;
+        bool outermost_;
+    };
+
+    // Defer `deleter(ptr)` until no reader can observe ptr
+    void Retire(void* ptr, void (*deleter)(void*));
+
+    // Try to advance the epoch and free what is safe (called from Retire)
+    void Collect();
+
+    // Block until everything retired before this call has been freed. Must
+    // not be called while the calling thread holds a Guard.
+    void Synchronize();
+
+    // Free everything regardless of readers. Only valid when no reader is active
+    // (e.g. container destruction after all worker threads joined).
+    void DrainAll();
+
+    size_t PendingCount();
+
+    static constexpr size_t kMaxThreads = 256;
+
+private:
+    EpochReclaimer() = default;
+    ~EpochReclaimer();
+
+    std::atomic<uint64_t>* AcquireSlot();
+    friend struct ThreadSlotOwner;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};   // 0 = quiescent, else epoch the reader entered in
+        std::atomic<bool> inUse{false};
+    };
+    Slot slots_[kMaxThreads];
+
+    alignas(64) std::atomic<uint64_t> globalEpoch_{1};
+
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+    std::mutex retireMutex_;
+    std::vector<Retired> retired_;
+    static constexpr size_t kCollectThreshold = 64;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
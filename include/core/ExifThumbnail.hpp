@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+namespace UltraImageViewer {
+namespace Core {
+
+// A JPEG preview stored inside another image file
+struct EmbeddedPreview {
+    size_t offset = 0;   // byte offset of the preview's SOI in the file
+    size_t length = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// True for TIFF-container RAW extensions whose IFDs carry JPEG previews
+// (.dng, .cr2, .nef, .nrw, .arw, .srw, .pef, .orf, .rw2)
+bool IsTiffRawPath(const std::filesystem::path& path);
+
+// Zero-decode metadata walk: JPEG APP1 (EXIF IFD1 thumbnail) and APP2 (MPF
+// preview images), or the IFD chain and SubIFDs of a TIFF-based RAW. Only
+// headers and the candidate previews' SOF segments are read. Picks the
+// smallest baseline/progressive JPEG preview whose long side reaches
+// `targetSize` and whose aspect ratio matches the main image (letterboxed
+// 160x120 thumbnails of 3:2 photos are rejected).
+bool FindEmbeddedPreview(const uint8_t* data, size_t size, uint32_t targetSize,
+                         EmbeddedPreview& out);
+
+} // namespace Core
+} // namespace UltraImageViewer
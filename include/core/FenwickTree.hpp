@@ -0,0 +1,83 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Running totals over a sequence of non-negative counts (a Fenwick tree):
+ * O(log n) to change one count, to sum a prefix, or to find which element
+ * a running position falls in. The sequence itself has a fixed length;
+ * inserting an element means building again (O(n)).
+ */
+template <typename T>
+class FenwickTree {
+public:
+    FenwickTree() = default;
+
+    // O(n) build from the counts
+    void Assign(const std::vector<T>& values)
+    {
+        tree_.assign(values.size() + 1, T{});
+        for (size_t i = 1; i <= values.size(); ++i) {
+            tree_[i] += values[i - 1];
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= values.size()) tree_[parent] += tree_[i];
+        }
+    }
+
+    void Clear() { tree_.clear(); }
+    size_t Size() const { return tree_.empty() ? 0 : tree_.size() - 1; }
+
+    void Add(size_t index, T amount)
+    {
+        for (size_t i = index + 1; i < tree_.size(); i += i & (~i + 1)) tree_[i] += amount;
+    }
+
+    void Subtract(size_t index, T amount)
+    {
+        for (size_t i = index + 1; i < tree_.size(); i += i & (~i + 1)) tree_[i] -= amount;
+    }
+
+    // Sum of the first `count` elements
+    T Prefix(size_t count) const
+    {
+        T sum{};
+        for (size_t i = count; i > 0; i -= i & (~i + 1)) sum += tree_[i];
+        return sum;
+    }
+
+    T Total() const { return Prefix(Size()); }
+
+    // Element whose span holds running position `position` (the first i with
+    // Prefix(i + 1) > position); Size() when position is past the total
+    size_t Find(T position) const
+    {
+        return Search([position](T prefix, size_t) { return prefix <= position; });
+    }
+
+    // Largest count with pred(Prefix(count), count) true, in O(log n);
+    // pred must hold for count 0 and, once false, stay false for larger counts
+    template <typename Pred>
+    size_t Search(Pred pred) const
+    {
+        size_t index = 0;
+        T sum{};
+        for (size_t step = std::bit_floor(Size()); step > 0; step >>= 1) {
+            if (index + step < tree_.size() && pred(sum + tree_[index + step], index + step)) {
+                index += step;
+                sum += tree_[index];
+            }
+        }
+        return index;
+    }
+
+private:
+    std::vector<T> tree_;  // 1-based; tree_[i] sums the (i & -i) elements ending at i
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
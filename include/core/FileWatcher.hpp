@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+// One change reported by a FileWatcher
+struct FileChange {
+    enum class Kind : uint8_t {
+        Added,     // created, or moved in from outside the watched trees
+        Removed,   // deleted or moved out; a directory takes its subtree along
+        Modified,  // written to (on Linux: closed after writing)
+        Renamed,   // moved within the watched trees, oldPath -> path
+        Overflow,  // events under root `path` were lost: walk it again
+    };
+    Kind kind = Kind::Added;
+    bool directory = false;         // known to be a directory (Added / Renamed always tell)
+    std::filesystem::path path;
+    std::filesystem::path oldPath;  // Renamed only
+};
+
+/**
+ * Recursive change notification for a set of directory trees.
+ *
+ * Backends: ReadDirectoryChangesW on Windows (one overlapped read per root
+ * covering its whole subtree) and inotify on Linux (a watch per directory,
+ * added as directories appear; fanotify's directory-entry events need
+ * CAP_SYS_ADMIN, which a viewer doesn't have). Elsewhere Create() returns
+ * nullptr and callers keep rescanning.
+ *
+ * Changes are delivered in OS order, in batches as the OS hands them over,
+ * on the watcher's own thread; coalescing is up to the callback. A move
+ * whose two halves arrive in different batches is reported as Removed plus
+ * Added. When the OS drops events, each affected root gets an Overflow.
+ */
+class FileWatcher {
+public:
+    using Callback = std::function<void(std::vector<FileChange>& changes)>;
+    // Directory names whose subtrees need no watching. inotify leaves them
+    // out; ReadDirectoryChangesW covers whole trees, so their changes still
+    // arrive there.
+    using DirectoryFilter = std::function<bool(const std::filesystem::path& name)>;
+
+    // nullptr when the platform has no backend
+    static std::unique_ptr<FileWatcher> Create(Callback callback, DirectoryFilter skipDirectory = nullptr);
+
+    virtual ~FileWatcher() = default;
+
+    // Starts watching `root` and everything below it (any thread). False if
+    // it can't be: missing, or out of OS watch handles (the watches already
+    // placed for it stay).
+    virtual bool Watch(const std::filesystem::path& root) = 0;
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+protected:
+    FileWatcher() = default;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
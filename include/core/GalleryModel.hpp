@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "FenwickTree.hpp"
+#include "IdTable.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+struct ScannedImage {
+    std::filesystem::path path;
+    ImageId id = kInvalidImageId;        // PathInterner::Global() id, assigned at scan time
+    std::filesystem::path sourceFolder;  // Top-level scan folder this image came from
+    int year = 0;
+    int month = 0;
+};
+
+/**
+ * The photo library as the gallery shows it: month sections, newest first,
+ * each in file name order (DateOrder), plus the folders the photos are in.
+ *
+ * Built for a library that arrives in batches while a scan runs. A batch is
+ * sorted on its own and merged into the sections it touches; sections hold
+ * ImageIds only (paths come from PathInterner::Global()), so a merge moves
+ * 4-byte ids. Fenwick trees over the section sizes, and over their row
+ * counts for the grid's column count, give an image's flat index and a
+ * section's place in the grid in O(log S) as sections grow.
+ *
+ * An image is known by its id: inserting one that is already there replaces
+ * it. Images without an id are left out. Single-threaded (the UI's).
+ */
+class GalleryModel {
+public:
+    using NameString = std::filesystem::path::string_type;
+
+    struct Section {
+        int year = 0;
+        int month = 0;
+        std::vector<ImageId> ids;  // in file name order
+    };
+
+    struct Folder {
+        std::filesystem::path path;
+        std::vector<ImageId> ids;          // in no particular order
+        ImageId cover = kInvalidImageId;   // first of ids in DateOrder
+    };
+
+    // Newest month first, then by file name
+    static bool DateOrder(const ScannedImage& a, const ScannedImage& b);
+
+    // How the model keys folders: the native path, case-folded where the
+    // filesystem is case-insensitive
+    static NameString FolderKey(const std::filesystem::path& folder);
+
+    void Clear();
+    // Replaces the contents (sorting them unless already in DateOrder)
+    void Assign(std::vector<ScannedImage> images);
+    // Replaces the contents with one section in the given order (a list
+    // opened by hand); later inserts are appended to it
+    void AssignList(const std::vector<ScannedImage>& images);
+    bool IsList() const { return list_; }
+
+    // Adds a batch, replacing images already there; an image that is there
+    // with the same month and source folder is left as it is
+    void Insert(std::vector<ScannedImage> batch);
+    // Removes the images at or below each path; returns their ids
+    std::vector<ImageId> Remove(const std::vector<std::filesystem::path>& paths);
+    // Removes the images directly in `folder`; returns their ids
+    std::vector<ImageId> RemoveFolder(const std::filesystem::path& folder);
+    // Makes the contents exactly `images`, touching only what differs;
+    // returns the ids removed
+    std::vector<ImageId> Sync(const std::vector<ScannedImage>& images);
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+    bool Contains(ImageId id) const { return id < info_.size() && info_[id].present; }
+    ScannedImage Image(ImageId id) const;
+
+    size_t SectionCount() const { return sections_.size(); }
+    const Section& GetSection(size_t section) const { return sections_[section]; }
+    // Flat index of a section's first image
+    size_t SectionStart(size_t section) const { return counts_.Prefix(section); }
+    // (section, offset in it) of a flat index < Size()
+    std::pair<size_t, size_t> Locate(size_t index) const;
+
+    // Grid rows of `columns` cells above a section, every section starting
+    // a new row
+    size_t RowsBefore(size_t section, int columns) const;
+    size_t TotalRows(int columns) const { return RowsBefore(sections_.size(), columns); }
+    // Section at `offset` in a grid where a section takes `sectionSpan` plus
+    // `rowSpan` per row: the last one starting at or before it, in O(log S)
+    size_t SectionAt(double offset, double sectionSpan, double rowSpan, int columns) const;
+
+    const std::unordered_map<NameString, Folder>& Folders() const { return folders_; }
+    const Folder* FindFolder(const std::filesystem::path& folder) const;
+
+    // Everything in display order; Paths() is kept until the next change
+    std::vector<ScannedImage> Images() const;
+    const std::vector<std::filesystem::path>& Paths() const;
+
+    // Changes with every change to the contents
+    uint64_t Version() const { return version_; }
+
+private:
+    struct Info {
+        int32_t year = 0;
+        uint8_t month = 0;
+        bool present = false;
+        uint16_t source = 0;  // index into sources_
+    };
+
+    bool Before(ImageId a, ImageId b) const;  // DateOrder on ids
+    bool Unchanged(const ScannedImage& img) const;  // here with the same month and source
+    size_t FindSection(int year, int month) const;  // sections_.size() if none
+    size_t AddSection(int year, int month);         // position it was inserted at
+    uint16_t SourceIndex(const std::filesystem::path& source);
+    void RemoveIds(std::vector<ImageId>& ids);
+    void AddToFolder(const ScannedImage& img, Folder*& last);  // last: the previous image's folder
+    void RebuildTrees();
+
+    std::vector<Section> sections_;
+    std::vector<Info> info_;  // indexed by ImageId
+    std::vector<std::filesystem::path> sources_;
+    std::unordered_map<NameString, Folder> folders_;
+    size_t size_ = 0;
+    bool list_ = false;
+    uint64_t version_ = 0;
+
+    FenwickTree<size_t> counts_;           // images per section
+    mutable FenwickTree<size_t> rows_;     // rows per section at rowColumns_
+    mutable int rowColumns_ = 0;           // 0: rows_ not built
+
+    mutable std::vector<std::filesystem::path> paths_;
+    mutable uint64_t pathsVersion_ = ~uint64_t{0};
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace UltraImageViewer {
+namespace Core {
+
+// Dense image identifier assigned by PathInterner (0, 1, 2, ... in intern order)
+using ImageId = uint32_t;
+inline constexpr ImageId kInvalidImageId = 0xFFFFFFFFu;
+
+/**
+ * Grow-only flat array indexed by ImageId.
+ *
+ * Storage is a fixed directory of lazily allocated chunks, so elements never
+ * move: readers index without locks while other threads extend the table.
+ * Elements are value-initialized; concurrent access to an element is the
+ * element type's business (use atomics for shared fields).
+ */
+template <typename T, size_t ChunkBits = 12>
+class IdTable {
+public:
+    static constexpr size_t kChunkSize = size_t{1} << ChunkBits;
+    static constexpr size_t kMaxChunks = 4096;
+    static constexpr size_t kCapacity = kChunkSize * kMaxChunks;
+
+    IdTable()
+    {
+        for (auto& c : chunks_) c.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~IdTable()
+    {
+        for (auto& c : chunks_) delete[] c.load(std::memory_order_relaxed);
+    }
+
+    IdTable(const IdTable&) = delete;
+    IdTable& operator=(const IdTable&) = delete;
+
+    // Existing element or nullptr if its chunk was never touched
+    T* Find(ImageId id) const
+    {
+        if (id >= kCapacity) return nullptr;
+        T* chunk = chunks_[id >> ChunkBits].load(std::memory_order_acquire);
+        return chunk ? &chunk[id & (kChunkSize - 1)] : nullptr;
+    }
+
+    // Element for id, allocating its chunk on first use (any thread)
+    T& operator[](ImageId id)
+    {
+        if (id >= kCapacity) std::abort();
+        auto& slot = chunks_[id >> ChunkBits];
+        T* chunk = slot.load(std::memory_order_acquire);
+        if (!chunk) {
+            T* fresh = new T[kChunkSize]();
+            if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) {
+                chunk = fresh;
+            } else {
+                delete[] fresh;  // another thread won; chunk now holds its pointer
+            }
+        }
+        return chunk[id & (kChunkSize - 1)];
+    }
+
+    // Visit allocated elements with id < limit as fn(ImageId, T&)
+    template <typename Fn>
+    void ForEach(size_t limit, Fn&& fn) const
+    {
+        if (limit > kCapacity) limit = kCapacity;
+        for (size_t c = 0; c * kChunkSize < limit; ++c) {
+            T* chunk = chunks_[c].load(std::memory_order_acquire);
+            if (!chunk) continue;
+            size_t end = std::min(kChunkSize, limit - c * kChunkSize);
+            for (size_t i = 0; i < end; ++i) {
+                fn(static_cast<ImageId>(c * kChunkSize + i), chunk[i]);
+            }
+        }
+    }
+
+private:
+    std::atomic<T*> chunks_[kMaxChunks];
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -84,6 +84,13 @@ public:
     static std::vector<std::wstring> GetSupportedExtensions();
 
 private:
+    // Strip-streamed downscale of frame 0 (GenerateThumbnail's common tail)
+    std::unique_ptr<DecodedImage> ThumbnailFromDecoder(
+        IWICBitmapDecoder* decoder,
+        const std::filesystem::path& filePath,
+        uint32_t maxSize
+    );
+
     // WIC decoder implementation
     std::unique_ptr<DecodedImage> DecodeWithWIC(
         const std::filesystem::path& filePath,
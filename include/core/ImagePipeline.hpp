@@ -5,30 +5,24 @@
 #include <unordered_map>
 #include <functional>
 #include <mutex>
-#include <shared_mutex>
-#include <thread>
-#include <deque>
-#include <condition_variable>
 #include <atomic>
-#include <chrono>
 #include <wrl/client.h>
 #include <d2d1.h>
 
+#include "ArcCache.hpp"
 #include "ImageDecoder.hpp"
 #include "CacheManager.hpp"
+#include "DirectoryScanner.hpp"
+#include "GalleryModel.hpp"
 #include "ThreadPool.hpp"
+#include "ThumbnailPipeline.hpp"
+#include "JpegThumbnail.hpp"
+#include "PathInterner.hpp"
 #include "../rendering/Direct2DRenderer.hpp"
 
 namespace UltraImageViewer {
 namespace Core {
 
-struct ScannedImage {
-    std::filesystem::path path;
-    std::filesystem::path sourceFolder;  // Top-level scan folder this image came from
-    int year = 0;
-    int month = 0;
-};
-
 class ImagePipeline {
 public:
     ImagePipeline();
@@ -44,46 +38,75 @@ public:
     using BitmapCallback = std::function<void(Microsoft::WRL::ComPtr<ID2D1Bitmap>)>;
     void GetBitmapAsync(const std::filesystem::path& path, BitmapCallback callback);
 
-    // Thumbnail (fast, low-resolution) — synchronous, kept for compatibility
+    // Thumbnail (fast, low-resolution) — synchronous, kept for compatibility.
+    // Interns the path; per-frame callers should use the ImageId API below.
     Microsoft::WRL::ComPtr<ID2D1Bitmap> GetThumbnail(const std::filesystem::path& path, uint32_t maxSize = 256);
 
-    // --- Async thumbnail API (non-blocking) ---
+    // --- Async thumbnail API (non-blocking, keyed by PathInterner::Global() ids) ---
 
     // Returns cached bitmap immediately, or nullptr if not yet decoded.
     // Queues a background decode request on cache miss.
-    Microsoft::WRL::ComPtr<ID2D1Bitmap> RequestThumbnail(const std::filesystem::path& path, uint32_t targetSize);
+    Microsoft::WRL::ComPtr<ID2D1Bitmap> RequestThumbnail(ImageId id, uint32_t targetSize);
+
+    // Same, for a grid cell spanning [cellTop, cellBottom] in viewport
+    // coordinates: decodes are queued closest to the viewport first.
+    Microsoft::WRL::ComPtr<ID2D1Bitmap> RequestThumbnail(ImageId id, uint32_t targetSize,
+                                                         float cellTop, float cellBottom);
 
     // Called by render thread each frame. Creates D2D bitmaps from decoded pixel
     // buffers (up to maxCount per frame to stay within frame budget).
     // Returns the number of bitmaps created this frame.
     int FlushReadyThumbnails(int maxCount);
 
-    // Cancel pending non-visible requests and increment generation counter.
+    // Cancel pending non-visible requests.
     // Call on fast scroll to avoid wasting decode work on off-screen images.
     void InvalidateRequests();
 
-    // Tell pipeline which paths are currently visible for prioritization.
-    void SetVisibleRange(const std::vector<std::filesystem::path>& paths);
+    // Before a frame's requests: viewport height and signed scroll velocity
+    // (px/s), which bias decode order towards where the scroll is heading.
+    void SetViewport(float height, float scrollVelocity);
+
+    // Same, during a fling predicted to stop landingOffset px from here:
+    // cells around the landing point decode first, at high priority.
+    void SetViewport(float height, float scrollVelocity, float landingOffset);
+
+    // Tell pipeline which images are currently visible for prioritization.
+    void SetVisibleRange(const std::vector<ImageId>& ids);
 
     // True if any decoded thumbnails are waiting for GPU upload
     bool HasPendingThumbnails() const;
 
     // Prefetch images around current index
-    void PrefetchAround(const std::vector<std::filesystem::path>& allPaths, size_t currentIndex, size_t radius = 3);
+    void PrefetchAround(const std::vector<ImageId>& allIds, size_t currentIndex, size_t radius = 3);
 
     // Scan a directory for supported image files
     static std::vector<std::filesystem::path> ScanDirectory(const std::filesystem::path& dir);
 
-    // Scan arbitrary folders recursively for images (with date grouping)
-    // Optional flushCallback is invoked periodically with sorted intermediate results
-    // (every 200 images or after each top-level folder).
+    // Scan arbitrary folders recursively for images (with date grouping),
+    // walking subdirectories in parallel (DirectoryScanner).
+    // Every result is interned into PathInterner::Global().
+    // Optional flushCallback is invoked periodically with the images found since
+    // its previous call, sorted by date (once at least 200 more have come in);
+    // together the batches are the result.
+    // Optional index (loaded from scan_index.bin) lets the walk skip listing
+    // directories unchanged since it was taken; a completed scan updates it.
     using ScanFlushCallback = std::function<void(const std::vector<ScannedImage>&)>;
 
     static std::vector<ScannedImage> ScanFolders(
         const std::vector<std::filesystem::path>& folders,
         std::atomic<bool>& cancelFlag,
         std::atomic<size_t>& outCount,
-        ScanFlushCallback flushCallback = nullptr);
+        ScanFlushCallback flushCallback = nullptr,
+        DirectoryIndex* index = nullptr);
+
+    // The filters ScanFolders walks with (extensions, skipped directories,
+    // minimum size), for anything that finds library files another way
+    static const DirectoryScanner::Config& LibraryScanConfig();
+
+    // A file found under folders[entry.root], as ScanFolders returns it
+    // (interned, dated by its last write)
+    static ScannedImage ToScannedImage(const ScanEntry& entry,
+                                       const std::vector<std::filesystem::path>& folders);
 
     // Scan system image folders (Pictures, Desktop, Downloads) recursively
     static std::vector<ScannedImage> ScanSystemImages(
@@ -92,12 +115,27 @@ public:
 
     // Cache-only thumbnail lookup (no decode queuing). Used during fast scroll
     // to display already-loaded thumbnails without starting new work.
-    Microsoft::WRL::ComPtr<ID2D1Bitmap> GetCachedThumbnail(const std::filesystem::path& path);
+    Microsoft::WRL::ComPtr<ID2D1Bitmap> GetCachedThumbnail(ImageId id);
 
     // Check if a thumbnail is already cached
-    bool HasThumbnail(const std::filesystem::path& path) const;
+    bool HasThumbnail(ImageId id) const;
+
+    // Files removed, rewritten or renamed on disk (see ThumbnailPipeline)
+    void ForgetThumbnails(const std::vector<ImageId>& ids);
+    void MoveThumbnail(ImageId from, ImageId to);
     bool HasFullImage(const std::filesystem::path& path) const;
 
+    // Full-size images the viewer is showing (current page plus neighbours).
+    // Pinned entries are never evicted; replaces the previous pinned set.
+    void PinFullImages(const std::vector<std::filesystem::path>& paths);
+
+    // The viewer opened `path`: feeds CacheManager's access predictor, which
+    // decodes likely next pages ahead on the Low lane
+    void RecordView(const std::filesystem::path& path);
+
+    using FullImageCache = ArcCache<ImageId, Microsoft::WRL::ComPtr<ID2D1Bitmap>>;
+    FullImageCache::Stats GetFullImageCacheStats() const;
+
     // Persistent thumbnail cache (disk-backed, memory-mapped)
     void LoadPersistentThumbs(const std::filesystem::path& cachePath);
     void SavePersistentThumbs(const std::filesystem::path& cachePath);
@@ -105,39 +143,11 @@ public:
 private:
     // Decode and create D2D bitmap from a path
     Microsoft::WRL::ComPtr<ID2D1Bitmap> DecodeAndCreateBitmap(const std::filesystem::path& path);
-    Microsoft::WRL::ComPtr<ID2D1Bitmap> DecodeAndCreateThumbnail(const std::filesystem::path& path, uint32_t maxSize);
-
-    // Single-task thumbnail decode (submitted to ThreadPool)
-    void ThumbnailDecodeTask(const std::filesystem::path& path,
-                             uint32_t targetSize, uint64_t generation);
-
-    // LRU eviction for full-size image cache
-    void EvictFullImagesIfNeeded();
-
-    // LRU eviction for thumbnail cache (demotes to Tier 2 compressed cache)
-    void EvictThumbnailsIfNeeded();
-
-    // --- Tier 2: CPU-RAM compressed pixel cache ---
-    // Evicted GPU bitmaps are compressed and kept in RAM. On re-request,
-    // decompressing from RAM (~0.3ms) is much faster than re-reading from
-    // disk and decoding JPEG (~5ms).
-    struct CompressedThumbnail {
-        std::unique_ptr<uint8_t[]> data;
-        size_t compressedSize = 0;
-        uint32_t rawSize = 0;  // uncompressed BGRA size
-        uint16_t width = 0;
-        uint16_t height = 0;
-        std::chrono::steady_clock::time_point lastAccess;
-    };
-    std::unordered_map<std::filesystem::path, CompressedThumbnail> tier2Cache_;
-    size_t tier2Bytes_ = 0;  // total compressed bytes
-    static constexpr size_t kTier2MaxBytes = 256ULL * 1024 * 1024;  // 256MB compressed
-
-    // Compress/decompress helpers (Windows Compression API: XPRESS + Huffman)
-    static bool CompressPixels(const uint8_t* src, uint32_t srcSize,
-                               std::unique_ptr<uint8_t[]>& outBuf, size_t& outSize);
-    static bool DecompressPixels(const uint8_t* src, size_t srcSize,
-                                 uint8_t* dst, uint32_t dstSize);
+
+    // Adapters binding the platform-neutral thumbnail core to WIC + Direct2D
+    class WicPixelSource;
+    class D2DTextureSink;
+    static Microsoft::WRL::ComPtr<ID2D1Bitmap> ToBitmap(const TextureHandle& texture);
 
     ImageDecoder* decoder_ = nullptr;
     CacheManager* cache_ = nullptr;
@@ -147,73 +157,17 @@ private:
     std::unique_ptr<ThreadPool> threadPool_;
     std::atomic<bool> shutdownRequested_ = false;
 
-    // Bitmap caches
-    struct ThumbnailCacheEntry {
-        Microsoft::WRL::ComPtr<ID2D1Bitmap> bitmap;
-        uint32_t width = 0;
-        uint32_t height = 0;
-        std::chrono::steady_clock::time_point lastAccess;
-    };
-    std::unordered_map<std::filesystem::path, ThumbnailCacheEntry> thumbnailCache_;
-    size_t thumbnailCacheBytes_ = 0;
-
-    std::unordered_map<std::filesystem::path, Microsoft::WRL::ComPtr<ID2D1Bitmap>> fullImageCache_;
-    size_t fullImageCacheBytes_ = 0;
+    // Thumbnail tiers, ready queue and persistent cache (see ThumbnailPipeline)
+    std::unique_ptr<WicPixelSource> pixelSource_;
+    std::unique_ptr<JpegPixelSource> jpegSource_;  // JPEG fast path in front of WIC
+    std::unique_ptr<D2DTextureSink> textureSink_;
+    std::unique_ptr<ThumbnailPipeline> thumbnails_;
+
+    // Full-size bitmaps keyed by PathInterner::Global() id. ARC keeps images
+    // revisited while paging back and forth over one-pass browsing.
     static constexpr size_t kFullImageCacheMax = 256ULL * 1024 * 1024;  // ~3 x 20MP images
+    FullImageCache fullImageCache_{kFullImageCacheMax};
     mutable std::mutex cacheMutex_;
-
-    // --- Async thumbnail pipeline ---
-
-    // Decoded pixel buffer produced by worker threads (CPU-only, no D2D)
-    struct ReadyThumbnail {
-        std::filesystem::path path;
-        std::unique_ptr<uint8_t[]> pixels;
-        uint32_t width;
-        uint32_t height;
-    };
-
-    // Ready queue: decoded pixel buffers waiting for GPU upload (deque for O(1) pop_front)
-    std::deque<ReadyThumbnail> readyQueue_;
-    mutable std::mutex readyMutex_;
-
-    // Generation counter: incremented on InvalidateRequests()
-    std::atomic<uint64_t> generation_{0};
-
-    // Track which paths have pending requests to avoid duplicate queuing
-    // Protected by cacheMutex_
-    std::unordered_map<std::filesystem::path, uint64_t> pendingRequests_;
-
-    // Currently visible paths (for prioritization). Protected by cacheMutex_
-    std::unordered_map<std::filesystem::path, bool> visiblePaths_;
-
-    // --- Persistent thumbnail cache (memory-mapped file) ---
-    void ClosePersistentMapping();
-
-    struct PersistThumbInfo {
-        const uint8_t* pixelData;  // pointer into memory-mapped region
-        uint16_t width;
-        uint16_t height;
-    };
-    std::unordered_map<std::filesystem::path, PersistThumbInfo> persistIndex_;
-    void* persistFileH_ = nullptr;      // HANDLE, nullptr = not open
-    void* persistMapH_ = nullptr;       // HANDLE
-    const uint8_t* persistData_ = nullptr;
-    size_t persistSize_ = 0;
-    std::shared_mutex persistMutex_;    // readers: worker threads, writer: save
-
-    // Save buffer: raw pixels collected during FlushReadyThumbnails
-    struct ThumbSaveEntry {
-        uint16_t width;
-        uint16_t height;
-        uint32_t pixelSize;
-        std::unique_ptr<uint8_t[]> pixels;
-    };
-    std::unordered_map<std::filesystem::path, ThumbSaveEntry> thumbSaveBuffer_;
-    std::mutex thumbSaveMutex_;
-
-    // Per-frame budget for synchronous D2D bitmap creation from persistent cache
-    // (render thread only — no synchronization needed)
-    int persistSyncBudget_ = 0;
 };
 
 } // namespace Core
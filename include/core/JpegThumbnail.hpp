@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+#include "ThumbnailPipeline.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+// True when built against libjpeg(-turbo) (UIV_HAVE_LIBJPEG); otherwise the
+// decode functions below always return false.
+bool JpegThumbnailAvailable();
+
+bool IsJpegPath(const std::filesystem::path& path);
+
+// Decodes a JPEG thumbnail through libjpeg's DCT-domain scaling: the IDCT
+// runs at 1/2, 1/4 or 1/8 size (the largest reduction that still covers
+// the thumbnail), and ThumbnailScaler finishes the resize. A 24 MP camera
+// JPEG decodes at 750x500 instead of 6000x4000. `dctScaling = false`
+// decodes at full size (baseline for benchmarks). Output is opaque BGRA.
+bool DecodeJpegThumbnail(const uint8_t* data, size_t size, uint32_t targetSize,
+                         PixelBuffer& out, bool dctScaling = true);
+bool DecodeJpegThumbnail(const std::filesystem::path& path, uint32_t targetSize,
+                         PixelBuffer& out, bool dctScaling = true);
+
+// PixelSource decorator: JPEGs and TIFF-based RAWs first try their embedded
+// EXIF/MPF preview (see ExifThumbnail.hpp), then JPEGs take the scaled
+// decode; anything else (or a file libjpeg rejects, e.g. CMYK) goes to the
+// wrapped source.
+class JpegPixelSource : public PixelSource {
+public:
+    explicit JpegPixelSource(PixelSource* fallback, bool embeddedPreviews = true)
+        : fallback_(fallback), embeddedPreviews_(embeddedPreviews) {}
+
+    bool DecodeThumbnail(const std::filesystem::path& path, uint32_t targetSize,
+                         PixelBuffer& out) override;
+
+private:
+    PixelSource* fallback_;
+    bool embeddedPreviews_;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "DirectoryScanner.hpp"
+#include "FileWatcher.hpp"
+#include "ThreadPool.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+// Photo-level changes to the library since the last TakeChanges()
+struct LibraryChanges {
+    // New or rewritten photos (replace any entry with the same path); root
+    // indexes the roots LibraryWatcher was given
+    std::vector<ScanEntry> added;
+    // Photos gone, or directories gone with every photo below them
+    std::vector<std::filesystem::path> removed;
+    // Photos moved within the library, (from, to): `from` is also in
+    // removed and `to` in added, so this only carries identity (thumbnails)
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> renamed;
+    // Events were lost: only a rescan of the roots is accurate now
+    bool rescan = false;
+
+    bool Empty() const { return added.empty() && removed.empty() && !rescan; }
+};
+
+/**
+ * Live library updates: FileWatcher events under the scan roots, turned
+ * into photo-level LibraryChanges with the library scan's own filters.
+ *
+ * Events are coalesced by path until the trees have been quiet for
+ * `settle`, or for at most `maxDelay` after the first one while a burst
+ * goes on. Then each path is resolved once: a created or written file is
+ * stat'ed and kept if the DirectoryScanner Config keeps it, a directory
+ * that appeared is walked with DirectoryScanner, and a photo moved inside
+ * the trees is reported as a rename. Paths under skipped directories are
+ * ignored, and a path under several roots belongs to the first, as in a
+ * full scan.
+ *
+ * Resolving runs on the watcher's own thread; the owner polls HasChanges
+ * (or waits for `notify`, called from that thread) and takes the merged
+ * batch with TakeChanges, from any thread.
+ */
+class LibraryWatcher {
+public:
+    struct Options {
+        std::chrono::milliseconds settle{100};
+        std::chrono::milliseconds maxDelay{1000};
+        uint32_t scanThreads = 2;  // pool for walking directories that appear
+    };
+
+    LibraryWatcher(const std::vector<std::filesystem::path>& roots,
+                   const DirectoryScanner::Config& config,
+                   std::function<void()> notify = nullptr);
+    LibraryWatcher(const std::vector<std::filesystem::path>& roots,
+                   const DirectoryScanner::Config& config,
+                   std::function<void()> notify,
+                   const Options& options);
+    ~LibraryWatcher();
+
+    LibraryWatcher(const LibraryWatcher&) = delete;
+    LibraryWatcher& operator=(const LibraryWatcher&) = delete;
+
+    // False when there is no backend or a root could not be watched; the
+    // caller should not rely on live updates for it then
+    bool IsWatching() const { return watching_; }
+
+    bool HasChanges() const { return hasChanges_.load(std::memory_order_acquire); }
+    LibraryChanges TakeChanges();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void OnEvents(std::vector<FileChange>& changes);
+    void Run(std::stop_token stop);
+    // Coalesce `events` by path and look at what each path is now
+    void Resolve(std::vector<FileChange>& events, LibraryChanges& out);
+    // Fold a later batch into ready_ (mutex_ held)
+    void Merge(LibraryChanges& batch);
+
+    // First root containing `path`, or -1; also -1 when a directory on the
+    // way down is one the scan skips
+    int RootOf(const std::filesystem::path& path) const;
+
+    std::vector<std::filesystem::path> roots_;
+    std::vector<std::filesystem::path::string_type> rootKeys_;  // comparable forms of roots_
+    DirectoryScanner::Config config_;
+    Options options_;
+    std::function<void()> notify_;
+    ThreadPool pool_;
+    DirectoryScanner scanner_;
+
+    std::mutex mutex_;
+    std::condition_variable_any cv_;
+    std::vector<FileChange> events_;  // guarded by mutex_, not yet resolved
+    Clock::time_point firstEvent_;    // of events_
+    Clock::time_point lastEvent_;
+    LibraryChanges ready_;            // guarded by mutex_, resolved
+    std::atomic<bool> hasChanges_{false};
+    std::atomic<bool> cancel_{false};  // stops a directory walk on shutdown
+
+    bool watching_ = false;
+    std::jthread thread_;
+    std::unique_ptr<FileWatcher> watcher_;  // last: stops delivering before the rest goes
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "IdTable.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Maps image paths to dense ImageIds, assigned once (at scan time) and stable
+ * for the life of the process. Everything downstream — thumbnail tiers,
+ * pending/visible tracking, the gallery model — keys on the id, so per-frame
+ * work never hashes a path.
+ *
+ * Intern/Find take a mutex (scanner threads); Path() is lock-free.
+ */
+class PathInterner {
+public:
+    PathInterner() = default;
+    PathInterner(const PathInterner&) = delete;
+    PathInterner& operator=(const PathInterner&) = delete;
+
+    // Process-wide instance shared by the scanner, pipeline and UI
+    static PathInterner& Global();
+
+    // Id for path, assigning the next id if unseen. kInvalidImageId when full.
+    ImageId Intern(const std::filesystem::path& path);
+
+    // Id for path or kInvalidImageId if it was never interned
+    ImageId Find(const std::filesystem::path& path) const;
+
+    // Path for an id returned by Intern (references stay valid forever)
+    const std::filesystem::path& Path(ImageId id) const;
+
+    // Number of ids assigned so far; ids are [0, Size())
+    size_t Size() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    using Key = std::basic_string_view<std::filesystem::path::value_type>;
+
+    IdTable<std::filesystem::path> paths_;
+    std::unordered_map<Key, ImageId> index_;  // views into paths_ (never move)
+    std::atomic<size_t> count_{0};
+    mutable std::mutex mutex_;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace UltraImageViewer {
+namespace Core {
+
+// Lossless codecs for BGRA thumbnails (persistent cache payloads). Both are
+// single-pass, table-free and decode at several hundred MB/s per core, so a
+// worker decompresses a 160 px thumbnail in well under the time a disk read
+// of its raw pixels would take.
+enum class PixelCodec : uint8_t {
+    Raw = 0,         // pixels as is: uploadable straight from the mapping
+    Qoi = 1,         // QOI ops: runs, 64-entry color index, small deltas
+    PlaneDelta = 2,  // per-channel MED prediction, residuals bit-packed in blocks of 16
+};
+
+const char* PixelCodecName(PixelCodec codec);
+
+// Case-sensitive match against PixelCodecName
+bool ParsePixelCodec(const char* name, PixelCodec& out);
+
+// Encodes width x height BGRA into `out` (replacing its contents). False for
+// Raw, or when the result would not be smaller than the raw pixels; the
+// caller stores those raw.
+bool EncodePixels(PixelCodec codec, const uint8_t* bgra, uint32_t width, uint32_t height,
+                  std::vector<uint8_t>& out);
+
+// Decodes into `bgra` (width * height * 4 bytes). False if `src` is
+// truncated or malformed; never reads past src + size.
+bool DecodePixels(PixelCodec codec, const uint8_t* src, size_t size, uint32_t width, uint32_t height,
+                  uint8_t* bgra);
+
+} // namespace Core
+} // namespace UltraImageViewer
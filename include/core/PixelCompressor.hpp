@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Lossless compressor for the Tier 2 RAM cache of BGRA thumbnails.
+ *
+ * Compress runs on the render thread during demotion and Decompress on
+ * decode workers, so implementations must be callable from any thread.
+ * Backend contexts (and scratch buffers) are created once per thread and
+ * reused rather than per call.
+ */
+class PixelCompressor {
+public:
+    virtual ~PixelCompressor() = default;
+
+    virtual const char* Name() const = 0;
+
+    // Compresses width x height BGRA into an exactly sized buffer. False when
+    // the backend fails or the result would not be smaller than the input.
+    virtual bool Compress(const uint8_t* bgra, uint32_t width, uint32_t height,
+                          std::unique_ptr<uint8_t[]>& out, size_t& outSize) = 0;
+
+    // Restores width * height * 4 bytes into `bgra`. False on corrupt input.
+    virtual bool Decompress(const uint8_t* src, size_t size, uint32_t width, uint32_t height,
+                            uint8_t* bgra) = 0;
+};
+
+enum class PixelCompressorKind : uint8_t {
+    Lz4,         // LZ4 block, acceleration 1 (UIV_HAVE_LZ4)
+    Zstd,        // zstd level 1 (UIV_HAVE_ZSTD)
+    Xpress,      // Windows Compression API, XPRESS + Huffman
+    PlaneDelta,  // PixelCodec::PlaneDelta, always available
+};
+
+const char* PixelCompressorName(PixelCompressorKind kind);
+
+// Whether this build (and platform) has the backend
+bool IsPixelCompressorAvailable(PixelCompressorKind kind);
+
+// zstd when built in (best ratio for its speed with the delta filter),
+// then LZ4, then PlaneDelta
+PixelCompressorKind DefaultPixelCompressorKind();
+
+// nullptr if the backend is unavailable. `deltaFilter` splits the pixels
+// into channel planes of differences from the pixel to the left before the
+// general-purpose backends (LZ4, zstd, XPRESS) see them; PlaneDelta
+// predicts on its own and ignores it.
+std::unique_ptr<PixelCompressor> CreatePixelCompressor(PixelCompressorKind kind, bool deltaFilter = true);
+
+} // namespace Core
+} // namespace UltraImageViewer
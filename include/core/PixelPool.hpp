@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+// Shared ownership of one thumbnail's BGRA pixels. Every holder (Tier 1
+// entry, save buffer, queued demotion) keeps the same buffer alive; the last
+// one to let go returns it to its PixelPool.
+using PixelHandle = std::shared_ptr<uint8_t[]>;
+
+/**
+ * Recycling allocator for thumbnail pixel buffers.
+ *
+ * Thumbnails come in a handful of sizes, so released buffers are kept on a
+ * free list per exact byte size (up to kMaxFreeBytes in total) and handed
+ * out again instead of going back to the heap. LiveBytes() is the CPU pixel
+ * memory currently held, counted once per buffer however many handles share
+ * it; the pipeline charges it to its memory budget.
+ *
+ * Thread-safe. Handles keep the pool alive, so they may outlive its owner.
+ */
+class PixelPool : public std::enable_shared_from_this<PixelPool> {
+public:
+    static std::shared_ptr<PixelPool> Create();
+    ~PixelPool();
+
+    PixelPool(const PixelPool&) = delete;
+    PixelPool& operator=(const PixelPool&) = delete;
+
+    // Uninitialized buffer of `bytes`, recycled when one is free
+    PixelHandle Acquire(size_t bytes);
+
+    // Take over a buffer allocated elsewhere (a PixelSource decode); it is
+    // recycled like any other once released
+    PixelHandle Adopt(std::unique_ptr<uint8_t[]> pixels, size_t bytes);
+
+    size_t LiveBytes() const { return liveBytes_.load(std::memory_order_relaxed); }
+    size_t FreeBytes() const;
+
+private:
+    PixelPool() = default;
+
+    PixelHandle Wrap(uint8_t* pixels, size_t bytes);
+    void Release(uint8_t* pixels, size_t bytes);
+
+    static constexpr size_t kMaxFreeBytes = 32ULL * 1024 * 1024;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<size_t, std::vector<uint8_t*>> free_;  // by exact size
+    size_t freeBytes_ = 0;
+    std::atomic<size_t> liveBytes_{0};
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+namespace UltraImageViewer {
+namespace Core {
+namespace Platform {
+
+// Thin OS shims for the portable core (ThumbnailPipeline, ThreadPool).
+// Windows keeps the exact calls the app used before; POSIX gets the
+// closest equivalent so the core builds and benchmarks on Linux.
+
+// Debugger trace output (OutputDebugString on Windows, no-op elsewhere)
+void DebugOutput(const std::string& message);
+
+// Spin-wait hint (_mm_pause on x86, yield on ARM)
+void CpuRelax();
+
+// OS scheduling priority of the calling thread (no-op on POSIX, where
+// raising priority needs privileges)
+enum class ThreadPriority { BelowNormal, Normal, AboveNormal };
+void SetCurrentThreadPriority(ThreadPriority priority);
+
+// fopen with a filesystem path (_wfopen on Windows)
+std::FILE* OpenFile(const std::filesystem::path& path, const char* mode);
+
+// fseek to an absolute 64-bit offset (_fseeki64 / fseeko)
+bool SeekFile(std::FILE* file, uint64_t offset);
+
+// Read-only whole-file memory mapping
+struct FileMapping {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    void* fileHandle = nullptr;  // HANDLE on Windows, fd (as intptr) on POSIX
+    void* mapHandle = nullptr;   // HANDLE on Windows, unused on POSIX
+};
+bool MapFileReadOnly(const std::filesystem::path& path, FileMapping& out);
+void UnmapFile(FileMapping& mapping);
+
+// Access hint for [offset, offset + length) of a mapping (madvise on POSIX;
+// WillNeed is PrefetchVirtualMemory on Windows, the others are no-ops
+// there). Random keeps a header probe from pulling the whole file in
+// through fault readahead.
+enum class MappingAdvice { Random, Sequential, WillNeed };
+void AdviseMapping(const FileMapping& mapping, MappingAdvice advice,
+                   size_t offset = 0, size_t length = SIZE_MAX);
+
+// RAII: lower the calling thread's I/O + memory priority for its lifetime
+// (THREAD_MODE_BACKGROUND_BEGIN/END on Windows, no-op elsewhere)
+class ScopedBackgroundMode {
+public:
+    explicit ScopedBackgroundMode(bool enter);
+    ~ScopedBackgroundMode();
+    ScopedBackgroundMode(const ScopedBackgroundMode&) = delete;
+    ScopedBackgroundMode& operator=(const ScopedBackgroundMode&) = delete;
+private:
+    bool active_;
+};
+
+} // namespace Platform
+} // namespace Core
+} // namespace UltraImageViewer
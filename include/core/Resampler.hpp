@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+enum class ResampleFilter : uint8_t {
+    Box,       // area average; cost per source pixel is independent of the ratio
+    Lanczos3,  // windowed sinc (a = 3); sharpest, used for the final step
+};
+
+// Per-axis filter table in Simd::ConvolveHorizontal/Vertical layout: output
+// i reads `taps` source samples from starts[i] with weights[i * taps ...].
+// Every window has the same tap count and lies inside the source.
+struct ResampleTaps {
+    std::vector<int32_t> starts;
+    std::vector<int16_t> weights;
+    uint32_t taps = 0;
+
+    static ResampleTaps Build(uint32_t srcSize, uint32_t dstSize, ResampleFilter filter);
+};
+
+// Separable resample of a BGRA8 image (premultiplied or straight). The
+// horizontal pass runs first into a dstWidth x srcHeight buffer. With
+// threads > 1 both passes are split into row bands; the calling thread
+// takes one band. Lanczos ringing on premultiplied input is clamped so
+// color never exceeds alpha.
+void ResampleBgra(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                  uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, size_t dstStride,
+                  ResampleFilter filter, bool premultiplied = true, uint32_t threads = 1);
+
+/**
+ * Streaming thumbnail downscaler for BGRA8 sources.
+ * Source rows arrive in order through PushRows (e.g. decoder strips), so the
+ * full-resolution image is never resident: only a ring of horizontally
+ * reduced rows. Ratios above kBoxRatio are first area-averaged to
+ * kBoxOversample x the target, then finished with Lanczos-3; smaller
+ * ratios go through Lanczos-3 directly.
+ */
+class ThumbnailScaler {
+public:
+    static constexpr uint32_t kBoxRatio = 3;
+    static constexpr uint32_t kBoxOversample = 2;
+
+    ThumbnailScaler(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight,
+                    bool premultiplied = true);
+
+    // Rows must be pushed top to bottom, `srcWidth` BGRA pixels each
+    void PushRows(const uint8_t* rows, size_t stride, uint32_t count);
+    uint32_t RowsPushed() const { return rowsPushed_; }
+
+    // Writes the thumbnail once every source row has been pushed
+    bool Finish(uint8_t* dst, size_t dstStride);
+
+    // Largest size within maxSize x maxSize with the source aspect ratio
+    static void FitWithin(uint32_t width, uint32_t height, uint32_t maxSize,
+                          uint32_t& outWidth, uint32_t& outHeight);
+
+private:
+    uint32_t srcWidth_, srcHeight_;
+    uint32_t dstWidth_, dstHeight_;
+    uint32_t stageWidth_, stageHeight_;  // streamed stage output size
+    bool twoStage_;
+    bool premultiplied_;
+
+    ResampleTaps hTaps_, vTaps_;
+    std::vector<uint8_t> ring_;   // vTaps_.taps horizontally reduced rows
+    std::vector<uint8_t> stage_;  // streamed stage output
+    std::vector<const uint8_t*> rowPtrs_;
+    uint32_t rowsPushed_ = 0;
+    uint32_t rowsEmitted_ = 0;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -1,12 +1,14 @@
 #pragma once
 #include <string>
 #include <cstddef>
+#include <cstdint>
 
 namespace UltraImageViewer {
 namespace Core {
 namespace Simd {
 
-// Call once at startup (CPUID detection)
+// Call once at startup (CPUID detection). Kernels also detect lazily on
+// first use, so calling this is only needed to refresh the Has*() flags.
 void DetectFeatures();
 bool HasAVX2();
 bool HasSSE42();
@@ -14,12 +16,96 @@ bool HasSSE42();
 // AVX2/SSE2 accelerated wchar_t in-place lowercasing.
 // Only converts ASCII A-Z (0x41-0x5A) to a-z (0x61-0x7A).
 // Non-ASCII characters are preserved (Windows paths are ASCII case-insensitive).
+// Handles both 16-bit (Windows) and 32-bit (Linux) wchar_t.
 void ToLowerInPlace(wchar_t* data, size_t length);
 
 inline void ToLowerInPlace(std::wstring& s) {
     ToLowerInPlace(s.data(), s.size());
 }
 
+// ---- Pixel kernels ----
+// Runtime-dispatched to the best instruction set the CPU supports. All
+// levels produce bit-identical results to the scalar reference. Counts are
+// in pixels (4 bytes, alpha last) unless noted; src and dst may be the same
+// buffer for the in-place-safe kernels marked below.
+
+enum class Level : uint8_t { Scalar, SSE41, AVX2, AVX512, NEON };
+
+// Level in use; SetLevel forces a (supported) level for testing and
+// benchmarks and returns false if the CPU or build lacks it.
+Level ActiveLevel();
+bool SetLevel(Level level);
+bool IsLevelSupported(Level level);
+const char* LevelName(Level level);
+
+// RGBA <-> BGRA (swap bytes 0 and 2). In-place safe.
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// Straight -> premultiplied alpha: c = round(c * a / 255). In-place safe.
+void PremultiplyAlpha(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// Premultiplied -> straight alpha: c = min(255, (c * 255 + a / 2) / a),
+// 0 where a == 0. In-place safe.
+void UnpremultiplyAlpha(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// Packed 3-byte pixels -> BGRA with opaque alpha. `src` holds 3*pixels bytes.
+void Rgb24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels);
+void Bgr24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels);
+
+// Per-channel depth conversion; counts are in samples, not pixels.
+// 8 -> 16 is v * 257 (full range); 16 -> 8 rounds v / 257.
+void Widen8To16(const uint8_t* src, uint16_t* dst, size_t samples);
+void Narrow16To8(const uint16_t* src, uint8_t* dst, size_t samples);
+
+// 8 -> float is v / 255; float -> 8 clamps to [0, 1] (NaN -> 0) and rounds.
+void U8ToFloat(const uint8_t* src, float* dst, size_t samples);
+void FloatToU8(const float* src, uint8_t* dst, size_t samples);
+
+// ---- Resampling convolutions (used by Resampler) ----
+// Weights are signed 1.14 fixed point (kConvolveBits); each output is
+// clamp((sum(w * s) + 2^13) >> 14, 0, 255).
+constexpr int kConvolveBits = 14;
+
+// One BGRA8 row: output pixel x reads `taps` source pixels starting at
+// starts[x] with weights[x * taps .. x * taps + taps). Reads stay inside
+// the window, so no source padding is needed.
+void ConvolveHorizontal(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                        const int32_t* starts, const int16_t* weights, size_t taps);
+
+// dst[i] = sum over k of weights[k] * rows[k][i], for `bytes` bytes.
+void ConvolveVertical(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                      uint8_t* dst, size_t bytes);
+
+namespace Detail {
+
+// One implementation per instruction set. Each kernel handles its own tail,
+// typically by delegating the remainder to the scalar table.
+struct PixelKernels {
+    void (*swapRedBlue)(const uint8_t*, uint8_t*, size_t);
+    void (*premultiply)(const uint8_t*, uint8_t*, size_t);
+    void (*unpremultiply)(const uint8_t*, uint8_t*, size_t);
+    void (*rgb24ToBgra32)(const uint8_t*, uint8_t*, size_t);
+    void (*bgr24ToBgra32)(const uint8_t*, uint8_t*, size_t);
+    void (*widen8To16)(const uint8_t*, uint16_t*, size_t);
+    void (*narrow16To8)(const uint16_t*, uint8_t*, size_t);
+    void (*u8ToFloat)(const uint8_t*, float*, size_t);
+    void (*floatToU8)(const float*, uint8_t*, size_t);
+    void (*convolveHorizontal)(const uint8_t*, uint8_t*, size_t, const int32_t*, const int16_t*, size_t);
+    void (*convolveVertical)(const uint8_t* const*, const int16_t*, size_t, uint8_t*, size_t);
+};
+
+extern const PixelKernels kScalarKernels;
+#if defined(UIV_SIMD_X86)
+extern const PixelKernels kSse41Kernels;
+extern const PixelKernels kAvx2Kernels;
+extern const PixelKernels kAvx512Kernels;
+#endif
+#if defined(UIV_SIMD_NEON)
+extern const PixelKernels kNeonKernels;
+#endif
+
+} // namespace Detail
+
 } // namespace Simd
 } // namespace Core
 } // namespace UltraImageViewer
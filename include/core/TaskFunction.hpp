@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Move-only void() callable with inline storage: std::move_only_function
+ * without the C++23 dependency, and with a small buffer guaranteed rather
+ * than left to the library.
+ *
+ * Callables of up to kInlineBytes that are nothrow-movable are stored in
+ * the object itself. That covers the pool's usual captures (`this`, an
+ * ImageId and a target size; or `this` and a path). A SubmitHandle task's
+ * shared state lives in the pool's slab, not in the capture. Anything
+ * larger costs one heap allocation. Like std::function, an empty std::function or
+ * null function pointer yields an empty TaskFunction.
+ */
+class TaskFunction {
+public:
+    static constexpr size_t kInlineBytes = 48;
+
+    TaskFunction() noexcept = default;
+    TaskFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, TaskFunction> &&
+                                          std::is_invocable_r_v<void, Fn&>>>
+    TaskFunction(F&& f)
+    {
+        if constexpr (std::is_constructible_v<bool, const Fn&>) {
+            if (!static_cast<bool>(f)) return;
+        }
+        if constexpr (kStoredInline<Fn>) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &kInlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(f));
+            ops_ = &kHeapOps<Fn>;
+        }
+    }
+
+    TaskFunction(TaskFunction&& other) noexcept { MoveFrom(other); }
+
+    TaskFunction& operator=(TaskFunction&& other) noexcept
+    {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    TaskFunction& operator=(std::nullptr_t) noexcept
+    {
+        Reset();
+        return *this;
+    }
+
+    TaskFunction(const TaskFunction&) = delete;
+    TaskFunction& operator=(const TaskFunction&) = delete;
+
+    ~TaskFunction() { Reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    void Reset() noexcept
+    {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*relocate)(void* dst, void* src) noexcept;  // move-construct dst, destroy src
+        void (*destroy)(void* self) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool kStoredInline =
+        sizeof(Fn) <= kInlineBytes && alignof(Fn) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<Fn>;
+
+    template <typename Fn>
+    static constexpr Ops kInlineOps = {
+        [](void* self) { (*static_cast<Fn*>(self))(); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* self) noexcept { static_cast<Fn*>(self)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops kHeapOps = {
+        [](void* self) { (**static_cast<Fn**>(self))(); },
+        [](void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+        [](void* self) noexcept { delete *static_cast<Fn**>(self); },
+    };
+
+    void MoveFrom(TaskFunction& other) noexcept
+    {
+        if (!other.ops_) return;
+        other.ops_->relocate(storage_, other.storage_);
+        ops_ = other.ops_;
+        other.ops_ = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineBytes];
+    const Ops* ops_ = nullptr;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -1,20 +1,88 @@
 #pragma once
 
-#include <functional>
-#include <deque>
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
-#include <optional>
-#include <intrin.h>
+#include <cstdint>
+
+#include "TaskFunction.hpp"
+#include "WorkStealingDeque.hpp"
 
 namespace UltraImageViewer {
 namespace Core {
 
 enum class TaskPriority : uint8_t { High = 0, Normal = 1, Low = 2 };
 
+class ThreadPool;
+
+/**
+ * Shared handle to a task submitted with ThreadPool::SubmitHandle.
+ *
+ * While the task is still queued it can be cancelled or moved to another
+ * lane; once a worker has started it, both are no-ops. Moving re-queues a
+ * node in the new lane and leaves the old one behind as a no-op, so it works
+ * on tasks sitting in any worker's deque. A task dropped by PurgePriority or
+ * the pool's destructor reads as cancelled. Any thread may use a handle,
+ * but SetPriority needs the pool to be alive.
+ */
+class TaskHandle {
+public:
+    TaskHandle() = default;
+    TaskHandle(const TaskHandle& other) noexcept;
+    TaskHandle(TaskHandle&& other) noexcept : control_(other.control_) { other.control_ = nullptr; }
+    TaskHandle& operator=(TaskHandle other) noexcept;
+    ~TaskHandle() { Reset(); }
+
+    explicit operator bool() const { return control_ != nullptr; }
+
+    // Queued: not started, not cancelled
+    bool Pending() const;
+
+    // Drop the task if it hasn't started. True if it will never run.
+    bool Cancel();
+
+    // Move a queued task to lane `p` (front: ahead of everything queued
+    // there). False if it has already started, finished or been cancelled.
+    bool SetPriority(TaskPriority p, bool front = false);
+
+    // Lane it was last queued in
+    TaskPriority Priority() const;
+
+    void Reset() noexcept;
+
+private:
+    friend class ThreadPool;
+    struct Control;
+    struct QueuedRun;
+
+    explicit TaskHandle(Control* control) : control_(control) {}
+
+    Control* control_ = nullptr;
+};
+
+/**
+ * Work-stealing pool with three priority lanes.
+ *
+ * Each worker owns a Chase-Lev deque per lane. Tasks submitted from outside
+ * the pool land in a per-lane injection queue; a worker that finds its own
+ * deque empty takes a small batch from there (keeping the order) and the
+ * others steal from its deque. High-lane work is taken one task at a time
+ * straight from the injection queue, so SubmitFront still puts visible work
+ * ahead of everything queued. Lanes are searched in priority order, own
+ * deque -> injection -> steal, before any lower lane is considered.
+ *
+ * Idle workers spin briefly and then park on an eventcount
+ * (std::atomic::wait: a futex on Linux, WaitOnAddress on Windows), so an
+ * idle pool costs no CPU and submitting only issues a wake-up when a worker
+ * is actually parked.
+ *
+ * Tasks are TaskFunctions (inline storage for small captures) in nodes from
+ * a process-wide slab, so a typical Submit performs no heap allocation.
+ * SubmitHandle tasks take a second slab node for their shared state.
+ */
 class ThreadPool {
 public:
     explicit ThreadPool(uint32_t numThreads = 0);  // 0 = auto
@@ -24,17 +92,26 @@ public:
     // Only meaningful inside a task callback. Returns -1 outside a task.
     static int CurrentLane() { return tl_currentLane_; }
 
+    // Index in [0, ThreadCount()) of the calling thread among this pool's
+    // workers, or ThreadCount() from any other thread (per-worker buffers)
+    uint32_t CurrentWorkerIndex() const { return tl_pool_ == this ? tl_workerIndex_ : threadCount_; }
+
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
 
-    // Submit a task to the back of the given priority lane
-    void Submit(std::function<void()> fn, TaskPriority p = TaskPriority::Normal);
+    // Submit a task to the back of the given priority lane. From one of this
+    // pool's workers it goes to the worker's own deque instead, where it
+    // runs next on that worker unless stolen first.
+    void Submit(TaskFunction fn, TaskPriority p = TaskPriority::Normal);
 
     // Submit a task to the front of the given priority lane (for urgent visible work)
-    void SubmitFront(std::function<void()> fn, TaskPriority p = TaskPriority::High);
+    void SubmitFront(TaskFunction fn, TaskPriority p = TaskPriority::High);
 
-    // Submit a batch of tasks (single lock acquisition, notify_all)
-    void SubmitBatch(std::vector<std::function<void()>>& fns, TaskPriority p);
+    // Submit a task that can later be cancelled or moved to another lane
+    TaskHandle SubmitHandle(TaskFunction fn, TaskPriority p = TaskPriority::Normal, bool front = false);
+
+    // Submit a batch of tasks (single lock acquisition, one wake-up round)
+    void SubmitBatch(std::vector<TaskFunction>& fns, TaskPriority p);
 
     // Cancel all pending tasks across all lanes
     void PurgeAll();
@@ -52,26 +129,96 @@ public:
     void WaitIdle();
 
 private:
-    void WorkerFunc(uint32_t index);
-
-    struct DequeuedTask {
-        std::function<void()> fn;
-        int lane;  // 0=High, 1=Normal, 2=Low
+    struct Task {
+        TaskFunction fn;
     };
-    std::optional<DequeuedTask> TryDequeue();
+
+    friend class TaskHandle;
+
+    // Recycles fixed-size nodes (Task, TaskHandle::Control); defined in
+    // ThreadPool.cpp
+    template <size_t Bytes, size_t Align>
+    class NodeSlab;
+    static Task* NewTask(TaskFunction&& fn);
+    static void DeleteTask(Task* task);
+    static TaskHandle::Control* NewControl();
+    static void DeleteControl(TaskHandle::Control* control);
 
     static constexpr int kLaneCount = 3;
-    static constexpr int kSpinCount = 64;
-    static constexpr int kYieldCount = 256;
+    static constexpr int kSpinCount = 64;       // CpuRelax rounds before parking
+    static constexpr uint32_t kMaxBatch = 16;   // injection -> own deque per grab
+
+    // Growable ring of tasks. It never shrinks, so once warmed up queueing
+    // doesn't allocate (std::deque frees and reallocates blocks as it drains)
+    struct TaskRing {
+        std::vector<Task*> slots;  // power-of-two size
+        size_t head = 0;
+        size_t count = 0;
+
+        size_t Size() const { return count; }
+
+        void PushBack(Task* task)
+        {
+            if (count == slots.size()) Grow();
+            slots[(head + count++) & (slots.size() - 1)] = task;
+        }
+
+        void PushFront(Task* task)
+        {
+            if (count == slots.size()) Grow();
+            head = (head - 1) & (slots.size() - 1);
+            slots[head] = task;
+            ++count;
+        }
+
+        Task* PopFront()
+        {
+            Task* task = slots[head];
+            head = (head + 1) & (slots.size() - 1);
+            --count;
+            return task;
+        }
+
+        void Grow()
+        {
+            std::vector<Task*> grown(slots.empty() ? 64 : slots.size() * 2);
+            for (size_t i = 0; i < count; ++i) grown[i] = slots[(head + i) & (slots.size() - 1)];
+            slots.swap(grown);
+            head = 0;
+        }
+    };
 
-    // 3 priority lanes, each cache-line padded
-    struct alignas(64) Lane {
-        std::deque<std::function<void()>> queue;
+    // Tasks from outside the pool, one queue per lane
+    struct alignas(64) InjectionQueue {
+        std::mutex mutex;
+        TaskRing tasks;
+        std::atomic<uint32_t> size{0};  // lock-free emptiness check
     };
-    Lane lanes_[kLaneCount];
 
-    mutable std::mutex mutex_;
-    std::condition_variable cv_;
+    struct alignas(64) Worker {
+        WorkStealingDeque<Task> lanes[kLaneCount];
+        uint32_t stealSeed = 0;  // xorshift state for victim selection
+    };
+
+    void WorkerFunc(uint32_t index);
+    Task* FindTask(uint32_t self, int& lane);
+    Task* TakeInjected(uint32_t self, int lane);
+    Task* StealFrom(uint32_t self, int lane);
+    bool HasQueuedWork() const;
+    void Execute(Task* task, int lane);
+    void Enqueue(Task* task, TaskPriority p, bool front);
+    void Wake(uint32_t count);
+    void FinishPurge(uint32_t purged);
+
+    InjectionQueue injection_[kLaneCount];
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Eventcount: parked workers wait for epoch_ to move past the value they
+    // read before their last look for work
+    alignas(64) std::atomic<uint32_t> epoch_{0};
+    alignas(64) std::atomic<uint32_t> sleepers_{0};
+
+    std::mutex idleMutex_;
     std::condition_variable idleCV_;
 
     std::vector<std::jthread> threads_;
@@ -83,6 +230,8 @@ private:
     std::atomic<bool> shutdown_{false};
 
     static thread_local int tl_currentLane_;
+    static thread_local ThreadPool* tl_pool_;       // pool the calling worker belongs to
+    static thread_local uint32_t tl_workerIndex_;
 };
 
 } // namespace Core
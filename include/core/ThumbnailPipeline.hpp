@@ -0,0 +1,423 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include "ThreadPool.hpp"
+#include "Platform.hpp"
+#include "PathInterner.hpp"
+#include "ThumbnailStore.hpp"
+#include "PixelCompressor.hpp"
+#include "PixelPool.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+// Opaque GPU texture created by a TextureSink (ID2D1Bitmap on Windows, a
+// plain allocation in benchmarks). The pipeline only holds and releases it.
+using TextureHandle = std::shared_ptr<void>;
+
+// Tightly packed BGRA8 (premultiplied) pixel buffer
+struct PixelBuffer {
+    std::unique_ptr<uint8_t[]> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Produces thumbnail pixels from a file. Called concurrently from pool
+// workers, so implementations must be thread-safe.
+class PixelSource {
+public:
+    virtual ~PixelSource() = default;
+    virtual bool DecodeThumbnail(const std::filesystem::path& path,
+                                 uint32_t targetSize, PixelBuffer& out) = 0;
+};
+
+// Uploads pixels to the GPU. Called on the render thread only.
+class TextureSink {
+public:
+    virtual ~TextureSink() = default;
+    virtual TextureHandle CreateTexture(uint32_t width, uint32_t height,
+                                        const uint8_t* bgra) = 0;
+};
+
+/**
+ * Platform-neutral thumbnail pipeline: decode (pool) → ready queue →
+ * upload (render thread), with three cache tiers:
+ *   Tier 1: GPU textures (CLOCK second-chance, visible pinned), each with
+ *           its CPU pixels kept as a PixelHandle so it can be demoted
+ *   Tier 2: compressed pixels in RAM (evicted Tier 1 entries)
+ *   Tier 3: persistent memory-mapped thumbnail file (scan_thumbs.bin, ThumbnailStore)
+ * Gallery decodes wait in a queue ordered by distance from the viewport,
+ * or during a fling from where it will come to rest (see SetViewport),
+ * re-keyed in bulk every frame; pool workers always take the closest cell.
+ * Requests that scroll out of the prefetch zone are dropped before they
+ * cost a decode (see RerankRequests).
+ *
+ * One memory budget covers GPU textures, pooled CPU pixels (Tier 1 copies
+ * and the save buffer) and Tier 2. Tier 1 may use the budget minus the save
+ * buffer and tier2ReserveBytes (but never less than a quarter of it). Tier 2
+ * gets whatever is left, borrowing space Tier 1 doesn't use, and hands it
+ * back oldest entries first when Tier 1 grows. The save buffer's own pixels
+ * are capped at half the budget (see TrimSaveBuffer).
+ *
+ * Images are addressed by ImageId (see PathInterner). Per-image state lives in
+ * a flat id-indexed table: Tier 1 lookups are an array index plus an
+ * epoch-protected pointer load, so render-thread reads never lock or hash.
+ * Tier 1 is written only by the render thread.
+ */
+class ThumbnailPipeline {
+public:
+    struct Config {
+        size_t memoryBudgetBytes = 2048ULL * 1024 * 1024;  // Tier 1 + CPU pixels + Tier 2
+        size_t tier2ReserveBytes = 256ULL * 1024 * 1024;   // part of the budget Tier 1 can't take from Tier 2
+        bool collectSaveBuffer = true;  // keep decoded pixels until SavePersistent writes them
+        int persistSyncBudgetPerFrame = 200;             // sync Tier 3 uploads per frame
+        PixelCodec persistCodec = PixelCodec::PlaneDelta;  // encoding of newly saved Tier 3 entries
+        std::shared_ptr<PixelCompressor> tier2Compressor;  // nullptr: DefaultPixelCompressorKind()
+        bool asyncDemotion = true;  // compress evicted thumbnails on a worker (false: render thread)
+        bool rerankRequests = true;  // re-key queued decodes each frame (false: keys fixed at request time, only InvalidateRequests drops them, all at once)
+        float scrollBiasVelocity = 1000.0f;  // px/s at which cells ahead of the scroll count half their distance, cells behind double
+        float requestLeadSeconds = 1.0f / 60.0f;  // distances are measured from where the viewport will be this much later
+    };
+
+    ThumbnailPipeline(PathInterner* interner, PixelSource* source, TextureSink* sink,
+                      ThreadPool* pool, const Config& config);
+    ~ThumbnailPipeline();
+
+    ThumbnailPipeline(const ThumbnailPipeline&) = delete;
+    ThumbnailPipeline& operator=(const ThumbnailPipeline&) = delete;
+
+    // Drop all cached state. The pool must be drained (or destroyed) first.
+    void Clear();
+
+    // Synchronous decode + upload (render thread), kept for compatibility
+    TextureHandle GetThumbnailSync(ImageId id, uint32_t maxSize);
+
+    // Returns cached texture immediately, or nullptr if not yet decoded.
+    // Queues a background decode request on cache miss.
+    TextureHandle RequestThumbnail(ImageId id, uint32_t targetSize);
+
+    // Same, for a cell spanning [cellTop, cellBottom] in viewport
+    // coordinates (see SetViewport): its decode is queued by distance from
+    // the viewport. The overload above ranks on-screen cells first and the
+    // rest in request order.
+    TextureHandle RequestThumbnail(ImageId id, uint32_t targetSize, float cellTop, float cellBottom);
+
+    // Cache-only lookup (no decode queuing), falls through to Tier 3
+    TextureHandle GetCachedThumbnail(ImageId id);
+
+    // Render thread, once per frame: upload up to maxCount decoded buffers.
+    // Returns the number of textures created.
+    int FlushReadyThumbnails(int maxCount);
+
+    // Cancel queued decodes for cells that are not on screen (fast scroll)
+    void InvalidateRequests();
+
+    // Render thread, once per frame before the frame's RequestThumbnail
+    // calls: viewport height in the coordinates cell extents are given in,
+    // and the scroll velocity in px/s (positive while scrolling towards
+    // larger offsets, i.e. cells below the viewport are coming into view)
+    void SetViewport(float height, float scrollVelocity);
+
+    // Same, during a fling predicted to come to rest `landingOffset` px
+    // from the current viewport (e.g. the scroll spring's closed-form rest
+    // point). Cells are also keyed against the landing viewport, centre
+    // first, so the rows where the fling will stop decode on High while it
+    // is still moving.
+    void SetViewport(float height, float scrollVelocity, float landingOffset);
+
+    // Render thread, once per frame after the frame's RequestThumbnail calls:
+    // images currently on screen (decoded first, never evicted). Also
+    // re-keys the queued decodes.
+    void SetVisibleRange(const std::vector<ImageId>& ids);
+
+    // Low-priority decode-ahead around currentIndex
+    void PrefetchAround(const std::vector<ImageId>& allIds,
+                        size_t currentIndex, size_t radius);
+
+    bool HasThumbnail(ImageId id) const;
+    bool HasPendingThumbnails() const;
+
+    // Render thread: the files behind `ids` were removed or rewritten. Their
+    // thumbnails leave Tiers 1 and 2, queued decodes and unuploaded results
+    // are dropped, Tier 3 is no longer read for them, and the next
+    // SavePersistent stores a fresh thumbnail or a tombstone over the saved
+    // one.
+    void ForgetThumbnails(const std::vector<ImageId>& ids);
+
+    // Render thread: `from` was renamed to `to`. A resident thumbnail moves
+    // to the new id (and is saved under the new path); `from` is forgotten.
+    void MoveThumbnail(ImageId from, ImageId to);
+
+    // Persistent thumbnail cache (disk-backed, memory-mapped)
+    void LoadPersistent(const std::filesystem::path& cachePath);
+    void SavePersistent(const std::filesystem::path& cachePath);
+
+    struct Stats {
+        size_t gpuEntries = 0;
+        size_t gpuBytes = 0;
+        size_t tier2Entries = 0;
+        size_t tier2Bytes = 0;
+        size_t tier2Pending = 0;    // evicted thumbnails waiting for compression
+        size_t cpuPixelBytes = 0;   // PixelPool buffers held: Tier 1 copies, save buffer, demotions
+        size_t saveBufferEntries = 0;
+        size_t persistEntries = 0;
+        uint64_t decodes = 0;       // PixelSource calls
+        uint64_t uploads = 0;       // TextureSink calls
+        uint64_t evictions = 0;     // Tier 1 entries evicted for budget
+        uint64_t cancelled = 0;     // queued decodes cancelled before they started
+    };
+    Stats GetStats() const;
+
+private:
+    // RequestThumbnail once the slot's requestKey is set
+    TextureHandle Request(ImageId id, uint32_t targetSize);
+
+    // Single-task thumbnail decode (submitted to ThreadPool)
+    void ThumbnailDecodeTask(ImageId id, uint32_t targetSize);
+
+    // Insert an uploaded texture and the pixels it was made from into Tier 1
+    // (render thread)
+    void InsertThumbnail(ImageId id, TextureHandle texture, PixelHandle pixels,
+                         uint32_t width, uint32_t height);
+
+    // Remove a Tier 1 entry (render thread). Returns the bytes released.
+    size_t RemoveThumbnail(ImageId id);
+
+    // Tier 1 lookup that marks the entry referenced for CLOCK
+    TextureHandle LookupThumbnail(ImageId id) const;
+
+    // Synchronous Tier 3 → GPU upload within the per-frame budget. Compressed
+    // entries are not decoded on the render thread: they queue a decode task,
+    // which decompresses them on a worker.
+    TextureHandle UploadFromPersistent(ImageId id);
+
+    // Queue a decode unless one is pending. Gallery requests go into
+    // decodeQueue_ keyed by the slot's requestKey; `prefetch` requests are
+    // Low-lane tasks, left alone until they run or InvalidateRequests drops
+    // them.
+    void QueueDecode(ImageId id, uint32_t targetSize, bool prefetch = false);
+
+    // Re-key the queued decodes (render thread): on-screen cells a key of 0
+    // or below, cells requested this frame or the last one their latest
+    // distance key.
+    // The rest (scrolled out of the prefetch zone) are dropped, and so are
+    // prefetch tasks unless `keepNearby` is set; on-screen prefetch tasks
+    // move to High. `keepVisible` false drops everything.
+    void RerankRequests(bool keepNearby, bool keepVisible);
+
+    // Distance key of a cell (see SetViewport). Off screen: the gap to the
+    // viewport, shrunk ahead of the scroll and stretched behind it. On
+    // screen: minus how far it can scroll before it leaves the viewport.
+    float DistanceKey(float cellTop, float cellBottom) const;
+
+    // Key against the landing viewport (see SetViewport): the cell's
+    // distance from its centre less half its height. Requests take the
+    // smaller of this and DistanceKey while a landing is set.
+    float LandingKey(float cellTop, float cellBottom) const;
+
+    // Worker: decode the closest queued cell, then keep enough pumps queued
+    void DecodePumpTask(bool urgent);
+
+    // Queue a DecodePumpTask: High (front) for an on-screen cell, else
+    // Normal, at most one per worker and lane. Caller holds decodeMutex_.
+    void SchedulePump(bool urgent);
+
+    // CLOCK eviction down to Tier 1's share of the memory budget. Amortized
+    // O(1) per evicted entry; visible entries are skipped. Evicted pixels are
+    // handed to the Tier 2 demotion stage, not compressed here.
+    void EvictThumbnailsIfNeeded();
+
+    // Bytes Tier 2 may hold right now: the budget minus GPU textures and live
+    // CPU pixels other than those queued for demotion. Caller holds tier2Mutex_.
+    size_t Tier2Limit() const;
+
+    // Drop the oldest Tier 2 entries down to `limit`. Caller holds tier2Mutex_.
+    void TrimTier2(size_t limit);
+
+    // Unsaved thumbnails only spare a decode next session, so once the save
+    // buffer's own pixels pass half the budget, entries nothing else holds
+    // are dropped until about `bytes` are released. Returns the bytes released.
+    size_t TrimSaveBuffer(size_t bytes);
+
+    // Allow `id` to be queued again
+    void ClearPending(ImageId id);
+
+    // --- Tier 2: CPU-RAM compressed pixel cache ---
+    // Evicted GPU textures are compressed (Config::tier2Compressor) and kept
+    // in RAM. On re-request, decompressing from RAM (~0.1ms) is much faster
+    // than re-reading from disk and decoding JPEG (~5ms).
+    //
+    // Demotion is a pipeline stage of its own: the render thread queues the
+    // evicted ids with their Tier 1 pixel handles (shared, not copied) and one
+    // Low-lane DemotionTask at a time compresses them, taking tier2Mutex_
+    // only to swap the queue and to insert finished entries.
+    struct CompressedThumbnail {
+        std::unique_ptr<uint8_t[]> data;
+        size_t compressedSize = 0;
+        uint32_t rawSize = 0;  // uncompressed BGRA size
+        uint16_t width = 0;
+        uint16_t height = 0;
+        uint64_t sequence = 0;  // insertion order; the oldest entry is evicted first
+    };
+    std::unordered_map<ImageId, CompressedThumbnail> tier2Cache_;
+    // (id, sequence) in insertion order; entries extracted since are skipped
+    std::deque<std::pair<ImageId, uint64_t>> tier2Order_;
+    uint64_t tier2Sequence_ = 0;
+    size_t tier2Bytes_ = 0;  // total compressed bytes
+    mutable std::mutex tier2Mutex_;  // demotion queue + cache: render, demotion task, decode workers
+
+    struct DemoteJob {
+        ImageId id;
+        PixelHandle pixels;  // possibly shared with thumbSaveBuffer_
+        uint16_t width;
+        uint16_t height;
+        uint32_t version;  // slot version at eviction; a forgotten file's job is dropped
+    };
+    std::vector<DemoteJob> demoteQueue_;
+    size_t demotePending_ = 0;      // queued + being compressed
+    size_t demotePendingBytes_ = 0;  // their raw pixel bytes
+    bool demoteScheduled_ = false;  // a DemotionTask is queued or running
+
+    // Worker: drains demoteQueue_, then clears demoteScheduled_
+    void DemotionTask();
+
+    // Compress outside the lock, then insert under tier2Mutex_ (oldest
+    // entries make room). Skips ids that are back in Tier 1 or were
+    // forgotten since. `queued`: the jobs came from demoteQueue_ and are
+    // counted in demotePending_.
+    void DemoteToTier2(std::vector<DemoteJob>& jobs, bool queued);
+
+    PathInterner* interner_;
+    PixelSource* source_;
+    TextureSink* sink_;
+    ThreadPool* pool_;
+    Config config_;
+
+    // Tier 1 entry: immutable once published except for the CLOCK reference
+    // bit, which readers set relaxed. Replaced/removed entries are retired
+    // through EpochReclaimer.
+    struct ThumbnailCacheEntry {
+        TextureHandle texture;
+        PixelHandle pixels;  // CPU copy for Tier 2 demotion
+        uint32_t width = 0;
+        uint32_t height = 0;
+        mutable std::atomic<bool> referenced{false};
+    };
+
+    static constexpr uint32_t kNotInClock = 0xFFFFFFFFu;
+    static constexpr float kUnkeyed = std::numeric_limits<float>::max();  // after every keyed cell
+
+    // Per-image state, indexed by ImageId
+    struct ImageSlot {
+        std::atomic<ThumbnailCacheEntry*> gpu{nullptr};  // Tier 1 (render thread writes)
+        std::atomic<bool> pending{false};     // decode queued, running or awaiting upload
+        TaskHandle decode;                    // the queued prefetch decode (render thread)
+        uint64_t requestFrame = 0;            // visibleFrame_ of the last gallery request, 0 = prefetch (render thread)
+        float requestKey = kUnkeyed;          // distance key of the last gallery request (render thread)
+        uint64_t visibleFrame = 0;            // == visibleFrame_ while on screen (render thread)
+        uint32_t clockIndex = kNotInClock;    // position in clockRing_ (render thread)
+        uint64_t persistMiss = 0;             // persistGeneration_ of the last Tier 3 miss (render thread)
+        std::atomic<bool> persistStale{false};  // Tier 3 entry outdated until the next save (ForgetThumbnails)
+        std::atomic<uint32_t> version{0};     // bumped by ForgetThumbnails; decodes of an older one are dropped
+    };
+    IdTable<ImageSlot> slots_;
+    std::atomic<size_t> thumbnailCount_{0};
+    std::atomic<size_t> thumbnailCacheBytes_{0};  // GPU texture bytes
+    size_t tier1PixelBytes_ = 0;                   // CPU pixels held by Tier 1 entries (render thread)
+
+    // Every CPU-side pixel buffer comes from here
+    std::shared_ptr<PixelPool> pixelPool_;
+
+    // CLOCK ring over resident Tier 1 ids (render thread only). Removal swaps
+    // the last id into the hole, so membership changes are O(1).
+    std::vector<ImageId> clockRing_;
+    size_t clockHand_ = 0;
+    std::atomic<uint64_t> evictionCount_{0};
+
+    // Decoded pixel buffer produced by worker threads (CPU-only, no GPU)
+    struct ReadyThumbnail {
+        ImageId id;
+        PixelHandle pixels;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Ready queue: decoded pixel buffers waiting for GPU upload (deque for O(1) pop_front)
+    std::deque<ReadyThumbnail> readyQueue_;
+    mutable std::mutex readyMutex_;
+
+    // Gallery decodes waiting for a worker, a heap ordered by key. Ties go
+    // to the oldest request, except on screen (key <= 0), where the cell
+    // that came into view last goes first (it stays longest, as with
+    // SubmitFront)
+    struct QueuedDecode {
+        float key;
+        uint64_t sequence;  // request order; renewed when the cell comes on screen
+        ImageId id;
+        uint32_t targetSize;
+
+        // Heap order: true if `a` should be decoded after `b`
+        static bool Later(const QueuedDecode& a, const QueuedDecode& b)
+        {
+            if (a.key != b.key) return a.key > b.key;
+            return a.key <= 0.0f ? a.sequence < b.sequence : a.sequence > b.sequence;
+        }
+    };
+    std::vector<QueuedDecode> decodeQueue_;
+    uint64_t decodeSequence_ = 0;
+    uint32_t urgentPumps_ = 0;  // DecodePumpTasks queued in High, not yet started
+    uint32_t pumps_ = 0;        // ... in Normal
+    std::mutex decodeMutex_;    // queue + pump counts: render thread, pumps
+
+    float viewportHeight_ = 0.0f;  // SetViewport (render thread)
+    float scrollVelocity_ = 0.0f;
+    float landingOffset_ = 0.0f;
+    bool hasLanding_ = false;
+
+    // Ids whose slot holds a prefetch handle, possibly finished (render thread)
+    std::vector<ImageId> prefetches_;
+    std::atomic<uint64_t> cancelCount_{0};
+
+    // Bumped by SetVisibleRange; slots stamped with it are on screen
+    uint64_t visibleFrame_ = 1;
+
+    // --- Persistent thumbnail cache (memory-mapped file, see ThumbnailStore) ---
+    void ClosePersistentMapping();
+
+    ThumbnailStore persistStore_;
+    mutable std::shared_mutex persistMutex_;  // readers: lookups, writer: load/save
+    std::atomic<uint64_t> persistGeneration_{1};  // bumped whenever the store (re)opens
+
+    // Save buffer: raw pixels collected during FlushReadyThumbnails
+    struct ThumbSaveEntry {
+        uint16_t width;
+        uint16_t height;
+        uint32_t pixelSize;
+        PixelHandle pixels;  // shared with the Tier 1 entry while resident
+    };
+    std::unordered_map<ImageId, ThumbSaveEntry> thumbSaveBuffer_;
+    std::unordered_set<ImageId> persistForgotten_;  // ForgetThumbnails since the last save
+    mutable std::mutex thumbSaveMutex_;
+
+    // Per-frame budget for synchronous texture creation from persistent cache
+    // (render thread only — no synchronization needed)
+    int persistSyncBudget_ = 0;
+
+    std::atomic<uint64_t> decodeCount_{0};
+    std::atomic<uint64_t> uploadCount_{0};
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "Platform.hpp"
+#include "PixelCodec.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * On-disk thumbnail cache (scan_thumbs.bin, format v3):
+ *
+ *   [header, 64 B][base index: IndexEntry[] sorted by path hash]
+ *   [base payloads: encoded pixels, each followed by its path]
+ *   [log: appended segments = payloads + sorted segment index + footer] ...
+ *
+ * Payloads are stored as the caller encoded them (PixelCodec, recorded per
+ * entry). Raw payloads sit at 4 KB-aligned offsets so they can be uploaded
+ * straight from the mapping; compressed ones are packed at 16 bytes.
+ *
+ * Open() maps the file and checks the header and index checksums; entries
+ * are never parsed, so it costs the same for 100 or 100k thumbnails.
+ * Find() hashes the path, binary-searches the segment indices newest first
+ * and then the base index, and confirms the path stored with the payload.
+ *
+ * Saving writes only new thumbnails: AppendSegment() adds a segment past the
+ * committed end and commits it with one header write (a torn append leaves
+ * the previous state valid). After kMaxSegments appends the caller rewrites
+ * the file with WriteCompacted() instead.
+ *
+ * A thumbnail is removed by saving a tombstone for its path: an entry with
+ * no pixels (0x0). It hides the older entries for that path from Find()
+ * and is dropped, along with them, by WriteCompacted().
+ *
+ * Find() is const and safe to call concurrently; Open/Close must be
+ * serialized against it by the owner (ThumbnailPipeline's persistMutex_).
+ */
+class ThumbnailStore {
+public:
+    static constexpr uint32_t kMaxSegments = 8;
+
+    struct View {
+        const uint8_t* data = nullptr;  // into the mapping; valid until Close()
+        size_t bytes = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        PixelCodec codec = PixelCodec::Raw;
+    };
+
+    // width == height == 0 (no data) is a tombstone
+    struct NewEntry {
+        const std::filesystem::path* path = nullptr;
+        const uint8_t* data = nullptr;  // width * height * 4 bytes when Raw
+        size_t bytes = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        PixelCodec codec = PixelCodec::Raw;
+    };
+
+    // On-disk index record (layout in ThumbnailStore.cpp)
+    struct IndexEntry;
+
+    ThumbnailStore() = default;
+    ~ThumbnailStore() { Close(); }
+
+    ThumbnailStore(const ThumbnailStore&) = delete;
+    ThumbnailStore& operator=(const ThumbnailStore&) = delete;
+
+    // Maps and validates `file`. False (store left empty) when missing,
+    // not v2, or corrupt.
+    bool Open(const std::filesystem::path& file);
+    void Close();
+
+    bool IsOpen() const { return mapping_.data != nullptr; }
+    const std::filesystem::path& File() const { return file_; }
+
+    // Index entries across base and segments (superseded ones included)
+    size_t EntryCount() const { return entryCount_; }
+
+    // Whether AppendSegment on the open file would be accepted
+    bool CanAppend() const { return IsOpen() && segments_.size() - 1 < kMaxSegments; }
+
+    // False when missing or removed (newest entry a tombstone)
+    bool Find(const std::filesystem::path& path, View& out) const;
+
+    // Starts reading a found payload as one request. The mapping is advised
+    // random access (payloads are in hash order, so readahead would fetch
+    // unrelated thumbnails), which otherwise faults it in a page at a time.
+    void WillNeed(const View& view) const;
+
+    // Appends `entries` to a valid v2 file as one segment. Reads the header
+    // from the file, so the file must not be mapped by this process on
+    // Windows (Close first). False, with the committed state untouched, if
+    // the file is not a valid v2 store or is out of segments.
+    static bool AppendSegment(const std::filesystem::path& file, const std::vector<NewEntry>& entries);
+
+    // Writes a fresh file holding `entries` plus every live entry of this
+    // store that they don't supersede. `file` must differ from File().
+    bool WriteCompacted(const std::filesystem::path& file, const std::vector<NewEntry>& entries) const;
+
+private:
+    // One sorted index: the base, or a segment
+    struct Segment {
+        const IndexEntry* entries = nullptr;
+        uint32_t count = 0;
+    };
+
+    const IndexEntry* FindIn(const Segment& segment, const std::filesystem::path& path, uint64_t key) const;
+
+    std::filesystem::path file_;
+    Platform::FileMapping mapping_;
+    size_t committedEnd_ = 0;
+    std::vector<Segment> segments_;  // newest first; the base index is last
+    size_t entryCount_ = 0;
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
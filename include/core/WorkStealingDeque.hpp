@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace UltraImageViewer {
+namespace Core {
+
+/**
+ * Chase-Lev work-stealing deque of T* (Lê, Pop, Cohen, Zappa Nardelli:
+ * "Correct and Efficient Work-Stealing for Weak Memory Models", 2013).
+ *
+ * The owning thread pushes and takes at the bottom without locks or atomic
+ * read-modify-writes except when racing for the last element; any thread
+ * steals from the top with one CAS. The ring grows by doubling; retired
+ * rings are kept until destruction, since a thief may still be reading one.
+ */
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t initialCapacity = 256)
+    {
+        size_t capacity = 1;
+        while (capacity < initialCapacity) capacity <<= 1;
+        rings_.push_back(std::make_unique<Ring>(capacity));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only
+    void Push(T* item)
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        if (b - t >= static_cast<int64_t>(ring->capacity)) ring = Grow(ring, t, b);
+        ring->Put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only: newest item, or nullptr when empty
+    T* Take()
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = ring->Get(b);
+        if (t == b) {
+            // Last element: race thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread: oldest item, or nullptr when empty. `lost` is set when a
+    // concurrent take or steal won the race; retrying may still succeed.
+    T* Steal(bool& lost)
+    {
+        lost = false;
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        T* item = ring_.load(std::memory_order_acquire)->Get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            lost = true;
+            return nullptr;
+        }
+        return item;
+    }
+
+    // Any thread; a hint only, since it races with push/take/steal
+    bool Empty() const
+    {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Ring {
+        explicit Ring(size_t cap) : capacity(cap), mask(cap - 1), slots(new std::atomic<T*>[cap]) {}
+
+        T* Get(int64_t i) const { return slots[static_cast<size_t>(i) & mask].load(std::memory_order_relaxed); }
+        void Put(int64_t i, T* item) { slots[static_cast<size_t>(i) & mask].store(item, std::memory_order_relaxed); }
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    Ring* Grow(Ring* old, int64_t t, int64_t b)
+    {
+        rings_.push_back(std::make_unique<Ring>(old->capacity * 2));
+        Ring* ring = rings_.back().get();
+        for (int64_t i = t; i < b; ++i) ring->Put(i, old->Get(i));
+        ring_.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring*> ring_{nullptr};
+    std::vector<std::unique_ptr<Ring>> rings_;  // owner-only; every ring ever used
+};
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -11,6 +11,7 @@
 #include "../animation/SpringAnimation.hpp"
 #include "../animation/AnimationEngine.hpp"
 #include "../rendering/Direct2DRenderer.hpp"
+#include "../core/GalleryModel.hpp"
 #include "../core/ImagePipeline.hpp"
 
 namespace UltraImageViewer {
@@ -23,6 +24,7 @@ struct FolderAlbum {
     std::wstring displayName;
     size_t imageCount = 0;
     std::filesystem::path coverImage;  // First image used as cover
+    Core::ImageId coverId = Core::kInvalidImageId;
 };
 
 class GalleryView {
@@ -37,10 +39,36 @@ public:
     // Set images grouped by date (phone gallery style)
     void SetImagesGrouped(const std::vector<Core::ScannedImage>& scannedImages);
 
-    // Set flat image list (for Ctrl+O / drag-drop / command-line)
+    // Library scan in progress: merges a batch into the grouped library
+    // (Core::GalleryModel), so photos appear while the walk goes on
+    void AddScannedImages(std::vector<Core::ScannedImage> batch);
+    // Library scan done: the library becomes exactly `scannedImages`, keeping
+    // what the batches already placed, and is shown again
+    void SyncScannedImages(const std::vector<Core::ScannedImage>& scannedImages);
+
+    // Set flat image list (for Ctrl+O / drag-drop / command-line); the
+    // grouped library stays for ShowLibrary
     void SetImages(const std::vector<std::filesystem::path>& paths);
+    // Back from a flat list to the grouped library
+    void ShowLibrary();
+
+    // Photos tab images in display order (built on demand after a change)
+    const std::vector<std::filesystem::path>& GetImages() const { return Photos().Paths(); }
+    size_t GetImageCount() const { return Photos().Size(); }
+
+    // The grouped library: SetImagesGrouped plus batches and live changes
+    std::vector<Core::ScannedImage> GetScannedImages() const { return library_.Images(); }
+    size_t GetLibraryCount() const { return library_.Size(); }
 
-    const std::vector<std::filesystem::path>& GetImages() const { return images_; }
+    // Live library changes (LibraryWatcher): drops every image at or below
+    // a `removed` path and every image an `added` one replaces, then merges
+    // `added` in date order. Sections, albums and an open folder follow;
+    // the scroll position stays. Returns the ids of the images dropped.
+    std::vector<Core::ImageId> ApplyLibraryChanges(std::vector<Core::ScannedImage> added,
+                                                   const std::vector<std::filesystem::path>& removed);
+
+    // Drops the library images directly in `folder` (a hidden album)
+    void RemoveAlbum(const std::filesystem::path& folder);
 
     // Get the currently active image list (Photos tab: all, FolderDetail: filtered)
     const std::vector<std::filesystem::path>& GetActiveImages() const;
@@ -93,12 +121,6 @@ public:
     void SetFolderVisitCallback(std::function<void(const std::filesystem::path&)> cb);
 
     // Public types needed by rendering helpers
-    struct Section {
-        std::wstring title;
-        size_t startIndex = 0;
-        size_t count = 0;
-    };
-
     struct GridLayout {
         int columns;
         float cellSize;
@@ -123,11 +145,32 @@ public:
 
     static std::wstring FormatNumber(size_t n);
 
+    // Where a model's section sits in the grid (from its row prefix sums)
+    static SectionLayoutInfo SectionLayout(const Core::GalleryModel& model, size_t section,
+                                           const GridLayout& grid);
+    // World-space height of a model's whole grid
+    static float GridHeight(const Core::GalleryModel& model, const GridLayout& grid);
+
+    struct GridPosition {
+        size_t section;  // < SectionCount() unless the model is empty
+        int row;         // within the section; rows >= its count lie below it
+    };
+    // Section and row at world-space y, in O(log S): the first row for a y
+    // in a section header, and back through SectionLayout
+    static GridPosition GridPositionAt(const Core::GalleryModel& model, float y,
+                                       const GridLayout& grid);
+
 private:
 
+    // The Photos tab: the grouped library, or a list opened by hand
+    const Core::GalleryModel& Photos() const { return showingList_ ? list_ : library_; }
+    // After library_ changed: albums, and an open folder, follow it
+    void OnLibraryChanged();
+    // Edit mode: one jiggle phase per album card after the albums changed
+    void ResetJigglePhases();
+
     GridLayout CalculateGridLayout(float viewWidth) const;
     AlbumGridLayout CalculateAlbumGridLayout(float viewWidth) const;
-    void ComputeSectionLayouts(const GridLayout& grid) const;
 
     // Rendering sub-methods
     void RenderPhotosTab(Rendering::Direct2DRenderer* renderer, ID2D1DeviceContext* ctx,
@@ -150,12 +193,16 @@ private:
     void GenerateDisplacementMap(ID2D1DeviceContext* ctx, float width, float height, float cornerRadius);
 
     // Albums helpers
-    void BuildFolderAlbums(const std::vector<Core::ScannedImage>& scannedImages);
+    void BuildFolderAlbums();  // from library_'s folders
     void EnterFolderDetail(size_t albumIndex);
+    void FillFolderDetail(const FolderAlbum& album);  // folderDetail_ from library_
     void ExitFolderDetail();
 
-    // Folder detail section layout helpers
-    void ComputeFolderDetailSectionLayouts(const GridLayout& grid) const;
+    // Content offset where a fast fling on `spring` will come to rest
+    // (closed-form spring prediction, clamped like the rubber band does);
+    // nullopt while dragging or below the fast-scroll threshold
+    std::optional<float> PredictScrollLanding(const Animation::SpringAnimation& spring,
+                                              float maxScroll) const;
 
     // Tab state
     GalleryTab activeTab_ = GalleryTab::Photos;
@@ -179,12 +226,13 @@ private:
     float maxScroll_ = 0.0f;
 
     // Data
-    std::vector<std::filesystem::path> images_;   // Flat list of all image paths
-    std::vector<Section> sections_;                // Grouped sections
+    Core::GalleryModel library_;   // Date sections of the scanned library
+    Core::GalleryModel list_;      // Flat list opened by hand (SetImages)
+    bool showingList_ = false;
+    std::wstring listTitle_;       // list_'s one section header
 
     // Folder albums data
     std::vector<FolderAlbum> folderAlbums_;
-    std::vector<Core::ScannedImage> allScannedImages_;  // Keep for folder detail filtering
 
     // Albums tab scrolling
     Animation::SpringAnimation albumsScrollY_;
@@ -193,12 +241,9 @@ private:
     // Folder detail mode
     bool inFolderDetail_ = false;
     size_t openFolderIndex_ = 0;
-    std::vector<std::filesystem::path> folderDetailImages_;
-    std::vector<Section> folderDetailSections_;
+    Core::GalleryModel folderDetail_;  // The open album's images
     Animation::SpringAnimation folderDetailScrollY_;
     float folderDetailMaxScroll_ = 0.0f;
-    mutable std::vector<SectionLayoutInfo> folderDetailSectionLayouts_;
-    mutable float folderDetailCachedTotalHeight_ = 0.0f;
 
     // Folder detail navigation transition
     Animation::SpringAnimation folderSlide_;  // 0=albums grid, 1=folder detail
@@ -211,9 +256,7 @@ private:
     Core::ImagePipeline* pipeline_ = nullptr;
     Animation::AnimationEngine* engine_ = nullptr;
 
-    // Section layouts (cached)
-    mutable std::vector<SectionLayoutInfo> sectionLayouts_;
-    mutable float cachedTotalHeight_ = 0.0f;
+    // Grid layout (cached)
     mutable float cachedLayoutWidth_ = 0.0f;
     mutable GridLayout cachedGrid_ = {};
 
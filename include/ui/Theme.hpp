@@ -95,9 +95,11 @@ namespace Theme {
     constexpr int MaxBitmapsPerFrame = 64;               // max GPU uploads (D2D bitmap creation) per frame
     constexpr int PersistSyncBudgetPerFrame = 200;       // max synchronous disk→GPU loads per frame
     constexpr int ThumbnailWorkerThreads = 4;            // background decode threads
-    constexpr size_t ThumbnailCacheMaxBytes = 1024ULL * 1024 * 1024;  // 1GB LRU eviction threshold
+    constexpr int ScanWorkerThreads = 8;                 // parallel directory listing threads (I/O-latency bound)
+    constexpr size_t ThumbnailMemoryBudgetBytes = 2048ULL * 1024 * 1024;  // 2GB: GPU thumbnails + CPU pixels + Tier 2
     constexpr uint32_t ThumbnailMaxPx = 160;                         // max thumbnail decode resolution (px)
     constexpr float PrefetchScreens = 3.0f;              // prefetch N screens above/below viewport
+    constexpr float LandingPrefetchScreens = 0.5f;       // during a fling, decode N screens around its predicted rest point
     constexpr float ContentBudgetMs = 12.0f;              // max ms for content rendering (reserves time for glass overlays)
     constexpr int BudgetCheckInterval = 16;                // check budget every N cells (amortize QueryPerformanceCounter)
 
@@ -71,6 +71,78 @@ void SpringAnimation::SnapToTarget()
     finished_ = true;
 }
 
+float SpringAnimation::PredictValue(float seconds) const
+{
+    if (finished_ || seconds <= 0.0f) {
+        return value_;
+    }
+
+    // Damped harmonic oscillator x'' + 2*zeta*w0*x' + w0^2*x = 0, with x the
+    // displacement from the target
+    const float x0 = value_ - target_;
+    const float v0 = velocity_;
+    const float w0 = std::sqrt(config_.stiffness / config_.mass);
+    const float zeta = config_.damping / (2.0f * std::sqrt(config_.stiffness * config_.mass));
+
+    float x;
+    if (zeta < 0.999f) {
+        // Underdamped: decaying oscillation
+        const float wd = w0 * std::sqrt(1.0f - zeta * zeta);
+        const float b = (v0 + zeta * w0 * x0) / wd;
+        x = std::exp(-zeta * w0 * seconds) *
+            (x0 * std::cos(wd * seconds) + b * std::sin(wd * seconds));
+    } else if (zeta <= 1.001f) {
+        // Critically damped
+        x = std::exp(-w0 * seconds) * (x0 + (v0 + w0 * x0) * seconds);
+    } else {
+        // Overdamped: sum of two decaying exponentials
+        const float root = w0 * std::sqrt(zeta * zeta - 1.0f);
+        const float r1 = -zeta * w0 + root;
+        const float r2 = -zeta * w0 - root;
+        const float c1 = (v0 - r2 * x0) / (r1 - r2);
+        x = c1 * std::exp(r1 * seconds) + (x0 - c1) * std::exp(r2 * seconds);
+    }
+    return target_ + x;
+}
+
+float SpringAnimation::PredictSettleTime() const
+{
+    if (finished_) {
+        return 0.0f;
+    }
+
+    const float x0 = value_ - target_;
+    const float v0 = velocity_;
+    const float w0 = std::sqrt(config_.stiffness / config_.mass);
+    const float zeta = config_.damping / (2.0f * std::sqrt(config_.stiffness * config_.mass));
+
+    // Amplitude * exp(-rate * t) bounds |x(t)|; solve for restThreshold
+    float rate;
+    float amplitude;
+    if (zeta < 0.999f) {
+        const float wd = w0 * std::sqrt(1.0f - zeta * zeta);
+        const float b = (v0 + zeta * w0 * x0) / wd;
+        rate = zeta * w0;
+        amplitude = std::sqrt(x0 * x0 + b * b);
+    } else if (zeta <= 1.001f) {
+        // t * exp(-w0 * t) <= (2 / w0) * exp(-w0 * t / 2)
+        rate = w0 * 0.5f;
+        amplitude = std::abs(x0) + std::abs(v0 + w0 * x0) / rate;
+    } else {
+        // The slower exponential dominates
+        const float root = w0 * std::sqrt(zeta * zeta - 1.0f);
+        const float r1 = -zeta * w0 + root;
+        const float r2 = -zeta * w0 - root;
+        const float c1 = (v0 - r2 * x0) / (r1 - r2);
+        rate = -r1;
+        amplitude = std::abs(c1) + std::abs(x0 - c1);
+    }
+    if (amplitude <= config_.restThreshold || rate <= 0.0f) {
+        return 0.0f;
+    }
+    return std::log(amplitude / config_.restThreshold) / rate;
+}
+
 // SpringAnimation2D
 
 SpringAnimation2D::SpringAnimation2D(const SpringConfig& config)
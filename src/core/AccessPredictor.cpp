@@ -0,0 +1,179 @@
+#include "core/AccessPredictor.hpp"
+#include <algorithm>
+
+namespace UltraImageViewer {
+namespace Core {
+
+void AccessPredictor::Successors::Add(uint32_t to)
+{
+    Edge* slot = nullptr;
+    for (auto& e : edges) {
+        if (e.count > 0 && e.to == to) {
+            slot = &e;
+            break;
+        }
+    }
+    if (!slot) {
+        // Replace the weakest edge (empty edges have count 0)
+        slot = std::min_element(std::begin(edges), std::end(edges),
+            [](const Edge& a, const Edge& b) { return a.count < b.count; });
+        total -= slot->count;
+        *slot = Edge{to, 0};
+    }
+    ++slot->count;
+    ++total;
+
+    if (total > kDecayThreshold) {
+        total = 0;
+        for (auto& e : edges) {
+            e.count /= 2;
+            total += e.count;
+        }
+    }
+}
+
+AccessPredictor::AccessPredictor(const PathInterner* interner, const Config& config)
+    : interner_(interner)
+    , config_(config)
+{
+    Reset();
+}
+
+void AccessPredictor::Reset()
+{
+    last_ = kInvalidImageId;
+    imageSuccessors_.clear();
+    folderSuccessors_.clear();
+    folderLastSeen_.clear();
+    switchCount_ = 0;
+    transitionCount_ = 0;
+
+    // Prior: paging forward, sometimes back, until real transitions arrive
+    deltaCounts_.assign(static_cast<size_t>(config_.deltaRange) * 2 + 1, 0);
+    deltaCounts_[config_.deltaRange + 1] = 2;
+    deltaCounts_[config_.deltaRange - 1] = 1;
+    deltaTotal_ = 3;
+}
+
+uint32_t AccessPredictor::FolderOf(ImageId id)
+{
+    uint32_t& folder = folderOf_[id];
+    if (folder == kNoFolder) {
+        auto parent = interner_->Path(id).parent_path();
+        auto [it, inserted] = folderIds_.try_emplace(parent.native(),
+            static_cast<uint32_t>(folderIds_.size() + 1));
+        folder = it->second;
+    }
+    return folder;
+}
+
+uint32_t AccessPredictor::FolderOfKnown(ImageId id) const
+{
+    const uint32_t* folder = folderOf_.Find(id);
+    return folder ? *folder : kNoFolder;
+}
+
+void AccessPredictor::Record(ImageId id)
+{
+    if (id == kInvalidImageId || id >= interner_->Size()) return;
+
+    uint32_t folder = FolderOf(id);
+    if (last_ != kInvalidImageId && last_ != id) {
+        ++transitionCount_;
+        imageSuccessors_[last_].Add(id);
+
+        uint32_t lastFolder = FolderOfKnown(last_);
+        if (lastFolder != folder) {
+            ++switchCount_;
+            folderSuccessors_[lastFolder].Add(folder);
+        } else {
+            int64_t delta = static_cast<int64_t>(id) - static_cast<int64_t>(last_);
+            if (delta >= -config_.deltaRange && delta <= config_.deltaRange) {
+                ++deltaCounts_[delta + config_.deltaRange];
+            }
+            ++deltaTotal_;  // long in-folder jumps dilute the paging model
+        }
+
+        if (transitionCount_ > kDecayThreshold) {
+            transitionCount_ /= 2;
+            switchCount_ /= 2;
+        }
+        if (deltaTotal_ > kDecayThreshold) {
+            uint32_t tracked = 0;
+            for (auto& c : deltaCounts_) {
+                c /= 2;
+                tracked += c;
+            }
+            deltaTotal_ = std::max(deltaTotal_ / 2, tracked);
+        }
+    }
+
+    folderLastSeen_[folder] = id;
+    last_ = id;
+}
+
+std::vector<AccessPredictor::Prediction> AccessPredictor::Predict(ImageId from,
+                                                                  size_t maxCount) const
+{
+    std::vector<Prediction> out;
+    if (from == kInvalidImageId || maxCount == 0) return out;
+
+    auto add = [&](ImageId id, float p) {
+        if (id == from || p <= 0.0f) return;
+        for (auto& o : out) {
+            if (o.id == id) {
+                o.probability += p;
+                return;
+            }
+        }
+        out.push_back({id, p});
+    };
+
+    // Per-image evidence: trust grows with the number of observed exits
+    float rest = 1.0f;
+    if (auto it = imageSuccessors_.find(from); it != imageSuccessors_.end() && it->second.total > 0) {
+        const auto& s = it->second;
+        float weight = static_cast<float>(s.total) / (s.total + 2.0f);
+        for (const auto& e : s.edges) {
+            if (e.count > 0) add(e.to, weight * e.count / s.total);
+        }
+        rest -= weight;
+    }
+
+    // Share of transitions that leave the folder (with a small prior)
+    float pSwitch = (switchCount_ + 1.0f) / (transitionCount_ + 4.0f);
+    uint32_t fromFolder = FolderOfKnown(from);
+
+    // Paging within the folder
+    size_t known = interner_->Size();
+    for (int d = -config_.deltaRange; d <= config_.deltaRange; ++d) {
+        uint32_t c = deltaCounts_[d + config_.deltaRange];
+        if (c == 0 || d == 0) continue;
+        int64_t target = static_cast<int64_t>(from) + d;
+        if (target < 0 || static_cast<size_t>(target) >= known) continue;
+        uint32_t targetFolder = FolderOfKnown(static_cast<ImageId>(target));
+        if (fromFolder != kNoFolder && targetFolder != kNoFolder && targetFolder != fromFolder) continue;
+        add(static_cast<ImageId>(target), rest * (1.0f - pSwitch) * c / deltaTotal_);
+    }
+
+    // Switching folders: resume where the user left the destination
+    if (auto it = folderSuccessors_.find(fromFolder); it != folderSuccessors_.end() && it->second.total > 0) {
+        const auto& s = it->second;
+        for (const auto& e : s.edges) {
+            if (e.count == 0) continue;
+            auto last = folderLastSeen_.find(e.to);
+            if (last != folderLastSeen_.end()) {
+                add(last->second, rest * pSwitch * e.count / s.total);
+            }
+        }
+    }
+
+    std::erase_if(out, [&](const Prediction& p) { return p.probability < config_.minProbability; });
+    std::sort(out.begin(), out.end(),
+              [](const Prediction& a, const Prediction& b) { return a.probability > b.probability; });
+    if (out.size() > maxCount) out.resize(maxCount);
+    return out;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
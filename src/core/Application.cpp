@@ -103,6 +103,13 @@ void Application::Shutdown()
         thumbSaveThread_.join();
     }
 
+    // Stop live library updates; keep what they changed for the next launch
+    libraryWatcher_.reset();
+    if (scanCacheDirty_ && viewManager_) {
+        SaveScanCache(viewManager_->GetGalleryView()->GetScannedImages());
+        scanCacheDirty_ = false;
+    }
+
     // Final save of persistent thumbnail cache (captures thumbnails decoded since last scan)
     if (pipeline_) {
         auto thumbPath = GetScanCachePath().parent_path() / L"scan_thumbs.bin";
@@ -261,6 +268,13 @@ void Application::StartFullScan()
     scanDirty_ = false;
     lastGalleryUpdateCount_ = 0;
     lastDisplayedScanCount_ = 0;
+    {
+        std::lock_guard lock(scanMutex_);
+        scanBatches_.clear();
+    }
+
+    // The scan picks up everything since; its own watcher takes over after
+    libraryWatcher_.reset();
 
     // Update gallery scanning state
     if (viewManager_) {
@@ -329,9 +343,33 @@ void Application::StartFullScan()
         SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
 
         try {
-            // No intermediate flush — gallery is frozen during scan, one-shot rebuild at end
+            // Directory index from the last completed scan: unchanged
+            // directories are not listed again
+            auto cachePath = GetScanCachePath();
+            auto indexPath = cachePath.empty() ? cachePath
+                                               : cachePath.parent_path() / L"scan_index.bin";
+            DirectoryIndex index;
+            if (!indexPath.empty() && index.Load(indexPath)) {
+                DebugLog(("Scan index: " + std::to_string(index.DirectoryCount()) +
+                          " directories").c_str());
+            }
+
+            // Watch before walking: changes made during the walk queue up
+            // and are applied once the results are shown
+            auto watcher = std::make_unique<LibraryWatcher>(folders, ImagePipeline::LibraryScanConfig());
+            if (!watcher->IsWatching()) DebugLog("Library watcher: not all folders are watched");
+
+            // Photos stream into the gallery as they are found; the UI
+            // thread merges each batch (CheckScanProgress)
             auto results = ImagePipeline::ScanFolders(
-                folders, scanCancelled_, scanProgress_, nullptr);
+                folders, scanCancelled_, scanProgress_,
+                [this](const std::vector<ScannedImage>& batch) {
+                    std::lock_guard lock(scanMutex_);
+                    scanBatches_.insert(scanBatches_.end(), batch.begin(), batch.end());
+                },
+                &index);
+
+            if (!scanCancelled_ && !indexPath.empty()) index.Save(indexPath);
 
             DebugLog(("Scan found " + std::to_string(results.size()) + " images").c_str());
 
@@ -339,6 +377,10 @@ void Application::StartFullScan()
             {
                 std::lock_guard lock(scanMutex_);
                 scannedResults_ = std::move(results);
+                if (!scanCancelled_) {
+                    scannedWatcher_ = std::move(watcher);
+                    scannedFolders_ = folders;
+                }
             }
             // Set isScanning_ BEFORE scanDirty_ to avoid race:
             // CheckScanProgress must see isScanning_==false when it consumes scanDirty_,
@@ -362,7 +404,7 @@ void Application::CheckScanProgress()
 
     auto* gallery = viewManager_->GetGalleryView();
 
-    // --- During scan: only update the progress counter for the blue bar animation ---
+    // --- During scan: merge the photos found so far, update the progress counter ---
     if (isScanning_) {
         size_t current = scanProgress_.load();
         if (current != lastDisplayedScanCount_) {
@@ -370,16 +412,37 @@ void Application::CheckScanProgress()
             lastDisplayedScanCount_ = current;
             needsRender_ = true;
         }
-        return;  // Do NOT touch gallery data until scan completes
+
+        std::vector<ScannedImage> batch;
+        {
+            std::lock_guard lock(scanMutex_);
+            batch.swap(scanBatches_);
+        }
+        FilterHiddenAlbums(batch);
+        if (!batch.empty()) {
+            gallery->AddScannedImages(std::move(batch));
+            lastGalleryUpdateCount_ = gallery->GetLibraryCount();
+            if (!inManualOpen_) {
+                std::wstring title = windowTitle_ + L" - " +
+                    std::to_wstring(lastGalleryUpdateCount_) + L" photos";
+                SetWindowTextW(hwnd_, title.c_str());
+            }
+            needsRender_ = true;
+        }
+        return;
     }
 
-    // --- ONE-SHOT rebuild when scan finishes ---
+    // --- Scan finished: the complete result replaces what streamed in ---
     if (scanDirty_.exchange(false)) {
         std::vector<ScannedImage> results;
         {
             std::lock_guard lock(scanMutex_);
             results = std::move(scannedResults_);
+            scanBatches_.clear();
+            libraryWatcher_ = std::move(scannedWatcher_);
+            watchedFolders_ = std::move(scannedFolders_);
         }
+        scanCacheDirty_ = false;
 
         // Filter out user-hidden albums before display
         FilterHiddenAlbums(results);
@@ -410,7 +473,9 @@ void Application::CheckScanProgress()
             skipThumbSave:;
         }
 
-        gallery->SetImagesGrouped(results);
+        // Only what differs from the streamed batches (and the cache shown
+        // before them) changes
+        gallery->SyncScannedImages(results);
 
         // Update flat image list for viewer compatibility
         currentImages_.clear();
@@ -427,6 +492,59 @@ void Application::CheckScanProgress()
 
         needsRender_ = true;
     }
+
+    // --- Between scans: files added, removed or renamed under the folders ---
+    // (held back while a manually opened folder replaces the library)
+    if (libraryWatcher_ && !inManualOpen_ && libraryWatcher_->HasChanges()) {
+        ApplyLibraryChanges(libraryWatcher_->TakeChanges());
+    }
+}
+
+void Application::ApplyLibraryChanges(LibraryChanges changes)
+{
+    if (changes.rescan) {
+        // Events were lost; the directory index keeps the rescan incremental
+        DebugLog("Library watcher overflowed: rescanning");
+        StartFullScan();
+        return;
+    }
+
+    std::vector<ScannedImage> added;
+    added.reserve(changes.added.size());
+    for (const auto& entry : changes.added) {
+        added.push_back(ImagePipeline::ToScannedImage(entry, watchedFolders_));
+    }
+    FilterHiddenAlbums(added);
+
+    auto* gallery = viewManager_->GetGalleryView();
+    auto dropped = gallery->ApplyLibraryChanges(std::move(added), changes.removed);
+
+    // Thumbnails: a moved photo keeps its own; removed and rewritten files
+    // lose theirs, in memory and in scan_thumbs.bin
+    if (pipeline_) {
+        auto& interner = PathInterner::Global();
+        std::unordered_set<ImageId> moved;
+        for (const auto& [from, to] : changes.renamed) {
+            ImageId toId = interner.Intern(to);
+            pipeline_->MoveThumbnail(interner.Intern(from), toId);
+            moved.insert(toId);
+        }
+        std::erase_if(dropped, [&](ImageId id) { return moved.contains(id); });
+        pipeline_->ForgetThumbnails(dropped);
+    }
+
+    const auto& images = gallery->GetImages();
+    currentImages_.assign(images.begin(), images.end());
+    scanCacheDirty_ = true;
+
+    std::wstring title = windowTitle_ + L" - " +
+        std::to_wstring(images.size()) + L" photos";
+    SetWindowTextW(hwnd_, title.c_str());
+
+    DebugLog(("Library changes: " + std::to_string(changes.added.size()) + " added, " +
+              std::to_string(changes.removed.size()) + " removed, " +
+              std::to_string(changes.renamed.size()) + " renamed").c_str());
+    needsRender_ = true;
 }
 
 bool Application::InitializeWindow()
@@ -909,21 +1027,14 @@ void Application::RestoreScanGallery()
         viewManager_->GetGalleryView()->SetManualOpenMode(false);
     }
 
-    // Try to restore from cached scan results
-    std::vector<ScannedImage> results;
-    {
-        std::lock_guard lock(scanMutex_);
-        results = scannedResults_;
-    }
-
-    if (!results.empty() && viewManager_) {
-        viewManager_->GetGalleryView()->SetImagesGrouped(results);
-        currentImages_.clear();
-        for (const auto& img : results) {
-            currentImages_.push_back(img.path);
-        }
+    // The library is still in the gallery behind the opened list
+    auto* gallery = viewManager_ ? viewManager_->GetGalleryView() : nullptr;
+    if (gallery && gallery->GetLibraryCount() > 0) {
+        gallery->ShowLibrary();
+        const auto& images = gallery->GetImages();
+        currentImages_.assign(images.begin(), images.end());
         std::wstring title = windowTitle_ + L" - " +
-            std::to_wstring(results.size()) + L" photos";
+            std::to_wstring(images.size()) + L" photos";
         SetWindowTextW(hwnd_, title.c_str());
     } else {
         // No cached results — start a fresh scan
@@ -1152,39 +1263,22 @@ void Application::RemoveAlbumFolder(const std::filesystem::path& albumPath)
     hiddenAlbumPaths_.push_back(albumPath);
     SaveHiddenAlbums();
 
-    // --- 2. In-memory surgery: erase images whose parent == albumPath ---
-    std::wstring albumLower = albumPath.wstring();
-    Simd::ToLowerInPlace(albumLower);
+    if (!viewManager_) return;
+    auto* gallery = viewManager_->GetGalleryView();
 
-    std::vector<ScannedImage> results;
-    {
-        std::lock_guard lock(scanMutex_);
-        scannedResults_.erase(
-            std::remove_if(scannedResults_.begin(), scannedResults_.end(),
-                [&albumLower](const ScannedImage& img) {
-                    std::wstring p = img.path.parent_path().wstring();
-                    Simd::ToLowerInPlace(p);
-                    return p == albumLower;
-                }),
-            scannedResults_.end());
-        results = scannedResults_;
-    }
-
-    // --- 3. Push pruned data to gallery (rebuilds Photos + Albums) ---
-    if (viewManager_)
-        viewManager_->GetGalleryView()->SetImagesGrouped(results);
-
-    // --- 4. Update flat image list ---
-    currentImages_.clear();
-    currentImages_.reserve(results.size());
-    for (const auto& img : results)
-        currentImages_.push_back(img.path);
+    // --- 2. Remove the images directly in the folder (Photos + Albums follow) ---
+    gallery->RemoveAlbum(albumPath);
+
+    // --- 3. Update flat image list ---
+    const auto& images = gallery->GetImages();
+    currentImages_.assign(images.begin(), images.end());
 
     SetWindowTextW(hwnd_, (windowTitle_ + L" - " +
-        std::to_wstring(results.size()) + L" photos").c_str());
+        std::to_wstring(images.size()) + L" photos").c_str());
 
-    // --- 5. Persist pruned scan cache ---
-    SaveScanCache(results);
+    // --- 4. Persist pruned scan cache ---
+    SaveScanCache(gallery->GetScannedImages());
+    scanCacheDirty_ = false;
 
     needsRender_ = true;
 }
@@ -1406,6 +1500,7 @@ std::vector<ScannedImage> Application::LoadScanCache()
 
             ScannedImage img;
             img.path = std::wstring(pathChars, pathLen);
+            img.id = PathInterner::Global().Intern(img.path);
             img.year = year;
             img.month = month;
             results.push_back(std::move(img));
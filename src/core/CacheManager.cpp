@@ -1,10 +1,12 @@
 #include "core/CacheManager.hpp"
+#include <algorithm>
 
 namespace UltraImageViewer {
 namespace Core {
 
 CacheManager::CacheManager(size_t maxSizeBytes)
     : maxSizeBytes_(maxSizeBytes)
+    , predictor_(&PathInterner::Global(), AccessPredictor::Config{})
 {
 }
 
@@ -28,13 +30,25 @@ std::shared_ptr<DecodedImage> CacheManager::Get(const std::filesystem::path& pat
     it->second->lastAccess = std::chrono::steady_clock::now();
     it->second->accessCount++;
 
+    // First use of a prefetched entry: the prediction paid off
+    if (it->second->isPrefetched) {
+        it->second->isPrefetched = false;
+        prefetchUnusedBytes_ -= it->second->sizeBytes;
+        predictionHitCount_++;
+    }
+
     return it->second->image;
 }
 
 void CacheManager::Put(const std::filesystem::path& path, std::shared_ptr<DecodedImage> image)
 {
     std::unique_lock lock(mutex_);
+    PutLocked(path, std::move(image), false);
+}
 
+void CacheManager::PutLocked(const std::filesystem::path& path,
+                             std::shared_ptr<DecodedImage> image, bool prefetched)
+{
     // Check if already in cache
     auto existing = cacheIndex_.find(path);
     if (existing != cacheIndex_.end()) {
@@ -53,9 +67,14 @@ void CacheManager::Put(const std::filesystem::path& path, std::shared_ptr<Decode
     entry.image = std::move(image);
     entry.path = path;
     entry.lastAccess = std::chrono::steady_clock::now();
-    entry.accessCount = 1;
+    entry.accessCount = prefetched ? 0 : 1;
     entry.sizeBytes = entrySize;
-    entry.isPrefetched = false;
+    entry.isPrefetched = prefetched;
+    if (prefetched) {
+        entry.prefetchTime = entry.lastAccess;
+        prefetchUnusedBytes_ += entrySize;
+        prefetchCount_++;
+    }
 
     lruList_.push_front(std::move(entry));
     cacheIndex_[path] = lruList_.begin();
@@ -63,14 +82,67 @@ void CacheManager::Put(const std::filesystem::path& path, std::shared_ptr<Decode
     currentSizeBytes_ += entrySize;
 }
 
+void CacheManager::SetPrefetchExecutor(ThreadPool* pool, PrefetchLoader loader)
+{
+    std::unique_lock lock(mutex_);
+    prefetchPool_ = pool;
+    prefetchLoader_ = pool ? std::move(loader) : nullptr;
+    prefetchInFlight_.clear();
+}
+
 void CacheManager::Prefetch(const std::filesystem::path& path)
 {
-    // TODO: Implement async pre-fetching
+    PrefetchBatch({path});
 }
 
 void CacheManager::PrefetchBatch(const std::vector<std::filesystem::path>& paths)
 {
-    // TODO: Implement batch pre-fetching
+    // `paths` is the current prediction, most likely first
+    std::unique_lock lock(mutex_);
+    if (!prefetchEnabled_ || !prefetchPool_ || !prefetchLoader_) return;
+
+    for (const auto& path : paths) {
+        if (cacheIndex_.contains(path) || prefetchInFlight_.contains(path)) continue;
+
+        // Bounded speculation: unused prefetches may hold a quarter of the
+        // cache. Make room by dropping guesses that are no longer predicted;
+        // if only current ones remain, stop.
+        if (!DropStalePrefetches(maxSizeBytes_ / 4, paths)) return;
+
+        prefetchInFlight_.insert(path);
+        prefetchPool_->Submit([this, path] { RunPrefetch(path); }, TaskPriority::Low);
+    }
+}
+
+bool CacheManager::DropStalePrefetches(size_t limit, const std::vector<std::filesystem::path>& keep)
+{
+    for (auto it = lruList_.end(); prefetchUnusedBytes_ >= limit && it != lruList_.begin();) {
+        --it;
+        if (!it->isPrefetched ||
+            std::find(keep.begin(), keep.end(), it->path) != keep.end()) continue;
+        OnEntryRemoved(*it);
+        currentSizeBytes_ -= it->sizeBytes;
+        cacheIndex_.erase(it->path);
+        it = lruList_.erase(it);
+    }
+    return prefetchUnusedBytes_ < limit;
+}
+
+void CacheManager::RunPrefetch(const std::filesystem::path& path)
+{
+    PrefetchLoader loader;
+    {
+        std::shared_lock lock(mutex_);
+        loader = prefetchLoader_;
+    }
+
+    std::shared_ptr<DecodedImage> image = loader ? loader(path) : nullptr;
+
+    std::unique_lock lock(mutex_);
+    prefetchInFlight_.erase(path);
+    if (image && image->data) {
+        PutLocked(path, std::move(image), true);
+    }
 }
 
 void CacheManager::Remove(const std::filesystem::path& path)
@@ -79,6 +151,7 @@ void CacheManager::Remove(const std::filesystem::path& path)
 
     auto it = cacheIndex_.find(path);
     if (it != cacheIndex_.end()) {
+        OnEntryRemoved(*it->second);
         currentSizeBytes_ -= it->second->sizeBytes;
         lruList_.erase(it->second);
         cacheIndex_.erase(it);
@@ -88,6 +161,9 @@ void CacheManager::Remove(const std::filesystem::path& path)
 void CacheManager::Clear()
 {
     std::unique_lock lock(mutex_);
+    for (const auto& entry : lruList_) {
+        OnEntryRemoved(entry);
+    }
     lruList_.clear();
     cacheIndex_.clear();
     currentSizeBytes_ = 0;
@@ -102,6 +178,8 @@ CacheManager::CacheStats CacheManager::GetStats() const
     stats.missCount = missCount_;
     stats.evictionCount = evictionCount_;
     stats.prefetchCount = prefetchCount_;
+    stats.predictionHitCount = predictionHitCount_;
+    stats.wastedPrefetchBytes = wastedPrefetchBytes_;
     stats.currentSizeBytes = currentSizeBytes_;
     stats.maxSizeBytes = maxSizeBytes_;
 
@@ -109,6 +187,9 @@ CacheManager::CacheStats CacheManager::GetStats() const
     if (total > 0) {
         stats.hitRate = static_cast<double>(hitCount_) / total;
     }
+    if (prefetchCount_ > 0) {
+        stats.predictionHitRate = static_cast<double>(predictionHitCount_) / prefetchCount_;
+    }
 
     return stats;
 }
@@ -122,8 +203,15 @@ void CacheManager::Resize(size_t newSizeBytes)
 
 void CacheManager::RecordAccess(const std::filesystem::path& path)
 {
-    std::unique_lock lock(mutex_);
-    accessHistory_[path]++;
+    std::vector<std::filesystem::path> predicted;
+    {
+        std::unique_lock lock(mutex_);
+        predictor_.Record(PathInterner::Global().Intern(path));
+        if (prefetchEnabled_ && prefetchPool_) {
+            predicted = PredictNextAccesses(path);
+        }
+    }
+    PrefetchBatch(predicted);
 }
 
 void CacheManager::EvictIfNeeded()
@@ -133,17 +221,33 @@ void CacheManager::EvictIfNeeded()
     }
 
     auto& entry = lruList_.back();
+    OnEntryRemoved(entry);
     currentSizeBytes_ -= entry.sizeBytes;
     cacheIndex_.erase(entry.path);
     lruList_.pop_back();
     evictionCount_++;
 }
 
+void CacheManager::OnEntryRemoved(const CacheEntry& entry)
+{
+    if (entry.isPrefetched) {
+        prefetchUnusedBytes_ -= entry.sizeBytes;
+        wastedPrefetchBytes_ += entry.sizeBytes;
+    }
+}
+
 std::vector<std::filesystem::path> CacheManager::PredictNextAccesses(
     const std::filesystem::path& currentPath)
 {
-    // TODO: Implement access pattern prediction
-    return {};
+    auto& interner = PathInterner::Global();
+    ImageId current = interner.Find(currentPath);
+
+    std::vector<std::filesystem::path> result;
+    for (const auto& p : predictor_.Predict(current, kMaxPredictions)) {
+        const auto& path = interner.Path(p.id);
+        if (!cacheIndex_.contains(path)) result.push_back(path);
+    }
+    return result;
 }
 
 size_t CacheManager::CalculateEntrySize(const DecodedImage& image)
@@ -0,0 +1,885 @@
+#include "core/DirectoryScanner.hpp"
+#include "core/Platform.hpp"
+#include "core/SimdUtils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+using NameString = std::filesystem::path::string_type;
+using NameChar = std::filesystem::path::value_type;
+
+constexpr NameChar kSeparator = std::filesystem::path::preferred_separator;
+
+enum class EntryKind { File, Directory, Other };
+
+NameString JoinPath(const NameString& dir, const NameChar* name)
+{
+    NameString path = dir;
+    if (!path.empty() && path.back() != kSeparator) path += kSeparator;
+    path += name;
+    return path;
+}
+
+// `path` lies strictly below directory `dir` (both normalized)
+bool IsBelow(const NameString& path, const NameString& dir)
+{
+    if (path.size() <= dir.size() || path.compare(0, dir.size(), dir) != 0) return false;
+    return dir.back() == kSeparator || path[dir.size()] == kSeparator;
+}
+
+// Comparable form of a directory path: lexically normal, no trailing
+// separator, case-folded where the filesystem is case-insensitive
+NameString DirectoryKey(const NameString& dir)
+{
+    NameString key = dir;
+#ifdef _WIN32
+    Simd::ToLowerInPlace(key);
+#endif
+    return key;
+}
+
+NameString NormalizeRoot(const std::filesystem::path& root)
+{
+    NameString path = root.lexically_normal().native();
+    // Keep the separator of a filesystem root ("/", "C:\")
+    while (path.size() > 1 && path.back() == kSeparator &&
+           path[path.size() - 2] != kSeparator && path[path.size() - 2] != NameChar(':')) {
+        path.pop_back();
+    }
+    return path;
+}
+
+// Stored in the index file, so it must not change between builds (FNV-1a)
+class StableHash {
+public:
+    void Add(const void* data, size_t size)
+    {
+        const auto* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) hash_ = (hash_ ^ p[i]) * 0x100000001B3ULL;
+    }
+    void Add(const NameString& s)
+    {
+        uint64_t length = s.size();
+        Add(&length, sizeof(length));
+        Add(s.data(), s.size() * sizeof(NameChar));
+    }
+    uint64_t Value() const { return hash_; }
+
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ULL;
+};
+
+int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+#ifdef _WIN32
+
+// Last write time of a directory, ns since the Unix epoch
+bool DirectoryModifiedTime(const NameString& dir, int64_t& modifiedTime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(dir.c_str(), GetFileExInfoStandard, &data)) return false;
+    uint64_t ticks = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                     data.ftLastWriteTime.dwLowDateTime;
+    modifiedTime = (static_cast<int64_t>(ticks) - 116444736000000000LL) * 100;
+    return true;
+}
+
+// Size and last write time of one file, as DirectoryListing::FileInfo
+bool FileInfoAt(const NameString& path, uint64_t& size, int64_t& modifiedTime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return false;
+    size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    uint64_t ticks = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                     data.ftLastWriteTime.dwLowDateTime;
+    modifiedTime = static_cast<int64_t>(ticks / 10000000ULL) - 11644473600LL;
+    return true;
+}
+
+// One directory read with FindFirstFileExW: the find data already carries
+// size and mtime, so FileInfo costs nothing
+class DirectoryListing {
+public:
+    explicit DirectoryListing(const NameString& dir)
+    {
+        NameString pattern = JoinPath(dir, L"*");
+        find_ = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data_,
+                                 FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    }
+
+    ~DirectoryListing()
+    {
+        if (find_ != INVALID_HANDLE_VALUE) FindClose(find_);
+    }
+
+    DirectoryListing(const DirectoryListing&) = delete;
+    DirectoryListing& operator=(const DirectoryListing&) = delete;
+
+    bool IsOpen() const { return find_ != INVALID_HANDLE_VALUE; }
+
+    bool Next(const NameChar*& name, EntryKind& kind)
+    {
+        if (find_ == INVALID_HANDLE_VALUE) return false;
+        for (;;) {
+            if (!first_ && !FindNextFileW(find_, &data_)) return false;
+            first_ = false;
+
+            const wchar_t* n = data_.cFileName;
+            if (n[0] == L'.' && (n[1] == 0 || (n[1] == L'.' && n[2] == 0))) continue;
+
+            name = n;
+            if (data_.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                // Junctions and directory symlinks are not followed
+                kind = (data_.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+                    ? EntryKind::Other : EntryKind::Directory;
+            } else {
+                kind = EntryKind::File;
+            }
+            return true;
+        }
+    }
+
+    bool FileInfo(uint64_t& size, int64_t& modifiedTime)
+    {
+        size = (static_cast<uint64_t>(data_.nFileSizeHigh) << 32) | data_.nFileSizeLow;
+        uint64_t ticks = (static_cast<uint64_t>(data_.ftLastWriteTime.dwHighDateTime) << 32) |
+                         data_.ftLastWriteTime.dwLowDateTime;
+        // FILETIME: 100 ns ticks since 1601-01-01
+        modifiedTime = static_cast<int64_t>(ticks / 10000000ULL) - 11644473600LL;
+        return true;
+    }
+
+private:
+    HANDLE find_ = INVALID_HANDLE_VALUE;
+    WIN32_FIND_DATAW data_{};
+    bool first_ = true;
+};
+
+#else
+
+// Last modification of a directory, ns since the Unix epoch. Unlike the
+// file stats this one syncs: a stale cached mtime would hide a change.
+bool DirectoryModifiedTime(const NameString& dir, int64_t& modifiedTime)
+{
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+    struct statx stx;
+    if (statx(AT_FDCWD, dir.c_str(), AT_STATX_SYNC_AS_STAT, STATX_MTIME, &stx) != 0) return false;
+    modifiedTime = static_cast<int64_t>(stx.stx_mtime.tv_sec) * 1000000000 + stx.stx_mtime.tv_nsec;
+#else
+    struct stat st;
+    if (stat(dir.c_str(), &st) != 0) return false;
+    modifiedTime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#endif
+    return true;
+}
+
+// Size and last write time of one file, as DirectoryListing::FileInfo
+bool FileInfoAt(const NameString& path, uint64_t& size, int64_t& modifiedTime)
+{
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+    struct statx stx;
+    if (statx(AT_FDCWD, path.c_str(), AT_STATX_DONT_SYNC, STATX_SIZE | STATX_MTIME, &stx) != 0) {
+        return false;
+    }
+    size = stx.stx_size;
+    modifiedTime = stx.stx_mtime.tv_sec;
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    modifiedTime = st.st_mtime;
+#endif
+    return true;
+}
+
+// One directory read in bulk (getdents64 on Linux, readdir elsewhere).
+// Entry types come with the names; size and mtime need a stat, done only
+// for the files that get that far, relative to the open directory.
+class DirectoryListing {
+public:
+    explicit DirectoryListing(const NameString& dir)
+    {
+        fd_ = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#ifndef __linux__
+        if (fd_ >= 0) {
+            dir_ = fdopendir(fd_);
+            if (!dir_) {
+                close(fd_);
+                fd_ = -1;
+            }
+        }
+#endif
+    }
+
+    ~DirectoryListing()
+    {
+#ifdef __linux__
+        if (fd_ >= 0) close(fd_);
+#else
+        if (dir_) closedir(dir_);  // closes fd_
+#endif
+    }
+
+    DirectoryListing(const DirectoryListing&) = delete;
+    DirectoryListing& operator=(const DirectoryListing&) = delete;
+
+    bool IsOpen() const { return fd_ >= 0; }
+
+    bool Next(const NameChar*& name, EntryKind& kind)
+    {
+        if (fd_ < 0) return false;
+        for (;;) {
+            unsigned char type;
+#ifdef __linux__
+            if (pos_ >= length_) {
+                long n = syscall(SYS_getdents64, fd_, buffer_, sizeof(buffer_));
+                if (n <= 0) return false;
+                length_ = static_cast<size_t>(n);
+                pos_ = 0;
+            }
+            const auto* entry = reinterpret_cast<const struct dirent64*>(buffer_ + pos_);
+            pos_ += entry->d_reclen;
+            name_ = entry->d_name;
+            type = entry->d_type;
+#else
+            const struct dirent* entry = readdir(dir_);
+            if (!entry) return false;
+            name_ = entry->d_name;
+            type = entry->d_type;
+#endif
+            if (name_[0] == '.' && (name_[1] == 0 || (name_[1] == '.' && name_[2] == 0))) continue;
+
+            name = name_;
+            statDone_ = false;
+            if (type == DT_DIR) {
+                kind = EntryKind::Directory;
+            } else if (type == DT_REG) {
+                kind = EntryKind::File;
+            } else if (type == DT_LNK) {
+                // Symlinks to files count as files; directories aren't followed
+                kind = Stat(true) && S_ISREG(mode_) ? EntryKind::File : EntryKind::Other;
+            } else if (type == DT_UNKNOWN) {
+                // Some filesystems don't fill in d_type
+                if (!Stat(false)) {
+                    kind = EntryKind::Other;
+                } else if (S_ISLNK(mode_)) {
+                    kind = Stat(true) && S_ISREG(mode_) ? EntryKind::File : EntryKind::Other;
+                } else {
+                    kind = S_ISDIR(mode_) ? EntryKind::Directory
+                         : S_ISREG(mode_) ? EntryKind::File : EntryKind::Other;
+                }
+            } else {
+                kind = EntryKind::Other;
+            }
+            return true;
+        }
+    }
+
+    bool FileInfo(uint64_t& size, int64_t& modifiedTime)
+    {
+        if (!statDone_ && !Stat(true)) return false;
+        size = size_;
+        modifiedTime = mtime_;
+        return true;
+    }
+
+private:
+    bool Stat(bool follow)
+    {
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+        // AT_STATX_DONT_SYNC: no round trip to a network server just to
+        // refresh attributes the client already holds
+        struct statx stx;
+        int flags = AT_STATX_DONT_SYNC | (follow ? 0 : AT_SYMLINK_NOFOLLOW);
+        if (statx(DirFd(), name_, flags, STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) != 0) return false;
+        mode_ = stx.stx_mode;
+        size_ = stx.stx_size;
+        mtime_ = stx.stx_mtime.tv_sec;
+#else
+        struct stat st;
+        if (fstatat(DirFd(), name_, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) != 0) return false;
+        mode_ = st.st_mode;
+        size_ = static_cast<uint64_t>(st.st_size);
+        mtime_ = st.st_mtime;
+#endif
+        statDone_ = true;
+        return true;
+    }
+
+    int DirFd() const
+    {
+#ifdef __linux__
+        return fd_;
+#else
+        return dirfd(dir_);
+#endif
+    }
+
+    int fd_ = -1;
+#ifdef __linux__
+    alignas(8) char buffer_[32 * 1024];
+    size_t pos_ = 0;
+    size_t length_ = 0;
+#else
+    DIR* dir_ = nullptr;
+#endif
+    const char* name_ = nullptr;
+    bool statDone_ = false;
+    unsigned mode_ = 0;
+    uint64_t size_ = 0;
+    int64_t mtime_ = 0;
+};
+
+#endif
+
+// scan_index.bin: a header, then per directory its key, record fields,
+// subdirectory names and files (name, size, mtime, rejected byte), every
+// string as a u32 length plus native characters. The payload hash catches a
+// torn write.
+constexpr char kIndexMagic[4] = {'U', 'I', 'V', 'D'};
+constexpr uint32_t kIndexVersion = 2;
+
+struct IndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t charSize;        // sizeof(NameChar): indexes don't move between platforms
+    uint32_t directoryCount;
+    uint64_t configHash;
+    uint64_t payloadHash;
+};
+static_assert(sizeof(IndexHeader) == 32);
+
+class IndexWriter {
+public:
+    template <typename T>
+    void Put(T value)
+    {
+        const auto* p = reinterpret_cast<const uint8_t*>(&value);
+        bytes_.insert(bytes_.end(), p, p + sizeof(T));
+    }
+    void Put(const NameString& s)
+    {
+        Put(static_cast<uint32_t>(s.size()));
+        const auto* p = reinterpret_cast<const uint8_t*>(s.data());
+        bytes_.insert(bytes_.end(), p, p + s.size() * sizeof(NameChar));
+    }
+    const std::vector<uint8_t>& Bytes() const { return bytes_; }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+// Bounds-checked; once a read runs past the end every later one fails too
+class IndexReader {
+public:
+    IndexReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool Get(T& value)
+    {
+        if (size_ - pos_ < sizeof(T)) return Fail();
+        memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool Get(NameString& s)
+    {
+        uint32_t length;
+        if (!Get(length)) return false;
+        if ((size_ - pos_) / sizeof(NameChar) < length) return Fail();
+        s.resize(length);
+        memcpy(s.data(), data_ + pos_, length * sizeof(NameChar));
+        pos_ += length * sizeof(NameChar);
+        return true;
+    }
+    size_t Remaining() const { return size_ - pos_; }
+
+private:
+    bool Fail()
+    {
+        pos_ = size_;
+        return false;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+void DirectoryIndex::Clear()
+{
+    directories_.clear();
+    configHash_ = 0;
+    listed_ = 0;
+    reused_ = 0;
+}
+
+size_t DirectoryIndex::FileCount() const
+{
+    size_t count = 0;
+    for (const auto& [key, dir] : directories_) {
+        for (const auto& f : dir.files) count += !f.rejected;
+    }
+    return count;
+}
+
+uint64_t DirectoryIndex::EntryCount() const
+{
+    uint64_t count = 0;
+    for (const auto& [key, dir] : directories_) count += dir.entryCount;
+    return count;
+}
+
+bool DirectoryIndex::Save(const std::filesystem::path& file) const
+{
+    IndexWriter payload;
+    for (const auto& [key, dir] : directories_) {
+        payload.Put(key);
+        payload.Put(dir.modifiedTime);
+        payload.Put(dir.listedAt);
+        payload.Put(dir.entryCount);
+        payload.Put(static_cast<uint32_t>(dir.subdirs.size()));
+        payload.Put(static_cast<uint32_t>(dir.files.size()));
+        for (const auto& name : dir.subdirs) payload.Put(name);
+        for (const auto& f : dir.files) {
+            payload.Put(f.name);
+            payload.Put(f.size);
+            payload.Put(f.modifiedTime);
+            payload.Put(static_cast<uint8_t>(f.rejected));
+        }
+    }
+    const auto& bytes = payload.Bytes();
+
+    IndexHeader header{};
+    memcpy(header.magic, kIndexMagic, 4);
+    header.version = kIndexVersion;
+    header.charSize = sizeof(NameChar);
+    header.directoryCount = static_cast<uint32_t>(directories_.size());
+    header.configHash = configHash_;
+    StableHash hash;
+    hash.Add(bytes.data(), bytes.size());
+    header.payloadHash = hash.Value();
+
+    std::FILE* f = Platform::OpenFile(file, "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+              (bytes.empty() || std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size());
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
+
+bool DirectoryIndex::Load(const std::filesystem::path& file)
+{
+    Clear();
+
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(file, ec);
+    if (ec || fileSize < sizeof(IndexHeader)) return false;
+
+    std::FILE* f = Platform::OpenFile(file, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> buffer(static_cast<size_t>(fileSize));
+    bool read = std::fread(buffer.data(), 1, buffer.size(), f) == buffer.size();
+    std::fclose(f);
+    if (!read) return false;
+
+    IndexHeader header;
+    memcpy(&header, buffer.data(), sizeof(header));
+    if (memcmp(header.magic, kIndexMagic, 4) != 0 || header.version != kIndexVersion ||
+        header.charSize != sizeof(NameChar)) {
+        return false;
+    }
+    const uint8_t* payload = buffer.data() + sizeof(header);
+    size_t payloadSize = buffer.size() - sizeof(header);
+    StableHash hash;
+    hash.Add(payload, payloadSize);
+    if (hash.Value() != header.payloadHash) return false;
+
+    // Smallest encodings, to bound counts before anything is allocated
+    constexpr size_t kMinDirectory = 4 + 8 + 8 + 4 + 4 + 4;
+    constexpr size_t kMinFile = 4 + 8 + 8 + 1;
+
+    IndexReader reader(payload, payloadSize);
+    if (payloadSize / kMinDirectory < header.directoryCount) return false;
+    directories_.reserve(header.directoryCount);
+    for (uint32_t i = 0; i < header.directoryCount; ++i) {
+        NameString key;
+        Directory dir;
+        uint32_t subdirCount = 0;
+        uint32_t fileCount = 0;
+        bool ok = reader.Get(key) && reader.Get(dir.modifiedTime) && reader.Get(dir.listedAt) &&
+                  reader.Get(dir.entryCount) && reader.Get(subdirCount) && reader.Get(fileCount) &&
+                  uint64_t{subdirCount} * 4 + uint64_t{fileCount} * kMinFile <= reader.Remaining();
+        if (ok) {
+            dir.subdirs.resize(subdirCount);
+            dir.files.resize(fileCount);
+        }
+        for (uint32_t j = 0; ok && j < subdirCount; ++j) ok = reader.Get(dir.subdirs[j]);
+        for (uint32_t j = 0; ok && j < fileCount; ++j) {
+            File& f = dir.files[j];
+            uint8_t rejected = 0;
+            ok = reader.Get(f.name) && reader.Get(f.size) && reader.Get(f.modifiedTime) &&
+                 reader.Get(rejected);
+            f.rejected = rejected != 0;
+        }
+        if (!ok) {
+            Clear();
+            return false;
+        }
+        directories_.emplace(std::move(key), std::move(dir));
+    }
+    if (reader.Remaining() != 0) {
+        Clear();
+        return false;
+    }
+    configHash_ = header.configHash;
+    return true;
+}
+
+struct DirectoryScanner::Walk {
+    struct alignas(64) WorkerBuffer {
+        std::mutex mutex;  // only contended by snapshots
+        std::vector<ScanEntry> entries;
+        // This walk's index records (with an index only)
+        std::vector<std::pair<NameString, DirectoryIndex::Directory>> directories;
+        size_t listed = 0;
+        size_t reused = 0;
+    };
+
+    const DirectoryScanner* scanner = nullptr;
+    std::atomic<bool>* cancelFlag = nullptr;
+    std::atomic<size_t>* outCount = nullptr;
+
+    bool indexing = false;                      // recording an index
+    const DirectoryIndex* previous = nullptr;   // records to reuse (same config)
+
+    // Roots lying inside a later root: that root's walk skips them
+    std::vector<NameString> innerRoots;
+
+    // One per pool worker, plus one for any other thread
+    std::vector<std::unique_ptr<WorkerBuffer>> buffers;
+
+    std::atomic<size_t> pendingDirs{0};
+    std::atomic<size_t> found{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCV;
+    bool done = false;  // guarded by doneMutex
+};
+
+DirectoryScanner::DirectoryScanner(ThreadPool* pool, const Config& config)
+    : pool_(pool)
+    , config_(config)
+{
+    for (const auto& ext : config_.extensions) {
+        extensions_.insert(ext.native());
+        maxExtension_ = std::max(maxExtension_, ext.native().size());
+    }
+    for (const auto& dir : config_.skipDirs) {
+        skipDirs_.insert(dir.native());
+    }
+
+    // Everything that decides what a record holds
+    StableHash hash;
+    uint32_t charSize = sizeof(NameChar);
+    hash.Add(&charSize, sizeof(charSize));
+    for (const auto& ext : config_.extensions) hash.Add(ext.native());
+    hash.Add(&kSeparator, sizeof(kSeparator));
+    for (const auto& dir : config_.skipDirs) hash.Add(dir.native());
+    uint8_t skipDots = config_.skipDotDirs ? 1 : 0;
+    hash.Add(&skipDots, sizeof(skipDots));
+    hash.Add(&config_.minFileSize, sizeof(config_.minFileSize));
+    configHash_ = hash.Value();
+}
+
+bool DirectoryScanner::MatchesExtension(NameView name) const
+{
+    // Lowercase just the extension (ASCII), short enough to stay in the
+    // string's inline buffer
+    size_t dot = name.rfind(NameChar('.'));
+    if (dot == NameView::npos || dot == 0 || name.size() - dot > maxExtension_) return false;
+    NameString ext(name.substr(dot));
+    for (auto& c : ext) {
+        if (c >= NameChar('A') && c <= NameChar('Z')) c = static_cast<NameChar>(c - 'A' + 'a');
+    }
+    return extensions_.contains(ext);
+}
+
+bool DirectoryScanner::SkipDirectory(NameView name) const
+{
+    if (config_.skipDotDirs && !name.empty() && name[0] == NameChar('.')) return true;
+    return skipDirs_.contains(NameString(name));
+}
+
+bool DirectoryScanner::AcceptsFile(const std::filesystem::path& name, uint64_t size) const
+{
+    return size >= config_.minFileSize && MatchesExtension(name.native());
+}
+
+bool DirectoryScanner::SkipsDirectory(const std::filesystem::path& name) const
+{
+    return SkipDirectory(name.native());
+}
+
+void DirectoryScanner::QueueDirectory(Walk* walk, NameString dir, uint32_t root)
+{
+    if (!walk->innerRoots.empty()) {
+        NameString key = DirectoryKey(dir);
+        if (std::find(walk->innerRoots.begin(), walk->innerRoots.end(), key) !=
+            walk->innerRoots.end()) {
+            return;  // walked as a root of its own
+        }
+    }
+    // From a worker this goes to its own deque: depth-first locally, whole
+    // subtrees for thieves
+    const DirectoryScanner& self = *walk->scanner;
+    walk->pendingDirs.fetch_add(1, std::memory_order_relaxed);
+    self.pool_->Submit([walk, dir = std::move(dir), root]() mutable {
+        ScanDirectoryTask(walk, std::move(dir), root);
+    }, self.config_.priority);
+}
+
+void DirectoryScanner::ScanDirectoryTask(Walk* walk, NameString dir, uint32_t root)
+{
+    const DirectoryScanner& self = *walk->scanner;
+
+    std::vector<ScanEntry> matches;
+    DirectoryIndex::Directory record;
+    bool recorded = false;  // `record` describes `dir`
+    bool reused = false;    // ... and came from the previous index
+    if (!walk->cancelFlag->load(std::memory_order_relaxed)) {
+        // The mtime is read before the listing, so a change made while
+        // listing leaves the record behind the directory, never ahead
+        if (walk->indexing && DirectoryModifiedTime(dir, record.modifiedTime)) {
+            recorded = true;
+            const DirectoryIndex::Directory* old = nullptr;
+            if (walk->previous) {
+                auto it = walk->previous->directories_.find(DirectoryKey(dir));
+                if (it != walk->previous->directories_.end()) old = &it->second;
+            }
+            if (old && old->modifiedTime == record.modifiedTime &&
+                old->listedAt - old->modifiedTime >= DirectoryIndex::kRacyWindow) {
+                record = *old;
+                reused = true;
+            } else {
+                record.listedAt = NowNs();
+            }
+        }
+
+        if (reused) {
+            for (const auto& name : record.subdirs) {
+                QueueDirectory(walk, JoinPath(dir, name.c_str()), root);
+            }
+            matches.reserve(record.files.size());
+            for (auto& file : record.files) {
+                ScanEntry entry;
+                entry.path = JoinPath(dir, file.name.c_str());
+                if (file.rejected) {
+                    // Growing a file leaves the directory's mtime alone
+                    if (!FileInfoAt(entry.path, file.size, file.modifiedTime)) continue;
+                    file.rejected = file.size < self.config_.minFileSize;
+                    if (file.rejected) continue;
+                }
+                entry.size = file.size;
+                entry.modifiedTime = file.modifiedTime;
+                entry.root = root;
+                matches.push_back(std::move(entry));
+            }
+        } else {
+            DirectoryListing listing(dir);
+            // An unreadable directory may become readable without its
+            // mtime moving: leave it out of the index
+            if (!listing.IsOpen()) recorded = false;
+
+            const NameChar* name;
+            EntryKind kind;
+            while (listing.Next(name, kind)) {
+                if (walk->cancelFlag->load(std::memory_order_relaxed)) {
+                    recorded = false;
+                    break;
+                }
+                ++record.entryCount;
+
+                if (kind == EntryKind::Directory) {
+                    if (self.SkipDirectory(name)) continue;
+                    if (recorded) record.subdirs.emplace_back(name);
+                    QueueDirectory(walk, JoinPath(dir, name), root);
+                } else if (kind == EntryKind::File) {
+                    if (!self.MatchesExtension(name)) continue;
+                    ScanEntry entry;
+                    if (!listing.FileInfo(entry.size, entry.modifiedTime)) continue;
+                    // Recorded even when too small: it may still be being written
+                    bool rejected = entry.size < self.config_.minFileSize;
+                    if (recorded) record.files.push_back({name, entry.size, entry.modifiedTime, rejected});
+                    if (rejected) continue;
+                    entry.path = JoinPath(dir, name);
+                    entry.root = root;
+                    matches.push_back(std::move(entry));
+                }
+            }
+        }
+    }
+
+    if (!matches.empty() || recorded) {
+        auto& buffer = *walk->buffers[self.pool_->CurrentWorkerIndex()];
+        {
+            std::lock_guard lock(buffer.mutex);
+            for (auto& entry : matches) buffer.entries.push_back(std::move(entry));
+            if (recorded) {
+                buffer.directories.emplace_back(DirectoryKey(dir), std::move(record));
+                ++(reused ? buffer.reused : buffer.listed);
+            }
+        }
+        walk->found.fetch_add(matches.size(), std::memory_order_relaxed);
+        walk->outCount->fetch_add(matches.size(), std::memory_order_relaxed);
+    }
+
+    // The last directory wakes Scan. Nothing touches `walk` after the
+    // unlock: Scan may destroy it as soon as it sees `done`.
+    if (walk->pendingDirs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard lock(walk->doneMutex);
+        walk->done = true;
+        walk->doneCV.notify_all();
+    }
+}
+
+std::vector<ScanEntry> DirectoryScanner::Scan(const std::vector<std::filesystem::path>& roots,
+                                              std::atomic<bool>& cancelFlag,
+                                              std::atomic<size_t>& outCount,
+                                              SnapshotCallback snapshot,
+                                              size_t snapshotInterval,
+                                              DirectoryIndex* index)
+{
+    outCount = 0;
+
+    Walk walk;
+    walk.scanner = this;
+    walk.cancelFlag = &cancelFlag;
+    walk.outCount = &outCount;
+    walk.indexing = index != nullptr;
+    if (index && index->configHash_ == configHash_) walk.previous = index;
+    walk.buffers.resize(pool_->ThreadCount() + 1);
+    for (auto& buffer : walk.buffers) buffer = std::make_unique<Walk::WorkerBuffer>();
+
+    // Drop missing roots and roots inside an earlier one; remember earlier
+    // roots inside a later one so that one's walk skips them
+    std::vector<std::pair<NameString, uint32_t>> walked;  // (path, root index)
+    std::vector<NameString> keys;
+    for (uint32_t i = 0; i < roots.size(); ++i) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(roots[i], ec)) continue;
+        NameString path = NormalizeRoot(roots[i]);
+        NameString key = DirectoryKey(path);
+        bool covered = false;
+        for (const auto& earlier : keys) {
+            if (key == earlier || IsBelow(key, earlier)) {
+                covered = true;
+                break;
+            }
+            if (IsBelow(earlier, key)) walk.innerRoots.push_back(earlier);
+        }
+        if (covered) continue;
+        keys.push_back(key);
+        walked.emplace_back(std::move(path), i);
+    }
+    if (walked.empty()) {
+        if (index) {
+            index->Clear();
+            index->configHash_ = configHash_;
+        }
+        return {};
+    }
+
+    walk.pendingDirs.store(walked.size(), std::memory_order_relaxed);
+    for (auto& [path, rootIndex] : walked) {
+        Walk* w = &walk;
+        pool_->Submit([w, path = std::move(path), root = rootIndex]() mutable {
+            ScanDirectoryTask(w, std::move(path), root);
+        }, config_.priority);
+    }
+
+    // Wait, handing the caller what came in since the last snapshot in
+    // between; buffers only grow, so a cursor per buffer marks what it has
+    size_t lastSnapshot = 0;
+    std::vector<size_t> taken(walk.buffers.size(), 0);
+    auto takeNew = [&] {
+        std::vector<ScanEntry> fresh;
+        for (size_t b = 0; b < walk.buffers.size(); ++b) {
+            auto& buffer = *walk.buffers[b];
+            std::lock_guard bufferLock(buffer.mutex);
+            fresh.insert(fresh.end(), buffer.entries.begin() + static_cast<ptrdiff_t>(taken[b]),
+                         buffer.entries.end());
+            taken[b] = buffer.entries.size();
+        }
+        return fresh;
+    };
+    std::unique_lock lock(walk.doneMutex);
+    while (!walk.done) {
+        walk.doneCV.wait_for(lock, std::chrono::milliseconds(50));
+        size_t found = walk.found.load(std::memory_order_relaxed);
+        if (!snapshot || walk.done || found - lastSnapshot < snapshotInterval) continue;
+
+        lock.unlock();
+        snapshot(takeNew());
+        lastSnapshot = found;
+        lock.lock();
+    }
+    lock.unlock();
+
+    // The rest, once the walk is complete
+    if (snapshot && !cancelFlag.load(std::memory_order_relaxed)) {
+        auto rest = takeNew();
+        if (!rest.empty()) snapshot(rest);
+    }
+
+    // Merge the per-worker buffers
+    std::vector<ScanEntry> result;
+    result.reserve(walk.found.load(std::memory_order_relaxed));
+    for (auto& buffer : walk.buffers) {
+        std::move(buffer->entries.begin(), buffer->entries.end(), std::back_inserter(result));
+    }
+
+    // A cancelled walk skipped directories; its index would drop them
+    if (index && !cancelFlag.load(std::memory_order_relaxed)) {
+        DirectoryIndex next;
+        next.configHash_ = configHash_;
+        for (auto& buffer : walk.buffers) {
+            for (auto& [key, record] : buffer->directories) {
+                next.directories_.insert_or_assign(std::move(key), std::move(record));
+            }
+            next.listed_ += buffer->listed;
+            next.reused_ += buffer->reused;
+        }
+        *index = std::move(next);
+    }
+    return result;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,164 @@
+#include "core/EpochReclaimer.hpp"
+#include <cstdlib>
+#include <thread>
+
+namespace UltraImageViewer {
+namespace Core {
+
+// Owns the calling thread's reader slot; released at thread exit
+struct ThreadSlotOwner {
+    std::atomic<uint64_t>* slot = nullptr;
+    int depth = 0;  // nested guards on the same thread
+
+    ~ThreadSlotOwner()
+    {
+        if (slot) {
+            slot->store(0, std::memory_order_seq_cst);
+            EpochReclaimer& r = EpochReclaimer::Instance();
+            for (auto& s : r.slots_) {
+                if (&s.epoch == slot) {
+                    s.inUse.store(false, std::memory_order_release);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+static thread_local ThreadSlotOwner tl_slotOwner;
+
+EpochReclaimer& EpochReclaimer::Instance()
+{
+    static EpochReclaimer instance;
+    return instance;
+}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    DrainAll();
+}
+
+std::atomic<uint64_t>* EpochReclaimer::AcquireSlot()
+{
+    for (auto& s : slots_) {
+        bool expected = false;
+        if (s.inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return &s.epoch;
+        }
+    }
+    // More live threads than slots is a configuration error (pool size is bounded)
+    std::abort();
+}
+
+EpochReclaimer::Guard::Guard()
+{
+    auto& owner = tl_slotOwner;
+    if (!owner.slot) {
+        owner.slot = EpochReclaimer::Instance().AcquireSlot();
+    }
+    slot_ = owner.slot;
+    outermost_ = (owner.depth++ == 0);
+    if (!outermost_) return;
+
+    // Publish the epoch we read under; re-check so a concurrent advance that
+    // missed our (still quiescent) slot cannot leave us on a stale epoch.
+    auto& global = EpochReclaimer::Instance().globalEpoch_;
+    uint64_t e = global.load(std::memory_order_seq_cst);
+    for (;;) {
+        slot_->store(e, std::memory_order_seq_cst);
+        uint64_t now = global.load(std::memory_order_seq_cst);
+        if (now == e) break;
+        e = now;
+    }
+}
+
+EpochReclaimer::Guard::~Guard()
+{
+    --tl_slotOwner.depth;
+    if (outermost_) {
+        slot_->store(0, std::memory_order_release);
+    }
+}
+
+void EpochReclaimer::Retire(void* ptr, void (*deleter)(void*))
+{
+    bool collect = false;
+    {
+        std::lock_guard lock(retireMutex_);
+        retired_.push_back({ptr, deleter, globalEpoch_.load(std::memory_order_seq_cst)});
+        collect = retired_.size() >= kCollectThreshold;
+    }
+    if (collect) Collect();
+}
+
+void EpochReclaimer::Collect()
+{
+    std::vector<Retired> ready;
+    {
+        std::lock_guard lock(retireMutex_);
+
+        // Advance only if every active reader has observed the current epoch
+        uint64_t global = globalEpoch_.load(std::memory_order_seq_cst);
+        bool canAdvance = true;
+        for (auto& s : slots_) {
+            uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e != global) {
+                canAdvance = false;
+                break;
+            }
+        }
+        if (canAdvance) {
+            globalEpoch_.store(global + 1, std::memory_order_seq_cst);
+            global += 1;
+        }
+
+        // Nodes retired at epoch <= global - 2 are unreachable by any reader
+        auto keep = retired_.begin();
+        for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+            if (it->epoch + 2 <= global) {
+                ready.push_back(*it);
+            } else {
+                *keep++ = *it;
+            }
+        }
+        retired_.erase(keep, retired_.end());
+    }
+
+    for (auto& r : ready) {
+        r.deleter(r.ptr);
+    }
+}
+
+void EpochReclaimer::Synchronize()
+{
+    // Two advances past the current epoch make all earlier retirees unreachable;
+    // the Collect() that performs the second advance also frees them.
+    uint64_t target = globalEpoch_.load(std::memory_order_seq_cst) + 2;
+    while (globalEpoch_.load(std::memory_order_seq_cst) < target) {
+        Collect();
+        if (globalEpoch_.load(std::memory_order_seq_cst) < target) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void EpochReclaimer::DrainAll()
+{
+    std::vector<Retired> all;
+    {
+        std::lock_guard lock(retireMutex_);
+        all.swap(retired_);
+    }
+    for (auto& r : all) {
+        r.deleter(r.ptr);
+    }
+}
+
+size_t EpochReclaimer::PendingCount()
+{
+    std::lock_guard lock(retireMutex_);
+    return retired_.size();
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
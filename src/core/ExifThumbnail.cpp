@@ -0,0 +1,327 @@
+#include "core/ExifThumbnail.hpp"
+#include "core/SimdUtils.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+// Metadata sits in the leading segments; nothing past this is scanned, so
+// with a lazily mapped file only the first pages are ever read
+constexpr size_t kMaxHeaderScan = 256 * 1024;
+
+constexpr size_t kMaxIfds = 32;
+constexpr size_t kMaxCandidates = 16;
+
+// Relative aspect mismatch above which a preview is taken to be letterboxed
+constexpr double kAspectTolerance = 0.03;
+
+// TIFF tags
+constexpr uint16_t kTagCompression = 0x0103;
+constexpr uint16_t kTagStripOffsets = 0x0111;
+constexpr uint16_t kTagStripByteCounts = 0x0117;
+constexpr uint16_t kTagSubIfds = 0x014A;
+constexpr uint16_t kTagJpegOffset = 0x0201;
+constexpr uint16_t kTagJpegLength = 0x0202;
+constexpr uint16_t kTagExifIfd = 0x8769;
+constexpr uint16_t kTagPixelXDimension = 0xA002;
+constexpr uint16_t kTagPixelYDimension = 0xA003;
+constexpr uint16_t kTagMpEntry = 0xB002;
+
+constexpr uint16_t kTypeShort = 3;
+
+struct Candidate {
+    size_t offset = 0;
+    size_t length = 0;
+};
+
+struct ScanResult {
+    std::array<Candidate, kMaxCandidates> candidates;
+    size_t count = 0;
+    uint32_t mainWidth = 0;
+    uint32_t mainHeight = 0;
+
+    void Add(size_t offset, size_t length)
+    {
+        if (count < candidates.size() && length > 0) candidates[count++] = {offset, length};
+    }
+};
+
+uint16_t LoadBe16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+
+// Bounds-checked view of a TIFF structure (EXIF, MPF or a whole RAW file).
+// Offsets inside it are relative to the header; `base` maps them to the file.
+class TiffReader {
+public:
+    TiffReader(const uint8_t* data, size_t size, size_t base) : data_(data), size_(size), base_(base) {}
+
+    // Byte order and magic; ORF ("IIRO"/"IIRS") and RW2 ("IIU") use their own
+    bool Open(uint32_t& firstIfd)
+    {
+        if (size_ < 8) return false;
+        if (data_[0] == 'I' && data_[1] == 'I') little_ = true;
+        else if (data_[0] == 'M' && data_[1] == 'M') little_ = false;
+        else return false;
+        uint16_t magic = U16(2);
+        if (magic != 0x2A && magic != 0x4F52 && magic != 0x5352 && magic != 0x55) return false;
+        firstIfd = U32(4);
+        return true;
+    }
+
+    bool Has(size_t offset, size_t length) const { return offset <= size_ && length <= size_ - offset; }
+
+    uint16_t U16(size_t offset) const
+    {
+        if (!Has(offset, 2)) return 0;
+        const uint8_t* p = data_ + offset;
+        return little_ ? static_cast<uint16_t>(p[0] | p[1] << 8) : LoadBe16(p);
+    }
+
+    uint32_t U32(size_t offset) const
+    {
+        if (!Has(offset, 4)) return 0;
+        const uint8_t* p = data_ + offset;
+        return little_ ? (uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24)
+                       : (uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]));
+    }
+
+    // SHORT or LONG scalar stored inline in a 12-byte IFD entry
+    uint32_t Value(size_t entry) const
+    {
+        return U16(entry + 2) == kTypeShort ? U16(entry + 8) : U32(entry + 8);
+    }
+
+    size_t Base() const { return base_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t base_;
+    bool little_ = true;
+};
+
+// Walks the IFD chain from `firstIfd`, following SubIFDs and the EXIF IFD,
+// collecting JPEG previews (IFD1-style JPEGInterchangeFormat, or a
+// single-strip JPEG-compressed IFD as in DNG/NEF) and the EXIF pixel size
+void ScanTiff(TiffReader& tiff, uint32_t firstIfd, ScanResult& result)
+{
+    std::array<uint32_t, kMaxIfds> pending{};
+    std::array<uint32_t, kMaxIfds> visited{};
+    size_t pendingCount = 0, visitedCount = 0;
+    auto push = [&](uint32_t ifd) {
+        if (ifd == 0 || pendingCount == pending.size()) return;
+        if (std::find(visited.begin(), visited.begin() + visitedCount, ifd) != visited.begin() + visitedCount) return;
+        pending[pendingCount++] = ifd;
+    };
+    push(firstIfd);
+
+    while (pendingCount > 0 && visitedCount < visited.size()) {
+        uint32_t ifd = pending[--pendingCount];
+        visited[visitedCount++] = ifd;
+        if (!tiff.Has(ifd, 2)) continue;
+        uint16_t entries = tiff.U16(ifd);
+        if (!tiff.Has(ifd + 2, static_cast<size_t>(entries) * 12 + 4)) continue;
+
+        uint32_t jpegOffset = 0, jpegLength = 0, compression = 0;
+        uint32_t stripOffset = 0, stripBytes = 0;
+        for (uint16_t i = 0; i < entries; ++i) {
+            size_t entry = ifd + 2 + static_cast<size_t>(i) * 12;
+            uint16_t tag = tiff.U16(entry);
+            uint32_t count = tiff.U32(entry + 4);
+            switch (tag) {
+            case kTagCompression: compression = tiff.Value(entry); break;
+            case kTagJpegOffset: jpegOffset = tiff.Value(entry); break;
+            case kTagJpegLength: jpegLength = tiff.Value(entry); break;
+            case kTagStripOffsets: if (count == 1) stripOffset = tiff.Value(entry); break;
+            case kTagStripByteCounts: if (count == 1) stripBytes = tiff.Value(entry); break;
+            case kTagExifIfd: push(tiff.U32(entry + 8)); break;
+            case kTagSubIfds:
+                if (count == 1) {
+                    push(tiff.U32(entry + 8));
+                } else {
+                    uint32_t list = tiff.U32(entry + 8);
+                    for (uint32_t k = 0; k < count && k < kMaxIfds; ++k) push(tiff.U32(list + k * 4));
+                }
+                break;
+            case kTagPixelXDimension: result.mainWidth = tiff.Value(entry); break;
+            case kTagPixelYDimension: result.mainHeight = tiff.Value(entry); break;
+            default: break;
+            }
+        }
+
+        if (jpegOffset && jpegLength) result.Add(tiff.Base() + jpegOffset, jpegLength);
+        // 6 = old-style JPEG, 7 = JPEG; lossless raw data is filtered out by the SOF check
+        if ((compression == 6 || compression == 7) && stripOffset && stripBytes) {
+            result.Add(tiff.Base() + stripOffset, stripBytes);
+        }
+        push(tiff.U32(ifd + 2 + static_cast<size_t>(entries) * 12));
+    }
+}
+
+// MPF (CIPA DC-007) APP2: a TIFF structure whose MP Entry table lists the
+// extra images appended after the primary one, typically a large preview
+void ScanMpf(TiffReader& tiff, uint32_t firstIfd, ScanResult& result)
+{
+    if (!tiff.Has(firstIfd, 2)) return;
+    uint16_t entries = tiff.U16(firstIfd);
+    for (uint16_t i = 0; i < entries; ++i) {
+        size_t entry = firstIfd + 2 + static_cast<size_t>(i) * 12;
+        if (tiff.U16(entry) != kTagMpEntry) continue;
+        uint32_t count = tiff.U32(entry + 4) / 16;
+        uint32_t table = tiff.U32(entry + 8);
+        for (uint32_t k = 0; k < count && k < kMaxCandidates; ++k) {
+            size_t e = table + static_cast<size_t>(k) * 16;
+            uint32_t size = tiff.U32(e + 4);
+            uint32_t offset = tiff.U32(e + 8);
+            if (offset != 0) result.Add(tiff.Base() + offset, size);  // 0 = the primary image
+        }
+    }
+}
+
+// Visits the marker segments of a JPEG from SOI up to SOS.
+// fn(marker, payloadOffset, payloadLength) returns false to stop.
+template <typename Fn>
+void WalkJpegSegments(const uint8_t* data, size_t size, Fn&& fn)
+{
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return;
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) return;
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) { ++pos; continue; }  // fill byte
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) { pos += 2; continue; }
+        if (marker == 0xD9 || marker == 0xDA) return;  // EOI, SOS: header is over
+        size_t length = LoadBe16(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size) return;
+        if (!fn(marker, pos + 4, length - 2)) return;
+        pos += 2 + length;
+    }
+}
+
+bool IsSofMarker(uint8_t marker)
+{
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+// Frame size of a baseline, extended or progressive huffman JPEG
+bool ReadJpegFrameSize(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height)
+{
+    bool ok = false;
+    WalkJpegSegments(data, std::min(size, kMaxHeaderScan), [&](uint8_t marker, size_t at, size_t length) {
+        if (!IsSofMarker(marker)) return true;
+        if (marker <= 0xC2 && length >= 5) {
+            height = LoadBe16(data + at + 1);
+            width = LoadBe16(data + at + 3);
+            ok = width > 0 && height > 0;
+        }
+        return false;
+    });
+    return ok;
+}
+
+void ScanJpeg(const uint8_t* data, size_t size, ScanResult& result)
+{
+    static constexpr uint8_t kExif[] = {'E', 'x', 'i', 'f', 0, 0};
+    static constexpr uint8_t kMpf[] = {'M', 'P', 'F', 0};
+
+    WalkJpegSegments(data, std::min(size, kMaxHeaderScan), [&](uint8_t marker, size_t at, size_t length) {
+        if (marker == 0xE1 && length > sizeof(kExif) && std::equal(kExif, kExif + sizeof(kExif), data + at)) {
+            size_t base = at + sizeof(kExif);
+            TiffReader tiff(data + base, length - sizeof(kExif), base);
+            uint32_t first;
+            if (tiff.Open(first)) ScanTiff(tiff, first, result);
+        } else if (marker == 0xE2 && length > sizeof(kMpf) && std::equal(kMpf, kMpf + sizeof(kMpf), data + at)) {
+            // MP Entry offsets point past this segment, so the view spans the file
+            size_t base = at + sizeof(kMpf);
+            TiffReader tiff(data + base, size - base, base);
+            uint32_t first;
+            if (tiff.Open(first)) ScanMpf(tiff, first, result);
+        } else if (IsSofMarker(marker)) {
+            // The primary image's own frame header is authoritative
+            uint32_t w = 0, h = 0;
+            if (length >= 5) {
+                h = LoadBe16(data + at + 1);
+                w = LoadBe16(data + at + 3);
+            }
+            if (w && h) {
+                result.mainWidth = w;
+                result.mainHeight = h;
+            }
+            return false;
+        }
+        return true;
+    });
+}
+
+} // namespace
+
+bool IsTiffRawPath(const std::filesystem::path& path)
+{
+    static constexpr const wchar_t* kExtensions[] = {
+        L".dng", L".cr2", L".nef", L".nrw", L".arw", L".srw", L".pef", L".orf", L".rw2"
+    };
+    std::wstring ext = path.extension().wstring();
+    Simd::ToLowerInPlace(ext);
+    return std::find(std::begin(kExtensions), std::end(kExtensions), ext) != std::end(kExtensions);
+}
+
+bool FindEmbeddedPreview(const uint8_t* data, size_t size, uint32_t targetSize,
+                         EmbeddedPreview& out)
+{
+    if (!data || size < 8) return false;
+
+    ScanResult scan;
+    if (data[0] == 0xFF && data[1] == 0xD8) {
+        ScanJpeg(data, size, scan);
+    } else {
+        TiffReader tiff(data, size, 0);
+        uint32_t first;
+        if (!tiff.Open(first)) return false;
+        ScanTiff(tiff, first, scan);
+    }
+
+    // Validate candidates and read their real dimensions from their SOF
+    std::array<EmbeddedPreview, kMaxCandidates> previews;
+    size_t count = 0;
+    EmbeddedPreview largest;
+    for (size_t i = 0; i < scan.count; ++i) {
+        const Candidate& c = scan.candidates[i];
+        if (c.offset >= size || c.length > size - c.offset) continue;
+        EmbeddedPreview p{c.offset, c.length, 0, 0};
+        if (!ReadJpegFrameSize(data + c.offset, c.length, p.width, p.height)) continue;
+        previews[count++] = p;
+        if (static_cast<uint64_t>(p.width) * p.height > static_cast<uint64_t>(largest.width) * largest.height) {
+            largest = p;
+        }
+    }
+    if (count == 0) return false;
+
+    // RAWs rarely state their developed size; their largest preview is full-frame
+    uint32_t refWidth = scan.mainWidth, refHeight = scan.mainHeight;
+    if (refWidth == 0 || refHeight == 0) {
+        refWidth = largest.width;
+        refHeight = largest.height;
+    }
+    const double refAspect = static_cast<double>(refWidth) / refHeight;
+
+    const EmbeddedPreview* best = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        const EmbeddedPreview& p = previews[i];
+        if (std::max(p.width, p.height) < targetSize) continue;
+        double aspect = static_cast<double>(p.width) / p.height;
+        if (std::abs(aspect / refAspect - 1.0) > kAspectTolerance) continue;
+        if (!best || static_cast<uint64_t>(p.width) * p.height <
+                     static_cast<uint64_t>(best->width) * best->height) {
+            best = &p;
+        }
+    }
+    if (!best) return false;
+    out = *best;
+    return true;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
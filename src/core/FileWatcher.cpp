@@ -0,0 +1,401 @@
+#include "core/FileWatcher.hpp"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <unordered_map>
+#endif
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+#ifdef _WIN32
+
+// One ReadDirectoryChangesW per root, watching its whole subtree. The
+// watcher thread issues every read (I/O started by a thread is cancelled
+// when that thread exits) and waits on their events plus a wake event.
+class WindowsFileWatcher final : public FileWatcher {
+public:
+    WindowsFileWatcher(Callback callback, DirectoryFilter)
+        : callback_(std::move(callback))
+    {
+        wake_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        thread_ = std::jthread([this](std::stop_token stop) { Run(stop); });
+    }
+
+    ~WindowsFileWatcher() override
+    {
+        thread_.request_stop();
+        SetEvent(wake_);
+        thread_.join();
+        CloseHandle(wake_);
+    }
+
+    bool Watch(const std::filesystem::path& root) override
+    {
+        HANDLE dir = CreateFileW(root.c_str(), FILE_LIST_DIRECTORY,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                 OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (dir == INVALID_HANDLE_VALUE) return false;
+        {
+            std::lock_guard lock(mutex_);
+            // One wait slot is the wake event
+            if (added_.size() + watchCount_ >= MAXIMUM_WAIT_OBJECTS - 1) {
+                CloseHandle(dir);
+                return false;
+            }
+            auto entry = std::make_unique<Root>();
+            entry->path = root;
+            entry->dir = dir;
+            added_.push_back(std::move(entry));
+        }
+        SetEvent(wake_);
+        return true;
+    }
+
+private:
+    static constexpr DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+                                           FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+    struct Root {
+        std::filesystem::path path;
+        HANDLE dir = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        alignas(DWORD) uint8_t buffer[64 * 1024];  // the network limit for one read
+        std::filesystem::path renamedFrom;          // RENAMED_OLD_NAME awaiting its new name
+        bool issued = false;                        // a read is outstanding
+
+        ~Root()
+        {
+            if (dir != INVALID_HANDLE_VALUE) {
+                if (issued) {
+                    CancelIo(dir);
+                    DWORD bytes;
+                    GetOverlappedResult(dir, &overlapped, &bytes, TRUE);
+                }
+                CloseHandle(dir);
+            }
+            if (overlapped.hEvent) CloseHandle(overlapped.hEvent);
+        }
+    };
+
+    bool Issue(Root& root)
+    {
+        root.issued = ReadDirectoryChangesW(root.dir, root.buffer, sizeof(root.buffer), TRUE, kNotifyFilter,
+                                            nullptr, &root.overlapped, nullptr) != 0;
+        return root.issued;
+    }
+
+    static bool IsDirectory(const std::filesystem::path& path)
+    {
+        DWORD attributes = GetFileAttributesW(path.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+    }
+
+    void Parse(Root& root, DWORD bytes, std::vector<FileChange>& changes)
+    {
+        if (bytes == 0) {
+            // The buffer overflowed and the OS kept nothing
+            changes.push_back({FileChange::Kind::Overflow, true, root.path, {}});
+            return;
+        }
+        const uint8_t* p = root.buffer;
+        for (;;) {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p);
+            std::filesystem::path path =
+                root.path / std::wstring(info->FileName, info->FileNameLength / sizeof(wchar_t));
+            switch (info->Action) {
+                case FILE_ACTION_ADDED:
+                    changes.push_back({FileChange::Kind::Added, IsDirectory(path), path, {}});
+                    break;
+                case FILE_ACTION_REMOVED:
+                    changes.push_back({FileChange::Kind::Removed, false, path, {}});
+                    break;
+                case FILE_ACTION_MODIFIED:
+                    // A directory's own mtime moving says nothing new
+                    if (!IsDirectory(path)) changes.push_back({FileChange::Kind::Modified, false, path, {}});
+                    break;
+                case FILE_ACTION_RENAMED_OLD_NAME:
+                    root.renamedFrom = path;
+                    break;
+                case FILE_ACTION_RENAMED_NEW_NAME:
+                    if (root.renamedFrom.empty()) {
+                        changes.push_back({FileChange::Kind::Added, IsDirectory(path), path, {}});
+                    } else {
+                        changes.push_back({FileChange::Kind::Renamed, IsDirectory(path), path,
+                                           std::move(root.renamedFrom)});
+                        root.renamedFrom.clear();
+                    }
+                    break;
+            }
+            if (info->NextEntryOffset == 0) break;
+            p += info->NextEntryOffset;
+        }
+    }
+
+    void Run(std::stop_token stop)
+    {
+        std::vector<std::unique_ptr<Root>> roots;
+        std::vector<HANDLE> waits;
+        std::vector<FileChange> changes;
+        while (!stop.stop_requested()) {
+            // Start the reads of newly added roots
+            {
+                std::lock_guard lock(mutex_);
+                for (auto& root : added_) {
+                    root->overlapped.hEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+                    if (root->overlapped.hEvent && Issue(*root)) roots.push_back(std::move(root));
+                }
+                added_.clear();
+                watchCount_ = roots.size();
+            }
+
+            waits.assign(1, wake_);
+            for (auto& root : roots) waits.push_back(root->overlapped.hEvent);
+            DWORD signalled = WaitForMultipleObjects(static_cast<DWORD>(waits.size()), waits.data(),
+                                                     FALSE, INFINITE);
+            if (signalled == WAIT_OBJECT_0 || signalled >= WAIT_OBJECT_0 + waits.size()) continue;
+
+            size_t index = signalled - WAIT_OBJECT_0 - 1;
+            Root& root = *roots[index];
+            DWORD bytes = 0;
+            root.issued = false;
+            bool ok = GetOverlappedResult(root.dir, &root.overlapped, &bytes, FALSE) != 0;
+            if (!ok && GetLastError() == ERROR_NOTIFY_ENUM_DIR) {
+                ok = true;  // overflowed: reported as no bytes
+                bytes = 0;
+            }
+            if (ok) Parse(root, bytes, changes);
+            // Reissue right away; the root is gone if that fails (deleted)
+            if (!ok || !Issue(root)) {
+                roots.erase(roots.begin() + static_cast<ptrdiff_t>(index));
+                std::lock_guard lock(mutex_);
+                watchCount_ = roots.size();
+            }
+            if (!changes.empty()) {
+                callback_(changes);
+                changes.clear();
+            }
+        }
+    }
+
+    Callback callback_;
+    HANDLE wake_ = nullptr;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Root>> added_;  // guarded by mutex_
+    size_t watchCount_ = 0;                     // guarded by mutex_
+    std::jthread thread_;
+};
+
+#elif defined(__linux__)
+
+// inotify: a watch per directory, placed when a root is watched and when a
+// directory is created or moved in below one. A rename inside the trees
+// pairs IN_MOVED_FROM with IN_MOVED_TO by cookie within one read.
+class InotifyFileWatcher final : public FileWatcher {
+public:
+    InotifyFileWatcher(Callback callback, DirectoryFilter skipDirectory)
+        : callback_(std::move(callback))
+        , skipDirectory_(std::move(skipDirectory))
+    {
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wake_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd_ >= 0 && wake_ >= 0) {
+            thread_ = std::jthread([this](std::stop_token stop) { Run(stop); });
+        }
+    }
+
+    ~InotifyFileWatcher() override
+    {
+        if (thread_.joinable()) {
+            thread_.request_stop();
+            uint64_t one = 1;
+            (void)!write(wake_, &one, sizeof(one));
+            thread_.join();
+        }
+        if (fd_ >= 0) close(fd_);
+        if (wake_ >= 0) close(wake_);
+    }
+
+    bool Watch(const std::filesystem::path& root) override
+    {
+        if (!thread_.joinable()) return false;
+        std::lock_guard lock(mutex_);
+        roots_.push_back(root);
+        return AddTree(root);
+    }
+
+private:
+    static constexpr uint32_t kMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                      IN_CLOSE_WRITE | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+
+    // Watch `dir` and the directories below it. Caller holds mutex_.
+    bool AddTree(const std::filesystem::path& dir)
+    {
+        int wd = inotify_add_watch(fd_, dir.c_str(), kMask);
+        if (wd < 0) return false;  // gone again, or out of watches (ENOSPC)
+        paths_[wd] = dir;
+
+        bool ok = true;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(dir, std::filesystem::directory_options::skip_permission_denied, ec), end;
+             it != end; it.increment(ec)) {
+            if (!it->is_directory(ec) || it->is_symlink(ec)) continue;
+            if (skipDirectory_ && skipDirectory_(it->path().filename())) continue;
+            ok = AddTree(it->path()) && ok;
+        }
+        return ok;
+    }
+
+    // Stop watching `dir` and below (moved out of the trees). Caller holds mutex_.
+    void RemoveTree(const std::filesystem::path& dir)
+    {
+        const auto& prefix = dir.native();
+        for (auto it = paths_.begin(); it != paths_.end();) {
+            const auto& p = it->second.native();
+            if (p == prefix || (p.size() > prefix.size() && p.compare(0, prefix.size(), prefix) == 0 &&
+                                p[prefix.size()] == '/')) {
+                inotify_rm_watch(fd_, it->first);
+                it = paths_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Watches follow the inode: after a directory rename, re-point the
+    // paths of its subtree. Caller holds mutex_.
+    void MoveTree(const std::filesystem::path& from, const std::filesystem::path& to)
+    {
+        const auto& prefix = from.native();
+        for (auto& [wd, path] : paths_) {
+            const auto& p = path.native();
+            if (p == prefix) {
+                path = to;
+            } else if (p.size() > prefix.size() && p.compare(0, prefix.size(), prefix) == 0 &&
+                       p[prefix.size()] == '/') {
+                path = to.native() + p.substr(prefix.size());
+            }
+        }
+    }
+
+    void Parse(const uint8_t* buffer, size_t length, std::vector<FileChange>& changes)
+    {
+        struct PendingMove {
+            uint32_t cookie;
+            std::filesystem::path path;
+            bool directory;
+        };
+        std::vector<PendingMove> moves;
+
+        std::lock_guard lock(mutex_);
+        for (size_t pos = 0; pos < length;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + pos);
+            pos += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const auto& root : roots_) changes.push_back({FileChange::Kind::Overflow, true, root, {}});
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                paths_.erase(event->wd);
+                continue;
+            }
+            auto it = paths_.find(event->wd);
+            if (it == paths_.end() || event->len == 0) continue;
+
+            std::filesystem::path path = it->second / event->name;
+            const bool directory = (event->mask & IN_ISDIR) != 0;
+            if (directory && skipDirectory_ && skipDirectory_(event->name)) continue;
+
+            if (event->mask & IN_CREATE) {
+                if (directory) AddTree(path);
+                changes.push_back({FileChange::Kind::Added, directory, std::move(path), {}});
+            } else if (event->mask & IN_CLOSE_WRITE) {
+                changes.push_back({FileChange::Kind::Modified, false, std::move(path), {}});
+            } else if (event->mask & IN_DELETE) {
+                changes.push_back({FileChange::Kind::Removed, directory, std::move(path), {}});
+            } else if (event->mask & IN_MOVED_FROM) {
+                moves.push_back({event->cookie, std::move(path), directory});
+            } else if (event->mask & IN_MOVED_TO) {
+                auto from = std::find_if(moves.begin(), moves.end(),
+                                         [&](const PendingMove& m) { return m.cookie == event->cookie; });
+                if (from == moves.end()) {
+                    // Moved in from outside the trees
+                    if (directory) AddTree(path);
+                    changes.push_back({FileChange::Kind::Added, directory, std::move(path), {}});
+                } else {
+                    if (directory) MoveTree(from->path, path);
+                    changes.push_back({FileChange::Kind::Renamed, directory, std::move(path),
+                                       std::move(from->path)});
+                    moves.erase(from);
+                }
+            }
+        }
+
+        // Moved out of the trees (or the other half is in the next read)
+        for (auto& move : moves) {
+            if (move.directory) RemoveTree(move.path);
+            changes.push_back({FileChange::Kind::Removed, move.directory, std::move(move.path), {}});
+        }
+    }
+
+    void Run(std::stop_token stop)
+    {
+        alignas(struct inotify_event) uint8_t buffer[64 * 1024];
+        std::vector<FileChange> changes;
+        pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_, POLLIN, 0}};
+        while (!stop.stop_requested()) {
+            if (poll(fds, 2, -1) < 0 && errno != EINTR) break;
+            if (fds[1].revents & POLLIN) continue;  // Stop
+
+            ssize_t n;
+            while ((n = read(fd_, buffer, sizeof(buffer))) > 0) {
+                Parse(buffer, static_cast<size_t>(n), changes);
+            }
+            if (!changes.empty()) {
+                callback_(changes);
+                changes.clear();
+            }
+        }
+    }
+
+    Callback callback_;
+    DirectoryFilter skipDirectory_;
+    int fd_ = -1;
+    int wake_ = -1;
+    std::mutex mutex_;
+    std::vector<std::filesystem::path> roots_;                 // guarded by mutex_
+    std::unordered_map<int, std::filesystem::path> paths_;     // watch -> directory, guarded by mutex_
+    std::jthread thread_;
+};
+
+#endif
+
+} // namespace
+
+std::unique_ptr<FileWatcher> FileWatcher::Create(Callback callback, DirectoryFilter skipDirectory)
+{
+#ifdef _WIN32
+    return std::make_unique<WindowsFileWatcher>(std::move(callback), std::move(skipDirectory));
+#elif defined(__linux__)
+    return std::make_unique<InotifyFileWatcher>(std::move(callback), std::move(skipDirectory));
+#else
+    (void)callback;
+    (void)skipDirectory;
+    return nullptr;
+#endif
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
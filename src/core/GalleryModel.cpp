@@ -0,0 +1,480 @@
+#include "core/GalleryModel.hpp"
+#include "core/PathInterner.hpp"
+#include "core/SimdUtils.hpp"
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+using NameString = GalleryModel::NameString;
+using NameView = std::basic_string_view<std::filesystem::path::value_type>;
+
+#ifdef _WIN32
+constexpr const wchar_t* kSeparators = L"\\/";
+#else
+constexpr const char* kSeparators = "/";
+#endif
+
+// The file name part of a path, without building a path for it
+NameView FileName(const std::filesystem::path& path)
+{
+    NameView native = path.native();
+    size_t slash = native.find_last_of(kSeparators);
+    return slash == NameView::npos ? native : native.substr(slash + 1);
+}
+
+// Comparable form of a path or name, case-folded where the filesystem is
+// case-insensitive (as DirectoryScanner keys its index)
+NameString Fold(NameView name)
+{
+    NameString key(name);
+#ifdef _WIN32
+    Simd::ToLowerInPlace(key);
+#endif
+    return key;
+}
+
+size_t RowsOf(size_t count, int columns)
+{
+    return (count + static_cast<size_t>(columns) - 1) / static_cast<size_t>(columns);
+}
+
+// Merges the sorted run ids[old, end) into the sorted ids[0, old): one
+// binary search per run element and one backward pass of block moves, so a
+// small batch costs a memmove of the section rather than a compare per id
+template <typename Less>
+void MergeTail(std::vector<ImageId>& ids, size_t old, Less less)
+{
+    std::vector<ImageId> run(ids.begin() + static_cast<ptrdiff_t>(old), ids.end());
+    auto write = ids.end();
+    auto high = ids.begin() + static_cast<ptrdiff_t>(old);
+    for (size_t r = run.size(); r-- > 0;) {
+        auto pos = std::upper_bound(ids.begin(), high, run[r], less);
+        write = std::move_backward(pos, high, write);
+        *--write = run[r];
+        high = pos;
+    }
+}
+
+} // namespace
+
+bool GalleryModel::DateOrder(const ScannedImage& a, const ScannedImage& b)
+{
+    if (a.year != b.year) return a.year > b.year;
+    if (a.month != b.month) return a.month > b.month;
+    return FileName(a.path) < FileName(b.path);
+}
+
+GalleryModel::NameString GalleryModel::FolderKey(const std::filesystem::path& folder)
+{
+    return Fold(folder.native());
+}
+
+bool GalleryModel::Before(ImageId a, ImageId b) const
+{
+    const Info& ia = info_[a];
+    const Info& ib = info_[b];
+    if (ia.year != ib.year) return ia.year > ib.year;
+    if (ia.month != ib.month) return ia.month > ib.month;
+    auto& interner = PathInterner::Global();
+    return FileName(interner.Path(a)) < FileName(interner.Path(b));
+}
+
+void GalleryModel::Clear()
+{
+    sections_.clear();
+    info_.clear();
+    sources_.clear();
+    folders_.clear();
+    size_ = 0;
+    list_ = false;
+    counts_.Clear();
+    rowColumns_ = 0;
+    ++version_;
+}
+
+void GalleryModel::Assign(std::vector<ScannedImage> images)
+{
+    Clear();
+    std::erase_if(images, [](const ScannedImage& img) { return img.id == kInvalidImageId; });
+    if (!std::is_sorted(images.begin(), images.end(), DateOrder)) {
+        std::sort(images.begin(), images.end(), DateOrder);
+    }
+
+    ImageId maxId = 0;
+    for (const auto& img : images) maxId = std::max(maxId, img.id);
+    info_.resize(images.empty() ? 0 : size_t{maxId} + 1);
+
+    Folder* folder = nullptr;
+    for (const auto& img : images) {
+        Info& info = info_[img.id];
+        if (info.present) continue;  // listed twice: the first stays
+        info = {img.year, static_cast<uint8_t>(img.month), true, SourceIndex(img.sourceFolder)};
+        if (sections_.empty() || sections_.back().year != img.year ||
+            sections_.back().month != img.month) {
+            sections_.push_back({img.year, img.month, {}});
+        }
+        sections_.back().ids.push_back(img.id);
+        AddToFolder(img, folder);
+        ++size_;
+    }
+    RebuildTrees();
+}
+
+void GalleryModel::AssignList(const std::vector<ScannedImage>& images)
+{
+    Clear();
+    list_ = true;
+    Insert(images);
+}
+
+bool GalleryModel::Unchanged(const ScannedImage& img) const
+{
+    if (!Contains(img.id)) return false;
+    const Info& info = info_[img.id];
+    return info.year == img.year && info.month == img.month &&
+           sources_[info.source].native() == img.sourceFolder.native();
+}
+
+void GalleryModel::Insert(std::vector<ScannedImage> batch)
+{
+    // The last of an id in the batch wins; an image already here is taken
+    // out first unless nothing about it changed
+    std::vector<ImageId> replaced;
+    std::unordered_set<ImageId> seen;
+    seen.reserve(batch.size());
+    ImageId maxId = 0;
+    for (size_t i = batch.size(); i-- > 0;) {
+        auto& img = batch[i];
+        if (img.id == kInvalidImageId) continue;
+        if (!seen.insert(img.id).second || Unchanged(img)) {
+            img.id = kInvalidImageId;
+            continue;
+        }
+        if (Contains(img.id)) replaced.push_back(img.id);
+        maxId = std::max(maxId, img.id);
+    }
+    std::erase_if(batch, [](const ScannedImage& img) { return img.id == kInvalidImageId; });
+    if (!replaced.empty()) RemoveIds(replaced);
+    if (batch.empty()) return;
+
+    if (maxId >= info_.size()) info_.resize(size_t{maxId} + 1);
+    if (!list_ && !std::is_sorted(batch.begin(), batch.end(), DateOrder)) {
+        std::sort(batch.begin(), batch.end(), DateOrder);
+    }
+    Folder* folder = nullptr;
+    for (const auto& img : batch) {
+        info_[img.id] = {img.year, static_cast<uint8_t>(img.month), true, SourceIndex(img.sourceFolder)};
+        AddToFolder(img, folder);
+    }
+    size_ += batch.size();
+
+    // Months new to the model first, so section positions hold below
+    bool newSections = false;
+    if (list_) {
+        if (sections_.empty()) {
+            sections_.push_back({});
+            newSections = true;
+        }
+    } else {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (i > 0 && batch[i].year == batch[i - 1].year && batch[i].month == batch[i - 1].month) continue;
+            if (FindSection(batch[i].year, batch[i].month) == sections_.size()) {
+                AddSection(batch[i].year, batch[i].month);
+                newSections = true;
+            }
+        }
+    }
+
+    // Each month's run of the batch merges into its section
+    auto less = [this](ImageId a, ImageId b) { return Before(a, b); };
+    for (size_t begin = 0, end; begin < batch.size(); begin = end) {
+        end = begin + 1;
+        while (end < batch.size() && (list_ || (batch[end].year == batch[begin].year &&
+                                                batch[end].month == batch[begin].month))) {
+            ++end;
+        }
+        size_t s = list_ ? 0 : FindSection(batch[begin].year, batch[begin].month);
+        auto& ids = sections_[s].ids;
+        size_t old = ids.size();
+        for (size_t i = begin; i < end; ++i) ids.push_back(batch[i].id);
+        if (!list_ && old > 0 && less(ids[old], ids[old - 1])) MergeTail(ids, old, less);
+
+        if (newSections) continue;
+        counts_.Add(s, end - begin);
+        if (rowColumns_ > 0) rows_.Add(s, RowsOf(ids.size(), rowColumns_) - RowsOf(old, rowColumns_));
+    }
+    if (newSections) RebuildTrees();
+    ++version_;
+}
+
+std::vector<ImageId> GalleryModel::Remove(const std::vector<std::filesystem::path>& paths)
+{
+    std::vector<ImageId> removed;
+    if (paths.empty()) return removed;
+
+    std::vector<NameString> keys;
+    keys.reserve(paths.size());
+    for (const auto& path : paths) keys.push_back(FolderKey(path));
+    std::sort(keys.begin(), keys.end());
+    auto isRemoved = [&](NameView key) {
+        for (;;) {
+            if (std::binary_search(keys.begin(), keys.end(), key)) return true;
+            size_t slash = key.find_last_of(kSeparators);
+            if (slash == NameView::npos || slash == 0) return false;
+            key = key.substr(0, slash);
+        }
+    };
+
+    // Folders at or below a removed path go whole
+    for (const auto& [key, folder] : folders_) {
+        if (isRemoved(key)) removed.insert(removed.end(), folder.ids.begin(), folder.ids.end());
+    }
+
+    // Single photos, found by name in their folder
+    std::unordered_map<NameString, std::vector<NameString>> names;
+    for (const auto& path : paths) {
+        names[FolderKey(path.parent_path())].push_back(Fold(FileName(path)));
+    }
+    auto& interner = PathInterner::Global();
+    for (auto& [key, list] : names) {
+        auto it = folders_.find(key);
+        if (it == folders_.end() || isRemoved(key)) continue;
+        std::sort(list.begin(), list.end());
+        for (ImageId id : it->second.ids) {
+            if (std::binary_search(list.begin(), list.end(), Fold(FileName(interner.Path(id))))) {
+                removed.push_back(id);
+            }
+        }
+    }
+
+    RemoveIds(removed);
+    return removed;
+}
+
+std::vector<ImageId> GalleryModel::RemoveFolder(const std::filesystem::path& folder)
+{
+    std::vector<ImageId> removed;
+    auto it = folders_.find(FolderKey(folder));
+    if (it == folders_.end()) return removed;
+    removed = it->second.ids;
+    RemoveIds(removed);
+    return removed;
+}
+
+std::vector<ImageId> GalleryModel::Sync(const std::vector<ScannedImage>& images)
+{
+    if (size_ == 0 && !list_) {
+        Assign(images);
+        return {};
+    }
+
+    std::vector<uint8_t> listed(info_.size());
+    std::vector<ScannedImage> batch;
+    for (const auto& img : images) {
+        if (img.id == kInvalidImageId) continue;
+        if (img.id < listed.size()) listed[img.id] = 1;
+        if (!Unchanged(img)) batch.push_back(img);
+    }
+
+    std::vector<ImageId> removed;
+    for (const auto& section : sections_) {
+        for (ImageId id : section.ids) {
+            if (!listed[id]) removed.push_back(id);
+        }
+    }
+    RemoveIds(removed);
+    Insert(std::move(batch));
+    return removed;
+}
+
+void GalleryModel::RemoveIds(std::vector<ImageId>& ids)
+{
+    // Mark, then sweep each section and folder touched once
+    std::vector<size_t> sections;
+    std::vector<NameString> folders;
+    auto& interner = PathInterner::Global();
+    std::erase_if(ids, [&](ImageId id) {
+        if (!Contains(id)) return true;  // not here, or listed twice
+        Info& info = info_[id];
+        info.present = false;
+        sections.push_back(list_ ? 0 : FindSection(info.year, info.month));
+        folders.push_back(FolderKey(interner.Path(id).parent_path()));
+        return false;
+    });
+    if (ids.empty()) return;
+    size_ -= ids.size();
+
+    std::sort(sections.begin(), sections.end());
+    sections.erase(std::unique(sections.begin(), sections.end()), sections.end());
+    bool emptied = false;
+    for (size_t s : sections) {
+        auto& section = sections_[s].ids;
+        size_t old = section.size();
+        std::erase_if(section, [this](ImageId id) { return !info_[id].present; });
+        if (section.empty()) {
+            emptied = true;
+            continue;
+        }
+        counts_.Subtract(s, old - section.size());
+        if (rowColumns_ > 0) rows_.Subtract(s, RowsOf(old, rowColumns_) - RowsOf(section.size(), rowColumns_));
+    }
+    if (emptied) {
+        std::erase_if(sections_, [](const Section& section) { return section.ids.empty(); });
+        RebuildTrees();
+    }
+
+    std::sort(folders.begin(), folders.end());
+    folders.erase(std::unique(folders.begin(), folders.end()), folders.end());
+    for (const auto& key : folders) {
+        auto it = folders_.find(key);
+        if (it == folders_.end()) continue;
+        Folder& folder = it->second;
+        std::erase_if(folder.ids, [this](ImageId id) { return !info_[id].present; });
+        if (folder.ids.empty()) {
+            folders_.erase(it);
+        } else if (!info_[folder.cover].present) {
+            folder.cover = *std::min_element(folder.ids.begin(), folder.ids.end(),
+                                             [this](ImageId a, ImageId b) { return Before(a, b); });
+        }
+    }
+    ++version_;
+}
+
+void GalleryModel::AddToFolder(const ScannedImage& img, Folder*& last)
+{
+    // Scans deliver a folder's photos together: most are in the last one
+    NameView native = img.path.native();
+    if (last) {
+        const NameString& dir = last->path.native();
+        bool same = native.size() > dir.size() && native.compare(0, dir.size(), dir) == 0 &&
+                    NameView(kSeparators).find(native[dir.size()]) != NameView::npos &&
+                    native.find_first_of(kSeparators, dir.size() + 1) == NameView::npos;
+        if (!same) last = nullptr;
+    }
+    if (!last) {
+        auto parent = img.path.parent_path();
+        auto [it, inserted] = folders_.try_emplace(FolderKey(parent));
+        if (inserted) it->second.path = std::move(parent);
+        last = &it->second;
+    }
+    last->ids.push_back(img.id);
+    if (last->cover == kInvalidImageId || Before(img.id, last->cover)) last->cover = img.id;
+}
+
+size_t GalleryModel::FindSection(int year, int month) const
+{
+    auto it = std::lower_bound(sections_.begin(), sections_.end(), std::make_pair(year, month),
+        [](const Section& section, const std::pair<int, int>& key) {
+            return section.year != key.first ? section.year > key.first : section.month > key.second;
+        });
+    if (it == sections_.end() || it->year != year || it->month != month) return sections_.size();
+    return static_cast<size_t>(it - sections_.begin());
+}
+
+size_t GalleryModel::AddSection(int year, int month)
+{
+    auto it = std::lower_bound(sections_.begin(), sections_.end(), std::make_pair(year, month),
+        [](const Section& section, const std::pair<int, int>& key) {
+            return section.year != key.first ? section.year > key.first : section.month > key.second;
+        });
+    it = sections_.insert(it, Section{year, month, {}});
+    return static_cast<size_t>(it - sections_.begin());
+}
+
+uint16_t GalleryModel::SourceIndex(const std::filesystem::path& source)
+{
+    auto it = std::find_if(sources_.begin(), sources_.end(),
+                           [&](const auto& known) { return known.native() == source.native(); });
+    if (it != sources_.end()) return static_cast<uint16_t>(it - sources_.begin());
+    sources_.push_back(source);
+    return static_cast<uint16_t>(sources_.size() - 1);
+}
+
+void GalleryModel::RebuildTrees()
+{
+    std::vector<size_t> counts;
+    counts.reserve(sections_.size());
+    for (const auto& section : sections_) counts.push_back(section.ids.size());
+    counts_.Assign(counts);
+    rowColumns_ = 0;  // rows_ follows on the next RowsBefore
+}
+
+std::pair<size_t, size_t> GalleryModel::Locate(size_t index) const
+{
+    size_t section = counts_.Find(index);
+    return {section, index - counts_.Prefix(section)};
+}
+
+size_t GalleryModel::RowsBefore(size_t section, int columns) const
+{
+    columns = std::max(columns, 1);
+    if (rowColumns_ != columns) {
+        std::vector<size_t> rows;
+        rows.reserve(sections_.size());
+        for (const auto& s : sections_) rows.push_back(RowsOf(s.ids.size(), columns));
+        rows_.Assign(rows);
+        rowColumns_ = columns;
+    }
+    return rows_.Prefix(section);
+}
+
+size_t GalleryModel::SectionAt(double offset, double sectionSpan, double rowSpan, int columns) const
+{
+    if (sections_.empty()) return 0;
+    RowsBefore(0, columns);  // rows_ at this column count
+    // Sections starting at or before offset; the section start grows with both terms
+    size_t starting = rows_.Search([&](size_t rows, size_t sections) {
+        return static_cast<double>(sections) * sectionSpan + static_cast<double>(rows) * rowSpan <= offset;
+    });
+    return std::min(starting, sections_.size() - 1);
+}
+
+const GalleryModel::Folder* GalleryModel::FindFolder(const std::filesystem::path& folder) const
+{
+    auto it = folders_.find(FolderKey(folder));
+    return it != folders_.end() ? &it->second : nullptr;
+}
+
+ScannedImage GalleryModel::Image(ImageId id) const
+{
+    const Info& info = info_[id];
+    ScannedImage img;
+    img.path = PathInterner::Global().Path(id);
+    img.id = id;
+    img.sourceFolder = sources_[info.source];
+    img.year = info.year;
+    img.month = info.month;
+    return img;
+}
+
+std::vector<ScannedImage> GalleryModel::Images() const
+{
+    std::vector<ScannedImage> images;
+    images.reserve(size_);
+    for (const auto& section : sections_) {
+        for (ImageId id : section.ids) images.push_back(Image(id));
+    }
+    return images;
+}
+
+const std::vector<std::filesystem::path>& GalleryModel::Paths() const
+{
+    if (pathsVersion_ != version_) {
+        auto& interner = PathInterner::Global();
+        paths_.clear();
+        paths_.reserve(size_);
+        for (const auto& section : sections_) {
+            for (ImageId id : section.ids) paths_.push_back(interner.Path(id));
+        }
+        pathsVersion_ = version_;
+    }
+    return paths_;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
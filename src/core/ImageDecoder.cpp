@@ -1,4 +1,8 @@
 #include "core/ImageDecoder.hpp"
+#include "core/ExifThumbnail.hpp"
+#include "core/JpegThumbnail.hpp"
+#include "core/Platform.hpp"
+#include "core/Resampler.hpp"
 #include "core/SimdUtils.hpp"
 #include <stdexcept>
 #include <algorithm>
@@ -8,6 +12,9 @@
 namespace UltraImageViewer {
 namespace Core {
 
+// Source rows decoded per CopyPixels call when generating thumbnails
+static constexpr uint32_t kThumbnailStripRows = 64;
+
 ImageDecoder::ImageDecoder()
 {
     // Initialize WIC factory
@@ -101,6 +108,31 @@ std::unique_ptr<DecodedImage> ImageDecoder::GenerateThumbnail(
     const std::filesystem::path& filePath,
     uint32_t maxSize)
 {
+    // Camera JPEGs and RAWs usually embed a preview (EXIF IFD1, MPF, RAW
+    // SubIFDs) big enough for a thumbnail; decode that instead of the image
+    if (IsJpegPath(filePath) || IsTiffRawPath(filePath)) {
+        std::unique_ptr<DecodedImage> image;
+        Platform::FileMapping mapping;
+        if (Platform::MapFileReadOnly(filePath, mapping)) {
+            EmbeddedPreview preview;
+            if (FindEmbeddedPreview(mapping.data, mapping.size, maxSize, preview) &&
+                preview.length <= MAXDWORD) {
+                Microsoft::WRL::ComPtr<IWICStream> stream;
+                Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+                if (SUCCEEDED(wicFactory_->CreateStream(&stream)) &&
+                    SUCCEEDED(stream->InitializeFromMemory(
+                        const_cast<BYTE*>(mapping.data + preview.offset),
+                        static_cast<DWORD>(preview.length))) &&
+                    SUCCEEDED(wicFactory_->CreateDecoderFromStream(
+                        stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder))) {
+                    image = ThumbnailFromDecoder(decoder.Get(), filePath, maxSize);
+                }
+            }
+            Platform::UnmapFile(mapping);
+        }
+        if (image) return image;
+    }
+
     Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
     HRESULT hr = wicFactory_->CreateDecoderFromFilename(
         filePath.c_str(),
@@ -113,9 +145,16 @@ std::unique_ptr<DecodedImage> ImageDecoder::GenerateThumbnail(
     if (FAILED(hr)) {
         return nullptr;
     }
+    return ThumbnailFromDecoder(decoder.Get(), filePath, maxSize);
+}
 
+std::unique_ptr<DecodedImage> ImageDecoder::ThumbnailFromDecoder(
+    IWICBitmapDecoder* decoder,
+    const std::filesystem::path& filePath,
+    uint32_t maxSize)
+{
     Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
-    hr = decoder->GetFrame(0, &frame);
+    HRESULT hr = decoder->GetFrame(0, &frame);
     if (FAILED(hr)) {
         return nullptr;
     }
@@ -126,37 +165,40 @@ std::unique_ptr<DecodedImage> ImageDecoder::GenerateThumbnail(
 
     // Calculate thumbnail size maintaining aspect ratio
     uint32_t thumbWidth, thumbHeight;
-    if (width > height) {
-        thumbWidth = maxSize;
-        thumbHeight = static_cast<uint32_t>((static_cast<float>(height) / width) * maxSize);
-    } else {
-        thumbHeight = maxSize;
-        thumbWidth = static_cast<uint32_t>((static_cast<float>(width) / height) * maxSize);
+    ThumbnailScaler::FitWithin(width, height, maxSize, thumbWidth, thumbHeight);
+    if (thumbWidth == 0 || thumbHeight == 0) {
+        return nullptr;
     }
 
-    // Create thumbnail
-    Microsoft::WRL::ComPtr<IWICBitmapScaler> scaler;
-    wicFactory_->CreateBitmapScaler(&scaler);
-
-    scaler->Initialize(
-        frame.Get(),
-        thumbWidth,
-        thumbHeight,
-        WICBitmapInterpolationModeFant
-    );
-
-    // Convert to 32-bit BGRA
+    // Convert to 32-bit premultiplied BGRA at full size; the in-house
+    // scaler consumes it in strips so the full image is never resident
     Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
     wicFactory_->CreateFormatConverter(&converter);
 
-    converter->Initialize(
-        scaler.Get(),
+    hr = converter->Initialize(
+        frame.Get(),
         GUID_WICPixelFormat32bppPBGRA,
         WICBitmapDitherTypeNone,
         nullptr,
         0.0,
         WICBitmapPaletteTypeCustom
     );
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    ThumbnailScaler scaler(width, height, thumbWidth, thumbHeight);
+    const UINT stripStride = width * 4;
+    std::vector<uint8_t> strip(static_cast<size_t>(stripStride) * kThumbnailStripRows);
+    for (uint32_t y = 0; y < height; y += kThumbnailStripRows) {
+        UINT rows = std::min<UINT>(kThumbnailStripRows, height - y);
+        WICRect rect = {0, static_cast<INT>(y), static_cast<INT>(width), static_cast<INT>(rows)};
+        hr = converter->CopyPixels(&rect, stripStride, stripStride * rows, strip.data());
+        if (FAILED(hr)) {
+            return nullptr;
+        }
+        scaler.PushRows(strip.data(), stripStride, rows);
+    }
 
     // Allocate buffer
     auto image = std::make_unique<DecodedImage>();
@@ -168,15 +210,7 @@ std::unique_ptr<DecodedImage> ImageDecoder::GenerateThumbnail(
     image->info.dataSize = thumbWidth * thumbHeight * 4;
     image->data = std::make_unique<uint8_t[]>(image->info.dataSize);
 
-    // Copy pixels
-    hr = converter->CopyPixels(
-        nullptr,
-        thumbWidth * 4,
-        image->info.dataSize,
-        image->data.get()
-    );
-
-    if (FAILED(hr)) {
+    if (!scaler.Finish(image->data.get(), thumbWidth * 4)) {
         return nullptr;
     }
 
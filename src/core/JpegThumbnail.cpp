@@ -0,0 +1,203 @@
+#include "core/JpegThumbnail.hpp"
+#include "core/ExifThumbnail.hpp"
+#include "core/Platform.hpp"
+#include "core/Resampler.hpp"
+#include "core/SimdUtils.hpp"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if defined(UIV_HAVE_LIBJPEG)
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+namespace UltraImageViewer {
+namespace Core {
+
+bool IsJpegPath(const std::filesystem::path& path)
+{
+    std::wstring ext = path.extension().wstring();
+    Simd::ToLowerInPlace(ext);
+    return ext == L".jpg" || ext == L".jpeg" || ext == L".jpe" || ext == L".jfif";
+}
+
+#if defined(UIV_HAVE_LIBJPEG)
+
+namespace {
+
+// Scanlines handed to ThumbnailScaler per batch
+constexpr uint32_t kStripRows = 16;
+
+struct ErrorManager {
+    jpeg_error_mgr pub;
+    std::jmp_buf jump;
+};
+
+[[noreturn]] void OnJpegError(j_common_ptr cinfo)
+{
+    std::longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->jump, 1);
+}
+
+void OnJpegMessage(j_common_ptr) {}
+
+// Everything libjpeg touches lives on the heap: locals modified between
+// setjmp and longjmp are indeterminate afterwards, heap objects are not.
+struct DecodeState {
+    jpeg_decompress_struct cinfo{};
+    ErrorManager err{};
+    std::vector<uint8_t> strip;
+#if !defined(JCS_EXTENSIONS)
+    std::vector<uint8_t> rgb;
+#endif
+    std::unique_ptr<ThumbnailScaler> scaler;
+};
+
+} // namespace
+
+bool JpegThumbnailAvailable() { return true; }
+
+bool DecodeJpegThumbnail(const uint8_t* data, size_t size, uint32_t targetSize,
+                         PixelBuffer& out, bool dctScaling)
+{
+    if (!data || size == 0 || targetSize == 0) return false;
+
+    auto state = std::make_unique<DecodeState>();
+    jpeg_decompress_struct* cinfo = &state->cinfo;
+    cinfo->err = jpeg_std_error(&state->err.pub);
+    state->err.pub.error_exit = OnJpegError;
+    state->err.pub.output_message = OnJpegMessage;
+
+    if (setjmp(state->err.jump)) {
+        jpeg_destroy_decompress(cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(cinfo);
+    jpeg_mem_src(cinfo, const_cast<uint8_t*>(data), static_cast<unsigned long>(size));
+    if (jpeg_read_header(cinfo, TRUE) != JPEG_HEADER_OK) {
+        jpeg_destroy_decompress(cinfo);
+        return false;
+    }
+
+    uint32_t thumbWidth, thumbHeight;
+    ThumbnailScaler::FitWithin(cinfo->image_width, cinfo->image_height, targetSize,
+                               thumbWidth, thumbHeight);
+
+    // Largest IDCT reduction whose output still covers the thumbnail, so the
+    // final resample only ever reduces
+    unsigned denom = 1;
+    while (dctScaling && denom < 8 &&
+           cinfo->image_width / (denom * 2) >= thumbWidth &&
+           cinfo->image_height / (denom * 2) >= thumbHeight) {
+        denom *= 2;
+    }
+    cinfo->scale_num = 1;
+    cinfo->scale_denom = denom;
+    cinfo->dct_method = JDCT_IFAST;
+    cinfo->do_fancy_upsampling = FALSE;
+#if defined(JCS_EXTENSIONS)
+    cinfo->out_color_space = JCS_EXT_BGRA;
+#else
+    cinfo->out_color_space = JCS_RGB;
+#endif
+
+    jpeg_start_decompress(cinfo);
+
+    const uint32_t width = cinfo->output_width;
+    const uint32_t height = cinfo->output_height;
+    const size_t stride = static_cast<size_t>(width) * 4;
+    state->scaler = std::make_unique<ThumbnailScaler>(width, height, thumbWidth, thumbHeight);
+    state->strip.resize(stride * kStripRows);
+#if !defined(JCS_EXTENSIONS)
+    state->rgb.resize(static_cast<size_t>(width) * 3 * kStripRows);
+#endif
+
+    JSAMPROW rows[kStripRows];
+    for (uint32_t r = 0; r < kStripRows; ++r) {
+#if defined(JCS_EXTENSIONS)
+        rows[r] = state->strip.data() + r * stride;
+#else
+        rows[r] = state->rgb.data() + r * static_cast<size_t>(width) * 3;
+#endif
+    }
+
+    while (cinfo->output_scanline < height) {
+        uint32_t got = 0;
+        while (got < kStripRows && cinfo->output_scanline < height) {
+            got += jpeg_read_scanlines(cinfo, rows + got, kStripRows - got);
+        }
+#if !defined(JCS_EXTENSIONS)
+        Simd::Rgb24ToBgra32(state->rgb.data(), state->strip.data(), static_cast<size_t>(width) * got);
+#endif
+        state->scaler->PushRows(state->strip.data(), stride, got);
+    }
+
+    jpeg_finish_decompress(cinfo);
+    jpeg_destroy_decompress(cinfo);
+
+    auto pixels = std::make_unique<uint8_t[]>(static_cast<size_t>(thumbWidth) * thumbHeight * 4);
+    if (!state->scaler->Finish(pixels.get(), static_cast<size_t>(thumbWidth) * 4)) return false;
+
+    out.pixels = std::move(pixels);
+    out.width = thumbWidth;
+    out.height = thumbHeight;
+    return true;
+}
+
+#else
+
+bool JpegThumbnailAvailable() { return false; }
+
+bool DecodeJpegThumbnail(const uint8_t*, size_t, uint32_t, PixelBuffer&, bool)
+{
+    return false;
+}
+
+#endif
+
+bool DecodeJpegThumbnail(const std::filesystem::path& path, uint32_t targetSize,
+                         PixelBuffer& out, bool dctScaling)
+{
+    if (!JpegThumbnailAvailable()) return false;
+
+    Platform::FileMapping mapping;
+    if (!Platform::MapFileReadOnly(path, mapping)) return false;
+    bool ok = DecodeJpegThumbnail(mapping.data, mapping.size, targetSize, out, dctScaling);
+    Platform::UnmapFile(mapping);
+    return ok;
+}
+
+bool JpegPixelSource::DecodeThumbnail(const std::filesystem::path& path, uint32_t targetSize,
+                                      PixelBuffer& out)
+{
+    const bool jpeg = IsJpegPath(path);
+    if ((jpeg || IsTiffRawPath(path)) && JpegThumbnailAvailable()) {
+        Platform::FileMapping mapping;
+        if (Platform::MapFileReadOnly(path, mapping)) {
+            bool ok = false;
+            EmbeddedPreview preview;
+            if (embeddedPreviews_) {
+                // Only the header and the preview should be read from disk
+                Platform::AdviseMapping(mapping, Platform::MappingAdvice::Random);
+                if (FindEmbeddedPreview(mapping.data, mapping.size, targetSize, preview)) {
+                    Platform::AdviseMapping(mapping, Platform::MappingAdvice::WillNeed,
+                                            preview.offset, preview.length);
+                    ok = DecodeJpegThumbnail(mapping.data + preview.offset, preview.length,
+                                             targetSize, out);
+                }
+            }
+            if (!ok && jpeg) {
+                Platform::AdviseMapping(mapping, Platform::MappingAdvice::Sequential);
+                ok = DecodeJpegThumbnail(mapping.data, mapping.size, targetSize, out);
+            }
+            Platform::UnmapFile(mapping);
+            if (ok) return true;
+        }
+    }
+    return fallback_ && fallback_->DecodeThumbnail(path, targetSize, out);
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,306 @@
+#include "core/LibraryWatcher.hpp"
+#include "core/SimdUtils.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+using NameString = std::filesystem::path::string_type;
+using NameChar = std::filesystem::path::value_type;
+
+constexpr NameChar kSeparator = std::filesystem::path::preferred_separator;
+
+// Comparable form of a path, case-folded where the filesystem is
+// case-insensitive (as DirectoryScanner keys its index)
+NameString PathKey(const NameString& path)
+{
+    NameString key = path;
+#ifdef _WIN32
+    Simd::ToLowerInPlace(key);
+#endif
+    return key;
+}
+
+// `path` lies strictly below directory `dir`
+bool IsBelow(const NameString& path, const NameString& dir)
+{
+    if (path.size() <= dir.size() || path.compare(0, dir.size(), dir) != 0) return false;
+    return dir.back() == kSeparator || path[dir.size()] == kSeparator;
+}
+
+// A root as DirectoryScanner spells the paths below it
+std::filesystem::path NormalizeRoot(const std::filesystem::path& root)
+{
+    NameString path = root.lexically_normal().native();
+    while (path.size() > 1 && path.back() == kSeparator &&
+           path[path.size() - 2] != kSeparator && path[path.size() - 2] != NameChar(':')) {
+        path.pop_back();
+    }
+    return path;
+}
+
+// Coalesced state of one path within a batch
+struct PendingPath {
+    std::filesystem::path path;
+    bool appeared = false;              // created or moved in (a directory needs walking)
+    std::filesystem::path renamedFrom;  // photo it was moved from, through any chain of moves
+};
+
+} // namespace
+
+LibraryWatcher::LibraryWatcher(const std::vector<std::filesystem::path>& roots,
+                               const DirectoryScanner::Config& config,
+                               std::function<void()> notify)
+    : LibraryWatcher(roots, config, std::move(notify), Options())
+{
+}
+
+LibraryWatcher::LibraryWatcher(const std::vector<std::filesystem::path>& roots,
+                               const DirectoryScanner::Config& config,
+                               std::function<void()> notify,
+                               const Options& options)
+    : config_(config)
+    , options_(options)
+    , notify_(std::move(notify))
+    , pool_(std::max<uint32_t>(1, options.scanThreads))
+    , scanner_(&pool_, config)
+{
+    for (const auto& root : roots) {
+        roots_.push_back(NormalizeRoot(root));
+        rootKeys_.push_back(PathKey(roots_.back().native()));
+    }
+
+    watcher_ = FileWatcher::Create(
+        [this](std::vector<FileChange>& changes) { OnEvents(changes); },
+        [this](const std::filesystem::path& name) { return scanner_.SkipsDirectory(name); });
+    if (!watcher_) return;
+
+    thread_ = std::jthread([this](std::stop_token stop) { Run(stop); });
+    watching_ = true;
+    for (const auto& root : roots_) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(root, ec) || !watcher_->Watch(root)) watching_ = false;
+    }
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+    // The FileWatcher goes first so no events arrive while the rest stops
+    watcher_.reset();
+    cancel_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+}
+
+LibraryChanges LibraryWatcher::TakeChanges()
+{
+    std::lock_guard lock(mutex_);
+    LibraryChanges changes = std::move(ready_);
+    ready_ = LibraryChanges();
+    hasChanges_.store(false, std::memory_order_release);
+    return changes;
+}
+
+void LibraryWatcher::OnEvents(std::vector<FileChange>& changes)
+{
+    auto now = Clock::now();
+    std::lock_guard lock(mutex_);
+    if (events_.empty()) firstEvent_ = now;
+    lastEvent_ = now;
+    std::move(changes.begin(), changes.end(), std::back_inserter(events_));
+    cv_.notify_one();
+}
+
+void LibraryWatcher::Run(std::stop_token stop)
+{
+    std::unique_lock lock(mutex_);
+    while (!stop.stop_requested()) {
+        if (events_.empty()) {
+            cv_.wait(lock, stop, [this] { return !events_.empty(); });
+            continue;
+        }
+        // Let a burst settle, but don't hold its start back for too long
+        auto due = std::min(lastEvent_ + options_.settle, firstEvent_ + options_.maxDelay);
+        if (Clock::now() < due) {
+            cv_.wait_until(lock, stop, due, [] { return false; });
+            continue;
+        }
+
+        std::vector<FileChange> events = std::move(events_);
+        events_.clear();
+        lock.unlock();
+        LibraryChanges batch;
+        Resolve(events, batch);
+        lock.lock();
+
+        if (batch.Empty() || stop.stop_requested()) continue;
+        Merge(batch);
+        hasChanges_.store(true, std::memory_order_release);
+        if (notify_) {
+            lock.unlock();
+            notify_();
+            lock.lock();
+        }
+    }
+}
+
+int LibraryWatcher::RootOf(const std::filesystem::path& path) const
+{
+    const NameString& native = path.native();
+    NameString key = PathKey(native);
+    for (size_t i = 0; i < rootKeys_.size(); ++i) {
+        const NameString& root = rootKeys_[i];
+        if (key == root) return static_cast<int>(i);
+        if (!IsBelow(key, root)) continue;
+
+        // The directories between the root and the path's own name
+        size_t start = root.size() + (root.back() == kSeparator ? 0 : 1);
+        for (size_t end; (end = native.find(kSeparator, start)) != NameString::npos; start = end + 1) {
+            if (scanner_.SkipsDirectory(native.substr(start, end - start))) return -1;
+        }
+        return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void LibraryWatcher::Resolve(std::vector<FileChange>& events, LibraryChanges& out)
+{
+    // Replay the events per path, keeping first-seen order
+    std::vector<PendingPath> pending;
+    std::unordered_map<NameString, size_t> byKey;
+    auto touch = [&](std::filesystem::path path) -> PendingPath& {
+        auto [it, inserted] = byKey.try_emplace(PathKey(path.native()), pending.size());
+        if (inserted) pending.push_back({std::move(path), false, {}});
+        return pending[it->second];
+    };
+
+    for (auto& event : events) {
+        switch (event.kind) {
+            case FileChange::Kind::Overflow:
+                out.rescan = true;
+                break;
+            case FileChange::Kind::Added:
+                if (RootOf(event.path) >= 0) touch(std::move(event.path)).appeared = true;
+                break;
+            case FileChange::Kind::Modified:
+                if (RootOf(event.path) >= 0) touch(std::move(event.path));
+                break;
+            case FileChange::Kind::Removed:
+                if (RootOf(event.path) >= 0) {
+                    PendingPath& entry = touch(std::move(event.path));
+                    entry.appeared = false;
+                    entry.renamedFrom.clear();
+                }
+                break;
+            case FileChange::Kind::Renamed: {
+                // The photo a chain of moves started from, if it was in the library
+                std::filesystem::path origin;
+                if (RootOf(event.oldPath) >= 0) {
+                    PendingPath& from = touch(std::move(event.oldPath));
+                    origin = from.renamedFrom.empty() && !from.appeared ? from.path : from.renamedFrom;
+                    from.appeared = false;
+                    from.renamedFrom.clear();
+                }
+                if (RootOf(event.path) >= 0) {
+                    PendingPath& to = touch(std::move(event.path));
+                    to.appeared = true;
+                    to.renamedFrom = event.directory ? std::filesystem::path() : std::move(origin);
+                }
+                break;
+            }
+        }
+    }
+    if (out.rescan) return;  // the rescan covers all of it
+
+    // Whatever each path is now decides; later events will say if it changes again
+    for (auto& entry : pending) {
+        std::error_code ec;
+        auto status = std::filesystem::symlink_status(entry.path, ec);
+        if (std::filesystem::is_regular_file(status)) {
+            uint64_t size = std::filesystem::file_size(entry.path, ec);
+            auto written = std::filesystem::last_write_time(entry.path, ec);
+            if (!ec && scanner_.AcceptsFile(entry.path.filename(), size)) {
+                ScanEntry scanned;
+                scanned.path = entry.path;
+                scanned.size = size;
+                scanned.modifiedTime = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::file_clock::to_sys(written).time_since_epoch()).count();
+                scanned.root = static_cast<uint32_t>(RootOf(entry.path));
+                if (!entry.renamedFrom.empty()) out.renamed.emplace_back(entry.renamedFrom, entry.path);
+                out.added.push_back(std::move(scanned));
+            } else {
+                out.removed.push_back(std::move(entry.path));  // no longer a photo (if it was one)
+            }
+        } else if (std::filesystem::is_directory(status)) {
+            if (!entry.appeared || scanner_.SkipsDirectory(entry.path.filename())) continue;
+            // New to the library: anything recorded under the name is stale
+            out.removed.push_back(entry.path);
+            std::atomic<size_t> count{0};
+            auto found = scanner_.Scan({entry.path}, cancel_, count);
+            for (auto& scanned : found) {
+                int root = RootOf(scanned.path);
+                if (root < 0) continue;
+                scanned.root = static_cast<uint32_t>(root);
+                out.added.push_back(std::move(scanned));
+            }
+        } else {
+            out.removed.push_back(std::move(entry.path));
+        }
+    }
+
+    // A directory that appeared walks what its new files and subdirectories
+    // already reported: keep each photo once
+    std::unordered_set<NameString> seen;
+    std::erase_if(out.added, [&](const ScanEntry& entry) {
+        return !seen.insert(PathKey(entry.path.native())).second;
+    });
+}
+
+void LibraryWatcher::Merge(LibraryChanges& batch)
+{
+    ready_.rescan = ready_.rescan || batch.rescan;
+
+    // Moves that continue one already waiting become a single move
+    for (auto& move : batch.renamed) {
+        auto chained = std::find_if(ready_.renamed.begin(), ready_.renamed.end(),
+                                    [&](const auto& m) { return m.second == move.first; });
+        if (chained != ready_.renamed.end()) {
+            chained->second = move.second;
+            move.first.clear();
+        }
+    }
+
+    // Earlier additions this batch removes or replaces are dropped; the
+    // consumer applies every removal before any addition
+    std::unordered_set<NameString> removed, replaced;
+    for (const auto& path : batch.removed) removed.insert(PathKey(path.native()));
+    for (const auto& entry : batch.added) replaced.insert(PathKey(entry.path.native()));
+    auto isRemoved = [&](const std::filesystem::path& path) {
+        NameString key = PathKey(path.native());
+        for (;;) {
+            if (removed.contains(key)) return true;
+            size_t slash = key.find_last_of(kSeparator);
+            if (slash == NameString::npos || slash == 0) return false;
+            key.resize(slash);
+        }
+    };
+    std::erase_if(ready_.added, [&](const ScanEntry& entry) {
+        return isRemoved(entry.path) || replaced.contains(PathKey(entry.path.native()));
+    });
+    std::erase_if(ready_.renamed, [&](const auto& move) { return isRemoved(move.second); });
+
+    std::move(batch.removed.begin(), batch.removed.end(), std::back_inserter(ready_.removed));
+    std::move(batch.added.begin(), batch.added.end(), std::back_inserter(ready_.added));
+    for (auto& move : batch.renamed) {
+        if (!move.first.empty()) ready_.renamed.push_back(std::move(move));
+    }
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
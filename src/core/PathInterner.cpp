@@ -0,0 +1,45 @@
+#include "core/PathInterner.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+PathInterner& PathInterner::Global()
+{
+    static PathInterner instance;
+    return instance;
+}
+
+ImageId PathInterner::Intern(const std::filesystem::path& path)
+{
+    std::lock_guard lock(mutex_);
+
+    auto it = index_.find(Key(path.native()));
+    if (it != index_.end()) return it->second;
+
+    size_t next = count_.load(std::memory_order_relaxed);
+    if (next >= IdTable<std::filesystem::path>::kCapacity) return kInvalidImageId;
+
+    ImageId id = static_cast<ImageId>(next);
+    auto& stored = paths_[id];
+    stored = path;
+    index_.emplace(Key(stored.native()), id);
+
+    // Publish after the path is written so lock-free Path() readers see it
+    count_.store(next + 1, std::memory_order_release);
+    return id;
+}
+
+ImageId PathInterner::Find(const std::filesystem::path& path) const
+{
+    std::lock_guard lock(mutex_);
+    auto it = index_.find(Key(path.native()));
+    return it != index_.end() ? it->second : kInvalidImageId;
+}
+
+const std::filesystem::path& PathInterner::Path(ImageId id) const
+{
+    return *paths_.Find(id);
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
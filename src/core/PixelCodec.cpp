@@ -0,0 +1,422 @@
+#include "core/PixelCodec.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(UIV_SIMD_X86)
+#include <emmintrin.h>
+#endif
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+size_t RawBytes(uint32_t width, uint32_t height)
+{
+    return static_cast<size_t>(width) * height * 4;
+}
+
+// --- QOI ---
+// The QOI op set (qoiformat.org) over BGRA, without its header and end
+// marker: dimensions live in the store index.
+
+constexpr uint8_t kQoiIndex = 0x00;
+constexpr uint8_t kQoiDiff = 0x40;
+constexpr uint8_t kQoiLuma = 0x80;
+constexpr uint8_t kQoiRun = 0xC0;
+constexpr uint8_t kQoiRgb = 0xFE;
+constexpr uint8_t kQoiRgba = 0xFF;
+constexpr uint8_t kQoiMask = 0xC0;
+
+struct Bgra {
+    uint8_t b, g, r, a;
+    bool operator==(const Bgra& o) const { return b == o.b && g == o.g && r == o.r && a == o.a; }
+};
+
+uint32_t QoiHash(const Bgra& p)
+{
+    return (p.r * 3u + p.g * 5u + p.b * 7u + p.a * 11u) & 63;
+}
+
+bool EncodeQoi(const uint8_t* bgra, size_t pixels, std::vector<uint8_t>& out)
+{
+    // Worst case is an RGBA op (5 bytes) per pixel; give up at raw size.
+    // One iteration writes at most a run and a 5-byte op past the check.
+    const size_t limit = pixels * 4;
+    out.resize(limit + 6);
+    uint8_t* o = out.data();
+    uint8_t* const end = o + limit;
+
+    Bgra index[64] = {};
+    Bgra prev{0, 0, 0, 255};
+    uint32_t run = 0;
+    for (size_t i = 0; i < pixels; ++i) {
+        if (o >= end) return false;
+        Bgra px;
+        memcpy(&px, bgra + i * 4, 4);
+        if (px == prev) {
+            if (++run == 62 || i + 1 == pixels) {
+                *o++ = static_cast<uint8_t>(kQoiRun | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            *o++ = static_cast<uint8_t>(kQoiRun | (run - 1));
+            run = 0;
+        }
+
+        uint32_t h = QoiHash(px);
+        if (index[h] == px) {
+            *o++ = static_cast<uint8_t>(kQoiIndex | h);
+        } else {
+            index[h] = px;
+            if (px.a == prev.a) {
+                int dr = static_cast<int8_t>(px.r - prev.r);
+                int dg = static_cast<int8_t>(px.g - prev.g);
+                int db = static_cast<int8_t>(px.b - prev.b);
+                int drg = dr - dg, dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    *o++ = static_cast<uint8_t>(kQoiDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    *o++ = static_cast<uint8_t>(kQoiLuma | (dg + 32));
+                    *o++ = static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8));
+                } else {
+                    *o++ = kQoiRgb;
+                    *o++ = px.r;
+                    *o++ = px.g;
+                    *o++ = px.b;
+                }
+            } else {
+                *o++ = kQoiRgba;
+                *o++ = px.r;
+                *o++ = px.g;
+                *o++ = px.b;
+                *o++ = px.a;
+            }
+        }
+        prev = px;
+    }
+    if (o >= end) return false;
+    out.resize(static_cast<size_t>(o - out.data()));
+    return true;
+}
+
+bool DecodeQoi(const uint8_t* src, size_t size, size_t pixels, uint8_t* bgra)
+{
+    const uint8_t* p = src;
+    const uint8_t* const end = src + size;
+    Bgra index[64] = {};
+    Bgra px{0, 0, 0, 255};
+    for (size_t i = 0; i < pixels;) {
+        if (p >= end) return false;
+        uint8_t op = *p++;
+        if (op == kQoiRgb) {
+            if (end - p < 3) return false;
+            px.r = p[0];
+            px.g = p[1];
+            px.b = p[2];
+            p += 3;
+        } else if (op == kQoiRgba) {
+            if (end - p < 4) return false;
+            px.r = p[0];
+            px.g = p[1];
+            px.b = p[2];
+            px.a = p[3];
+            p += 4;
+        } else if ((op & kQoiMask) == kQoiIndex) {
+            px = index[op];
+        } else if ((op & kQoiMask) == kQoiDiff) {
+            px.r = static_cast<uint8_t>(px.r + ((op >> 4) & 3) - 2);
+            px.g = static_cast<uint8_t>(px.g + ((op >> 2) & 3) - 2);
+            px.b = static_cast<uint8_t>(px.b + (op & 3) - 2);
+        } else if ((op & kQoiMask) == kQoiLuma) {
+            if (p >= end) return false;
+            int dg = (op & 0x3F) - 32;
+            uint8_t rb = *p++;
+            px.r = static_cast<uint8_t>(px.r + dg - 8 + (rb >> 4));
+            px.g = static_cast<uint8_t>(px.g + dg);
+            px.b = static_cast<uint8_t>(px.b + dg - 8 + (rb & 0x0F));
+        } else {
+            size_t run = std::min<size_t>((op & 0x3F) + 1, pixels - i);
+            for (size_t k = 0; k < run; ++k) memcpy(bgra + (i + k) * 4, &px, 4);
+            i += run;
+            continue;
+        }
+        index[QoiHash(px)] = px;
+        memcpy(bgra + i * 4, &px, 4);
+        ++i;
+    }
+    return true;
+}
+
+// --- PlaneDelta ---
+// Each channel is predicted with LOCO-I's median edge detector, i.e. the
+// median of left, above and left + above - upper-left. Residuals are
+// zigzagged to bytes, split into one plane per channel and packed in blocks
+// of 16 at the bit width of the block's largest value, so smooth areas take
+// 2-4 bits per sample and a constant alpha plane almost nothing. Prediction
+// runs over all four channels of a pixel at once, so the planes are only a
+// storage order.
+// Per plane: [block widths, one nibble each][packed blocks, 2 * width bytes each]
+
+constexpr size_t kBlock = 16;
+
+inline int PredictMed(int left, int above, int upperLeft)
+{
+    return std::max(std::min(left, above), std::min(std::max(left, above), left + above - upperLeft));
+}
+
+inline uint8_t ZigZag(uint8_t residual)
+{
+    int s = static_cast<int8_t>(residual);
+    return static_cast<uint8_t>((s << 1) ^ (s >> 7));
+}
+
+inline uint8_t UnZigZag(uint8_t z)
+{
+    return static_cast<uint8_t>((z >> 1) ^ (0 - (z & 1)));
+}
+
+// Calls `fn(i, c, pred)` for channel c of pixel i in raster order, `pred`
+// being the prediction from the neighbours. DecodePlaneDelta walks the same
+// order with the row loop in ReconstructRow.
+template <typename Fn>
+inline void ForEachPredicted(const uint8_t* bgra, uint32_t width, uint32_t height, Fn&& fn)
+{
+    const size_t stride = static_cast<size_t>(width) * 4;
+    for (int c = 0; c < 4; ++c) fn(size_t{0}, c, 0);
+    for (uint32_t x = 1; x < width; ++x) {
+        for (int c = 0; c < 4; ++c) fn(size_t{x}, c, bgra[(x - 1) * 4 + c]);
+    }
+    for (uint32_t y = 1; y < height; ++y) {
+        const uint8_t* row = bgra + y * stride;
+        const uint8_t* above = row - stride;
+        const size_t base = static_cast<size_t>(y) * width;
+        for (int c = 0; c < 4; ++c) fn(base, c, above[c]);
+        for (uint32_t x = 1; x < width; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                fn(base + x, c, PredictMed(row[(x - 1) * 4 + c], above[x * 4 + c], above[(x - 1) * 4 + c]));
+            }
+        }
+    }
+}
+
+uint32_t BitWidth(uint8_t v)
+{
+    uint32_t w = 0;
+    while (v) {
+        ++w;
+        v >>= 1;
+    }
+    return w;
+}
+
+bool EncodePlaneDelta(const uint8_t* bgra, uint32_t width, uint32_t height, std::vector<uint8_t>& out)
+{
+    const size_t samples = static_cast<size_t>(width) * height;
+    const size_t blocks = (samples + kBlock - 1) / kBlock;
+    const size_t planeSize = blocks * kBlock;
+    const size_t widthBytes = (blocks + 1) / 2;
+    const size_t limit = samples * 4;
+
+    std::vector<uint8_t> residuals(planeSize * 4, 0);
+    ForEachPredicted(bgra, width, height, [&](size_t i, int c, int pred) {
+        residuals[c * planeSize + i] = ZigZag(static_cast<uint8_t>(bgra[i * 4 + c] - pred));
+    });
+
+    out.clear();
+    out.reserve(limit);
+    for (int c = 0; c < 4; ++c) {
+        const size_t widthsAt = out.size();
+        out.resize(widthsAt + widthBytes, 0);
+        for (size_t b = 0; b < blocks; ++b) {
+            const uint8_t* v = residuals.data() + c * planeSize + b * kBlock;
+            uint8_t maxValue = 0;
+            for (size_t k = 0; k < kBlock; ++k) maxValue |= v[k];
+            const uint32_t w = BitWidth(maxValue);
+            out[widthsAt + b / 2] |= static_cast<uint8_t>(w << ((b & 1) * 4));
+            if (out.size() + 2 * w > limit) return false;
+
+            uint32_t acc = 0, bits = 0;
+            for (size_t k = 0; k < kBlock && w > 0; ++k) {
+                acc |= static_cast<uint32_t>(v[k]) << bits;
+                bits += w;
+                for (; bits >= 8; bits -= 8, acc >>= 8) out.push_back(static_cast<uint8_t>(acc));
+            }
+        }
+    }
+    return out.size() < limit;
+}
+
+// Unpacks one block of 16 `W`-bit values from 2 * W bytes to every 4th
+// byte of `v` (residuals are reconstructed interleaved)
+template <uint32_t W>
+inline void UnpackBlock(const uint8_t* p, uint8_t* v)
+{
+    uint64_t lo = 0, hi = 0;
+    if constexpr (W * 2 >= 8) {
+        memcpy(&lo, p, 8);
+        if constexpr (W * 2 > 8) memcpy(&hi, p + 8, W * 2 - 8);
+    } else {
+        memcpy(&lo, p, W * 2);
+    }
+    constexpr uint64_t mask = (1u << W) - 1;
+    for (uint32_t k = 0; k < kBlock; ++k) {
+        const uint32_t bit = k * W;
+        uint64_t value;
+        if (bit + W <= 64) {
+            value = lo >> bit;
+        } else if (bit >= 64) {
+            value = hi >> (bit - 64);
+        } else {
+            value = (lo >> bit) | (hi << (64 - bit));
+        }
+        v[k * 4] = static_cast<uint8_t>(value & mask);
+    }
+}
+
+// Reconstructs pixels 1.. of a row below the first from the pixel above-left
+// chain; pixel 0 is already written. `res` holds zigzagged residuals,
+// interleaved like the pixels.
+void ReconstructRow(uint8_t* row, const uint8_t* above, const uint8_t* res, uint32_t width)
+{
+#if defined(UIV_SIMD_X86)
+    // The four channels side by side in 16-bit lanes (SSE2, always present on
+    // x86-64): the serial chain per pixel is min, max, add, mask
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i low = _mm_set1_epi16(0xFF);
+    auto load = [&zero](const uint8_t* p) {
+        int32_t v;
+        memcpy(&v, p, 4);
+        return _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+    };
+    __m128i left = load(row);
+    __m128i upperLeft = load(above);
+    for (uint32_t x = 1; x < width; ++x) {
+        const __m128i up = load(above + x * 4);
+        const __m128i z = load(res + x * 4);
+        const __m128i delta = _mm_xor_si128(_mm_srli_epi16(z, 1), _mm_sub_epi16(zero, _mm_and_si128(z, one)));
+        const __m128i gradient = _mm_add_epi16(left, _mm_sub_epi16(up, upperLeft));
+        const __m128i pred = _mm_max_epi16(_mm_min_epi16(left, up),
+                                           _mm_min_epi16(_mm_max_epi16(left, up), gradient));
+        left = _mm_and_si128(_mm_add_epi16(pred, delta), low);
+        const int32_t out = _mm_cvtsi128_si32(_mm_packus_epi16(left, left));
+        memcpy(row + x * 4, &out, 4);
+        upperLeft = up;
+    }
+#else
+    int left[4] = {row[0], row[1], row[2], row[3]};
+    for (uint32_t x = 1; x < width; ++x) {
+        for (int c = 0; c < 4; ++c) {
+            const int pred = PredictMed(left[c], above[x * 4 + c], above[(x - 1) * 4 + c]);
+            left[c] = static_cast<uint8_t>(pred + UnZigZag(res[x * 4 + c]));
+            row[x * 4 + c] = static_cast<uint8_t>(left[c]);
+        }
+    }
+#endif
+}
+
+bool DecodePlaneDelta(const uint8_t* src, size_t size, uint32_t width, uint32_t height, uint8_t* bgra)
+{
+    const size_t samples = static_cast<size_t>(width) * height;
+    const size_t blocks = (samples + kBlock - 1) / kBlock;
+    const size_t widthBytes = (blocks + 1) / 2;
+
+    std::vector<uint8_t> residuals(blocks * kBlock * 4);
+    const uint8_t* p = src;
+    const uint8_t* const end = src + size;
+    for (int c = 0; c < 4; ++c) {
+        if (static_cast<size_t>(end - p) < widthBytes) return false;
+        const uint8_t* widths = p;
+        p += widthBytes;
+
+        for (size_t b = 0; b < blocks; ++b) {
+            const uint32_t w = (widths[b / 2] >> ((b & 1) * 4)) & 0x0F;
+            uint8_t* v = residuals.data() + b * kBlock * 4 + c;
+            if (w > 8 || static_cast<size_t>(end - p) < 2 * w) return false;
+            switch (w) {
+                case 0: for (size_t k = 0; k < kBlock; ++k) v[k * 4] = 0; break;
+                case 1: UnpackBlock<1>(p, v); break;
+                case 2: UnpackBlock<2>(p, v); break;
+                case 3: UnpackBlock<3>(p, v); break;
+                case 4: UnpackBlock<4>(p, v); break;
+                case 5: UnpackBlock<5>(p, v); break;
+                case 6: UnpackBlock<6>(p, v); break;
+                case 7: UnpackBlock<7>(p, v); break;
+                case 8: for (size_t k = 0; k < kBlock; ++k) v[k * 4] = p[k]; break;
+            }
+            p += 2 * w;
+        }
+    }
+
+    // ForEachPredicted's order: the first row predicts from the left, the
+    // first column from above, everything else through ReconstructRow
+    const uint8_t* res = residuals.data();
+    for (int c = 0; c < 4; ++c) bgra[c] = UnZigZag(res[c]);
+    for (size_t i = 4; i < static_cast<size_t>(width) * 4; ++i) {
+        bgra[i] = static_cast<uint8_t>(bgra[i - 4] + UnZigZag(res[i]));
+    }
+    const size_t stride = static_cast<size_t>(width) * 4;
+    for (uint32_t y = 1; y < height; ++y) {
+        uint8_t* row = bgra + y * stride;
+        const uint8_t* above = row - stride;
+        const uint8_t* rowRes = res + y * stride;
+        for (int c = 0; c < 4; ++c) row[c] = static_cast<uint8_t>(above[c] + UnZigZag(rowRes[c]));
+        ReconstructRow(row, above, rowRes, width);
+    }
+    return true;
+}
+
+} // namespace
+
+const char* PixelCodecName(PixelCodec codec)
+{
+    switch (codec) {
+        case PixelCodec::Raw: return "raw";
+        case PixelCodec::Qoi: return "qoi";
+        case PixelCodec::PlaneDelta: return "planedelta";
+    }
+    return "unknown";
+}
+
+bool ParsePixelCodec(const char* name, PixelCodec& out)
+{
+    for (PixelCodec codec : {PixelCodec::Raw, PixelCodec::Qoi, PixelCodec::PlaneDelta}) {
+        if (std::strcmp(name, PixelCodecName(codec)) == 0) {
+            out = codec;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EncodePixels(PixelCodec codec, const uint8_t* bgra, uint32_t width, uint32_t height,
+                  std::vector<uint8_t>& out)
+{
+    if (width == 0 || height == 0) return false;
+    switch (codec) {
+        case PixelCodec::Qoi: return EncodeQoi(bgra, static_cast<size_t>(width) * height, out);
+        case PixelCodec::PlaneDelta: return EncodePlaneDelta(bgra, width, height, out);
+        case PixelCodec::Raw: break;
+    }
+    return false;
+}
+
+bool DecodePixels(PixelCodec codec, const uint8_t* src, size_t size, uint32_t width, uint32_t height,
+                  uint8_t* bgra)
+{
+    switch (codec) {
+        case PixelCodec::Raw:
+            if (size != RawBytes(width, height)) return false;
+            memcpy(bgra, src, size);
+            return true;
+        case PixelCodec::Qoi: return DecodeQoi(src, size, static_cast<size_t>(width) * height, bgra);
+        case PixelCodec::PlaneDelta: return DecodePlaneDelta(src, size, width, height, bgra);
+    }
+    return false;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
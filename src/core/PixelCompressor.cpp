@@ -0,0 +1,336 @@
+#include "core/PixelCompressor.hpp"
+#include "core/PixelCodec.hpp"
+#include <cstring>
+#include <vector>
+
+#if defined(UIV_SIMD_X86)
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#include <compressapi.h>
+#pragma comment(lib, "cabinet.lib")
+#endif
+
+#if defined(UIV_HAVE_LZ4)
+#include <lz4.h>
+#endif
+
+#if defined(UIV_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+// Per-thread scratch shared by all compressors: the filtered input and the
+// backend's output before it is copied into an exactly sized buffer
+struct Scratch {
+    std::vector<uint8_t> filtered;
+    std::vector<uint8_t> packed;
+};
+thread_local Scratch t_scratch;
+
+// Splits BGRA into four channel planes, each stored as differences from the
+// pixel to its left. Photo thumbnails turn into small values clustered
+// around zero (and opaque alpha into a run of zeros), which the LZ stage
+// finds far more repeats in than in interleaved pixels.
+void DeltaFilter(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t c = 0; c < 4; ++c) {
+        uint8_t* plane = dst + c * pixels;
+        uint8_t prev = 0;
+        for (size_t i = 0; i < pixels; ++i) {
+            uint8_t v = src[i * 4 + c];
+            plane[i] = static_cast<uint8_t>(v - prev);
+            prev = v;
+        }
+    }
+}
+
+// Inverse of DeltaFilter: a running sum per plane, re-interleaved
+void DeltaUnfilter(uint8_t* planes, size_t pixels, uint8_t* dst)
+{
+    size_t done = 0;
+#if defined(UIV_SIMD_X86)
+    // Prefix sums over 16 samples in four shifted adds plus the previous
+    // vector's last sample, then two rounds of unpacks to interleave
+    __m128i carry[4] = {};
+    for (; done + 16 <= pixels; done += 16) {
+        __m128i v[4];
+        for (size_t c = 0; c < 4; ++c) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes + c * pixels + done));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+            v[c] = _mm_add_epi8(x, carry[c]);
+            carry[c] = _mm_set1_epi8(static_cast<char>(_mm_extract_epi16(v[c], 7) >> 8));
+        }
+        const __m128i bgLo = _mm_unpacklo_epi8(v[0], v[1]), bgHi = _mm_unpackhi_epi8(v[0], v[1]);
+        const __m128i raLo = _mm_unpacklo_epi8(v[2], v[3]), raHi = _mm_unpackhi_epi8(v[2], v[3]);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + done * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bgLo, raLo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+    }
+#endif
+    for (size_t c = 0; c < 4; ++c) {
+        const uint8_t* plane = planes + c * pixels;
+        uint8_t prev = done > 0 ? dst[(done - 1) * 4 + c] : 0;
+        for (size_t i = done; i < pixels; ++i) {
+            prev = static_cast<uint8_t>(prev + plane[i]);
+            dst[i * 4 + c] = prev;
+        }
+    }
+}
+
+// General-purpose byte compressors behind the optional delta filter
+class BlockCompressor : public PixelCompressor {
+public:
+    explicit BlockCompressor(bool deltaFilter) : deltaFilter_(deltaFilter) {}
+
+    bool Compress(const uint8_t* bgra, uint32_t width, uint32_t height,
+                  std::unique_ptr<uint8_t[]>& out, size_t& outSize) override
+    {
+        const size_t raw = static_cast<size_t>(width) * height * 4;
+        if (raw < 2) return false;
+        Scratch& scratch = t_scratch;
+        const uint8_t* input = bgra;
+        if (deltaFilter_) {
+            scratch.filtered.resize(raw);
+            DeltaFilter(bgra, scratch.filtered.data(), raw / 4);
+            input = scratch.filtered.data();
+        }
+        // Capacity just under the input size: backends fail rather than expand
+        scratch.packed.resize(raw - 1);
+        size_t packed = CompressBlock(input, raw, scratch.packed.data(), scratch.packed.size());
+        if (packed == 0) return false;
+        out = std::make_unique<uint8_t[]>(packed);
+        memcpy(out.get(), scratch.packed.data(), packed);
+        outSize = packed;
+        return true;
+    }
+
+    bool Decompress(const uint8_t* src, size_t size, uint32_t width, uint32_t height,
+                    uint8_t* bgra) override
+    {
+        const size_t raw = static_cast<size_t>(width) * height * 4;
+        if (!deltaFilter_) return DecompressBlock(src, size, bgra, raw);
+        std::vector<uint8_t>& planes = t_scratch.filtered;
+        planes.resize(raw);
+        if (!DecompressBlock(src, size, planes.data(), raw)) return false;
+        DeltaUnfilter(planes.data(), raw / 4, bgra);
+        return true;
+    }
+
+protected:
+    // Compressed size, or 0 if it failed or did not fit in `capacity`
+    virtual size_t CompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) = 0;
+    // True only if exactly `rawSize` bytes came out
+    virtual bool DecompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) = 0;
+
+private:
+    bool deltaFilter_;
+};
+
+#if defined(UIV_HAVE_LZ4)
+class Lz4Compressor : public BlockCompressor {
+public:
+    using BlockCompressor::BlockCompressor;
+    const char* Name() const override { return "lz4"; }
+
+protected:
+    size_t CompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) override
+    {
+        // LZ4_compress_fast would otherwise set up its state on the stack per call
+        thread_local std::unique_ptr<uint64_t[]> state(new uint64_t[(LZ4_sizeofState() + 7) / 8]);
+        int n = LZ4_compress_fast_extState(state.get(), reinterpret_cast<const char*>(src),
+                                           reinterpret_cast<char*>(dst), static_cast<int>(size),
+                                           static_cast<int>(capacity), 1);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    bool DecompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) override
+    {
+        int n = LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst),
+                                    static_cast<int>(size), static_cast<int>(rawSize));
+        return n >= 0 && static_cast<size_t>(n) == rawSize;
+    }
+};
+#endif
+
+#if defined(UIV_HAVE_ZSTD)
+class ZstdCompressor : public BlockCompressor {
+public:
+    using BlockCompressor::BlockCompressor;
+    const char* Name() const override { return "zstd"; }
+
+protected:
+    static constexpr int kLevel = 1;
+
+    struct Contexts {
+        ZSTD_CCtx* cctx = nullptr;
+        ZSTD_DCtx* dctx = nullptr;
+        ~Contexts()
+        {
+            ZSTD_freeCCtx(cctx);
+            ZSTD_freeDCtx(dctx);
+        }
+    };
+
+    static Contexts& ThreadContexts()
+    {
+        thread_local Contexts contexts;
+        return contexts;
+    }
+
+    size_t CompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) override
+    {
+        Contexts& c = ThreadContexts();
+        if (!c.cctx && !(c.cctx = ZSTD_createCCtx())) return 0;
+        size_t n = ZSTD_compressCCtx(c.cctx, dst, capacity, src, size, kLevel);
+        return ZSTD_isError(n) ? 0 : n;
+    }
+
+    bool DecompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) override
+    {
+        Contexts& c = ThreadContexts();
+        if (!c.dctx && !(c.dctx = ZSTD_createDCtx())) return false;
+        size_t n = ZSTD_decompressDCtx(c.dctx, dst, rawSize, src, size);
+        return !ZSTD_isError(n) && n == rawSize;
+    }
+};
+#endif
+
+#ifdef _WIN32
+class XpressCompressor : public BlockCompressor {
+public:
+    using BlockCompressor::BlockCompressor;
+    const char* Name() const override { return "xpress"; }
+
+protected:
+    struct Handles {
+        COMPRESSOR_HANDLE compressor = nullptr;
+        DECOMPRESSOR_HANDLE decompressor = nullptr;
+        ~Handles()
+        {
+            if (compressor) CloseCompressor(compressor);
+            if (decompressor) CloseDecompressor(decompressor);
+        }
+    };
+
+    static Handles& ThreadHandles()
+    {
+        thread_local Handles handles;
+        return handles;
+    }
+
+    size_t CompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) override
+    {
+        Handles& h = ThreadHandles();
+        if (!h.compressor && !CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &h.compressor)) {
+            return 0;
+        }
+        // Fails with ERROR_INSUFFICIENT_BUFFER when the output would not shrink
+        SIZE_T n = 0;
+        if (!::Compress(h.compressor, src, size, dst, capacity, &n)) return 0;
+        return static_cast<size_t>(n);
+    }
+
+    bool DecompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) override
+    {
+        Handles& h = ThreadHandles();
+        if (!h.decompressor && !CreateDecompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &h.decompressor)) {
+            return false;
+        }
+        SIZE_T n = 0;
+        return ::Decompress(h.decompressor, src, size, dst, rawSize, &n) && n == rawSize;
+    }
+};
+#endif
+
+class PlaneDeltaCompressor : public PixelCompressor {
+public:
+    const char* Name() const override { return "planedelta"; }
+
+    bool Compress(const uint8_t* bgra, uint32_t width, uint32_t height,
+                  std::unique_ptr<uint8_t[]>& out, size_t& outSize) override
+    {
+        std::vector<uint8_t>& packed = t_scratch.packed;
+        if (!EncodePixels(PixelCodec::PlaneDelta, bgra, width, height, packed)) return false;
+        out = std::make_unique<uint8_t[]>(packed.size());
+        memcpy(out.get(), packed.data(), packed.size());
+        outSize = packed.size();
+        return true;
+    }
+
+    bool Decompress(const uint8_t* src, size_t size, uint32_t width, uint32_t height,
+                    uint8_t* bgra) override
+    {
+        return DecodePixels(PixelCodec::PlaneDelta, src, size, width, height, bgra);
+    }
+};
+
+} // namespace
+
+const char* PixelCompressorName(PixelCompressorKind kind)
+{
+    switch (kind) {
+        case PixelCompressorKind::Lz4: return "lz4";
+        case PixelCompressorKind::Zstd: return "zstd";
+        case PixelCompressorKind::Xpress: return "xpress";
+        case PixelCompressorKind::PlaneDelta: return "planedelta";
+    }
+    return "unknown";
+}
+
+bool IsPixelCompressorAvailable(PixelCompressorKind kind)
+{
+    switch (kind) {
+#if defined(UIV_HAVE_LZ4)
+        case PixelCompressorKind::Lz4: return true;
+#endif
+#if defined(UIV_HAVE_ZSTD)
+        case PixelCompressorKind::Zstd: return true;
+#endif
+#ifdef _WIN32
+        case PixelCompressorKind::Xpress: return true;
+#endif
+        case PixelCompressorKind::PlaneDelta: return true;
+        default: return false;
+    }
+}
+
+PixelCompressorKind DefaultPixelCompressorKind()
+{
+    // Ratio first (more thumbnails in the Tier 2 budget), then speed
+    for (PixelCompressorKind kind : {PixelCompressorKind::Zstd, PixelCompressorKind::Lz4}) {
+        if (IsPixelCompressorAvailable(kind)) return kind;
+    }
+    return PixelCompressorKind::PlaneDelta;
+}
+
+std::unique_ptr<PixelCompressor> CreatePixelCompressor(PixelCompressorKind kind, bool deltaFilter)
+{
+    switch (kind) {
+#if defined(UIV_HAVE_LZ4)
+        case PixelCompressorKind::Lz4: return std::make_unique<Lz4Compressor>(deltaFilter);
+#endif
+#if defined(UIV_HAVE_ZSTD)
+        case PixelCompressorKind::Zstd: return std::make_unique<ZstdCompressor>(deltaFilter);
+#endif
+#ifdef _WIN32
+        case PixelCompressorKind::Xpress: return std::make_unique<XpressCompressor>(deltaFilter);
+#endif
+        case PixelCompressorKind::PlaneDelta: return std::make_unique<PlaneDeltaCompressor>();
+        default: return nullptr;
+    }
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
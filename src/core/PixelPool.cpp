@@ -0,0 +1,69 @@
+#include "core/PixelPool.hpp"
+
+namespace UltraImageViewer {
+namespace Core {
+
+std::shared_ptr<PixelPool> PixelPool::Create()
+{
+    return std::shared_ptr<PixelPool>(new PixelPool);
+}
+
+PixelPool::~PixelPool()
+{
+    for (auto& [bytes, buffers] : free_) {
+        for (uint8_t* p : buffers) delete[] p;
+    }
+}
+
+PixelHandle PixelPool::Acquire(size_t bytes)
+{
+    uint8_t* pixels = nullptr;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = free_.find(bytes);
+        if (it != free_.end() && !it->second.empty()) {
+            pixels = it->second.back();
+            it->second.pop_back();
+            freeBytes_ -= bytes;
+        }
+    }
+    if (!pixels) pixels = new uint8_t[bytes];
+    return Wrap(pixels, bytes);
+}
+
+PixelHandle PixelPool::Adopt(std::unique_ptr<uint8_t[]> pixels, size_t bytes)
+{
+    if (!pixels) return nullptr;
+    return Wrap(pixels.release(), bytes);
+}
+
+size_t PixelPool::FreeBytes() const
+{
+    std::lock_guard lock(mutex_);
+    return freeBytes_;
+}
+
+PixelHandle PixelPool::Wrap(uint8_t* pixels, size_t bytes)
+{
+    liveBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return PixelHandle(pixels, [pool = shared_from_this(), bytes](uint8_t* p) {
+        pool->Release(p, bytes);
+    });
+}
+
+void PixelPool::Release(uint8_t* pixels, size_t bytes)
+{
+    liveBytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(mutex_);
+        if (freeBytes_ + bytes <= kMaxFreeBytes) {
+            free_[bytes].push_back(pixels);
+            freeBytes_ += bytes;
+            return;
+        }
+    }
+    delete[] pixels;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
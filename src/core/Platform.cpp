@@ -0,0 +1,181 @@
+#include "core/Platform.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#endif
+
+namespace UltraImageViewer {
+namespace Core {
+namespace Platform {
+
+void DebugOutput(const std::string& message)
+{
+#ifdef _WIN32
+    OutputDebugStringA(message.c_str());
+#else
+    (void)message;
+#endif
+}
+
+void CpuRelax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(_M_ARM64)
+    __yield();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+void SetCurrentThreadPriority(ThreadPriority priority)
+{
+#ifdef _WIN32
+    int prio = THREAD_PRIORITY_NORMAL;
+    if (priority == ThreadPriority::AboveNormal) prio = THREAD_PRIORITY_ABOVE_NORMAL;
+    if (priority == ThreadPriority::BelowNormal) prio = THREAD_PRIORITY_BELOW_NORMAL;
+    SetThreadPriority(GetCurrentThread(), prio);
+#else
+    (void)priority;
+#endif
+}
+
+std::FILE* OpenFile(const std::filesystem::path& path, const char* mode)
+{
+#ifdef _WIN32
+    std::wstring wmode(mode, mode + strlen(mode));
+    return _wfopen(path.c_str(), wmode.c_str());
+#else
+    return std::fopen(path.c_str(), mode);
+#endif
+}
+
+bool SeekFile(std::FILE* file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+bool MapFileReadOnly(const std::filesystem::path& path, FileMapping& out)
+{
+    out = {};
+#ifdef _WIN32
+    HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!hMapping) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(
+        MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    out.data = data;
+    out.size = static_cast<size_t>(fileSize.QuadPart);
+    out.fileHandle = hFile;
+    out.mapHandle = hMapping;
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    out.data = static_cast<const uint8_t*>(data);
+    out.size = static_cast<size_t>(st.st_size);
+    out.fileHandle = reinterpret_cast<void*>(static_cast<intptr_t>(fd) + 1);  // 0 = not open
+    return true;
+#endif
+}
+
+void UnmapFile(FileMapping& mapping)
+{
+#ifdef _WIN32
+    if (mapping.data) UnmapViewOfFile(mapping.data);
+    if (mapping.mapHandle) CloseHandle(static_cast<HANDLE>(mapping.mapHandle));
+    if (mapping.fileHandle) CloseHandle(static_cast<HANDLE>(mapping.fileHandle));
+#else
+    if (mapping.data) munmap(const_cast<uint8_t*>(mapping.data), mapping.size);
+    if (mapping.fileHandle) ::close(static_cast<int>(reinterpret_cast<intptr_t>(mapping.fileHandle) - 1));
+#endif
+    mapping = {};
+}
+
+void AdviseMapping(const FileMapping& mapping, MappingAdvice advice, size_t offset, size_t length)
+{
+    if (!mapping.data || offset >= mapping.size) return;
+    length = std::min(length, mapping.size - offset);
+#ifdef _WIN32
+    if (advice == MappingAdvice::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY range = {const_cast<uint8_t*>(mapping.data + offset), length};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    // madvise wants a page-aligned start
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t aligned = offset & ~(pageSize - 1);
+    int flag = advice == MappingAdvice::Random ? MADV_RANDOM
+             : advice == MappingAdvice::Sequential ? MADV_SEQUENTIAL : MADV_WILLNEED;
+    madvise(const_cast<uint8_t*>(mapping.data + aligned), length + (offset - aligned), flag);
+#endif
+}
+
+ScopedBackgroundMode::ScopedBackgroundMode(bool enter)
+    : active_(enter)
+{
+#ifdef _WIN32
+    if (active_) SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#endif
+}
+
+ScopedBackgroundMode::~ScopedBackgroundMode()
+{
+#ifdef _WIN32
+    if (active_) SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+#endif
+}
+
+} // namespace Platform
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,258 @@
+#include "core/Resampler.hpp"
+#include "core/SimdUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace UltraImageViewer {
+namespace Core {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int32_t kWeightOne = 1 << Simd::kConvolveBits;
+
+// Below this many rows per band, extra threads cost more than they save
+constexpr uint32_t kMinBandRows = 16;
+
+double Lanczos3(double x)
+{
+    if (x == 0.0) return 1.0;
+    if (x <= -3.0 || x >= 3.0) return 0.0;
+    double px = kPi * x;
+    return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+}
+
+// Premultiplied color can't exceed alpha; Lanczos overshoot can push it over
+void ClampToAlpha(uint8_t* px, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i, px += 4) {
+        uint8_t a = px[3];
+        px[0] = std::min(px[0], a);
+        px[1] = std::min(px[1], a);
+        px[2] = std::min(px[2], a);
+    }
+}
+
+// Runs fn(begin, end) over [0, count) split into up to `threads` bands
+template <typename Fn>
+void ForEachBand(uint32_t count, uint32_t threads, Fn&& fn)
+{
+    threads = std::min(threads, std::max<uint32_t>(count / kMinBandRows, 1));
+    if (threads <= 1) {
+        fn(0u, count);
+        return;
+    }
+    uint32_t per = (count + threads - 1) / threads;
+    std::vector<std::jthread> workers;
+    for (uint32_t t = 1; t < threads; ++t) {
+        uint32_t begin = t * per, end = std::min(count, begin + per);
+        if (begin < end) workers.emplace_back([&fn, begin, end] { fn(begin, end); });
+    }
+    fn(0u, std::min(per, count));
+}
+
+} // namespace
+
+ResampleTaps ResampleTaps::Build(uint32_t srcSize, uint32_t dstSize, ResampleFilter filter)
+{
+    ResampleTaps t;
+    if (srcSize == 0 || dstSize == 0) return t;
+
+    // Filter support in source pixels widens with the ratio when reducing
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    const double filterScale = std::max(scale, 1.0);
+    const double support = (filter == ResampleFilter::Box ? 0.5 : 3.0) * filterScale;
+    const uint32_t maxTaps = static_cast<uint32_t>(std::ceil(support * 2.0)) + 2;
+
+    std::vector<int32_t> fixed(static_cast<size_t>(dstSize) * maxTaps);
+    std::vector<int32_t> starts(dstSize), counts(dstSize);
+    std::vector<double> w(maxTaps);
+    uint32_t taps = 1;
+
+    for (uint32_t i = 0; i < dstSize; ++i) {
+        double center = (i + 0.5) * scale;
+        int32_t lo = std::max(0, static_cast<int32_t>(std::floor(center - support)));
+        int32_t hi = std::min(static_cast<int32_t>(srcSize), static_cast<int32_t>(std::ceil(center + support)));
+        int32_t n = std::min<int32_t>(hi - lo, static_cast<int32_t>(maxTaps));
+
+        double sum = 0.0;
+        for (int32_t k = 0; k < n; ++k) {
+            double x0 = static_cast<double>(lo + k);
+            if (filter == ResampleFilter::Box) {
+                // Coverage of source pixel [x0, x0 + 1) by the output footprint
+                w[k] = std::max(0.0, std::min(x0 + 1.0, center + support) - std::max(x0, center - support));
+            } else {
+                w[k] = Lanczos3((x0 + 0.5 - center) / filterScale);
+            }
+            sum += w[k];
+        }
+
+        // Quantize so the weights sum to exactly 1.0; rounding error goes to the peak
+        int32_t* q = &fixed[static_cast<size_t>(i) * maxTaps];
+        int32_t total = 0, peak = 0;
+        for (int32_t k = 0; k < n; ++k) {
+            q[k] = sum > 0.0 ? static_cast<int32_t>(std::lround(w[k] / sum * kWeightOne)) : 0;
+            total += q[k];
+            if (q[k] > q[peak]) peak = k;
+        }
+        q[peak] += kWeightOne - total;
+
+        int32_t first = 0, last = n;
+        while (first < last && q[first] == 0) ++first;
+        while (last > first + 1 && q[last - 1] == 0) --last;
+        std::memmove(q, q + first, sizeof(int32_t) * (last - first));
+        starts[i] = lo + first;
+        counts[i] = last - first;
+        taps = std::max<uint32_t>(taps, static_cast<uint32_t>(counts[i]));
+    }
+
+    // Fixed tap count for the kernels: shift windows left where they would
+    // run off the end and pad with zero weights
+    t.taps = taps;
+    t.starts.resize(dstSize);
+    t.weights.assign(static_cast<size_t>(dstSize) * taps, 0);
+    for (uint32_t i = 0; i < dstSize; ++i) {
+        int32_t start = std::min(starts[i], static_cast<int32_t>(srcSize - taps));
+        int32_t offset = starts[i] - start;
+        const int32_t* q = &fixed[static_cast<size_t>(i) * maxTaps];
+        int16_t* out = &t.weights[static_cast<size_t>(i) * taps + offset];
+        for (int32_t k = 0; k < counts[i]; ++k) out[k] = static_cast<int16_t>(q[k]);
+        t.starts[i] = start;
+    }
+    return t;
+}
+
+void ResampleBgra(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                  uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, size_t dstStride,
+                  ResampleFilter filter, bool premultiplied, uint32_t threads)
+{
+    if (!src || !dst || srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) return;
+
+    const ResampleTaps h = ResampleTaps::Build(srcWidth, dstWidth, filter);
+    const ResampleTaps v = ResampleTaps::Build(srcHeight, dstHeight, filter);
+    const bool clamp = premultiplied && filter == ResampleFilter::Lanczos3;
+
+    // Horizontal pass over just the source rows some output window reads
+    const size_t tmpStride = static_cast<size_t>(dstWidth) * 4;
+    const uint32_t rowBegin = static_cast<uint32_t>(v.starts.front());
+    const uint32_t rowCount = static_cast<uint32_t>(v.starts.back()) + v.taps - rowBegin;
+    std::vector<uint8_t> tmp(tmpStride * rowCount);
+
+    ForEachBand(rowCount, threads, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y) {
+            Simd::ConvolveHorizontal(src + (rowBegin + y) * srcStride, tmp.data() + y * tmpStride,
+                                     dstWidth, h.starts.data(), h.weights.data(), h.taps);
+        }
+    });
+
+    ForEachBand(dstHeight, threads, [&](uint32_t begin, uint32_t end) {
+        std::vector<const uint8_t*> rows(v.taps);
+        for (uint32_t y = begin; y < end; ++y) {
+            const uint8_t* first = tmp.data() + (v.starts[y] - rowBegin) * tmpStride;
+            for (uint32_t k = 0; k < v.taps; ++k) rows[k] = first + k * tmpStride;
+            uint8_t* out = dst + y * dstStride;
+            Simd::ConvolveVertical(rows.data(), v.weights.data() + static_cast<size_t>(y) * v.taps,
+                                   v.taps, out, tmpStride);
+            if (clamp) ClampToAlpha(out, dstWidth);
+        }
+    });
+}
+
+ThumbnailScaler::ThumbnailScaler(uint32_t srcWidth, uint32_t srcHeight,
+                                 uint32_t dstWidth, uint32_t dstHeight, bool premultiplied)
+    : srcWidth_(srcWidth)
+    , srcHeight_(srcHeight)
+    , dstWidth_(dstWidth)
+    , dstHeight_(dstHeight)
+    , premultiplied_(premultiplied)
+{
+    const bool boxW = static_cast<uint64_t>(srcWidth) > static_cast<uint64_t>(dstWidth) * kBoxRatio;
+    const bool boxH = static_cast<uint64_t>(srcHeight) > static_cast<uint64_t>(dstHeight) * kBoxRatio;
+    twoStage_ = boxW || boxH;
+    if (twoStage_) {
+        stageWidth_ = boxW ? dstWidth * kBoxOversample : srcWidth;
+        stageHeight_ = boxH ? dstHeight * kBoxOversample : srcHeight;
+    } else {
+        stageWidth_ = dstWidth;
+        stageHeight_ = dstHeight;
+    }
+    if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) {
+        stageWidth_ = stageHeight_ = 0;
+        return;
+    }
+
+    const ResampleFilter filter = twoStage_ ? ResampleFilter::Box : ResampleFilter::Lanczos3;
+    hTaps_ = ResampleTaps::Build(srcWidth, stageWidth_, filter);
+    vTaps_ = ResampleTaps::Build(srcHeight, stageHeight_, filter);
+    ring_.resize(static_cast<size_t>(vTaps_.taps) * stageWidth_ * 4);
+    stage_.resize(static_cast<size_t>(stageWidth_) * stageHeight_ * 4);
+    rowPtrs_.resize(vTaps_.taps);
+}
+
+void ThumbnailScaler::PushRows(const uint8_t* rows, size_t stride, uint32_t count)
+{
+    if (stageWidth_ == 0) return;
+    const size_t stageStride = static_cast<size_t>(stageWidth_) * 4;
+    const uint32_t vt = vTaps_.taps;
+
+    for (uint32_t r = 0; r < count && rowsPushed_ < srcHeight_; ++r) {
+        // Row n lands in slot n % taps. Output rows are emitted as soon as
+        // their window is complete, so the row it replaces is no longer read.
+        uint8_t* slot = ring_.data() + (rowsPushed_ % vt) * stageStride;
+        Simd::ConvolveHorizontal(rows + r * stride, slot, stageWidth_,
+                                 hTaps_.starts.data(), hTaps_.weights.data(), hTaps_.taps);
+        ++rowsPushed_;
+
+        while (rowsEmitted_ < stageHeight_ &&
+               static_cast<uint32_t>(vTaps_.starts[rowsEmitted_]) + vt <= rowsPushed_) {
+            uint32_t start = static_cast<uint32_t>(vTaps_.starts[rowsEmitted_]);
+            for (uint32_t k = 0; k < vt; ++k) {
+                rowPtrs_[k] = ring_.data() + ((start + k) % vt) * stageStride;
+            }
+            uint8_t* out = stage_.data() + rowsEmitted_ * stageStride;
+            Simd::ConvolveVertical(rowPtrs_.data(), vTaps_.weights.data() + static_cast<size_t>(rowsEmitted_) * vt,
+                                   vt, out, stageStride);
+            if (!twoStage_ && premultiplied_) ClampToAlpha(out, stageWidth_);
+            ++rowsEmitted_;
+        }
+    }
+}
+
+bool ThumbnailScaler::Finish(uint8_t* dst, size_t dstStride)
+{
+    if (!dst || stageWidth_ == 0 || rowsEmitted_ < stageHeight_) return false;
+
+    if (twoStage_) {
+        ResampleBgra(stage_.data(), stageWidth_, stageHeight_, static_cast<size_t>(stageWidth_) * 4,
+                     dst, dstWidth_, dstHeight_, dstStride, ResampleFilter::Lanczos3, premultiplied_);
+    } else {
+        const size_t rowBytes = static_cast<size_t>(dstWidth_) * 4;
+        for (uint32_t y = 0; y < dstHeight_; ++y) {
+            std::memcpy(dst + y * dstStride, stage_.data() + y * rowBytes, rowBytes);
+        }
+    }
+    return true;
+}
+
+void ThumbnailScaler::FitWithin(uint32_t width, uint32_t height, uint32_t maxSize,
+                                uint32_t& outWidth, uint32_t& outHeight)
+{
+    if (width == 0 || height == 0) {
+        outWidth = outHeight = 0;
+        return;
+    }
+    if (width > height) {
+        outWidth = maxSize;
+        outHeight = static_cast<uint32_t>(std::lround(static_cast<double>(height) * maxSize / width));
+    } else {
+        outHeight = maxSize;
+        outWidth = static_cast<uint32_t>(std::lround(static_cast<double>(width) * maxSize / height));
+    }
+    outWidth = std::max(outWidth, 1u);
+    outHeight = std::max(outHeight, 1u);
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
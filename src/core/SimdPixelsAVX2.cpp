@@ -0,0 +1,348 @@
+// AVX2 pixel kernels (and the AVX2 path of ToLowerInPlace). Built with AVX2
+// code generation enabled; only reached after CPUID reports support.
+// Pack instructions work within 128-bit lanes, so results that cross lanes
+// are put back in order with a permute.
+
+#include "core/SimdUtils.hpp"
+#include <immintrin.h>
+#include <cstring>
+
+namespace UltraImageViewer {
+namespace Core {
+namespace Simd {
+namespace Detail {
+
+// ---- ToLowerInPlace: 32 bytes per iteration (see SimdUtils.cpp) ----
+
+void ToLowerAvx2(wchar_t* data, size_t count)
+{
+    constexpr size_t kLanes = 32 / sizeof(wchar_t);
+
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i lowBit;
+
+        if constexpr (sizeof(wchar_t) == 2) {
+            __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi16(chars, _mm256_set1_epi16(0x0040)),
+                                            _mm256_cmpgt_epi16(_mm256_set1_epi16(0x005B), chars));
+            lowBit = _mm256_and_si256(mask, _mm256_set1_epi16(0x0020));
+        } else {
+            __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(chars, _mm256_set1_epi32(0x0040)),
+                                            _mm256_cmpgt_epi32(_mm256_set1_epi32(0x005B), chars));
+            lowBit = _mm256_and_si256(mask, _mm256_set1_epi32(0x0020));
+        }
+        chars = _mm256_or_si256(chars, lowBit);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), chars);
+    }
+
+    // Scalar tail
+    for (; i < count; ++i) {
+        wchar_t c = data[i];
+        if (c >= L'A' && c <= L'Z') c |= 0x0020;
+        data[i] = c;
+    }
+}
+
+namespace {
+
+const Detail::PixelKernels& S = kScalarKernels;
+
+inline __m256i Load(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+inline void Store(void* p, __m256i v) { _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+
+inline __m256i AlphaMask() { return _mm256_set1_epi32(static_cast<int>(0xFF000000u)); }
+
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m256i shuf = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        Store(dst + i * 4, _mm256_shuffle_epi8(Load(src + i * 4), shuf));
+    }
+    S.swapRedBlue(src + i * 4, dst + i * 4, pixels - i);
+}
+
+inline __m256i MulDiv255(__m256i c, __m256i a)
+{
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+inline __m256i BroadcastAlpha16(__m256i v)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, 0xFF), 0xFF);
+}
+
+void Premultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        // unpack/pack are both in-lane, so pixel order is preserved
+        __m256i px = Load(src + i * 4);
+        __m256i lo = _mm256_unpacklo_epi8(px, zero);
+        __m256i hi = _mm256_unpackhi_epi8(px, zero);
+        lo = MulDiv255(lo, BroadcastAlpha16(lo));
+        hi = MulDiv255(hi, BroadcastAlpha16(hi));
+        Store(dst + i * 4, _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), px, AlphaMask()));
+    }
+    S.premultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// Two pixels in 32-bit lanes (see SimdPixelsSSE41.cpp for the exactness note)
+inline __m256i Unpremul2(__m256i c)
+{
+    __m256i a = _mm256_shuffle_epi32(c, 0xFF);
+    __m256i num = _mm256_add_epi32(_mm256_mullo_epi32(c, _mm256_set1_epi32(255)),
+                                   _mm256_srli_epi32(a, 1));
+    __m256i q = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(num), _mm256_cvtepi32_ps(a)));
+    q = _mm256_min_epi32(q, _mm256_set1_epi32(255));
+    return _mm256_and_si256(q, _mm256_cmpgt_epi32(a, _mm256_setzero_si256()));
+}
+
+void Unpremultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    // After the two in-lane packs, lane 0 holds pixels 0,2,4,6 and lane 1
+    // pixels 1,3,5,7
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i px = Load(src + i * 4);
+        __m128i lo = _mm256_castsi256_si128(px);
+        __m128i hi = _mm256_extracti128_si256(px, 1);
+        __m256i p01 = Unpremul2(_mm256_cvtepu8_epi32(lo));
+        __m256i p23 = Unpremul2(_mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+        __m256i p45 = Unpremul2(_mm256_cvtepu8_epi32(hi));
+        __m256i p67 = Unpremul2(_mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+        __m256i out = _mm256_packus_epi16(_mm256_packus_epi32(p01, p23),
+                                          _mm256_packus_epi32(p45, p67));
+        out = _mm256_permutevar8x32_epi32(out, order);
+        Store(dst + i * 4, _mm256_blendv_epi8(out, px, AlphaMask()));
+    }
+    S.unpremultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// 8 packed 3-byte pixels: each 128-bit lane loads 16 bytes at a 12-byte
+// stride and shuffles 4 pixels. The upper load ends 28 bytes in, so the loop
+// stops while at least 10 pixels remain.
+inline void Expand24(const uint8_t* src, uint8_t* dst, size_t pixels, __m256i shuf,
+                     void (*tail)(const uint8_t*, uint8_t*, size_t))
+{
+    size_t i = 0;
+    for (; i + 10 <= pixels; i += 8) {
+        const uint8_t* s = src + i * 3;
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 12)), 1);
+        Store(dst + i * 4, _mm256_or_si256(_mm256_shuffle_epi8(v, shuf), AlphaMask()));
+    }
+    tail(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void Rgb24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m256i shuf = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                          2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    Expand24(src, dst, pixels, shuf, S.rgb24ToBgra32);
+}
+
+void Bgr24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                          0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    Expand24(src, dst, pixels, shuf, S.bgr24ToBgra32);
+}
+
+void Widen8To16(const uint8_t* src, uint16_t* dst, size_t samples)
+{
+    const __m256i k257 = _mm256_set1_epi16(257);
+    size_t i = 0;
+    for (; i + 32 <= samples; i += 32) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        Store(dst + i, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(a), k257));
+        Store(dst + i + 16, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(b), k257));
+    }
+    S.widen8To16(src + i, dst + i, samples - i);
+}
+
+inline __m256i Narrow8(__m256i v32)
+{
+    __m256i t = _mm256_add_epi32(_mm256_mullo_epi32(v32, _mm256_set1_epi32(255)),
+                                 _mm256_set1_epi32(32895));
+    return _mm256_srli_epi32(t, 16);
+}
+
+// 16 values in 32-bit lanes (a: 0-7, b: 8-15) -> 16 bytes in order
+inline __m128i Pack32To8(__m256i a, __m256i b)
+{
+    __m256i w = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+}
+
+void Narrow16To8(const uint16_t* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        __m128i out = Pack32To8(Narrow8(_mm256_cvtepu16_epi32(a)), Narrow8(_mm256_cvtepu16_epi32(b)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+    S.narrow16To8(src + i, dst + i, samples - i);
+}
+
+void U8ToFloat(const uint8_t* src, float* dst, size_t samples)
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(lo, scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(hi, scale));
+    }
+    S.u8ToFloat(src + i, dst + i, samples - i);
+}
+
+inline __m256i FloatTo32(__m256 v)
+{
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)),
+                                             _mm256_set1_ps(0.5f)));
+}
+
+void FloatToU8(const float* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i out = Pack32To8(FloatTo32(_mm256_loadu_ps(src + i)),
+                                FloatTo32(_mm256_loadu_ps(src + i + 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+    S.floatToU8(src + i, dst + i, samples - i);
+}
+
+} // namespace
+
+// ---- Resampling convolutions (also used by the AVX-512 table) ----
+
+namespace {
+
+inline int WeightPair(const int16_t* w)
+{
+    return static_cast<int>(static_cast<uint16_t>(w[0]) | (static_cast<uint32_t>(static_cast<uint16_t>(w[1])) << 16));
+}
+
+// Four taps per iteration: pixels 0-1 in the low lane and 2-3 in the high
+// lane, each interleaved as [b0 b1 g0 g1 r0 r1 a0 a1] for pmaddwd. The
+// lanes are folded together before the 2- and 1-tap remainders.
+inline __m128i ConvolvePixel(const uint8_t* s, const int16_t* w, size_t taps)
+{
+    const __m256i interleave = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15));
+    // Weight pair (w0, w1) across the low lane, (w2, w3) across the high lane
+    const __m256i spread = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+    __m256i acc8 = _mm256_setzero_si256();
+    size_t k = 0;
+    for (; k + 4 <= taps; k += 4) {
+        __m256i px = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + k * 4)));
+        __m256i wv = _mm256_permutevar8x32_epi32(
+            _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(w + k))), spread);
+        acc8 = _mm256_add_epi32(acc8, _mm256_madd_epi16(_mm256_shuffle_epi8(px, interleave), wv));
+    }
+    __m128i acc = _mm_add_epi32(_mm256_castsi256_si128(acc8), _mm256_extracti128_si256(acc8, 1));
+    acc = _mm_add_epi32(acc, _mm_set1_epi32(1 << (kConvolveBits - 1)));
+    if (k + 2 <= taps) {
+        const __m128i pairInterleave = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+        __m128i px = _mm_cvtepu8_epi16(_mm_shuffle_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + k * 4)), pairInterleave));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(px, _mm_set1_epi32(WeightPair(w + k))));
+        k += 2;
+    }
+    for (; k < taps; ++k) {
+        int v;
+        std::memcpy(&v, s + k * 4, 4);
+        acc = _mm_add_epi32(acc, _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v)), _mm_set1_epi32(w[k])));
+    }
+    return _mm_srai_epi32(acc, kConvolveBits);
+}
+
+} // namespace
+
+void ConvolveHorizontalAvx2(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                            const int32_t* starts, const int16_t* weights, size_t taps)
+{
+    size_t x = 0;
+    for (; x + 4 <= dstPixels; x += 4) {
+        __m128i p0 = ConvolvePixel(src + starts[x] * 4, weights + x * taps, taps);
+        __m128i p1 = ConvolvePixel(src + starts[x + 1] * 4, weights + (x + 1) * taps, taps);
+        __m128i p2 = ConvolvePixel(src + starts[x + 2] * 4, weights + (x + 2) * taps, taps);
+        __m128i p3 = ConvolvePixel(src + starts[x + 3] * 4, weights + (x + 3) * taps, taps);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4),
+                         _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+    }
+    for (; x < dstPixels; ++x) {
+        __m128i p = ConvolvePixel(src + starts[x] * 4, weights + x * taps, taps);
+        p = _mm_packus_epi16(_mm_packs_epi32(p, p), p);
+        int v = _mm_cvtsi128_si32(p);
+        std::memcpy(dst + x * 4, &v, 4);
+    }
+}
+
+// 32 bytes per iteration. Unpacks stay within 128-bit lanes and the packs
+// at the end undo them lane by lane, so no cross-lane permute is needed.
+void ConvolveVerticalAvx2(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                          uint8_t* dst, size_t bytes)
+{
+    const __m256i round = _mm256_set1_epi32(1 << (kConvolveBits - 1));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a0 = round, a1 = round, a2 = round, a3 = round;
+        for (size_t k = 0; k < taps; k += 2) {
+            bool pair = k + 1 < taps;
+            __m256i w = _mm256_set1_epi32(pair ? WeightPair(weights + k) : static_cast<uint16_t>(weights[k]));
+            __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+            __m256i r1 = pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i)) : zero;
+            __m256i lo = _mm256_unpacklo_epi8(r0, r1);
+            __m256i hi = _mm256_unpackhi_epi8(r0, r1);
+            a0 = _mm256_add_epi32(a0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+            a1 = _mm256_add_epi32(a1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+            a2 = _mm256_add_epi32(a2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+            a3 = _mm256_add_epi32(a3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+        }
+        __m256i lo16 = _mm256_packs_epi32(_mm256_srai_epi32(a0, kConvolveBits), _mm256_srai_epi32(a1, kConvolveBits));
+        __m256i hi16 = _mm256_packs_epi32(_mm256_srai_epi32(a2, kConvolveBits), _mm256_srai_epi32(a3, kConvolveBits));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo16, hi16));
+    }
+    for (; i < bytes; ++i) {
+        int32_t acc = 1 << (kConvolveBits - 1);
+        for (size_t k = 0; k < taps; ++k) acc += weights[k] * rows[k][i];
+        acc >>= kConvolveBits;
+        dst[i] = static_cast<uint8_t>(acc < 0 ? 0 : (acc > 255 ? 255 : acc));
+    }
+}
+
+const PixelKernels kAvx2Kernels = {
+    SwapRedBlue,
+    Premultiply,
+    Unpremultiply,
+    Rgb24ToBgra32,
+    Bgr24ToBgra32,
+    Widen8To16,
+    Narrow16To8,
+    U8ToFloat,
+    FloatToU8,
+    ConvolveHorizontalAvx2,
+    ConvolveVerticalAvx2,
+};
+
+} // namespace Detail
+} // namespace Simd
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,190 @@
+// AVX-512 (F + BW) pixel kernels. Built with AVX-512 code generation
+// enabled; only reached after CPUID and XCR0 report support. Narrowing uses
+// the order-preserving vpmovusdb instead of lane-local packs.
+
+#include "core/SimdUtils.hpp"
+#include <immintrin.h>
+
+namespace UltraImageViewer {
+namespace Core {
+namespace Simd {
+namespace Detail {
+
+// SimdPixelsAVX2.cpp; every AVX-512 CPU has AVX2
+void ConvolveHorizontalAvx2(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                            const int32_t* starts, const int16_t* weights, size_t taps);
+void ConvolveVerticalAvx2(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                          uint8_t* dst, size_t bytes);
+
+namespace {
+
+const Detail::PixelKernels& S = kScalarKernels;
+
+inline __m512i Load(const void* p) { return _mm512_loadu_si512(p); }
+inline void Store(void* p, __m512i v) { _mm512_storeu_si512(p, v); }
+
+// Byte 3 of every pixel
+constexpr __mmask64 kAlphaBytes = 0x8888888888888888ULL;
+
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m512i shuf = _mm512_broadcast_i32x4(
+        _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        Store(dst + i * 4, _mm512_shuffle_epi8(Load(src + i * 4), shuf));
+    }
+    S.swapRedBlue(src + i * 4, dst + i * 4, pixels - i);
+}
+
+inline __m512i MulDiv255(__m512i c, __m512i a)
+{
+    __m512i t = _mm512_add_epi16(_mm512_mullo_epi16(c, a), _mm512_set1_epi16(128));
+    return _mm512_srli_epi16(_mm512_add_epi16(t, _mm512_srli_epi16(t, 8)), 8);
+}
+
+inline __m512i BroadcastAlpha16(__m512i v)
+{
+    return _mm512_shufflehi_epi16(_mm512_shufflelo_epi16(v, 0xFF), 0xFF);
+}
+
+void Premultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m512i px = Load(src + i * 4);
+        __m512i lo = _mm512_unpacklo_epi8(px, zero);
+        __m512i hi = _mm512_unpackhi_epi8(px, zero);
+        lo = MulDiv255(lo, BroadcastAlpha16(lo));
+        hi = MulDiv255(hi, BroadcastAlpha16(hi));
+        Store(dst + i * 4, _mm512_mask_blend_epi8(kAlphaBytes, _mm512_packus_epi16(lo, hi), px));
+    }
+    S.premultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// Four pixels in 32-bit lanes (see SimdPixelsSSE41.cpp for the exactness note)
+inline __m128i Unpremul4(__m128i px)
+{
+    __m512i c = _mm512_cvtepu8_epi32(px);
+    __m512i a = _mm512_shuffle_epi32(c, _MM_PERM_DDDD);
+    __m512i num = _mm512_add_epi32(_mm512_mullo_epi32(c, _mm512_set1_epi32(255)),
+                                   _mm512_srli_epi32(a, 1));
+    __m512i q = _mm512_cvttps_epi32(_mm512_div_ps(_mm512_cvtepi32_ps(num), _mm512_cvtepi32_ps(a)));
+    q = _mm512_min_epi32(q, _mm512_set1_epi32(255));
+    q = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(a, _mm512_setzero_si512()), q);
+    __m128i out = _mm512_cvtusepi32_epi8(q);
+    return _mm_blendv_epi8(out, px, _mm_set1_epi32(static_cast<int>(0xFF000000u)));
+}
+
+void Unpremultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), Unpremul4(px));
+    }
+    S.unpremultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// 16 packed 3-byte pixels: four 16-byte loads at a 12-byte stride, shuffled
+// in-lane. The last load ends 52 bytes in, so stop while 18 pixels remain.
+inline void Expand24(const uint8_t* src, uint8_t* dst, size_t pixels, __m128i shuf128,
+                     void (*tail)(const uint8_t*, uint8_t*, size_t))
+{
+    const __m512i shuf = _mm512_broadcast_i32x4(shuf128);
+    const __m512i alpha = _mm512_set1_epi32(static_cast<int>(0xFF000000u));
+    size_t i = 0;
+    for (; i + 18 <= pixels; i += 16) {
+        const uint8_t* s = src + i * 3;
+        __m512i v = _mm512_castsi128_si512(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 12)), 1);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 24)), 2);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 36)), 3);
+        Store(dst + i * 4, _mm512_or_si512(_mm512_shuffle_epi8(v, shuf), alpha));
+    }
+    tail(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void Rgb24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Expand24(src, dst, pixels,
+             _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1),
+             S.rgb24ToBgra32);
+}
+
+void Bgr24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Expand24(src, dst, pixels,
+             _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1),
+             S.bgr24ToBgra32);
+}
+
+void Widen8To16(const uint8_t* src, uint16_t* dst, size_t samples)
+{
+    const __m512i k257 = _mm512_set1_epi16(257);
+    size_t i = 0;
+    for (; i + 32 <= samples; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        Store(dst + i, _mm512_mullo_epi16(_mm512_cvtepu8_epi16(v), k257));
+    }
+    S.widen8To16(src + i, dst + i, samples - i);
+}
+
+void Narrow16To8(const uint16_t* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m512i t = _mm512_add_epi32(_mm512_mullo_epi32(_mm512_cvtepu16_epi32(v), _mm512_set1_epi32(255)),
+                                     _mm512_set1_epi32(32895));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm512_cvtusepi32_epi8(_mm512_srli_epi32(t, 16)));
+    }
+    S.narrow16To8(src + i, dst + i, samples - i);
+}
+
+void U8ToFloat(const uint8_t* src, float* dst, size_t samples)
+{
+    const __m512 scale = _mm512_set1_ps(1.0f / 255.0f);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(v)), scale));
+    }
+    S.u8ToFloat(src + i, dst + i, samples - i);
+}
+
+void FloatToU8(const float* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m512 v = _mm512_loadu_ps(src + i);
+        v = _mm512_min_ps(_mm512_max_ps(v, _mm512_setzero_ps()), _mm512_set1_ps(1.0f));
+        __m512i q = _mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(v, _mm512_set1_ps(255.0f)),
+                                                      _mm512_set1_ps(0.5f)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm512_cvtusepi32_epi8(q));
+    }
+    S.floatToU8(src + i, dst + i, samples - i);
+}
+
+} // namespace
+
+const PixelKernels kAvx512Kernels = {
+    SwapRedBlue,
+    Premultiply,
+    Unpremultiply,
+    Rgb24ToBgra32,
+    Bgr24ToBgra32,
+    Widen8To16,
+    Narrow16To8,
+    U8ToFloat,
+    FloatToU8,
+    ConvolveHorizontalAvx2,
+    ConvolveVerticalAvx2,
+};
+
+} // namespace Detail
+} // namespace Simd
+} // namespace Core
+} // namespace UltraImageViewer
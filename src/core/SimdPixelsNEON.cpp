@@ -0,0 +1,257 @@
+// NEON pixel kernels (AArch64, where NEON is baseline). Structured loads
+// (vld3/vld4) deinterleave channels, so every kernel works per channel on
+// 16 pixels at a time.
+
+#include "core/SimdUtils.hpp"
+#include <arm_neon.h>
+#include <cstring>
+
+namespace UltraImageViewer {
+namespace Core {
+namespace Simd {
+namespace Detail {
+
+namespace {
+
+const Detail::PixelKernels& S = kScalarKernels;
+
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t px = vld4q_u8(src + i * 4);
+        uint8x16_t r = px.val[0];
+        px.val[0] = px.val[2];
+        px.val[2] = r;
+        vst4q_u8(dst + i * 4, px);
+    }
+    S.swapRedBlue(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// round(c * a / 255) for 8 lanes: t = c*a + 128; (t + (t >> 8)) >> 8
+inline uint8x8_t MulDiv255(uint8x8_t c, uint8x8_t a)
+{
+    uint16x8_t t = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+inline uint8x16_t MulDiv255(uint8x16_t c, uint8x16_t a)
+{
+    return vcombine_u8(MulDiv255(vget_low_u8(c), vget_low_u8(a)),
+                       MulDiv255(vget_high_u8(c), vget_high_u8(a)));
+}
+
+void Premultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t px = vld4q_u8(src + i * 4);
+        px.val[0] = MulDiv255(px.val[0], px.val[3]);
+        px.val[1] = MulDiv255(px.val[1], px.val[3]);
+        px.val[2] = MulDiv255(px.val[2], px.val[3]);
+        vst4q_u8(dst + i * 4, px);
+    }
+    S.premultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// min(255, (c*255 + a/2) / a), 0 where a == 0, for 4 lanes (exact: see
+// SimdPixelsSSE41.cpp)
+inline uint32x4_t Unpremul4(uint32x4_t c, uint32x4_t a)
+{
+    uint32x4_t num = vaddq_u32(vmulq_n_u32(c, 255), vshrq_n_u32(a, 1));
+    uint32x4_t q = vcvtq_u32_f32(vdivq_f32(vcvtq_f32_u32(num), vcvtq_f32_u32(a)));
+    q = vminq_u32(q, vdupq_n_u32(255));
+    return vandq_u32(q, vcgtq_u32(a, vdupq_n_u32(0)));
+}
+
+inline uint8x16_t Unpremul16(uint8x16_t c, uint8x16_t a)
+{
+    uint16x8_t c0 = vmovl_u8(vget_low_u8(c)), c1 = vmovl_u8(vget_high_u8(c));
+    uint16x8_t a0 = vmovl_u8(vget_low_u8(a)), a1 = vmovl_u8(vget_high_u8(a));
+    uint16x8_t lo = vcombine_u16(vmovn_u32(Unpremul4(vmovl_u16(vget_low_u16(c0)), vmovl_u16(vget_low_u16(a0)))),
+                                 vmovn_u32(Unpremul4(vmovl_u16(vget_high_u16(c0)), vmovl_u16(vget_high_u16(a0)))));
+    uint16x8_t hi = vcombine_u16(vmovn_u32(Unpremul4(vmovl_u16(vget_low_u16(c1)), vmovl_u16(vget_low_u16(a1)))),
+                                 vmovn_u32(Unpremul4(vmovl_u16(vget_high_u16(c1)), vmovl_u16(vget_high_u16(a1)))));
+    return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+void Unpremultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t px = vld4q_u8(src + i * 4);
+        px.val[0] = Unpremul16(px.val[0], px.val[3]);
+        px.val[1] = Unpremul16(px.val[1], px.val[3]);
+        px.val[2] = Unpremul16(px.val[2], px.val[3]);
+        vst4q_u8(dst + i * 4, px);
+    }
+    S.unpremultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+void Rgb24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        uint8x16x4_t bgra = {{rgb.val[2], rgb.val[1], rgb.val[0], vdupq_n_u8(0xFF)}};
+        vst4q_u8(dst + i * 4, bgra);
+    }
+    S.rgb24ToBgra32(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void Bgr24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t bgr = vld3q_u8(src + i * 3);
+        uint8x16x4_t bgra = {{bgr.val[0], bgr.val[1], bgr.val[2], vdupq_n_u8(0xFF)}};
+        vst4q_u8(dst + i * 4, bgra);
+    }
+    S.bgr24ToBgra32(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void Widen8To16(const uint8_t* src, uint16_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        vst1q_u16(dst + i, vmulq_n_u16(vmovl_u8(vget_low_u8(v)), 257));
+        vst1q_u16(dst + i + 8, vmulq_n_u16(vmovl_u8(vget_high_u8(v)), 257));
+    }
+    S.widen8To16(src + i, dst + i, samples - i);
+}
+
+// (v * 255 + 32895) >> 16 for 4 lanes
+inline uint16x4_t Narrow4(uint16x4_t v)
+{
+    uint32x4_t t = vaddq_u32(vmulq_n_u32(vmovl_u16(v), 255), vdupq_n_u32(32895));
+    return vshrn_n_u32(t, 16);
+}
+
+void Narrow16To8(const uint16_t* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        uint16x8_t v = vld1q_u16(src + i);
+        uint16x8_t n = vcombine_u16(Narrow4(vget_low_u16(v)), Narrow4(vget_high_u16(v)));
+        vst1_u8(dst + i, vmovn_u16(n));
+    }
+    S.narrow16To8(src + i, dst + i, samples - i);
+}
+
+void U8ToFloat(const uint8_t* src, float* dst, size_t samples)
+{
+    const float scale = 1.0f / 255.0f;
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+    }
+    S.u8ToFloat(src + i, dst + i, samples - i);
+}
+
+// maxnm returns the number when the other operand is NaN, matching the
+// scalar "v > 0 ? v : 0"
+inline uint16x4_t FloatTo16(float32x4_t v)
+{
+    v = vminq_f32(vmaxnmq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+    v = vaddq_f32(vmulq_n_f32(v, 255.0f), vdupq_n_f32(0.5f));
+    return vmovn_u32(vcvtq_u32_f32(v));
+}
+
+void FloatToU8(const float* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        uint16x8_t n = vcombine_u16(FloatTo16(vld1q_f32(src + i)), FloatTo16(vld1q_f32(src + i + 4)));
+        vst1_u8(dst + i, vmovn_u16(n));
+    }
+    S.floatToU8(src + i, dst + i, samples - i);
+}
+
+// ---- Resampling convolutions ----
+
+// One output pixel as four 32-bit channel sums, already shifted down
+inline int32x4_t ConvolvePixel(const uint8_t* s, const int16_t* w, size_t taps)
+{
+    int32x4_t acc = vdupq_n_s32(1 << (kConvolveBits - 1));
+    size_t k = 0;
+    for (; k + 2 <= taps; k += 2) {
+        int16x8_t px = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(s + k * 4)));
+        acc = vmlal_n_s16(acc, vget_low_s16(px), w[k]);
+        acc = vmlal_n_s16(acc, vget_high_s16(px), w[k + 1]);
+    }
+    if (k < taps) {
+        uint32_t v;
+        std::memcpy(&v, s + k * 4, 4);
+        int16x8_t px = vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(v))));
+        acc = vmlal_n_s16(acc, vget_low_s16(px), w[k]);
+    }
+    return vshrq_n_s32(acc, kConvolveBits);
+}
+
+void ConvolveHorizontal(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                        const int32_t* starts, const int16_t* weights, size_t taps)
+{
+    size_t x = 0;
+    for (; x + 2 <= dstPixels; x += 2) {
+        int32x4_t p0 = ConvolvePixel(src + starts[x] * 4, weights + x * taps, taps);
+        int32x4_t p1 = ConvolvePixel(src + starts[x + 1] * 4, weights + (x + 1) * taps, taps);
+        vst1_u8(dst + x * 4, vqmovun_s16(vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1))));
+    }
+    if (x < dstPixels) {
+        int16x4_t p = vqmovn_s32(ConvolvePixel(src + starts[x] * 4, weights + x * taps, taps));
+        uint8x8_t v = vqmovun_s16(vcombine_s16(p, p));
+        vst1_lane_u32(reinterpret_cast<uint32_t*>(dst + x * 4), vreinterpret_u32_u8(v), 0);
+    }
+}
+
+void ConvolveVertical(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                      uint8_t* dst, size_t bytes)
+{
+    const int32x4_t round = vdupq_n_s32(1 << (kConvolveBits - 1));
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        int32x4_t a0 = round, a1 = round, a2 = round, a3 = round;
+        for (size_t k = 0; k < taps; ++k) {
+            uint8x16_t v = vld1q_u8(rows[k] + i);
+            int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v)));
+            int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v)));
+            a0 = vmlal_n_s16(a0, vget_low_s16(lo), weights[k]);
+            a1 = vmlal_n_s16(a1, vget_high_s16(lo), weights[k]);
+            a2 = vmlal_n_s16(a2, vget_low_s16(hi), weights[k]);
+            a3 = vmlal_n_s16(a3, vget_high_s16(hi), weights[k]);
+        }
+        int16x8_t lo16 = vcombine_s16(vqshrn_n_s32(a0, kConvolveBits), vqshrn_n_s32(a1, kConvolveBits));
+        int16x8_t hi16 = vcombine_s16(vqshrn_n_s32(a2, kConvolveBits), vqshrn_n_s32(a3, kConvolveBits));
+        vst1q_u8(dst + i, vcombine_u8(vqmovun_s16(lo16), vqmovun_s16(hi16)));
+    }
+    for (; i < bytes; ++i) {
+        int32_t acc = 1 << (kConvolveBits - 1);
+        for (size_t k = 0; k < taps; ++k) acc += weights[k] * rows[k][i];
+        acc >>= kConvolveBits;
+        dst[i] = static_cast<uint8_t>(acc < 0 ? 0 : (acc > 255 ? 255 : acc));
+    }
+}
+
+} // namespace
+
+const PixelKernels kNeonKernels = {
+    SwapRedBlue,
+    Premultiply,
+    Unpremultiply,
+    Rgb24ToBgra32,
+    Bgr24ToBgra32,
+    Widen8To16,
+    Narrow16To8,
+    U8ToFloat,
+    FloatToU8,
+    ConvolveHorizontal,
+    ConvolveVertical,
+};
+
+} // namespace Detail
+} // namespace Simd
+} // namespace Core
+} // namespace UltraImageViewer
@@ -0,0 +1,290 @@
+// SSE4.1 (+SSSE3) pixel kernels. Built with SSE4.1 code generation enabled;
+// only reached after CPUID reports support. Tails go to the scalar kernels.
+
+#include "core/SimdUtils.hpp"
+#include <immintrin.h>
+#include <cstring>
+
+namespace UltraImageViewer {
+namespace Core {
+namespace Simd {
+namespace Detail {
+
+namespace {
+
+const Detail::PixelKernels& S = kScalarKernels;
+
+inline __m128i Load(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+inline void Store(void* p, __m128i v) { _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+
+// Byte 3 of every pixel
+inline __m128i AlphaMask() { return _mm_set1_epi32(static_cast<int>(0xFF000000u)); }
+
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m128i shuf = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        Store(dst + i * 4, _mm_shuffle_epi8(Load(src + i * 4), shuf));
+    }
+    S.swapRedBlue(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// round(c * a / 255) on 16-bit lanes: t = c*a + 128; (t + (t >> 8)) >> 8
+inline __m128i MulDiv255(__m128i c, __m128i a)
+{
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// Alpha (lane 3 of each 4-lane pixel) broadcast across the pixel
+inline __m128i BroadcastAlpha16(__m128i v)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+}
+
+void Premultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i px = Load(src + i * 4);
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+        lo = MulDiv255(lo, BroadcastAlpha16(lo));
+        hi = MulDiv255(hi, BroadcastAlpha16(hi));
+        Store(dst + i * 4, _mm_blendv_epi8(_mm_packus_epi16(lo, hi), px, AlphaMask()));
+    }
+    S.premultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// One pixel in 32-bit lanes: min(255, (c*255 + a/2) / a), 0 where a == 0.
+// Float division is exact here: numerators stay below 2^16 and a non-integer
+// quotient is at least 1/255 away from the next integer.
+inline __m128i Unpremul1(__m128i c)
+{
+    __m128i a = _mm_shuffle_epi32(c, 0xFF);
+    __m128i num = _mm_add_epi32(_mm_mullo_epi32(c, _mm_set1_epi32(255)), _mm_srli_epi32(a, 1));
+    __m128i q = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(num), _mm_cvtepi32_ps(a)));
+    q = _mm_min_epi32(q, _mm_set1_epi32(255));
+    return _mm_and_si128(q, _mm_cmpgt_epi32(a, _mm_setzero_si128()));
+}
+
+void Unpremultiply(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i px = Load(src + i * 4);
+        __m128i p0 = Unpremul1(_mm_cvtepu8_epi32(px));
+        __m128i p1 = Unpremul1(_mm_cvtepu8_epi32(_mm_srli_si128(px, 4)));
+        __m128i p2 = Unpremul1(_mm_cvtepu8_epi32(_mm_srli_si128(px, 8)));
+        __m128i p3 = Unpremul1(_mm_cvtepu8_epi32(_mm_srli_si128(px, 12)));
+        __m128i out = _mm_packus_epi16(_mm_packus_epi32(p0, p1), _mm_packus_epi32(p2, p3));
+        Store(dst + i * 4, _mm_blendv_epi8(out, px, AlphaMask()));
+    }
+    S.unpremultiply(src + i * 4, dst + i * 4, pixels - i);
+}
+
+// 4 packed 3-byte pixels -> 4 BGRA pixels. Reads 16 bytes for 12 used, so
+// the loop stops while at least 6 pixels remain.
+inline void Expand24(const uint8_t* src, uint8_t* dst, size_t pixels, __m128i shuf,
+                     void (*tail)(const uint8_t*, uint8_t*, size_t))
+{
+    size_t i = 0;
+    for (; i + 6 <= pixels; i += 4) {
+        __m128i v = _mm_shuffle_epi8(Load(src + i * 3), shuf);
+        Store(dst + i * 4, _mm_or_si128(v, AlphaMask()));
+    }
+    tail(src + i * 3, dst + i * 4, pixels - i);
+}
+
+void Rgb24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m128i shuf = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    Expand24(src, dst, pixels, shuf, S.rgb24ToBgra32);
+}
+
+void Bgr24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    const __m128i shuf = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    Expand24(src, dst, pixels, shuf, S.bgr24ToBgra32);
+}
+
+void Widen8To16(const uint8_t* src, uint16_t* dst, size_t samples)
+{
+    const __m128i k257 = _mm_set1_epi16(257);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i v = Load(src + i);
+        Store(dst + i, _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), k257));
+        Store(dst + i + 8, _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), k257));
+    }
+    S.widen8To16(src + i, dst + i, samples - i);
+}
+
+// (v * 255 + 32895) >> 16 on 32-bit lanes
+inline __m128i Narrow4(__m128i v32)
+{
+    __m128i t = _mm_add_epi32(_mm_mullo_epi32(v32, _mm_set1_epi32(255)), _mm_set1_epi32(32895));
+    return _mm_srli_epi32(t, 16);
+}
+
+void Narrow16To8(const uint16_t* src, uint8_t* dst, size_t samples)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i a = Load(src + i);
+        __m128i b = Load(src + i + 8);
+        __m128i a16 = _mm_packus_epi32(Narrow4(_mm_unpacklo_epi16(a, zero)),
+                                       Narrow4(_mm_unpackhi_epi16(a, zero)));
+        __m128i b16 = _mm_packus_epi32(Narrow4(_mm_unpacklo_epi16(b, zero)),
+                                       Narrow4(_mm_unpackhi_epi16(b, zero)));
+        Store(dst + i, _mm_packus_epi16(a16, b16));
+    }
+    S.narrow16To8(src + i, dst + i, samples - i);
+}
+
+void U8ToFloat(const uint8_t* src, float* dst, size_t samples)
+{
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i v = Load(src + i);
+        for (int k = 0; k < 4; ++k) {
+            __m128i v32 = _mm_cvtepu8_epi32(v);
+            _mm_storeu_ps(dst + i + k * 4, _mm_mul_ps(_mm_cvtepi32_ps(v32), scale));
+            v = _mm_srli_si128(v, 4);
+        }
+    }
+    S.u8ToFloat(src + i, dst + i, samples - i);
+}
+
+// clamp to [0, 1] (max with NaN returns the second operand, i.e. 0), scale, round
+inline __m128i FloatTo32(__m128 v)
+{
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+void FloatToU8(const float* src, uint8_t* dst, size_t samples)
+{
+    size_t i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m128i a = _mm_packus_epi32(FloatTo32(_mm_loadu_ps(src + i)), FloatTo32(_mm_loadu_ps(src + i + 4)));
+        __m128i b = _mm_packus_epi32(FloatTo32(_mm_loadu_ps(src + i + 8)), FloatTo32(_mm_loadu_ps(src + i + 12)));
+        Store(dst + i, _mm_packus_epi16(a, b));
+    }
+    S.floatToU8(src + i, dst + i, samples - i);
+}
+
+// ---- Resampling convolutions ----
+
+// Two taps' weights packed for pmaddwd: low half w[0], high half w[1]
+inline int WeightPair(const int16_t* w)
+{
+    return static_cast<int>(static_cast<uint16_t>(w[0]) | (static_cast<uint32_t>(static_cast<uint16_t>(w[1])) << 16));
+}
+
+inline __m128i LoadPixel(const uint8_t* s)
+{
+    int v;
+    std::memcpy(&v, s, 4);
+    return _mm_cvtsi32_si128(v);
+}
+
+// Two adjacent source pixels as [b0 b1 g0 g1 r0 r1 a0 a1] in 16-bit lanes,
+// so one pmaddwd applies two taps to all four channels
+inline __m128i PixelPair(const uint8_t* s)
+{
+    const __m128i interleave = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+    return _mm_cvtepu8_epi16(_mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s)), interleave));
+}
+
+// One output pixel as four 32-bit channel sums, already shifted down
+inline __m128i ConvolvePixel(const uint8_t* s, const int16_t* w, size_t taps)
+{
+    __m128i acc = _mm_set1_epi32(1 << (kConvolveBits - 1));
+    size_t k = 0;
+    for (; k + 2 <= taps; k += 2) {
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(PixelPair(s + k * 4), _mm_set1_epi32(WeightPair(w + k))));
+    }
+    if (k < taps) {
+        acc = _mm_add_epi32(acc, _mm_mullo_epi32(_mm_cvtepu8_epi32(LoadPixel(s + k * 4)), _mm_set1_epi32(w[k])));
+    }
+    return _mm_srai_epi32(acc, kConvolveBits);
+}
+
+void ConvolveHorizontal(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                        const int32_t* starts, const int16_t* weights, size_t taps)
+{
+    size_t x = 0;
+    for (; x + 4 <= dstPixels; x += 4) {
+        __m128i p0 = ConvolvePixel(src + starts[x] * 4, weights + x * taps, taps);
+        __m128i p1 = ConvolvePixel(src + starts[x + 1] * 4, weights + (x + 1) * taps, taps);
+        __m128i p2 = ConvolvePixel(src + starts[x + 2] * 4, weights + (x + 2) * taps, taps);
+        __m128i p3 = ConvolvePixel(src + starts[x + 3] * 4, weights + (x + 3) * taps, taps);
+        Store(dst + x * 4, _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+    }
+    for (; x < dstPixels; ++x) {
+        __m128i p = ConvolvePixel(src + starts[x] * 4, weights + x * taps, taps);
+        p = _mm_packus_epi16(_mm_packs_epi32(p, p), p);
+        int v = _mm_cvtsi128_si32(p);
+        std::memcpy(dst + x * 4, &v, 4);
+    }
+}
+
+void ConvolveVertical(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                      uint8_t* dst, size_t bytes)
+{
+    const __m128i round = _mm_set1_epi32(1 << (kConvolveBits - 1));
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a0 = round, a1 = round, a2 = round, a3 = round;
+        for (size_t k = 0; k < taps; k += 2) {
+            // Interleave rows k and k+1 so pmaddwd sums both taps per byte
+            bool pair = k + 1 < taps;
+            __m128i w = _mm_set1_epi32(pair ? WeightPair(weights + k) : static_cast<uint16_t>(weights[k]));
+            __m128i r0 = Load(rows[k] + i);
+            __m128i r1 = pair ? Load(rows[k + 1] + i) : zero;
+            __m128i lo = _mm_unpacklo_epi8(r0, r1);
+            __m128i hi = _mm_unpackhi_epi8(r0, r1);
+            a0 = _mm_add_epi32(a0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            a1 = _mm_add_epi32(a1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            a2 = _mm_add_epi32(a2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            a3 = _mm_add_epi32(a3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+        __m128i lo16 = _mm_packs_epi32(_mm_srai_epi32(a0, kConvolveBits), _mm_srai_epi32(a1, kConvolveBits));
+        __m128i hi16 = _mm_packs_epi32(_mm_srai_epi32(a2, kConvolveBits), _mm_srai_epi32(a3, kConvolveBits));
+        Store(dst + i, _mm_packus_epi16(lo16, hi16));
+    }
+    for (; i < bytes; ++i) {
+        int32_t acc = 1 << (kConvolveBits - 1);
+        for (size_t k = 0; k < taps; ++k) acc += weights[k] * rows[k][i];
+        acc >>= kConvolveBits;
+        dst[i] = static_cast<uint8_t>(acc < 0 ? 0 : (acc > 255 ? 255 : acc));
+    }
+}
+
+} // namespace
+
+const PixelKernels kSse41Kernels = {
+    SwapRedBlue,
+    Premultiply,
+    Unpremultiply,
+    Rgb24ToBgra32,
+    Bgr24ToBgra32,
+    Widen8To16,
+    Narrow16To8,
+    U8ToFloat,
+    FloatToU8,
+    ConvolveHorizontal,
+    ConvolveVertical,
+};
+
+} // namespace Detail
+} // namespace Simd
+} // namespace Core
+} // namespace UltraImageViewer
@@ -1,123 +1,468 @@
 #include "core/SimdUtils.hpp"
+#include <algorithm>
+
+#if defined(UIV_SIMD_X86)
+#if defined(_MSC_VER)
 #include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
 #include <immintrin.h>
+#endif
 
 namespace UltraImageViewer {
 namespace Core {
 namespace Simd {
 
+#if defined(UIV_SIMD_X86)
+namespace Detail {
+void ToLowerAvx2(wchar_t* data, size_t count);  // SimdPixelsAVX2.cpp
+}
+#endif
+
 static bool s_hasAVX2 = false;
 static bool s_hasSSE42 = false;
+static bool s_hasSSE41 = false;
+static bool s_hasAVX512 = false;  // F + BW, with OS ZMM state support
+
+#if defined(UIV_SIMD_X86)
+
+static void CpuId(int leaf, int subLeaf, int out[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(out, leaf, subLeaf);
+#else
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(leaf, subLeaf, a, b, c, d);
+    out[0] = static_cast<int>(a);
+    out[1] = static_cast<int>(b);
+    out[2] = static_cast<int>(c);
+    out[3] = static_cast<int>(d);
+#endif
+}
+
+// XCR0: which register states the OS saves on context switch
+static uint64_t ReadXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+#endif
 
 void DetectFeatures()
 {
+#if defined(UIV_SIMD_X86)
     int cpuInfo[4];
 
-    __cpuid(cpuInfo, 0);
+    CpuId(0, 0, cpuInfo);
     int nIds = cpuInfo[0];
 
+    // SSE4.1: Leaf 1, ECX bit 19 (SSSE3 bit 9 is implied on every SSE4.1 CPU)
     // SSE4.2: Leaf 1, ECX bit 20
-    __cpuid(cpuInfo, 1);
+    CpuId(1, 0, cpuInfo);
+    s_hasSSE41 = (cpuInfo[2] & (1 << 19)) != 0 && (cpuInfo[2] & (1 << 9)) != 0;
     s_hasSSE42 = (cpuInfo[2] & (1 << 20)) != 0;
 
-    // AVX requires OS XSAVE support (Leaf 1, ECX bit 27) + AVX bit (ECX bit 28)
-    bool hasAVX = (cpuInfo[2] & (1 << 27)) != 0 && (cpuInfo[2] & (1 << 28)) != 0;
+    // AVX requires OS XSAVE support (Leaf 1, ECX bit 27) + AVX bit (ECX bit 28),
+    // and the OS must save YMM (XCR0 bits 1-2) / ZMM (bits 5-7) state
+    bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+    bool hasAVX = osxsave && (cpuInfo[2] & (1 << 28)) != 0;
+    uint64_t xcr0 = osxsave ? ReadXcr0() : 0;
+    bool osYmm = (xcr0 & 0x6) == 0x6;
+    bool osZmm = (xcr0 & 0xE6) == 0xE6;
 
-    // AVX2: Leaf 7, Sub-leaf 0, EBX bit 5
-    if (hasAVX && nIds >= 7) {
-        __cpuidex(cpuInfo, 7, 0);
+    // AVX2: Leaf 7, Sub-leaf 0, EBX bit 5; AVX-512 F/BW: EBX bits 16/30
+    if (hasAVX && osYmm && nIds >= 7) {
+        CpuId(7, 0, cpuInfo);
         s_hasAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+        s_hasAVX512 = osZmm && (cpuInfo[1] & (1 << 16)) != 0 && (cpuInfo[1] & (1 << 30)) != 0;
     }
+#endif
 }
 
 bool HasAVX2()  { return s_hasAVX2; }
 bool HasSSE42() { return s_hasSSE42; }
 
-// ---- AVX2 path: 16 wchar_t (32 bytes) per iteration ----
-// Range check: (ch > 0x40) AND (0x5B > ch) identifies A-Z.
-// For chars > 0x7FFF (CJK etc.), signed cmpgt sees them as negative,
-// so (negative > 0x40) = false, making the AND mask 0. Safe.
+// ---- ToLowerInPlace ----
+// wchar_t is UTF-16 on Windows and UTF-32 on Linux: lanes follow its size.
+// Range check: (ch > 0x40) AND (0x5B > ch) identifies A-Z. For 16-bit chars
+// above 0x7FFF (CJK etc.), signed cmpgt sees them as negative, so
+// (negative > 0x40) = false, making the AND mask 0. Safe. 32-bit code points
+// never reach the sign bit.
 
-static void ToLower_AVX2(wchar_t* data, size_t count)
+static void ToLower_Scalar(wchar_t* data, size_t count)
 {
-    const __m256i v40 = _mm256_set1_epi16(0x0040);  // 'A' - 1
-    const __m256i v5B = _mm256_set1_epi16(0x005B);  // 'Z' + 1
-    const __m256i v20 = _mm256_set1_epi16(0x0020);  // lowercase bit
-
-    size_t i = 0;
-    for (; i + 16 <= count; i += 16) {
-        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
-
-        __m256i gt40 = _mm256_cmpgt_epi16(chars, v40);
-        __m256i lt5B = _mm256_cmpgt_epi16(v5B, chars);
-        __m256i mask = _mm256_and_si256(gt40, lt5B);
-
-        __m256i lowBit = _mm256_and_si256(mask, v20);
-        chars = _mm256_or_si256(chars, lowBit);
-
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), chars);
-    }
-
-    // Scalar tail
-    for (; i < count; ++i) {
+    for (size_t i = 0; i < count; ++i) {
         wchar_t c = data[i];
         if (c >= L'A' && c <= L'Z') c |= 0x0020;
         data[i] = c;
     }
 }
 
-// ---- SSE2 path: 8 wchar_t (16 bytes) per iteration ----
+#if defined(UIV_SIMD_X86)
+
+// ---- SSE2 path: 16 bytes per iteration ----
 
 static void ToLower_SSE2(wchar_t* data, size_t count)
 {
-    const __m128i v40 = _mm_set1_epi16(0x0040);
-    const __m128i v5B = _mm_set1_epi16(0x005B);
-    const __m128i v20 = _mm_set1_epi16(0x0020);
+    constexpr size_t kLanes = 16 / sizeof(wchar_t);
 
     size_t i = 0;
-    for (; i + 8 <= count; i += 8) {
+    for (; i + kLanes <= count; i += kLanes) {
         __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i mask;
+        __m128i lowBit;
 
-        __m128i gt40 = _mm_cmpgt_epi16(chars, v40);
-        __m128i lt5B = _mm_cmpgt_epi16(v5B, chars);
-        __m128i mask = _mm_and_si128(gt40, lt5B);
-
-        __m128i lowBit = _mm_and_si128(mask, v20);
+        if constexpr (sizeof(wchar_t) == 2) {
+            mask = _mm_and_si128(_mm_cmpgt_epi16(chars, _mm_set1_epi16(0x0040)),
+                                 _mm_cmpgt_epi16(_mm_set1_epi16(0x005B), chars));
+            lowBit = _mm_and_si128(mask, _mm_set1_epi16(0x0020));
+        } else {
+            mask = _mm_and_si128(_mm_cmpgt_epi32(chars, _mm_set1_epi32(0x0040)),
+                                 _mm_cmpgt_epi32(_mm_set1_epi32(0x005B), chars));
+            lowBit = _mm_and_si128(mask, _mm_set1_epi32(0x0020));
+        }
         chars = _mm_or_si128(chars, lowBit);
 
         _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), chars);
     }
 
     // Scalar tail
-    for (; i < count; ++i) {
-        wchar_t c = data[i];
-        if (c >= L'A' && c <= L'Z') c |= 0x0020;
-        data[i] = c;
-    }
+    ToLower_Scalar(data + i, count - i);
 }
 
+#endif
+
 void ToLowerInPlace(wchar_t* data, size_t length)
 {
     if (length == 0 || !data) return;
 
-    if (s_hasAVX2 && length >= 16) {
-        ToLower_AVX2(data, length);
+#if defined(UIV_SIMD_X86)
+    if (s_hasAVX2 && length * sizeof(wchar_t) >= 32) {
+        Detail::ToLowerAvx2(data, length);
         return;
     }
 
-    if (length >= 8) {
+    if (length * sizeof(wchar_t) >= 16) {
         ToLower_SSE2(data, length);
         return;
     }
+#endif
 
     // Pure scalar for very short strings
-    for (size_t i = 0; i < length; ++i) {
-        wchar_t c = data[i];
-        if (c >= L'A' && c <= L'Z') c |= 0x0020;
-        data[i] = c;
+    ToLower_Scalar(data, length);
+}
+
+// ---- Scalar pixel kernels (reference implementations) ----
+
+namespace {
+
+void SwapRedBlueScalar(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+        uint8_t r = src[0], g = src[1], b = src[2], a = src[3];
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+        dst[3] = a;
+    }
+}
+
+inline uint8_t MulDiv255(uint32_t c, uint32_t a)
+{
+    uint32_t t = c * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+void PremultiplyScalar(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+        uint32_t a = src[3];
+        dst[0] = MulDiv255(src[0], a);
+        dst[1] = MulDiv255(src[1], a);
+        dst[2] = MulDiv255(src[2], a);
+        dst[3] = static_cast<uint8_t>(a);
+    }
+}
+
+inline uint8_t Unpremul(uint32_t c, uint32_t a)
+{
+    return static_cast<uint8_t>(std::min<uint32_t>(255, (c * 255 + a / 2) / a));
+}
+
+void UnpremultiplyScalar(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+        uint32_t a = src[3];
+        if (a == 0) {
+            dst[0] = dst[1] = dst[2] = 0;
+        } else {
+            uint8_t c0 = Unpremul(src[0], a), c1 = Unpremul(src[1], a), c2 = Unpremul(src[2], a);
+            dst[0] = c0;
+            dst[1] = c1;
+            dst[2] = c2;
+        }
+        dst[3] = static_cast<uint8_t>(a);
+    }
+}
+
+void Rgb24ToBgra32Scalar(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = 0xFF;
+    }
+}
+
+void Bgr24ToBgra32Scalar(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xFF;
+    }
+}
+
+void Widen8To16Scalar(const uint8_t* src, uint16_t* dst, size_t samples)
+{
+    for (size_t i = 0; i < samples; ++i) dst[i] = static_cast<uint16_t>(src[i] * 257u);
+}
+
+void Narrow16To8Scalar(const uint16_t* src, uint8_t* dst, size_t samples)
+{
+    // (v * 255 + 32895) >> 16 == round(v / 257) for every 16-bit v
+    for (size_t i = 0; i < samples; ++i) {
+        dst[i] = static_cast<uint8_t>((src[i] * 255u + 32895u) >> 16);
     }
 }
 
+void U8ToFloatScalar(const uint8_t* src, float* dst, size_t samples)
+{
+    constexpr float kScale = 1.0f / 255.0f;
+    for (size_t i = 0; i < samples; ++i) dst[i] = static_cast<float>(src[i]) * kScale;
+}
+
+void FloatToU8Scalar(const float* src, uint8_t* dst, size_t samples)
+{
+    for (size_t i = 0; i < samples; ++i) {
+        float v = src[i];
+        v = v > 0.0f ? v : 0.0f;  // also maps NaN to 0
+        v = v < 1.0f ? v : 1.0f;
+        dst[i] = static_cast<uint8_t>(static_cast<int>(v * 255.0f + 0.5f));
+    }
+}
+
+inline uint8_t ClampConvolved(int32_t acc)
+{
+    acc >>= kConvolveBits;
+    return static_cast<uint8_t>(acc < 0 ? 0 : (acc > 255 ? 255 : acc));
+}
+
+void ConvolveHorizontalScalar(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                              const int32_t* starts, const int16_t* weights, size_t taps)
+{
+    constexpr int32_t kRound = 1 << (kConvolveBits - 1);
+    for (size_t x = 0; x < dstPixels; ++x, weights += taps, dst += 4) {
+        const uint8_t* s = src + static_cast<size_t>(starts[x]) * 4;
+        int32_t b = kRound, g = kRound, r = kRound, a = kRound;
+        for (size_t k = 0; k < taps; ++k, s += 4) {
+            int32_t w = weights[k];
+            b += w * s[0];
+            g += w * s[1];
+            r += w * s[2];
+            a += w * s[3];
+        }
+        dst[0] = ClampConvolved(b);
+        dst[1] = ClampConvolved(g);
+        dst[2] = ClampConvolved(r);
+        dst[3] = ClampConvolved(a);
+    }
+}
+
+void ConvolveVerticalScalar(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                            uint8_t* dst, size_t bytes)
+{
+    constexpr int32_t kRound = 1 << (kConvolveBits - 1);
+    for (size_t i = 0; i < bytes; ++i) {
+        int32_t acc = kRound;
+        for (size_t k = 0; k < taps; ++k) acc += weights[k] * rows[k][i];
+        dst[i] = ClampConvolved(acc);
+    }
+}
+
+} // namespace
+
+namespace Detail {
+
+const PixelKernels kScalarKernels = {
+    SwapRedBlueScalar,
+    PremultiplyScalar,
+    UnpremultiplyScalar,
+    Rgb24ToBgra32Scalar,
+    Bgr24ToBgra32Scalar,
+    Widen8To16Scalar,
+    Narrow16To8Scalar,
+    U8ToFloatScalar,
+    FloatToU8Scalar,
+    ConvolveHorizontalScalar,
+    ConvolveVerticalScalar,
+};
+
+} // namespace Detail
+
+// ---- Dispatch ----
+
+namespace {
+
+struct Dispatch {
+    Level level = Level::Scalar;
+    const Detail::PixelKernels* kernels = &Detail::kScalarKernels;
+};
+
+const Detail::PixelKernels* KernelsFor(Level level)
+{
+    switch (level) {
+    case Level::Scalar: return &Detail::kScalarKernels;
+#if defined(UIV_SIMD_X86)
+    case Level::SSE41:  return &Detail::kSse41Kernels;
+    case Level::AVX2:   return &Detail::kAvx2Kernels;
+    case Level::AVX512: return &Detail::kAvx512Kernels;
+#endif
+#if defined(UIV_SIMD_NEON)
+    case Level::NEON:   return &Detail::kNeonKernels;
+#endif
+    default:            return nullptr;
+    }
+}
+
+Dispatch& Current()
+{
+    // Detected once, on first use from any thread
+    static Dispatch dispatch = [] {
+        DetectFeatures();
+        Dispatch d;
+        for (Level l : {Level::AVX512, Level::AVX2, Level::SSE41, Level::NEON}) {
+            if (IsLevelSupported(l)) {
+                d.level = l;
+                d.kernels = KernelsFor(l);
+                break;
+            }
+        }
+        return d;
+    }();
+    return dispatch;
+}
+
+} // namespace
+
+bool IsLevelSupported(Level level)
+{
+    switch (level) {
+    case Level::Scalar: return true;
+#if defined(UIV_SIMD_X86)
+    case Level::SSE41:  return s_hasSSE41;
+    case Level::AVX2:   return s_hasAVX2;
+    case Level::AVX512: return s_hasAVX512;
+#endif
+#if defined(UIV_SIMD_NEON)
+    case Level::NEON:   return true;  // baseline on AArch64
+#endif
+    default:            return false;
+    }
+}
+
+const char* LevelName(Level level)
+{
+    switch (level) {
+    case Level::Scalar: return "scalar";
+    case Level::SSE41:  return "sse4.1";
+    case Level::AVX2:   return "avx2";
+    case Level::AVX512: return "avx512";
+    case Level::NEON:   return "neon";
+    }
+    return "?";
+}
+
+Level ActiveLevel()
+{
+    return Current().level;
+}
+
+bool SetLevel(Level level)
+{
+    Dispatch& d = Current();
+    if (!IsLevelSupported(level)) return false;
+    d.level = level;
+    d.kernels = KernelsFor(level);
+    return true;
+}
+
+void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Current().kernels->swapRedBlue(src, dst, pixels);
+}
+
+void PremultiplyAlpha(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Current().kernels->premultiply(src, dst, pixels);
+}
+
+void UnpremultiplyAlpha(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Current().kernels->unpremultiply(src, dst, pixels);
+}
+
+void Rgb24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Current().kernels->rgb24ToBgra32(src, dst, pixels);
+}
+
+void Bgr24ToBgra32(const uint8_t* src, uint8_t* dst, size_t pixels)
+{
+    Current().kernels->bgr24ToBgra32(src, dst, pixels);
+}
+
+void Widen8To16(const uint8_t* src, uint16_t* dst, size_t samples)
+{
+    Current().kernels->widen8To16(src, dst, samples);
+}
+
+void Narrow16To8(const uint16_t* src, uint8_t* dst, size_t samples)
+{
+    Current().kernels->narrow16To8(src, dst, samples);
+}
+
+void U8ToFloat(const uint8_t* src, float* dst, size_t samples)
+{
+    Current().kernels->u8ToFloat(src, dst, samples);
+}
+
+void FloatToU8(const float* src, uint8_t* dst, size_t samples)
+{
+    Current().kernels->floatToU8(src, dst, samples);
+}
+
+void ConvolveHorizontal(const uint8_t* src, uint8_t* dst, size_t dstPixels,
+                        const int32_t* starts, const int16_t* weights, size_t taps)
+{
+    Current().kernels->convolveHorizontal(src, dst, dstPixels, starts, weights, taps);
+}
+
+void ConvolveVertical(const uint8_t* const* rows, const int16_t* weights, size_t taps,
+                      uint8_t* dst, size_t bytes)
+{
+    Current().kernels->convolveVertical(rows, weights, taps, dst, bytes);
+}
+
 } // namespace Simd
 } // namespace Core
 } // namespace UltraImageViewer
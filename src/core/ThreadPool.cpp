@@ -1,12 +1,292 @@
 #include "core/ThreadPool.hpp"
+#include "core/Platform.hpp"
 #include <algorithm>
+#include <new>
 #include <string>
-#include <windows.h>
 
 namespace UltraImageViewer {
 namespace Core {
 
 thread_local int ThreadPool::tl_currentLane_ = -1;
+thread_local ThreadPool* ThreadPool::tl_pool_ = nullptr;
+thread_local uint32_t ThreadPool::tl_workerIndex_ = 0;
+
+namespace {
+
+// Map lane index to OS thread priority for "unfair scheduling":
+//   High (0)   → AboveNormal  (visible thumbnails)
+//   Normal (1) → Normal       (default)
+//   Low (2)    → BelowNormal  (prefetch)
+constexpr Platform::ThreadPriority kLanePriority[] = {
+    Platform::ThreadPriority::AboveNormal,
+    Platform::ThreadPriority::Normal,
+    Platform::ThreadPriority::BelowNormal,
+};
+
+// Priority the calling worker last switched to; changed only between lanes
+thread_local Platform::ThreadPriority t_osPriority = Platform::ThreadPriority::Normal;
+
+} // namespace
+
+/**
+ * Process-wide free list of nodes of one size, shared by every pool. There
+ * is one per node type (Task, TaskHandle::Control). Each thread
+ * keeps a small cache and trades whole batches with the shared list, so the
+ * mutex is taken once per kBatch allocations or frees rather than per task
+ * (the render thread allocates, workers free). Nodes are carved from 64 KB
+ * chunks that are never returned to the heap.
+ */
+template <size_t Bytes, size_t Align>
+class ThreadPool::NodeSlab {
+public:
+    // Never destroyed: a thread may free nodes during static destruction
+    static NodeSlab& Instance()
+    {
+        static NodeSlab* slab = new NodeSlab;
+        return *slab;
+    }
+
+    void* Allocate()
+    {
+        Cache& cache = LocalCache();
+        if (!cache.head) Refill(cache);
+        Node* node = cache.head;
+        cache.head = node->next;
+        --cache.count;
+        return node;
+    }
+
+    void Free(void* p)
+    {
+        Cache& cache = LocalCache();
+        Node* node = static_cast<Node*>(p);
+        node->next = cache.head;
+        cache.head = node;
+        if (++cache.count >= 2 * kBatch) Spill(cache, kBatch);
+    }
+
+private:
+    static constexpr size_t kBatch = 64;
+    static constexpr size_t kChunkNodes = 1024;
+
+    union Node {
+        Node* next;
+        alignas(Align) unsigned char bytes[Bytes];
+    };
+
+    struct Cache {
+        Node* head = nullptr;
+        size_t count = 0;
+        ~Cache() { if (count) Instance().Spill(*this, count); }
+    };
+
+    static Cache& LocalCache()
+    {
+        thread_local Cache cache;
+        return cache;
+    }
+
+    void Refill(Cache& cache)
+    {
+        std::lock_guard lock(mutex_);
+        if (!batches_.empty()) {
+            cache.head = batches_.back().first;
+            cache.count = batches_.back().second;
+            batches_.pop_back();
+            return;
+        }
+        if (chunkNext_ == chunkEnd_) {
+            chunkNext_ = static_cast<Node*>(::operator new(kChunkNodes * sizeof(Node),
+                                                           std::align_val_t{alignof(Node)}));
+            chunkEnd_ = chunkNext_ + kChunkNodes;
+        }
+        size_t n = std::min(kBatch, static_cast<size_t>(chunkEnd_ - chunkNext_));
+        for (size_t i = 0; i < n; ++i) {
+            chunkNext_[i].next = (i + 1 < n) ? &chunkNext_[i + 1] : nullptr;
+        }
+        cache.head = chunkNext_;
+        cache.count = n;
+        chunkNext_ += n;
+    }
+
+    // Hand the first `count` cached nodes to the shared list
+    void Spill(Cache& cache, size_t count)
+    {
+        Node* head = cache.head;
+        Node* tail = head;
+        for (size_t i = 1; i < count; ++i) tail = tail->next;
+        cache.head = tail->next;
+        cache.count -= count;
+        tail->next = nullptr;
+
+        std::lock_guard lock(mutex_);
+        batches_.emplace_back(head, count);
+    }
+
+    std::mutex mutex_;
+    std::vector<std::pair<Node*, size_t>> batches_;
+    Node* chunkNext_ = nullptr;
+    Node* chunkEnd_ = nullptr;
+};
+
+// Shared state of a SubmitHandle task. `state` packs a version, bumped
+// each time the task is re-queued, with the status; a queued node runs the
+// task only if its version is still current and the task still queued.
+struct TaskHandle::Control {
+    static constexpr uint32_t kQueued = 0;
+    static constexpr uint32_t kRunning = 1;
+    static constexpr uint32_t kDone = 2;
+    static constexpr uint32_t kCancelled = 3;
+
+    static uint32_t Status(uint32_t state) { return state & 3; }
+    static uint32_t Make(uint32_t version, uint32_t status) { return (version << 2) | status; }
+
+    // Queued(version) -> `status`; false if the task moved on
+    bool Leave(uint32_t version, uint32_t status)
+    {
+        uint32_t expected = Make(version, kQueued);
+        return state.compare_exchange_strong(expected, Make(version, status),
+                                             std::memory_order_acq_rel);
+    }
+
+    TaskFunction fn;
+    ThreadPool* pool = nullptr;
+    std::atomic<uint32_t> state{0};
+    std::atomic<uint32_t> refs{1};
+    std::atomic<TaskPriority> priority{TaskPriority::Normal};
+};
+
+// What a handle task's node holds: the handle and the version it was queued
+// as. Dropped unrun (purge, pool shutdown), it cancels the task.
+struct TaskHandle::QueuedRun {
+    TaskHandle handle;
+    uint32_t version;
+
+    QueuedRun(TaskHandle h, uint32_t v) : handle(std::move(h)), version(v) {}
+    QueuedRun(QueuedRun&&) noexcept = default;
+
+    ~QueuedRun()
+    {
+        if (handle && handle.control_->Leave(version, Control::kCancelled)) {
+            handle.control_->fn = nullptr;
+        }
+    }
+
+    void operator()()
+    {
+        Control* c = handle.control_;
+        if (!c->Leave(version, Control::kRunning)) {
+            handle.Reset();  // re-queued elsewhere or cancelled
+            return;
+        }
+        try {
+            c->fn();
+        } catch (...) {
+            c->fn = nullptr;
+            c->state.store(Control::Make(version, Control::kDone), std::memory_order_release);
+            handle.Reset();
+            throw;
+        }
+        c->fn = nullptr;
+        c->state.store(Control::Make(version, Control::kDone), std::memory_order_release);
+        handle.Reset();
+    }
+};
+
+ThreadPool::Task* ThreadPool::NewTask(TaskFunction&& fn)
+{
+    return ::new (NodeSlab<sizeof(Task), alignof(Task)>::Instance().Allocate()) Task{std::move(fn)};
+}
+
+void ThreadPool::DeleteTask(Task* task)
+{
+    task->~Task();
+    NodeSlab<sizeof(Task), alignof(Task)>::Instance().Free(task);
+}
+
+TaskHandle::Control* ThreadPool::NewControl()
+{
+    using Control = TaskHandle::Control;
+    return ::new (NodeSlab<sizeof(Control), alignof(Control)>::Instance().Allocate()) Control;
+}
+
+void ThreadPool::DeleteControl(TaskHandle::Control* control)
+{
+    using Control = TaskHandle::Control;
+    control->~Control();
+    NodeSlab<sizeof(Control), alignof(Control)>::Instance().Free(control);
+}
+
+TaskHandle::TaskHandle(const TaskHandle& other) noexcept : control_(other.control_)
+{
+    if (control_) control_->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+TaskHandle& TaskHandle::operator=(TaskHandle other) noexcept
+{
+    std::swap(control_, other.control_);
+    return *this;
+}
+
+void TaskHandle::Reset() noexcept
+{
+    if (control_ && control_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ThreadPool::DeleteControl(control_);
+    }
+    control_ = nullptr;
+}
+
+bool TaskHandle::Pending() const
+{
+    return control_ &&
+           Control::Status(control_->state.load(std::memory_order_acquire)) == Control::kQueued;
+}
+
+bool TaskHandle::Cancel()
+{
+    if (!control_) return false;
+    uint32_t state = control_->state.load(std::memory_order_acquire);
+    while (Control::Status(state) == Control::kQueued) {
+        if (control_->state.compare_exchange_weak(state, state | Control::kCancelled,
+                                                  std::memory_order_acq_rel)) {
+            control_->fn = nullptr;  // no node will touch it now
+            return true;
+        }
+    }
+    return Control::Status(state) == Control::kCancelled;
+}
+
+bool TaskHandle::SetPriority(TaskPriority p, bool front)
+{
+    if (!control_) return false;
+    uint32_t state = control_->state.load(std::memory_order_acquire);
+    uint32_t next = 0;
+    do {
+        if (Control::Status(state) != Control::kQueued) return false;
+        next = Control::Make((state >> 2) + 1, Control::kQueued);
+    } while (!control_->state.compare_exchange_weak(state, next, std::memory_order_acq_rel));
+
+    // The node left behind fails its version check and does nothing
+    control_->priority.store(p, std::memory_order_relaxed);
+    control_->pool->Enqueue(ThreadPool::NewTask(QueuedRun(*this, next >> 2)), p, front);
+    return true;
+}
+
+TaskPriority TaskHandle::Priority() const
+{
+    return control_ ? control_->priority.load(std::memory_order_relaxed) : TaskPriority::Normal;
+}
+
+TaskHandle ThreadPool::SubmitHandle(TaskFunction fn, TaskPriority p, bool front)
+{
+    TaskHandle handle(NewControl());
+    TaskHandle::Control* c = handle.control_;
+    c->fn = std::move(fn);
+    c->pool = this;
+    c->priority.store(p, std::memory_order_relaxed);
+    Enqueue(NewTask(TaskHandle::QueuedRun(handle, 0)), p, front);
+    return handle;
+}
 
 ThreadPool::ThreadPool(uint32_t numThreads)
 {
@@ -17,19 +297,26 @@ ThreadPool::ThreadPool(uint32_t numThreads)
     }
     threadCount_ = numThreads;
 
+    workers_.reserve(numThreads);
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->stealSeed = i * 0x9E3779B9u + 1;
+    }
+
     threads_.reserve(numThreads);
     for (uint32_t i = 0; i < numThreads; ++i) {
         threads_.emplace_back([this, i](std::stop_token) { WorkerFunc(i); });
     }
 
-    OutputDebugStringA(("[ThreadPool] Started with " +
-        std::to_string(numThreads) + " workers\n").c_str());
+    Platform::DebugOutput(("[ThreadPool] Started with " +
+        std::to_string(numThreads) + " workers\n"));
 }
 
 ThreadPool::~ThreadPool()
 {
-    shutdown_.store(true, std::memory_order_release);
-    cv_.notify_all();
+    shutdown_.store(true, std::memory_order_seq_cst);
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    epoch_.notify_all();
 
     for (auto& t : threads_) {
         if (t.joinable()) {
@@ -39,179 +326,293 @@ ThreadPool::~ThreadPool()
     }
     threads_.clear();
 
-    OutputDebugStringA(("[ThreadPool] Shutdown. Completed " +
-        std::to_string(completed_.load()) + " tasks total\n").c_str());
+    // Tasks never run; the workers are gone, so any thread may drain
+    for (auto& q : injection_) {
+        while (q.tasks.Size() > 0) DeleteTask(q.tasks.PopFront());
+    }
+    for (auto& w : workers_) {
+        for (auto& deque : w->lanes) {
+            bool lost = false;
+            while (Task* task = deque.Steal(lost)) DeleteTask(task);
+        }
+    }
+
+    Platform::DebugOutput(("[ThreadPool] Shutdown. Completed " +
+        std::to_string(completed_.load()) + " tasks total\n"));
 }
 
-void ThreadPool::Submit(std::function<void()> fn, TaskPriority p)
+void ThreadPool::Submit(TaskFunction fn, TaskPriority p)
 {
-    {
-        std::lock_guard lock(mutex_);
-        lanes_[static_cast<int>(p)].queue.push_back(std::move(fn));
-    }
-    pending_.fetch_add(1, std::memory_order_acq_rel);
-    cv_.notify_one();
+    Enqueue(NewTask(std::move(fn)), p, false);
 }
 
-void ThreadPool::SubmitFront(std::function<void()> fn, TaskPriority p)
+void ThreadPool::SubmitFront(TaskFunction fn, TaskPriority p)
 {
-    {
-        std::lock_guard lock(mutex_);
-        lanes_[static_cast<int>(p)].queue.push_front(std::move(fn));
-    }
+    Enqueue(NewTask(std::move(fn)), p, true);
+}
+
+void ThreadPool::Enqueue(Task* task, TaskPriority p, bool front)
+{
+    // Counted before it becomes visible, so a worker can't finish it first
     pending_.fetch_add(1, std::memory_order_acq_rel);
-    cv_.notify_one();
+    int lane = static_cast<int>(p);
+
+    if (!front && tl_pool_ == this) {
+        workers_[tl_workerIndex_]->lanes[lane].Push(task);
+    } else {
+        InjectionQueue& q = injection_[lane];
+        std::lock_guard lock(q.mutex);
+        if (front) {
+            q.tasks.PushFront(task);
+        } else {
+            q.tasks.PushBack(task);
+        }
+        q.size.store(static_cast<uint32_t>(q.tasks.Size()), std::memory_order_release);
+    }
+    Wake(1);
 }
 
-void ThreadPool::SubmitBatch(std::vector<std::function<void()>>& fns, TaskPriority p)
+void ThreadPool::SubmitBatch(std::vector<TaskFunction>& fns, TaskPriority p)
 {
     if (fns.empty()) return;
 
     uint32_t count = static_cast<uint32_t>(fns.size());
+    pending_.fetch_add(count, std::memory_order_acq_rel);
     {
-        std::lock_guard lock(mutex_);
-        auto& q = lanes_[static_cast<int>(p)].queue;
+        InjectionQueue& q = injection_[static_cast<int>(p)];
+        std::lock_guard lock(q.mutex);
         for (auto& fn : fns) {
-            q.push_back(std::move(fn));
+            q.tasks.PushBack(NewTask(std::move(fn)));
         }
+        q.size.store(static_cast<uint32_t>(q.tasks.Size()), std::memory_order_release);
     }
-    pending_.fetch_add(count, std::memory_order_acq_rel);
-    cv_.notify_all();
+    Wake(count);
 }
 
-void ThreadPool::PurgeAll()
+void ThreadPool::Wake(uint32_t count)
 {
-    std::lock_guard lock(mutex_);
-    uint32_t purged = 0;
-    for (int i = 0; i < kLaneCount; ++i) {
-        purged += static_cast<uint32_t>(lanes_[i].queue.size());
-        lanes_[i].queue.clear();
+    // Publish, then look for sleepers: a worker that registered before this
+    // load is woken, one that registers after it sees the new epoch (and the
+    // task) when it reads the epoch and rechecks the queues
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t sleeping = sleepers_.load(std::memory_order_seq_cst);
+    if (sleeping == 0) return;
+    if (count >= sleeping) {
+        epoch_.notify_all();
+    } else {
+        for (uint32_t i = 0; i < count; ++i) epoch_.notify_one();
     }
-    // Adjust pending count (saturating subtract)
-    uint32_t old = pending_.load(std::memory_order_acquire);
-    while (old > 0 && !pending_.compare_exchange_weak(old,
-           (old >= purged) ? old - purged : 0, std::memory_order_acq_rel)) {}
+}
 
-    // Wake WaitIdle() if all work is done
-    if (pending_.load(std::memory_order_acquire) == 0 &&
-        active_.load(std::memory_order_acquire) == 0) {
-        idleCV_.notify_all();
+void ThreadPool::PurgeAll()
+{
+    for (int i = 0; i < kLaneCount; ++i) {
+        PurgePriority(static_cast<TaskPriority>(i));
     }
 }
 
 void ThreadPool::PurgePriority(TaskPriority p)
 {
-    std::lock_guard lock(mutex_);
-    auto& q = lanes_[static_cast<int>(p)].queue;
-    uint32_t purged = static_cast<uint32_t>(q.size());
-    q.clear();
+    int lane = static_cast<int>(p);
+    std::vector<Task*> dropped;
+    {
+        InjectionQueue& q = injection_[lane];
+        std::lock_guard lock(q.mutex);
+        dropped.reserve(q.tasks.Size());
+        while (q.tasks.Size() > 0) dropped.push_back(q.tasks.PopFront());
+        q.size.store(0, std::memory_order_release);
+    }
+    // Steal everything left in the workers' deques for this lane; losing a
+    // race means the owner or a thief took that task to run it
+    for (auto& w : workers_) {
+        auto& deque = w->lanes[lane];
+        for (;;) {
+            bool lost = false;
+            Task* task = deque.Steal(lost);
+            if (task) {
+                dropped.push_back(task);
+            } else if (!lost) {
+                break;
+            }
+        }
+    }
+    for (Task* task : dropped) DeleteTask(task);
+    FinishPurge(static_cast<uint32_t>(dropped.size()));
+}
 
+void ThreadPool::FinishPurge(uint32_t purged)
+{
+    // Adjust pending count (saturating subtract)
     uint32_t old = pending_.load(std::memory_order_acquire);
     while (old > 0 && !pending_.compare_exchange_weak(old,
            (old >= purged) ? old - purged : 0, std::memory_order_acq_rel)) {}
 
+    // Wake WaitIdle() if all work is done
     if (pending_.load(std::memory_order_acquire) == 0 &&
         active_.load(std::memory_order_acquire) == 0) {
+        std::lock_guard lock(idleMutex_);
         idleCV_.notify_all();
     }
 }
 
 void ThreadPool::WaitIdle()
 {
-    std::unique_lock lock(mutex_);
+    std::unique_lock lock(idleMutex_);
     idleCV_.wait(lock, [this] {
         return pending_.load(std::memory_order_acquire) == 0 &&
                active_.load(std::memory_order_acquire) == 0;
     });
 }
 
-std::optional<ThreadPool::DequeuedTask> ThreadPool::TryDequeue()
+ThreadPool::Task* ThreadPool::TakeInjected(uint32_t self, int lane)
 {
-    std::lock_guard lock(mutex_);
-    for (int i = 0; i < kLaneCount; ++i) {
-        auto& q = lanes_[i].queue;
-        if (!q.empty()) {
-            DequeuedTask result;
-            result.fn = std::move(q.front());
-            result.lane = i;
-            q.pop_front();
-            return result;
+    InjectionQueue& q = injection_[lane];
+    if (q.size.load(std::memory_order_acquire) == 0) return nullptr;
+
+    Task* batch[kMaxBatch];
+    uint32_t n = 0;
+    {
+        std::lock_guard lock(q.mutex);
+        if (q.tasks.Size() == 0) return nullptr;
+        // High-lane tasks one at a time (SubmitFront order holds); otherwise
+        // a fair share, so one worker doesn't hoard a burst
+        uint32_t want = 1;
+        if (lane != static_cast<int>(TaskPriority::High)) {
+            uint32_t share = static_cast<uint32_t>((q.tasks.Size() + threadCount_ - 1) / threadCount_);
+            want = std::clamp(share, 1u, kMaxBatch);
         }
+        while (n < want && q.tasks.Size() > 0) batch[n++] = q.tasks.PopFront();
+        q.size.store(static_cast<uint32_t>(q.tasks.Size()), std::memory_order_release);
     }
-    return std::nullopt;
+
+    // Run the first now; push the rest newest-first so Take() returns them
+    // in submission order and thieves take the far end
+    auto& deque = workers_[self]->lanes[lane];
+    for (uint32_t i = n; i-- > 1;) deque.Push(batch[i]);
+    if (n > 1) Wake(n - 1);
+    return batch[0];
 }
 
-void ThreadPool::WorkerFunc(uint32_t /*index*/)
+ThreadPool::Task* ThreadPool::StealFrom(uint32_t self, int lane)
 {
-    // Map lane index to Windows thread priority for "unfair scheduling":
-    //   High (0)   → THREAD_PRIORITY_ABOVE_NORMAL  (visible thumbnails)
-    //   Normal (1) → THREAD_PRIORITY_NORMAL         (default)
-    //   Low (2)    → THREAD_PRIORITY_BELOW_NORMAL   (prefetch)
-    static constexpr int kLanePriority[] = {
-        THREAD_PRIORITY_ABOVE_NORMAL,
-        THREAD_PRIORITY_NORMAL,
-        THREAD_PRIORITY_BELOW_NORMAL,
-    };
+    const uint32_t count = static_cast<uint32_t>(workers_.size());
+    if (count < 2) return nullptr;
+
+    // Random first victim so thieves spread out
+    uint32_t& seed = workers_[self]->stealSeed;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    const uint32_t start = seed % count;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t victim = (start + i) % count;
+        if (victim == self) continue;
+        auto& deque = workers_[victim]->lanes[lane];
+        if (deque.Empty()) continue;  // skip the fence and CAS on idle victims
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            bool lost = false;
+            if (Task* task = deque.Steal(lost)) return task;
+            if (!lost) break;
+        }
+    }
+    return nullptr;
+}
 
-    auto executeTask = [this](DequeuedTask& task) {
-        pending_.fetch_sub(1, std::memory_order_acq_rel);
-        active_.fetch_add(1, std::memory_order_acq_rel);
+ThreadPool::Task* ThreadPool::FindTask(uint32_t self, int& lane)
+{
+    Worker& me = *workers_[self];
+    // Only thieves shrink our deque, so an Empty() hint here is never a
+    // false negative; it saves Take()'s fence on lanes we haven't used
+    auto takeOwn = [&me](int l) { return me.lanes[l].Empty() ? nullptr : me.lanes[l].Take(); };
+    for (int l = 0; l < kLaneCount; ++l) {
+        Task* task = nullptr;
+        if (l == static_cast<int>(TaskPriority::High)) {
+            task = TakeInjected(self, l);
+            if (!task) task = takeOwn(l);
+        } else {
+            task = takeOwn(l);
+            if (!task) task = TakeInjected(self, l);
+        }
+        if (!task) task = StealFrom(self, l);
+        if (task) {
+            lane = l;
+            return task;
+        }
+    }
+    return nullptr;
+}
 
-        // Set OS thread priority based on task lane (unfair scheduling)
-        int prio = kLanePriority[task.lane];
-        bool changed = (prio != THREAD_PRIORITY_NORMAL);
-        if (changed) SetThreadPriority(GetCurrentThread(), prio);
-        tl_currentLane_ = task.lane;
+bool ThreadPool::HasQueuedWork() const
+{
+    for (int l = 0; l < kLaneCount; ++l) {
+        if (injection_[l].size.load(std::memory_order_acquire) != 0) return true;
+        for (const auto& w : workers_) {
+            if (!w->lanes[l].Empty()) return true;
+        }
+    }
+    return false;
+}
 
-        try { task.fn(); } catch (...) { /* swallow — worker must not die */ }
+void ThreadPool::Execute(Task* task, int lane)
+{
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    active_.fetch_add(1, std::memory_order_acq_rel);
+
+    // Set OS thread priority based on task lane (unfair scheduling)
+    auto prio = kLanePriority[lane];
+    if (prio != t_osPriority) {
+        Platform::SetCurrentThreadPriority(prio);
+        t_osPriority = prio;
+    }
+    tl_currentLane_ = lane;
 
-        tl_currentLane_ = -1;
-        if (changed) SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+    try { task->fn(); } catch (...) { /* swallow — worker must not die */ }
+    DeleteTask(task);
 
-        active_.fetch_sub(1, std::memory_order_acq_rel);
-        completed_.fetch_add(1, std::memory_order_relaxed);
+    tl_currentLane_ = -1;
 
-        if (pending_.load(std::memory_order_acquire) == 0 &&
-            active_.load(std::memory_order_acquire) == 0) {
-            idleCV_.notify_all();
-        }
-    };
+    active_.fetch_sub(1, std::memory_order_acq_rel);
+    completed_.fetch_add(1, std::memory_order_relaxed);
 
-    while (!shutdown_.load(std::memory_order_acquire)) {
+    if (pending_.load(std::memory_order_acquire) == 0 &&
+        active_.load(std::memory_order_acquire) == 0) {
+        std::lock_guard lock(idleMutex_);
+        idleCV_.notify_all();
+    }
+}
 
-        // Phase 1: Spin — try to grab a task with no syscall
-        for (int spin = 0; spin < kSpinCount; ++spin) {
-            auto task = TryDequeue();
-            if (task) {
-                executeTask(*task);
-                goto next_cycle;
-            }
-        }
+void ThreadPool::WorkerFunc(uint32_t index)
+{
+    tl_pool_ = this;
+    tl_workerIndex_ = index;
 
-        // Phase 2: Yield — pause the CPU pipeline briefly
-        for (int y = 0; y < kYieldCount; ++y) {
-            _mm_pause();
-            auto task = TryDequeue();
-            if (task) {
-                executeTask(*task);
-                goto next_cycle;
-            }
+    while (!shutdown_.load(std::memory_order_acquire)) {
+        int lane = 0;
+        if (Task* task = FindTask(index, lane)) {
+            Execute(task, lane);
+            continue;
         }
 
-        // Phase 3: Sleep — wait on condition variable (syscall)
-        {
-            std::unique_lock lock(mutex_);
-            cv_.wait(lock, [this] {
-                for (int i = 0; i < kLaneCount; ++i) {
-                    if (!lanes_[i].queue.empty()) return true;
-                }
-                return shutdown_.load(std::memory_order_relaxed);
-            });
+        // Spin briefly on lock-free emptiness hints (no mutex, no steals)
+        bool found = false;
+        for (int spin = 0; spin < kSpinCount && !found; ++spin) {
+            Platform::CpuRelax();
+            found = HasQueuedWork();
         }
-        continue;
-
-    next_cycle:;
+        if (found) continue;
+
+        // Park: register, read the epoch, then recheck. A submit after the
+        // recheck bumps the epoch, so wait() returns at once or is notified.
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t key = epoch_.load(std::memory_order_seq_cst);
+        if (!HasQueuedWork() && !shutdown_.load(std::memory_order_seq_cst)) {
+            epoch_.wait(key, std::memory_order_seq_cst);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
     }
+
+    tl_pool_ = nullptr;
 }
 
 } // namespace Core
@@ -0,0 +1,1112 @@
+#include "core/ThumbnailPipeline.hpp"
+#include "core/EpochReclaimer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace UltraImageViewer {
+namespace Core {
+
+ThumbnailPipeline::ThumbnailPipeline(PathInterner* interner, PixelSource* source,
+                                     TextureSink* sink, ThreadPool* pool,
+                                     const Config& config)
+    : interner_(interner)
+    , source_(source)
+    , sink_(sink)
+    , pool_(pool)
+    , config_(config)
+    , pixelPool_(PixelPool::Create())
+{
+    if (!config_.tier2Compressor) {
+        config_.tier2Compressor = CreatePixelCompressor(DefaultPixelCompressorKind());
+    }
+}
+
+ThumbnailPipeline::~ThumbnailPipeline()
+{
+    Clear();
+}
+
+void ThumbnailPipeline::Clear()
+{
+    ClosePersistentMapping();
+
+    {
+        std::lock_guard lock(thumbSaveMutex_);
+        thumbSaveBuffer_.clear();
+        persistForgotten_.clear();
+    }
+    {
+        std::lock_guard lock(readyMutex_);
+        readyQueue_.clear();
+    }
+    {
+        std::lock_guard lock(tier2Mutex_);
+        tier2Cache_.clear();
+        tier2Order_.clear();
+        tier2Bytes_ = 0;
+        demoteQueue_.clear();
+        demotePending_ = 0;
+        demotePendingBytes_ = 0;
+        demoteScheduled_ = false;  // the pool is drained: no task is left to clear it
+    }
+    {
+        std::lock_guard lock(decodeMutex_);
+        decodeQueue_.clear();
+        urgentPumps_ = 0;  // likewise
+        pumps_ = 0;
+    }
+
+    slots_.ForEach(interner_->Size(), [this](ImageId id, ImageSlot& slot) {
+        RemoveThumbnail(id);
+        slot.pending.store(false, std::memory_order_relaxed);
+        slot.decode.Reset();
+        slot.requestFrame = 0;
+        slot.requestKey = kUnkeyed;
+        slot.visibleFrame = 0;
+        slot.clockIndex = kNotInClock;
+    });
+    thumbnailCacheBytes_ = 0;
+    prefetches_.clear();
+    clockRing_.clear();
+    clockHand_ = 0;
+
+    // Release retired textures now rather than on some later write
+    EpochReclaimer::Instance().Synchronize();
+}
+
+void ThumbnailPipeline::InsertThumbnail(ImageId id, TextureHandle texture, PixelHandle pixels,
+                                        uint32_t width, uint32_t height)
+{
+    auto* entry = new ThumbnailCacheEntry;
+    entry->texture = std::move(texture);
+    entry->pixels = std::move(pixels);
+    entry->width = width;
+    entry->height = height;
+    // Prefetched cells are uploaded before anything looks them up; without
+    // the bit a sweep would evict them before they scroll into view
+    entry->referenced.store(true, std::memory_order_relaxed);
+
+    RemoveThumbnail(id);  // replacing: release the old texture's bytes first
+    ImageSlot& slot = slots_[id];
+    slot.gpu.store(entry, std::memory_order_release);
+    slot.clockIndex = static_cast<uint32_t>(clockRing_.size());
+    clockRing_.push_back(id);
+    thumbnailCount_.fetch_add(1, std::memory_order_relaxed);
+    thumbnailCacheBytes_ += static_cast<size_t>(width) * height * 4;
+    if (entry->pixels) tier1PixelBytes_ += static_cast<size_t>(width) * height * 4;
+}
+
+size_t ThumbnailPipeline::RemoveThumbnail(ImageId id)
+{
+    ImageSlot* slot = slots_.Find(id);
+    if (!slot) return 0;
+    ThumbnailCacheEntry* old = slot->gpu.exchange(nullptr, std::memory_order_acq_rel);
+    if (!old) return 0;
+
+    // Swap-remove from the CLOCK ring; the moved id takes over our position,
+    // so a hand parked here examines it next
+    uint32_t pos = slot->clockIndex;
+    if (pos != kNotInClock && pos < clockRing_.size()) {
+        ImageId last = clockRing_.back();
+        clockRing_[pos] = last;
+        slots_[last].clockIndex = pos;
+        clockRing_.pop_back();
+    }
+    slot->clockIndex = kNotInClock;
+
+    size_t bytes = static_cast<size_t>(old->width) * old->height * 4;
+    thumbnailCount_.fetch_sub(1, std::memory_order_relaxed);
+    thumbnailCacheBytes_ -= std::min(bytes, thumbnailCacheBytes_.load(std::memory_order_relaxed));
+    if (old->pixels) tier1PixelBytes_ -= std::min(bytes, tier1PixelBytes_);
+
+    // Readers may still hold the entry; free it once they have left their guard
+    EpochReclaimer::Instance().Retire(old, [](void* p) {
+        delete static_cast<ThumbnailCacheEntry*>(p);
+    });
+    return bytes;
+}
+
+TextureHandle ThumbnailPipeline::LookupThumbnail(ImageId id) const
+{
+    EpochReclaimer::Guard guard;
+    const ImageSlot* slot = slots_.Find(id);
+    if (!slot) return nullptr;
+    const ThumbnailCacheEntry* entry = slot->gpu.load(std::memory_order_acquire);
+    if (!entry) return nullptr;
+    // Plain load first: avoid dirtying the cache line when already set
+    if (!entry->referenced.load(std::memory_order_relaxed)) {
+        entry->referenced.store(true, std::memory_order_relaxed);
+    }
+    return entry->texture;
+}
+
+void ThumbnailPipeline::ClearPending(ImageId id)
+{
+    // At most one decode per id is outstanding, so the marker is ours
+    slots_[id].pending.store(false, std::memory_order_release);
+}
+
+TextureHandle ThumbnailPipeline::GetThumbnailSync(ImageId id, uint32_t maxSize)
+{
+    if (id >= interner_->Size()) return nullptr;
+    if (auto texture = LookupThumbnail(id)) {
+        return texture;
+    }
+
+    if (!source_ || !sink_) return nullptr;
+
+    PixelBuffer buf;
+    decodeCount_.fetch_add(1, std::memory_order_relaxed);
+    if (!source_->DecodeThumbnail(interner_->Path(id), maxSize, buf) || !buf.pixels) return nullptr;
+
+    PixelHandle pixels = pixelPool_->Adopt(std::move(buf.pixels), static_cast<size_t>(buf.width) * buf.height * 4);
+    auto texture = sink_->CreateTexture(buf.width, buf.height, pixels.get());
+    if (texture) {
+        uploadCount_.fetch_add(1, std::memory_order_relaxed);
+        InsertThumbnail(id, texture, std::move(pixels), buf.width, buf.height);
+    }
+    return texture;
+}
+
+void ThumbnailPipeline::PrefetchAround(const std::vector<ImageId>& allIds,
+                                       size_t currentIndex, size_t radius)
+{
+    if (allIds.empty() || !pool_) return;
+
+    for (size_t offset = 1; offset <= radius; ++offset) {
+        // Forward
+        if (currentIndex + offset < allIds.size()) {
+            ImageId id = allIds[currentIndex + offset];
+            if (id < interner_->Size() && !HasThumbnail(id)) QueueDecode(id, 256, true);
+        }
+        // Backward
+        if (currentIndex >= offset) {
+            ImageId id = allIds[currentIndex - offset];
+            if (id < interner_->Size() && !HasThumbnail(id)) QueueDecode(id, 256, true);
+        }
+    }
+}
+
+TextureHandle ThumbnailPipeline::UploadFromPersistent(ImageId id)
+{
+    if (persistSyncBudget_ <= 0 || !sink_) return nullptr;
+
+    // Visible misses are re-requested every frame; skip the path hash and
+    // index search until the store changes
+    ImageSlot& slot = slots_[id];
+    const uint64_t persistGen = persistGeneration_.load(std::memory_order_acquire);
+    if (slot.persistMiss == persistGen) return nullptr;
+    if (slot.persistStale.load(std::memory_order_acquire)) return nullptr;
+
+    // A queued decode reads Tier 3 itself
+    if (slot.pending.load(std::memory_order_acquire)) return nullptr;
+
+    // The view points into the mapping, so copy the pixels out (Tier 1 keeps
+    // them for demotion) before releasing the lock
+    ThumbnailStore::View view;
+    PixelHandle pixels;
+    {
+        std::shared_lock plock(persistMutex_);
+        if (!persistStore_.Find(interner_->Path(id), view) || view.width == 0 || view.height == 0) {
+            slot.persistMiss = persistGen;
+            return nullptr;
+        }
+        if (view.codec == PixelCodec::Raw) {
+            persistStore_.WillNeed(view);
+            pixels = pixelPool_->Acquire(view.bytes);
+            memcpy(pixels.get(), view.data, view.bytes);
+        }
+    }
+    if (view.codec != PixelCodec::Raw) {
+        QueueDecode(id, std::max(view.width, view.height));
+        return nullptr;
+    }
+
+    TextureHandle texture = sink_->CreateTexture(view.width, view.height, pixels.get());
+    if (!texture) return nullptr;
+
+    --persistSyncBudget_;
+    uploadCount_.fetch_add(1, std::memory_order_relaxed);
+    InsertThumbnail(id, texture, std::move(pixels), view.width, view.height);
+    return texture;
+}
+
+TextureHandle ThumbnailPipeline::GetCachedThumbnail(ImageId id)
+{
+    if (id >= interner_->Size()) return nullptr;
+
+    // Check GPU cache first
+    if (auto texture = LookupThumbnail(id)) {
+        return texture;
+    }
+
+    // Fall through to persistent disk cache (even during fast scroll)
+    return UploadFromPersistent(id);
+}
+
+bool ThumbnailPipeline::HasThumbnail(ImageId id) const
+{
+    EpochReclaimer::Guard guard;
+    const ImageSlot* slot = slots_.Find(id);
+    return slot && slot->gpu.load(std::memory_order_acquire) != nullptr;
+}
+
+TextureHandle ThumbnailPipeline::RequestThumbnail(ImageId id, uint32_t targetSize)
+{
+    if (id >= interner_->Size()) return nullptr;
+    slots_[id].requestKey = kUnkeyed;
+    return Request(id, targetSize);
+}
+
+TextureHandle ThumbnailPipeline::RequestThumbnail(ImageId id, uint32_t targetSize,
+                                                  float cellTop, float cellBottom)
+{
+    if (id >= interner_->Size()) return nullptr;
+    float key = DistanceKey(cellTop, cellBottom);
+    if (hasLanding_) key = std::min(key, LandingKey(cellTop, cellBottom));
+    slots_[id].requestKey = key;
+    return Request(id, targetSize);
+}
+
+TextureHandle ThumbnailPipeline::Request(ImageId id, uint32_t targetSize)
+{
+    // Lock-free Tier 1 lookup
+    if (auto texture = LookupThumbnail(id)) {
+        return texture;
+    }
+
+    // Synchronous path: create texture directly from persistent cache
+    // on the render thread. Zero-frame latency — identical to iOS behavior.
+    if (auto texture = UploadFromPersistent(id)) {
+        return texture;
+    }
+
+    QueueDecode(id, targetSize);
+    return nullptr;  // Not ready yet
+}
+
+void ThumbnailPipeline::QueueDecode(ImageId id, uint32_t targetSize, bool prefetch)
+{
+    if (!pool_) return;
+
+    // Every frame's request keeps a queued decode alive (see RerankRequests)
+    ImageSlot& slot = slots_[id];
+    if (!prefetch) slot.requestFrame = visibleFrame_;
+    if (slot.pending.load(std::memory_order_acquire)) {
+        return;  // queued, decoding or waiting for upload
+    }
+    slot.pending.store(true, std::memory_order_release);
+
+    if (prefetch) {
+        slot.requestFrame = 0;
+        slot.decode = pool_->SubmitHandle([this, id, targetSize] {
+            ThumbnailDecodeTask(id, targetSize);
+        }, TaskPriority::Low);
+        prefetches_.push_back(id);
+        return;
+    }
+
+    // Unkeyed requests fall back to last frame's on-screen stamp
+    float key = slot.requestKey;
+    if (key == kUnkeyed && slot.visibleFrame == visibleFrame_) key = 0.0f;
+
+    std::lock_guard lock(decodeMutex_);
+    decodeQueue_.push_back({key, decodeSequence_++, id, targetSize});
+    std::push_heap(decodeQueue_.begin(), decodeQueue_.end(), QueuedDecode::Later);
+    SchedulePump(key <= 0.0f);
+}
+
+float ThumbnailPipeline::DistanceKey(float cellTop, float cellBottom) const
+{
+    // Measured from where the viewport will be when a decode queued now has
+    // been uploaded
+    const float shift = scrollVelocity_ * config_.requestLeadSeconds;
+    const float viewTop = shift;
+    const float viewBottom = viewportHeight_ + shift;
+
+    float gap;
+    bool below;
+    if (cellBottom < viewTop) {
+        gap = viewTop - cellBottom;
+        below = false;
+    } else if (cellTop > viewBottom) {
+        gap = cellTop - viewBottom;
+        below = true;
+    } else {
+        // On screen: at or below 0, those that will stay in view longest
+        // (the scroll's leading edge) first
+        if (scrollVelocity_ > 0.0f) return viewTop - cellBottom;
+        if (scrollVelocity_ < 0.0f) return cellTop - viewBottom;
+        return 0.0f;
+    }
+
+    // Cells the scroll is heading for are needed sooner than their distance
+    // says, the ones it is leaving later
+    float bias = 1.0f + std::abs(scrollVelocity_) / config_.scrollBiasVelocity;
+    bool ahead = (scrollVelocity_ > 0.0f) == below;
+    return ahead ? gap / bias : gap * bias;
+}
+
+float ThumbnailPipeline::LandingKey(float cellTop, float cellBottom) const
+{
+    // At or below 0 inside the landing viewport, most negative at its
+    // centre: the whole screen will be visible at once when the fling stops
+    const float half = viewportHeight_ * 0.5f;
+    return std::abs((cellTop + cellBottom) * 0.5f - (landingOffset_ + half)) - half;
+}
+
+void ThumbnailPipeline::SchedulePump(bool urgent)
+{
+    // Pumps don't own an entry, they take the closest one when they start.
+    // One per worker and lane keeps every worker busy without flooding the
+    // lanes; a finishing pump queues its successor.
+    const uint32_t limit = pool_->ThreadCount();
+    if (urgent) {
+        if (urgentPumps_ >= limit) return;
+        ++urgentPumps_;
+        pool_->SubmitFront([this] { DecodePumpTask(true); }, TaskPriority::High);
+    } else {
+        if (pumps_ >= limit || urgentPumps_ + pumps_ >= decodeQueue_.size()) return;
+        ++pumps_;
+        pool_->Submit([this] { DecodePumpTask(false); }, TaskPriority::Normal);
+    }
+}
+
+void ThumbnailPipeline::DecodePumpTask(bool urgent)
+{
+    QueuedDecode next;
+    {
+        std::lock_guard lock(decodeMutex_);
+        --(urgent ? urgentPumps_ : pumps_);
+        if (decodeQueue_.empty()) return;
+        std::pop_heap(decodeQueue_.begin(), decodeQueue_.end(), QueuedDecode::Later);
+        next = decodeQueue_.back();
+        decodeQueue_.pop_back();
+    }
+
+    ThumbnailDecodeTask(next.id, next.targetSize);
+
+    std::lock_guard lock(decodeMutex_);
+    if (!decodeQueue_.empty()) SchedulePump(decodeQueue_.front().key <= 0.0f);
+}
+
+int ThumbnailPipeline::FlushReadyThumbnails(int maxCount)
+{
+    // Reset per-frame budget for synchronous persistent cache loads
+    persistSyncBudget_ = config_.persistSyncBudgetPerFrame;
+
+    std::vector<ReadyThumbnail> batch;
+    {
+        std::lock_guard lock(readyMutex_);
+        int count = std::min(maxCount, static_cast<int>(readyQueue_.size()));
+        if (count == 0) return 0;
+
+        batch.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            batch.push_back(std::move(readyQueue_.front()));
+            readyQueue_.pop_front();  // O(1) deque pop vs O(n) vector erase
+        }
+    }
+
+    int created = 0;
+    for (auto& ready : batch) {
+        ClearPending(ready.id);  // uploaded below, or dropped and free to be re-requested
+        if (!sink_ || !ready.pixels || ready.width == 0 || ready.height == 0) continue;
+
+        // Create texture (copies pixels to GPU internally)
+        auto texture = sink_->CreateTexture(ready.width, ready.height, ready.pixels.get());
+        if (texture) {
+            uploadCount_.fetch_add(1, std::memory_order_relaxed);
+
+            // Save raw pixels for persistent cache; the buffer is shared
+            // with the Tier 1 entry, not copied
+            if (config_.collectSaveBuffer) {
+                std::lock_guard lock(thumbSaveMutex_);
+                if (!thumbSaveBuffer_.contains(ready.id)) {
+                    ThumbSaveEntry save;
+                    save.width = static_cast<uint16_t>(ready.width);
+                    save.height = static_cast<uint16_t>(ready.height);
+                    save.pixelSize = ready.width * ready.height * 4;
+                    save.pixels = ready.pixels;
+                    thumbSaveBuffer_[ready.id] = std::move(save);
+                }
+            }
+
+            InsertThumbnail(ready.id, std::move(texture), std::move(ready.pixels), ready.width, ready.height);
+            ++created;
+        }
+    }
+
+    // Evict if over budget
+    if (created > 0) {
+        EvictThumbnailsIfNeeded();
+    }
+
+    return created;
+}
+
+void ThumbnailPipeline::InvalidateRequests()
+{
+    // Only the cancelled decodes are lost; the demotion task and anything
+    // else in the pool's lanes stay queued
+    RerankRequests(false, config_.rerankRequests);
+}
+
+void ThumbnailPipeline::SetViewport(float height, float scrollVelocity)
+{
+    viewportHeight_ = height;
+    scrollVelocity_ = scrollVelocity;
+    hasLanding_ = false;
+}
+
+void ThumbnailPipeline::SetViewport(float height, float scrollVelocity, float landingOffset)
+{
+    viewportHeight_ = height;
+    scrollVelocity_ = scrollVelocity;
+    landingOffset_ = landingOffset;
+    hasLanding_ = true;
+}
+
+void ThumbnailPipeline::SetVisibleRange(const std::vector<ImageId>& ids)
+{
+    // Stamp instead of rebuilding a set: anything not stamped this frame is
+    // implicitly off screen
+    ++visibleFrame_;
+    size_t limit = interner_->Size();
+    for (ImageId id : ids) {
+        if (id < limit) slots_[id].visibleFrame = visibleFrame_;
+    }
+
+    if (config_.rerankRequests) RerankRequests(true, true);
+}
+
+void ThumbnailPipeline::RerankRequests(bool keepNearby, bool keepVisible)
+{
+    // Requests from this frame carry visibleFrame_ - 1 (SetVisibleRange has
+    // bumped it since); one more frame of grace covers views that skip a
+    // frame's requests
+    const uint64_t recent = visibleFrame_ >= 2 ? visibleFrame_ - 2 : 0;
+
+    // Gallery requests: one pass over the queue, then a single make_heap
+    bool urgent = false;
+    {
+        std::lock_guard lock(decodeMutex_);
+        size_t kept = 0;
+        for (size_t i = 0; i < decodeQueue_.size(); ++i) {
+            QueuedDecode entry = decodeQueue_[i];
+            const ImageSlot& slot = slots_[entry.id];
+            float key;
+            if (keepVisible && slot.visibleFrame == visibleFrame_) {
+                // Keyed cells stay where their geometry puts them
+                key = slot.requestKey != kUnkeyed ? slot.requestKey : 0.0f;
+            } else if (keepNearby && slot.requestFrame >= recent) {
+                key = slot.requestKey;
+            } else {
+                ClearPending(entry.id);  // queued entries are ours alone
+                cancelCount_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (key <= 0.0f) {
+                if (entry.key > 0.0f) entry.sequence = decodeSequence_++;  // just came on screen
+                urgent = true;
+            }
+            entry.key = key;
+            decodeQueue_[kept++] = entry;
+        }
+        decodeQueue_.resize(kept);
+        std::make_heap(decodeQueue_.begin(), decodeQueue_.end(), QueuedDecode::Later);
+
+        // Cells that came on screen while queued behind Normal pumps
+        if (urgent && urgentPumps_ == 0) SchedulePump(true);
+    }
+
+    // Prefetch tasks stay in Low unless they come on screen
+    size_t kept = 0;
+    for (ImageId id : prefetches_) {
+        ImageSlot& slot = slots_[id];
+        if (!slot.decode.Pending()) {
+            slot.decode.Reset();  // started, finished or already cancelled
+            continue;
+        }
+
+        if (keepVisible && slot.visibleFrame == visibleFrame_) {
+            if (slot.decode.Priority() != TaskPriority::High) {
+                slot.decode.SetPriority(TaskPriority::High, true);
+            }
+        } else if (!keepNearby) {
+            // Only a task that never started leaves the pending marker to us
+            if (slot.decode.Cancel()) {
+                ClearPending(id);
+                cancelCount_.fetch_add(1, std::memory_order_relaxed);
+            }
+            slot.decode.Reset();
+            continue;
+        }
+        prefetches_[kept++] = id;
+    }
+    prefetches_.resize(kept);
+}
+
+bool ThumbnailPipeline::HasPendingThumbnails() const
+{
+    std::lock_guard lock(readyMutex_);
+    return !readyQueue_.empty();
+}
+
+ThumbnailPipeline::Stats ThumbnailPipeline::GetStats() const
+{
+    Stats stats;
+    stats.gpuEntries = thumbnailCount_.load(std::memory_order_relaxed);
+    stats.gpuBytes = thumbnailCacheBytes_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard lock(tier2Mutex_);
+        stats.tier2Entries = tier2Cache_.size();
+        stats.tier2Bytes = tier2Bytes_;
+        stats.tier2Pending = demotePending_;
+    }
+    {
+        std::lock_guard lock(thumbSaveMutex_);
+        stats.saveBufferEntries = thumbSaveBuffer_.size();
+    }
+    stats.cpuPixelBytes = pixelPool_->LiveBytes();
+    {
+        std::shared_lock plock(persistMutex_);
+        stats.persistEntries = persistStore_.EntryCount();
+    }
+    stats.decodes = decodeCount_.load(std::memory_order_relaxed);
+    stats.uploads = uploadCount_.load(std::memory_order_relaxed);
+    stats.evictions = evictionCount_.load(std::memory_order_relaxed);
+    stats.cancelled = cancelCount_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ThumbnailPipeline::ThumbnailDecodeTask(ImageId id, uint32_t targetSize)
+{
+    // Read before any tier: a ForgetThumbnails from here on makes the result stale
+    const uint32_t version = slots_[id].version.load(std::memory_order_acquire);
+
+    // Check if already cached (uploaded from Tier 3 since this was queued)
+    if (HasThumbnail(id)) {
+        ClearPending(id);
+        return;
+    }
+
+    // I/O priority: Low-priority (prefetch) tasks enter background mode,
+    // reducing both I/O and memory priority so they don't compete with
+    // visible thumbnail decodes for disk bandwidth.
+    bool lowIoPriority = (ThreadPool::CurrentLane() == static_cast<int>(TaskPriority::Low));
+    Platform::ScopedBackgroundMode bgGuard(lowIoPriority);
+
+    // Tier 2: check CPU-RAM compressed cache first (~0.3ms decompress vs ~5ms disk)
+    PixelHandle pixels;
+    uint32_t imgWidth = 0, imgHeight = 0;
+
+    // Extract compressed data under lock, decompress outside lock
+    {
+        CompressedThumbnail t2copy;
+        {
+            std::lock_guard lock(tier2Mutex_);
+            auto t2it = tier2Cache_.find(id);
+            if (t2it != tier2Cache_.end()) {
+                t2copy = std::move(t2it->second);
+                tier2Bytes_ -= t2copy.compressedSize;
+                tier2Cache_.erase(t2it);
+            }
+        }
+        if (t2copy.data) {
+            imgWidth = t2copy.width;
+            imgHeight = t2copy.height;
+            pixels = pixelPool_->Acquire(t2copy.rawSize);
+            if (!config_.tier2Compressor->Decompress(t2copy.data.get(), t2copy.compressedSize,
+                                                     t2copy.width, t2copy.height, pixels.get())) {
+                pixels.reset();
+                imgWidth = imgHeight = 0;
+            }
+        }
+    }
+
+    // Tier 3: try persistent thumbnail cache (decompress vs JPEG decode = 20-100x faster)
+    if (!pixels && !slots_[id].persistStale.load(std::memory_order_acquire)) {
+        std::shared_lock plock(persistMutex_);
+        ThumbnailStore::View view;
+        if (persistStore_.Find(interner_->Path(id), view)) {
+            imgWidth = view.width;
+            imgHeight = view.height;
+            persistStore_.WillNeed(view);
+            pixels = pixelPool_->Acquire(static_cast<size_t>(imgWidth) * imgHeight * 4);
+            if (!DecodePixels(view.codec, view.data, view.bytes, imgWidth, imgHeight, pixels.get())) {
+                pixels.reset();
+                imgWidth = imgHeight = 0;
+            }
+        }
+    }
+
+    // Fall back to a full decode if not in persistent cache
+    if (!pixels) {
+        PixelBuffer buf;
+        decodeCount_.fetch_add(1, std::memory_order_relaxed);
+        if (!source_ || !source_->DecodeThumbnail(interner_->Path(id), targetSize, buf) ||
+            !buf.pixels) {
+            ClearPending(id);
+            return;
+        }
+
+        pixels = pixelPool_->Adopt(std::move(buf.pixels), static_cast<size_t>(buf.width) * buf.height * 4);
+        imgWidth = buf.width;
+        imgHeight = buf.height;
+    }
+
+    // Push to ready queue for render thread to create the texture
+    ReadyThumbnail ready;
+    ready.id = id;
+    ready.pixels = std::move(pixels);
+    ready.width = imgWidth;
+    ready.height = imgHeight;
+
+    {
+        // ForgetThumbnails bumps the version before it sweeps readyQueue_, so
+        // a result checked here is either dropped now or swept there
+        std::lock_guard lock(readyMutex_);
+        if (slots_[id].version.load(std::memory_order_acquire) == version) {
+            readyQueue_.push_back(std::move(ready));
+            return;
+        }
+    }
+    ClearPending(id);  // the old file's pixels; the next request decodes the new one
+}
+
+void ThumbnailPipeline::EvictThumbnailsIfNeeded()
+{
+    // Render thread: the only Tier 1 writer. CPU pixels Tier 1 doesn't hold
+    // are the save buffer's; those already queued for demotion count as
+    // released (they shrink to Tier 2 size shortly).
+    const size_t budget = config_.memoryBudgetBytes;
+    size_t others = 0;
+    {
+        std::lock_guard lock(tier2Mutex_);
+        const size_t live = pixelPool_->LiveBytes();
+        others = live - std::min(live, tier1PixelBytes_ + demotePendingBytes_);
+        // Tier 1 may have grown into space Tier 2 borrowed
+        TrimTier2(Tier2Limit());
+    }
+    if (others > budget / 2) {
+        others -= std::min(others, TrimSaveBuffer(others - budget * 3 / 8));
+    }
+    const size_t reserved = others + config_.tier2ReserveBytes;
+    const size_t limit = std::max(budget - std::min(budget, reserved), budget / 4);
+    auto tier1Bytes = [this] {
+        return thumbnailCacheBytes_.load(std::memory_order_relaxed) + tier1PixelBytes_;
+    };
+    if (tier1Bytes() <= limit) return;
+
+    // CLOCK sweep: referenced entries get a second chance (bit cleared),
+    // visible entries are pinned. Each step either evicts, clears a bit set
+    // by a hit since the last pass, or skips one of the few on-screen cells,
+    // so the sweep is amortized O(1) per eviction and stops at the budget
+    // instead of overshooting to a low-water mark.
+    std::vector<DemoteJob> jobs;
+    size_t jobBytes = 0;
+    size_t scanned = 0;
+    const size_t scanLimit = clockRing_.size() * 2 + 1;  // all pinned/referenced: give up
+    while (tier1Bytes() > limit && !clockRing_.empty() && scanned < scanLimit) {
+        ++scanned;
+        if (clockHand_ >= clockRing_.size()) clockHand_ = 0;
+
+        ImageId id = clockRing_[clockHand_];
+        ImageSlot& slot = slots_[id];
+        const ThumbnailCacheEntry* entry = slot.gpu.load(std::memory_order_relaxed);
+
+        if (slot.visibleFrame == visibleFrame_ ||
+            entry->referenced.exchange(false, std::memory_order_relaxed)) {
+            ++clockHand_;
+            continue;
+        }
+
+        // Tier 2 demotion from the entry's own CPU pixels (GPU textures
+        // can't be read back cheaply)
+        if (entry->pixels) {
+            jobs.push_back({id, entry->pixels, static_cast<uint16_t>(entry->width),
+                            static_cast<uint16_t>(entry->height),
+                            slot.version.load(std::memory_order_relaxed)});
+            jobBytes += static_cast<size_t>(entry->width) * entry->height * 4;
+        }
+        RemoveThumbnail(id);  // swap-removes: the hand now points at the moved id
+        evictionCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (jobs.empty()) return;
+
+    // The render thread only hands references over; compression happens in
+    // DemotionTask
+    if (!config_.asyncDemotion || !pool_) {
+        DemoteToTier2(jobs, false);
+        return;
+    }
+
+    bool schedule = false;
+    {
+        std::lock_guard lock(tier2Mutex_);
+        demotePending_ += jobs.size();
+        demotePendingBytes_ += jobBytes;
+        if (demoteQueue_.empty()) {
+            demoteQueue_ = std::move(jobs);
+        } else {
+            std::move(jobs.begin(), jobs.end(), std::back_inserter(demoteQueue_));
+        }
+        schedule = !demoteScheduled_;
+        demoteScheduled_ = true;
+    }
+    if (schedule) {
+        pool_->Submit([this] { DemotionTask(); }, TaskPriority::Low);
+    }
+}
+
+void ThumbnailPipeline::DemotionTask()
+{
+    for (;;) {
+        std::vector<DemoteJob> jobs;
+        {
+            std::lock_guard lock(tier2Mutex_);
+            if (demoteQueue_.empty()) {
+                demoteScheduled_ = false;
+                return;
+            }
+            jobs.swap(demoteQueue_);
+        }
+        DemoteToTier2(jobs, true);
+    }
+}
+
+size_t ThumbnailPipeline::TrimSaveBuffer(size_t bytes)
+{
+    size_t released = 0;
+    std::lock_guard lock(thumbSaveMutex_);
+    for (auto it = thumbSaveBuffer_.begin(); it != thumbSaveBuffer_.end() && released < bytes;) {
+        // Only buffers nothing else holds actually free memory
+        if (it->second.pixels.use_count() == 1) {
+            released += it->second.pixelSize;
+            it = thumbSaveBuffer_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return released;
+}
+
+size_t ThumbnailPipeline::Tier2Limit() const
+{
+    const size_t live = pixelPool_->LiveBytes();
+    const size_t used = thumbnailCacheBytes_.load(std::memory_order_relaxed) +
+                        live - std::min(live, demotePendingBytes_);
+    return config_.memoryBudgetBytes - std::min(config_.memoryBudgetBytes, used);
+}
+
+void ThumbnailPipeline::TrimTier2(size_t limit)
+{
+    while (tier2Bytes_ > limit && !tier2Order_.empty()) {
+        auto [oldId, oldSequence] = tier2Order_.front();
+        tier2Order_.pop_front();
+        auto it = tier2Cache_.find(oldId);
+        if (it != tier2Cache_.end() && it->second.sequence == oldSequence) {
+            tier2Bytes_ -= it->second.compressedSize;
+            tier2Cache_.erase(it);
+        }
+    }
+}
+
+void ThumbnailPipeline::DemoteToTier2(std::vector<DemoteJob>& jobs, bool queued)
+{
+    std::vector<CompressedThumbnail> compressed(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        DemoteJob& job = jobs[i];
+        // Re-requested and uploaded again while queued
+        if (HasThumbnail(job.id)) continue;
+
+        CompressedThumbnail& ct = compressed[i];
+        if (!config_.tier2Compressor->Compress(job.pixels.get(), job.width, job.height,
+                                              ct.data, ct.compressedSize)) {
+            ct.data.reset();
+            continue;
+        }
+        ct.rawSize = static_cast<uint32_t>(job.width) * job.height * 4;
+        ct.width = job.width;
+        ct.height = job.height;
+    }
+    // Back to the pool (unless the save buffer still holds them) before the
+    // budget is checked, and off the pending count in the same critical
+    // section so Tier2Limit never sees them as both released and pending
+    size_t rawBytes = 0;
+    for (const DemoteJob& job : jobs) rawBytes += static_cast<size_t>(job.width) * job.height * 4;
+
+    std::lock_guard lock(tier2Mutex_);
+    for (DemoteJob& job : jobs) job.pixels.reset();
+    if (queued) {
+        demotePending_ -= std::min(jobs.size(), demotePending_);
+        demotePendingBytes_ -= std::min(rawBytes, demotePendingBytes_);
+    }
+    const size_t limit = Tier2Limit();
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        CompressedThumbnail& ct = compressed[i];
+        if (!ct.data || tier2Cache_.contains(jobs[i].id)) continue;
+        // ForgetThumbnails bumps the version under this lock: a job it missed
+        // in demoteQueue_ (already compressing) is caught here
+        if (slots_[jobs[i].id].version.load(std::memory_order_relaxed) != jobs[i].version) continue;
+
+        // Make room by dropping the oldest entries; skip it if it can't fit
+        TrimTier2(limit - std::min(limit, ct.compressedSize));
+        if (tier2Bytes_ + ct.compressedSize > limit) continue;
+
+        ct.sequence = ++tier2Sequence_;
+        tier2Order_.emplace_back(jobs[i].id, ct.sequence);
+        tier2Bytes_ += ct.compressedSize;
+        tier2Cache_[jobs[i].id] = std::move(ct);
+    }
+
+    // Entries taken by decode tasks leave stale order records behind
+    if (tier2Order_.size() > 2 * tier2Cache_.size() + 1024) {
+        std::erase_if(tier2Order_, [this](const std::pair<ImageId, uint64_t>& e) {
+            auto it = tier2Cache_.find(e.first);
+            return it == tier2Cache_.end() || it->second.sequence != e.second;
+        });
+    }
+}
+
+void ThumbnailPipeline::ForgetThumbnails(const std::vector<ImageId>& ids)
+{
+    if (ids.empty()) return;
+    std::unordered_set<ImageId> forget;
+    for (ImageId id : ids) {
+        if (id >= interner_->Size()) continue;
+        RemoveThumbnail(id);
+        forget.insert(id);
+    }
+    if (forget.empty()) return;
+    {
+        // Decodes and demotions that started before this read the old file
+        // (or its pixels); they see the new version when they publish. Bumped
+        // under tier2Mutex_, so a decode that reads the new version finds
+        // Tier 2 already swept.
+        std::lock_guard lock(tier2Mutex_);
+        for (ImageId id : forget) {
+            slots_[id].version.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        // Order records of erased entries are skipped by TrimTier2
+        for (ImageId id : forget) {
+            auto it = tier2Cache_.find(id);
+            if (it == tier2Cache_.end()) continue;
+            tier2Bytes_ -= it->second.compressedSize;
+            tier2Cache_.erase(it);
+        }
+        std::erase_if(demoteQueue_, [&](const DemoteJob& job) {
+            if (!forget.contains(job.id)) return false;
+            --demotePending_;
+            demotePendingBytes_ -= std::min(static_cast<size_t>(job.width) * job.height * 4,
+                                            demotePendingBytes_);
+            return true;
+        });
+    }
+    {
+        // SavePersistent clears the flag under the same lock
+        std::lock_guard lock(thumbSaveMutex_);
+        for (ImageId id : forget) {
+            slots_[id].persistStale.store(true, std::memory_order_release);
+            thumbSaveBuffer_.erase(id);
+            persistForgotten_.insert(id);
+        }
+    }
+
+    // Queued and uploadable work is ours to drop; a running decode keeps its
+    // pending marker until it drops its own result
+    {
+        std::lock_guard lock(decodeMutex_);
+        std::erase_if(decodeQueue_, [&](const QueuedDecode& entry) {
+            if (!forget.contains(entry.id)) return false;
+            ClearPending(entry.id);
+            return true;
+        });
+        std::make_heap(decodeQueue_.begin(), decodeQueue_.end(), QueuedDecode::Later);
+    }
+    for (ImageId id : forget) {
+        ImageSlot& slot = slots_[id];
+        if (slot.decode.Cancel()) ClearPending(id);
+        slot.decode.Reset();  // RerankRequests skips it in prefetches_
+    }
+    std::lock_guard lock(readyMutex_);
+    std::erase_if(readyQueue_, [&](const ReadyThumbnail& ready) {
+        if (!forget.contains(ready.id)) return false;
+        ClearPending(ready.id);
+        return true;
+    });
+}
+
+void ThumbnailPipeline::MoveThumbnail(ImageId from, ImageId to)
+{
+    if (from == to || from >= interner_->Size() || to >= interner_->Size()) return;
+
+    // Tier 1 entries are only replaced on this thread, so no epoch guard
+    TextureHandle texture;
+    PixelHandle pixels;
+    uint32_t width = 0, height = 0;
+    if (const ImageSlot* slot = slots_.Find(from)) {
+        if (const ThumbnailCacheEntry* entry = slot->gpu.load(std::memory_order_acquire)) {
+            texture = entry->texture;
+            pixels = entry->pixels;
+            width = entry->width;
+            height = entry->height;
+        }
+    }
+
+    // `to` may have replaced a file that had a thumbnail of its own
+    ForgetThumbnails({from, to});
+    if (!texture) return;
+
+    InsertThumbnail(to, texture, pixels, width, height);
+    if (pixels && config_.collectSaveBuffer) {
+        ThumbSaveEntry save;
+        save.width = static_cast<uint16_t>(width);
+        save.height = static_cast<uint16_t>(height);
+        save.pixelSize = width * height * 4;
+        save.pixels = std::move(pixels);
+        std::lock_guard lock(thumbSaveMutex_);
+        thumbSaveBuffer_[to] = std::move(save);
+    }
+}
+
+// --- Persistent thumbnail cache (memory-mapped binary file) ---
+//
+// Format v3 (see ThumbnailStore): sorted hash index up front, payloads
+// encoded with Config::persistCodec, and an append-only log of per-save
+// segments. Loading maps the file and validates the index; lookups resolve
+// id -> path -> index entry on demand. Raw entries upload from the mapping
+// on the render thread, compressed ones are decoded by ThumbnailDecodeTask.
+// Older files (v1 sequential entries, v2 raw-only index) are ignored and
+// replaced on the next save.
+
+void ThumbnailPipeline::ClosePersistentMapping()
+{
+    std::unique_lock plock(persistMutex_);
+    persistStore_.Close();
+}
+
+void ThumbnailPipeline::LoadPersistent(const std::filesystem::path& cachePath)
+{
+    std::unique_lock plock(persistMutex_);
+    if (!persistStore_.Open(cachePath)) return;
+    persistGeneration_.fetch_add(1, std::memory_order_release);
+
+    Platform::DebugOutput("Loaded persistent thumb cache: " +
+        std::to_string(persistStore_.EntryCount()) + " entries\n");
+}
+
+void ThumbnailPipeline::SavePersistent(const std::filesystem::path& cachePath)
+{
+    // Snapshot the save buffer (newly decoded this session)
+    std::unordered_map<ImageId, ThumbSaveEntry> saveBuffer;
+    std::unordered_set<ImageId> forgotten;
+    {
+        std::lock_guard lock(thumbSaveMutex_);
+        saveBuffer = std::move(thumbSaveBuffer_);
+        thumbSaveBuffer_.clear();
+        forgotten = std::move(persistForgotten_);
+        persistForgotten_.clear();
+    }
+
+    // Once the file holds the fresh thumbnail or tombstone, Tier 3 is safe
+    // to read again, unless the id was forgotten once more since the snapshot.
+    // A failed save hands the thumbnails and ids back for the next one; those
+    // buffered or forgotten since are newer and stay.
+    auto finishSave = [&](bool saved) {
+        std::lock_guard lock(thumbSaveMutex_);
+        if (!saved) {
+            for (auto& [id, entry] : saveBuffer) {
+                if (!persistForgotten_.contains(id)) thumbSaveBuffer_.try_emplace(id, std::move(entry));
+            }
+        }
+        for (ImageId id : forgotten) {
+            if (!saved) {
+                persistForgotten_.insert(id);
+            } else if (!persistForgotten_.contains(id)) {
+                slots_[id].persistStale.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    // Thumbnails served from the file itself come back through the upload
+    // path too; only genuinely new ones are written, and those of forgotten
+    // files, whose stored entry is outdated
+    std::vector<ThumbnailStore::NewEntry> entries;
+    bool canAppend = false;
+    {
+        std::shared_lock plock(persistMutex_);
+        for (const auto& [id, entry] : saveBuffer) {
+            if (!entry.pixels) continue;
+            const auto& path = interner_->Path(id);
+            ThumbnailStore::View view;
+            if (!forgotten.contains(id) && persistStore_.Find(path, view)) continue;
+            entries.push_back({&path, entry.pixels.get(), entry.pixelSize, entry.width, entry.height,
+                               PixelCodec::Raw});
+        }
+        // Forgotten without a fresh thumbnail: a tombstone hides the stored one
+        for (ImageId id : forgotten) {
+            auto it = saveBuffer.find(id);
+            if (it != saveBuffer.end() && it->second.pixels) continue;
+            const auto& path = interner_->Path(id);
+            ThumbnailStore::View view;
+            if (persistStore_.Find(path, view)) entries.push_back({&path, nullptr, 0, 0, 0, PixelCodec::Raw});
+        }
+        canAppend = persistStore_.CanAppend() && persistStore_.File() == cachePath;
+    }
+    if (entries.empty()) {
+        finishSave(true);  // nothing new, and no stored entry to hide
+        return;
+    }
+
+    // Compress outside the lock; entries that don't shrink stay raw
+    std::vector<std::vector<uint8_t>> encoded(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto& e = entries[i];
+        if (e.width == 0 || e.height == 0) continue;  // tombstone
+        if (EncodePixels(config_.persistCodec, e.data, e.width, e.height, encoded[i])) {
+            e.data = encoded[i].data();
+            e.bytes = encoded[i].size();
+            e.codec = config_.persistCodec;
+        }
+    }
+
+    // Append only the new thumbnails as one log segment. The mapping is
+    // closed meanwhile (Windows refuses writes to a mapped file), so
+    // lookups miss until it reopens, as they did during a v1 rewrite.
+    bool saved = false;
+    if (canAppend) {
+        ClosePersistentMapping();
+        saved = ThumbnailStore::AppendSegment(cachePath, entries);
+        if (!saved) LoadPersistent(cachePath);
+    }
+
+    // No valid v3 file yet, or out of segments: rewrite it compacted
+    if (!saved) {
+        auto tmpPath = cachePath;
+        tmpPath += ".tmp";
+        {
+            std::shared_lock plock(persistMutex_);
+            saved = persistStore_.WriteCompacted(tmpPath, entries);
+        }
+        ClosePersistentMapping();
+        std::error_code ec;
+        if (saved) std::filesystem::rename(tmpPath, cachePath, ec);
+        saved = saved && !ec;
+    }
+
+    // Reopen so lookups keep hitting the file for the rest of the session.
+    // Without this, thumbnails evicted from the GPU tier require full JPEG decode again.
+    LoadPersistent(cachePath);
+    finishSave(saved);
+
+    Platform::DebugOutput(std::string(saved ? "Saved" : "Failed to save") +
+        " persistent thumb cache: " + std::to_string(entries.size()) + " new entries\n");
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
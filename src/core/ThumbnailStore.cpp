@@ -0,0 +1,407 @@
+#include "core/ThumbnailStore.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+namespace UltraImageViewer {
+namespace Core {
+
+struct ThumbnailStore::IndexEntry {
+    uint64_t key;        // HashBytes of the native path
+    uint64_t offset;     // payload, then the native path
+    uint32_t bytes;      // payload size
+    uint16_t width;
+    uint16_t height;
+    uint32_t pathBytes;
+    uint8_t codec;       // PixelCodec
+    uint8_t reserved[3];
+};
+static_assert(sizeof(ThumbnailStore::IndexEntry) == 32);
+
+namespace {
+
+constexpr char kMagic[4] = {'U', 'I', 'V', 'T'};
+constexpr char kSegmentMagic[4] = {'U', 'I', 'V', 'S'};
+constexpr uint32_t kVersion = 3;
+constexpr size_t kRawAlign = 4096;
+constexpr size_t kPackedAlign = 16;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t baseCount;
+    uint32_t segmentCount;
+    uint64_t baseIndexOffset;
+    uint64_t baseIndexHash;
+    uint64_t tailSegment;   // footer offset of the newest segment, 0 = none
+    uint64_t committedEnd;  // anything past this is an uncommitted append
+    uint64_t reserved;
+    uint64_t headerHash;    // over the preceding fields
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct SegmentFooter {
+    char magic[4];
+    uint32_t count;
+    uint64_t indexOffset;
+    uint64_t indexHash;
+    uint64_t prevSegment;   // footer offset of the previous segment, 0 = none
+};
+static_assert(sizeof(SegmentFooter) == 32);
+
+using IndexEntry = ThumbnailStore::IndexEntry;
+
+// Stored on disk as keys and checksums, so it must not change between builds
+uint64_t HashBytes(const void* data, size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ (size * 0xFF51AFD7ED558CCDULL);
+    auto round = [&h](uint64_t w) {
+        h ^= w * 0x9E3779B97F4A7C15ULL;
+        h = ((h << 31) | (h >> 33)) * 0xC2B2AE3D27D4EB4FULL;
+    };
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        round(w);
+    }
+    if (size > 0) {
+        uint64_t w = 0;
+        memcpy(&w, p, size);
+        round(w);
+    }
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+uint64_t HashHeader(const FileHeader& header)
+{
+    return HashBytes(&header, offsetof(FileHeader, headerHash));
+}
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+size_t PayloadAlign(PixelCodec codec)
+{
+    return codec == PixelCodec::Raw ? kRawAlign : kPackedAlign;
+}
+
+// A payload inside the committed region whose size fits its codec
+bool PayloadValid(const IndexEntry& e, size_t committedEnd)
+{
+    if (e.offset > committedEnd || static_cast<uint64_t>(e.bytes) + e.pathBytes > committedEnd - e.offset) {
+        return false;
+    }
+    switch (static_cast<PixelCodec>(e.codec)) {
+        case PixelCodec::Raw: return e.bytes == static_cast<size_t>(e.width) * e.height * 4;
+        case PixelCodec::Qoi:
+        case PixelCodec::PlaneDelta: return true;
+    }
+    return false;
+}
+
+// One thumbnail to write, from a new entry or an existing payload
+struct Record {
+    uint64_t key;
+    const uint8_t* data;
+    uint32_t bytes;
+    const void* path;
+    uint32_t pathBytes;
+    uint16_t width;
+    uint16_t height;
+    PixelCodec codec;
+};
+
+Record MakeRecord(const ThumbnailStore::NewEntry& entry)
+{
+    const auto& native = entry.path->native();
+    uint32_t pathBytes = static_cast<uint32_t>(native.size() * sizeof(native[0]));
+    return {HashBytes(native.data(), pathBytes), entry.data, static_cast<uint32_t>(entry.bytes),
+            native.data(), pathBytes, entry.width, entry.height, entry.codec};
+}
+
+// Sorts by key and assigns payload offsets from `start`, aligned per codec.
+// Returns the end of the last payload.
+size_t Layout(std::vector<Record>& records, size_t start, std::vector<IndexEntry>& index)
+{
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record& a, const Record& b) { return a.key < b.key; });
+    index.resize(records.size());
+    size_t pos = start;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        pos = AlignUp(pos, r.bytes == 0 ? kPackedAlign : PayloadAlign(r.codec));  // tombstones hold no pixels
+        index[i] = {r.key, pos, r.bytes, r.width, r.height, r.pathBytes, static_cast<uint8_t>(r.codec), {}};
+        pos += r.bytes + r.pathBytes;
+    }
+    return pos;
+}
+
+// Sequential writer that tracks the file position and zero-fills gaps
+class Writer {
+public:
+    Writer(std::FILE* file, uint64_t pos) : file_(file), pos_(pos) {}
+
+    void Write(const void* data, size_t size)
+    {
+        if (ok_ && size > 0) ok_ = std::fwrite(data, 1, size, file_) == size;
+        pos_ += size;
+    }
+
+    void PadTo(uint64_t offset)
+    {
+        static const uint8_t kZeros[kRawAlign] = {};
+        while (pos_ < offset) Write(kZeros, static_cast<size_t>(std::min<uint64_t>(offset - pos_, sizeof(kZeros))));
+    }
+
+    void Payloads(const std::vector<Record>& records, const std::vector<IndexEntry>& index)
+    {
+        for (size_t i = 0; i < records.size(); ++i) {
+            PadTo(index[i].offset);
+            Write(records[i].data, records[i].bytes);
+            Write(records[i].path, records[i].pathBytes);
+        }
+    }
+
+    bool Ok() const { return ok_; }
+
+private:
+    std::FILE* file_;
+    uint64_t pos_;
+    bool ok_ = true;
+};
+
+bool ReadHeader(std::FILE* file, FileHeader& header)
+{
+    return std::fread(&header, sizeof(header), 1, file) == 1 &&
+           memcmp(header.magic, kMagic, 4) == 0 && header.version == kVersion &&
+           header.headerHash == HashHeader(header);
+}
+
+} // namespace
+
+bool ThumbnailStore::Open(const std::filesystem::path& file)
+{
+    Close();
+    if (!Platform::MapFileReadOnly(file, mapping_)) return false;
+
+    const uint8_t* data = mapping_.data;
+    FileHeader header;
+    bool ok = mapping_.size >= sizeof(header);
+    if (ok) {
+        memcpy(&header, data, sizeof(header));
+        ok = memcmp(header.magic, kMagic, 4) == 0 && header.version == kVersion &&
+             header.headerHash == HashHeader(header) &&
+             header.committedEnd >= sizeof(header) && header.committedEnd <= mapping_.size;
+    }
+
+    // An index block is in bounds, aligned for IndexEntry, and matches its checksum
+    auto indexValid = [&](uint64_t offset, uint64_t count, uint64_t limit, uint64_t hash) {
+        return offset % alignof(IndexEntry) == 0 && offset <= limit &&
+               count <= (limit - offset) / sizeof(IndexEntry) &&
+               HashBytes(data + offset, count * sizeof(IndexEntry)) == hash;
+    };
+
+    ok = ok && indexValid(header.baseIndexOffset, header.baseCount, header.committedEnd, header.baseIndexHash);
+
+    uint64_t next = ok ? header.tailSegment : 0;
+    for (uint32_t i = 0; ok && i < header.segmentCount; ++i) {
+        SegmentFooter footer;
+        ok = next >= sizeof(header) && next <= header.committedEnd - sizeof(footer);
+        if (!ok) break;
+        memcpy(&footer, data + next, sizeof(footer));
+        ok = memcmp(footer.magic, kSegmentMagic, 4) == 0 &&
+             indexValid(footer.indexOffset, footer.count, next, footer.indexHash);
+        if (!ok) break;
+        segments_.push_back({reinterpret_cast<const IndexEntry*>(data + footer.indexOffset), footer.count});
+        entryCount_ += footer.count;
+        next = footer.prevSegment;
+    }
+    if (!ok || next != 0) {
+        Close();
+        return false;
+    }
+
+    // Payloads are in hash order: see WillNeed
+    Platform::AdviseMapping(mapping_, Platform::MappingAdvice::Random);
+
+    segments_.push_back({reinterpret_cast<const IndexEntry*>(data + header.baseIndexOffset), header.baseCount});
+    entryCount_ += header.baseCount;
+    committedEnd_ = static_cast<size_t>(header.committedEnd);
+    file_ = file;
+    return true;
+}
+
+void ThumbnailStore::Close()
+{
+    Platform::UnmapFile(mapping_);
+    file_.clear();
+    segments_.clear();
+    entryCount_ = 0;
+    committedEnd_ = 0;
+}
+
+const ThumbnailStore::IndexEntry* ThumbnailStore::FindIn(const Segment& segment,
+                                                         const std::filesystem::path& path,
+                                                         uint64_t key) const
+{
+    const auto& native = path.native();
+    const size_t pathBytes = native.size() * sizeof(native[0]);
+    const IndexEntry* end = segment.entries + segment.count;
+    const IndexEntry* e = std::lower_bound(segment.entries, end, key,
+                                           [](const IndexEntry& a, uint64_t k) { return a.key < k; });
+    for (; e != end && e->key == key; ++e) {
+        if (e->pathBytes != pathBytes || !PayloadValid(*e, committedEnd_)) continue;
+        if (memcmp(mapping_.data + e->offset + e->bytes, native.data(), pathBytes) == 0) return e;
+    }
+    return nullptr;
+}
+
+bool ThumbnailStore::Find(const std::filesystem::path& path, View& out) const
+{
+    if (!IsOpen()) return false;
+    const auto& native = path.native();
+    const uint64_t key = HashBytes(native.data(), native.size() * sizeof(native[0]));
+    for (const Segment& segment : segments_) {
+        if (const IndexEntry* e = FindIn(segment, path, key)) {
+            if (e->width == 0 || e->height == 0) return false;  // tombstone
+            out.data = mapping_.data + e->offset;
+            out.bytes = e->bytes;
+            out.width = e->width;
+            out.height = e->height;
+            out.codec = static_cast<PixelCodec>(e->codec);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThumbnailStore::WillNeed(const View& view) const
+{
+    if (!IsOpen() || !view.data) return;
+    Platform::AdviseMapping(mapping_, Platform::MappingAdvice::WillNeed,
+                            static_cast<size_t>(view.data - mapping_.data), view.bytes);
+}
+
+bool ThumbnailStore::AppendSegment(const std::filesystem::path& file, const std::vector<NewEntry>& entries)
+{
+    if (entries.empty()) return true;
+
+    std::FILE* f = Platform::OpenFile(file, "r+b");
+    if (!f) return false;
+
+    FileHeader header;
+    if (!ReadHeader(f, header) || header.segmentCount >= kMaxSegments) {
+        std::fclose(f);
+        return false;
+    }
+
+    std::vector<Record> records;
+    records.reserve(entries.size());
+    for (const auto& entry : entries) records.push_back(MakeRecord(entry));
+
+    std::vector<IndexEntry> index;
+    const size_t start = AlignUp(static_cast<size_t>(header.committedEnd), kRawAlign);
+    const size_t indexOffset = AlignUp(Layout(records, start, index), alignof(IndexEntry));
+    const size_t footerOffset = indexOffset + index.size() * sizeof(IndexEntry);
+
+    SegmentFooter footer{};
+    memcpy(footer.magic, kSegmentMagic, 4);
+    footer.count = static_cast<uint32_t>(index.size());
+    footer.indexOffset = indexOffset;
+    footer.indexHash = HashBytes(index.data(), index.size() * sizeof(IndexEntry));
+    footer.prevSegment = header.tailSegment;
+
+    // Segment first; the header rewrite below is the commit point
+    Writer writer(f, start);
+    bool ok = Platform::SeekFile(f, start);
+    if (ok) {
+        writer.Payloads(records, index);
+        writer.PadTo(indexOffset);
+        writer.Write(index.data(), index.size() * sizeof(IndexEntry));
+        writer.Write(&footer, sizeof(footer));
+        ok = writer.Ok() && std::fflush(f) == 0;
+    }
+    if (ok) {
+        header.segmentCount += 1;
+        header.tailSegment = footerOffset;
+        header.committedEnd = footerOffset + sizeof(footer);
+        header.headerHash = HashHeader(header);
+        ok = Platform::SeekFile(f, 0) && std::fwrite(&header, sizeof(header), 1, f) == 1;
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+bool ThumbnailStore::WriteCompacted(const std::filesystem::path& file,
+                                    const std::vector<NewEntry>& entries) const
+{
+    // New entries first, then segments newest to oldest, then the base: the
+    // stable sort keeps that order within a key, so the first of each path wins
+    std::vector<Record> records;
+    records.reserve(entries.size() + entryCount_);
+    for (const auto& entry : entries) records.push_back(MakeRecord(entry));
+    for (const Segment& segment : segments_) {
+        for (uint32_t i = 0; i < segment.count; ++i) {
+            const IndexEntry& e = segment.entries[i];
+            if (!PayloadValid(e, committedEnd_)) continue;
+            const uint8_t* data = mapping_.data + e.offset;
+            records.push_back({e.key, data, e.bytes, data + e.bytes, e.pathBytes, e.width, e.height,
+                               static_cast<PixelCodec>(e.codec)});
+        }
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record& a, const Record& b) { return a.key < b.key; });
+
+    std::vector<Record> unique;
+    unique.reserve(records.size());
+    for (size_t i = 0; i < records.size();) {
+        size_t run = i;
+        while (run < records.size() && records[run].key == records[i].key) ++run;
+        for (size_t j = i; j < run; ++j) {
+            bool superseded = false;
+            for (size_t k = i; k < j && !superseded; ++k) {
+                superseded = records[k].pathBytes == records[j].pathBytes &&
+                             memcmp(records[k].path, records[j].path, records[j].pathBytes) == 0;
+            }
+            // A tombstone has done its job once it hides the older entries
+            if (!superseded && records[j].width != 0 && records[j].height != 0) {
+                unique.push_back(records[j]);
+            }
+        }
+        i = run;
+    }
+
+    std::vector<IndexEntry> index;
+    const size_t indexOffset = sizeof(FileHeader);
+    const size_t payloadStart = indexOffset + unique.size() * sizeof(IndexEntry);
+    const size_t end = Layout(unique, payloadStart, index);
+
+    FileHeader header{};
+    memcpy(header.magic, kMagic, 4);
+    header.version = kVersion;
+    header.baseCount = static_cast<uint32_t>(index.size());
+    header.baseIndexOffset = indexOffset;
+    header.baseIndexHash = HashBytes(index.data(), index.size() * sizeof(IndexEntry));
+    header.committedEnd = end;
+    header.headerHash = HashHeader(header);
+
+    std::FILE* f = Platform::OpenFile(file, "wb");
+    if (!f) return false;
+    Writer writer(f, 0);
+    writer.Write(&header, sizeof(header));
+    writer.Write(index.data(), index.size() * sizeof(IndexEntry));
+    writer.Payloads(unique, index);
+    bool ok = writer.Ok();
+    return std::fclose(f) == 0 && ok;
+}
+
+} // namespace Core
+} // namespace UltraImageViewer
@@ -2,7 +2,6 @@
 #include "ui/Theme.hpp"
 #include <algorithm>
 #include <cmath>
-#include <map>
 #include <vector>
 #include <d2d1_1.h>
 #include <d2d1effects.h>
@@ -57,6 +56,19 @@ static D2D1_RECT_F ComputeCropRect(ID2D1Bitmap* bitmap, float destW, float destH
     }
 }
 
+// Helper: date section title ("2024年3月", or "2024年" without a month)
+static std::wstring SectionTitle(int year, int month)
+{
+    static const wchar_t* monthNames[] = {
+        L"", L"1\u6708", L"2\u6708", L"3\u6708", L"4\u6708", L"5\u6708", L"6\u6708",
+        L"7\u6708", L"8\u6708", L"9\u6708", L"10\u6708", L"11\u6708", L"12\u6708"
+    };
+    if (month >= 1 && month <= 12) {
+        return std::to_wstring(year) + L"\u5E74" + monthNames[month];
+    }
+    return std::to_wstring(year) + L"\u5E74";
+}
+
 GalleryView::GalleryView()
     : scrollY_(Animation::SpringConfig{Theme::ScrollStiffness, Theme::ScrollDamping, 1.0f, 0.5f})
     , albumsScrollY_(Animation::SpringConfig{Theme::ScrollStiffness, Theme::ScrollDamping, 1.0f, 0.5f})
@@ -109,44 +121,43 @@ void GalleryView::Initialize(Rendering::Direct2DRenderer* renderer,
 
 void GalleryView::SetImagesGrouped(const std::vector<Core::ScannedImage>& scannedImages)
 {
-    bool wasEmpty = images_.empty();
+    bool wasEmpty = Photos().Empty();
+    library_.Assign(scannedImages);
+    showingList_ = false;
+    list_.Clear();
 
-    images_.clear();
-    sections_.clear();
-
-    if (scannedImages.empty()) {
-        cachedLayoutWidth_ = 0.0f;
-        allScannedImages_.clear();
-        folderAlbums_.clear();
-        return;
+    if (wasEmpty) {
+        scrollY_.SetValue(0.0f);
+        scrollY_.SetTarget(0.0f);
+        scrollY_.SnapToTarget();
     }
 
-    int currentYear = -1;
-    int currentMonth = -1;
-
-    static const wchar_t* monthNames[] = {
-        L"", L"1\u6708", L"2\u6708", L"3\u6708", L"4\u6708", L"5\u6708", L"6\u6708",
-        L"7\u6708", L"8\u6708", L"9\u6708", L"10\u6708", L"11\u6708", L"12\u6708"
-    };
+    OnLibraryChanged();
+}
 
-    for (const auto& img : scannedImages) {
-        if (img.year != currentYear || img.month != currentMonth) {
-            currentYear = img.year;
-            currentMonth = img.month;
+void GalleryView::AddScannedImages(std::vector<Core::ScannedImage> batch)
+{
+    if (batch.empty()) return;
+    bool wasEmpty = library_.Empty();
+    library_.Insert(std::move(batch));
+    if (showingList_) return;
 
-            Section section;
-            if (currentMonth >= 1 && currentMonth <= 12) {
-                section.title = std::to_wstring(currentYear) + L"\u5E74" + monthNames[currentMonth];
-            } else {
-                section.title = std::to_wstring(currentYear) + L"\u5E74";
-            }
-            section.startIndex = images_.size();
-            section.count = 0;
-            sections_.push_back(std::move(section));
-        }
+    // Photos tab: later batches leave the scroll position where it is
+    if (wasEmpty) {
+        scrollY_.SetValue(0.0f);
+        scrollY_.SetTarget(0.0f);
+        scrollY_.SnapToTarget();
+    }
+    OnLibraryChanged();
+}
 
-        images_.push_back(img.path);
-        sections_.back().count++;
+void GalleryView::SyncScannedImages(const std::vector<Core::ScannedImage>& scannedImages)
+{
+    bool wasEmpty = library_.Empty();
+    library_.Sync(scannedImages);
+    if (showingList_) {
+        ShowLibrary();
+        return;
     }
 
     if (wasEmpty) {
@@ -154,50 +165,115 @@ void GalleryView::SetImagesGrouped(const std::vector<Core::ScannedImage>& scanne
         scrollY_.SetTarget(0.0f);
         scrollY_.SnapToTarget();
     }
+    OnLibraryChanged();
+}
+
+void GalleryView::ShowLibrary()
+{
+    showingList_ = false;
+    list_.Clear();
+    listTitle_.clear();
+
+    scrollY_.SetValue(0.0f);
+    scrollY_.SetTarget(0.0f);
+    scrollY_.SnapToTarget();
     cachedLayoutWidth_ = 0.0f;
 
-    allScannedImages_ = scannedImages;
-    BuildFolderAlbums(scannedImages);
+    OnLibraryChanged();
+}
 
-    // Edit mode resilience: re-init jiggle phases for new album count
-    if (editMode_) {
-        jigglePhases_.resize(folderAlbums_.size() + 1);
-        for (auto& phase : jigglePhases_) {
-            phase = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 6.2831853f;
+void GalleryView::OnLibraryChanged()
+{
+    if (showingList_) return;  // albums come back with ShowLibrary
+
+    std::filesystem::path openFolder;
+    if (inFolderDetail_ && openFolderIndex_ < folderAlbums_.size()) {
+        openFolder = folderAlbums_[openFolderIndex_].folderPath;
+    }
+    size_t albumCount = folderAlbums_.size();
+    BuildFolderAlbums();
+    if (folderAlbums_.size() != albumCount) ResetJigglePhases();
+
+    // An open folder shows its new contents, or closes when it is gone
+    if (inFolderDetail_ && !folderTransitionActive_) {
+        auto it = std::find_if(folderAlbums_.begin(), folderAlbums_.end(),
+            [&](const FolderAlbum& album) { return album.folderPath == openFolder; });
+        if (it == folderAlbums_.end()) {
+            openFolderIndex_ = 0;
+            ExitFolderDetail();
+        } else {
+            openFolderIndex_ = static_cast<size_t>(it - folderAlbums_.begin());
+            FillFolderDetail(*it);
         }
-        deletingCardIndex_ = -1;
-        deleteCardScale_.SetValue(1.0f);
-        deleteCardScale_.SetTarget(1.0f);
-        deleteCardScale_.SnapToTarget();
     }
 }
 
-void GalleryView::SetImages(const std::vector<std::filesystem::path>& paths)
+void GalleryView::ResetJigglePhases()
 {
-    images_ = paths;
-    sections_.clear();
+    // Edit mode resilience: re-init jiggle phases for new album count
+    if (!editMode_) return;
+    jigglePhases_.resize(folderAlbums_.size() + 1);
+    for (auto& phase : jigglePhases_) {
+        phase = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 6.2831853f;
+    }
+    deletingCardIndex_ = -1;
+    deleteCardScale_.SetValue(1.0f);
+    deleteCardScale_.SetTarget(1.0f);
+    deleteCardScale_.SnapToTarget();
+}
+
+std::vector<Core::ImageId> GalleryView::ApplyLibraryChanges(
+    std::vector<Core::ScannedImage> added,
+    const std::vector<std::filesystem::path>& removed)
+{
+    std::vector<Core::ImageId> dropped;
+    if (added.empty() && removed.empty()) return dropped;
 
-    if (!paths.empty()) {
-        Section section;
-        section.title = paths[0].parent_path().filename().wstring();
-        section.startIndex = 0;
-        section.count = paths.size();
-        sections_.push_back(std::move(section));
+    // Removals first; an added image still here was rewritten in place
+    dropped = library_.Remove(removed);
+    for (const auto& img : added) {
+        if (library_.Contains(img.id)) dropped.push_back(img.id);
     }
+    library_.Insert(std::move(added));
+
+    // Photos tab: the scroll position stays where it was
+    OnLibraryChanged();
+    return dropped;
+}
+
+void GalleryView::RemoveAlbum(const std::filesystem::path& folder)
+{
+    library_.RemoveFolder(folder);
+    OnLibraryChanged();
+}
+
+void GalleryView::SetImages(const std::vector<std::filesystem::path>& paths)
+{
+    std::vector<Core::ScannedImage> images;
+    images.reserve(paths.size());
+    auto& interner = Core::PathInterner::Global();
+    for (const auto& p : paths) {
+        Core::ScannedImage img;
+        img.path = p;
+        img.id = interner.Intern(p);
+        images.push_back(std::move(img));
+    }
+    list_.AssignList(images);
+    showingList_ = true;
+    listTitle_ = paths.empty() ? std::wstring() : paths[0].parent_path().filename().wstring();
 
     scrollY_.SetValue(0.0f);
     scrollY_.SetTarget(0.0f);
     scrollY_.SnapToTarget();
     cachedLayoutWidth_ = 0.0f;
 
-    allScannedImages_.clear();
     folderAlbums_.clear();
 }
 
 const std::vector<std::filesystem::path>& GalleryView::GetActiveImages() const
 {
-    if (inFolderDetail_) return folderDetailImages_;
-    return images_;
+    if (inFolderDetail_) return folderDetail_.Paths();
+    return Photos().Paths();
 }
 
 void GalleryView::SetScanningState(bool scanning, size_t count)
@@ -255,30 +331,30 @@ void GalleryView::SetEditMode(bool enabled)
     }
 }
 
-void GalleryView::BuildFolderAlbums(const std::vector<Core::ScannedImage>& scannedImages)
+void GalleryView::BuildFolderAlbums()
 {
-    std::map<std::wstring, FolderAlbum> albumMap;
-    for (const auto& img : scannedImages) {
-        auto parentDir = img.path.parent_path();
-        std::wstring key = parentDir.wstring();
-        auto& album = albumMap[key];
-        if (album.imageCount == 0) {
-            album.folderPath = parentDir;
-            album.displayName = parentDir.filename().wstring();
-            album.coverImage = img.path;
-        }
-        album.imageCount++;
-    }
+    // Most photos first; order the folders before building their cards
+    std::vector<const Core::GalleryModel::Folder*> folders;
+    folders.reserve(library_.Folders().size());
+    for (const auto& [_, folder] : library_.Folders()) folders.push_back(&folder);
+    std::sort(folders.begin(), folders.end(),
+        [](const Core::GalleryModel::Folder* a, const Core::GalleryModel::Folder* b) {
+            if (a->ids.size() != b->ids.size()) return a->ids.size() > b->ids.size();
+            return a->path.native() < b->path.native();
+        });
 
+    auto& interner = Core::PathInterner::Global();
     folderAlbums_.clear();
-    for (auto& [_, album] : albumMap) {
+    folderAlbums_.reserve(folders.size());
+    for (const auto* folder : folders) {
+        FolderAlbum album;
+        album.folderPath = folder->path;
+        album.displayName = folder->path.filename().wstring();
+        album.imageCount = folder->ids.size();
+        album.coverImage = interner.Path(folder->cover);
+        album.coverId = folder->cover;
         folderAlbums_.push_back(std::move(album));
     }
-
-    std::sort(folderAlbums_.begin(), folderAlbums_.end(),
-        [](const FolderAlbum& a, const FolderAlbum& b) {
-            return a.imageCount > b.imageCount;
-        });
 }
 
 void GalleryView::EnterFolderDetail(size_t albumIndex)
@@ -294,38 +370,7 @@ void GalleryView::EnterFolderDetail(size_t albumIndex)
         folderVisitCallback_(album.folderPath);
     }
 
-    folderDetailImages_.clear();
-    folderDetailSections_.clear();
-
-    int currentYear = -1;
-    int currentMonth = -1;
-
-    static const wchar_t* monthNames[] = {
-        L"", L"1\u6708", L"2\u6708", L"3\u6708", L"4\u6708", L"5\u6708", L"6\u6708",
-        L"7\u6708", L"8\u6708", L"9\u6708", L"10\u6708", L"11\u6708", L"12\u6708"
-    };
-
-    for (const auto& img : allScannedImages_) {
-        if (img.path.parent_path() != album.folderPath) continue;
-
-        if (img.year != currentYear || img.month != currentMonth) {
-            currentYear = img.year;
-            currentMonth = img.month;
-
-            Section section;
-            if (currentMonth >= 1 && currentMonth <= 12) {
-                section.title = std::to_wstring(currentYear) + L"\u5E74" + monthNames[currentMonth];
-            } else {
-                section.title = std::to_wstring(currentYear) + L"\u5E74";
-            }
-            section.startIndex = folderDetailImages_.size();
-            section.count = 0;
-            folderDetailSections_.push_back(std::move(section));
-        }
-
-        folderDetailImages_.push_back(img.path);
-        folderDetailSections_.back().count++;
-    }
+    FillFolderDetail(album);
 
     folderDetailScrollY_.SetValue(0.0f);
     folderDetailScrollY_.SetTarget(0.0f);
@@ -335,9 +380,11 @@ void GalleryView::EnterFolderDetail(size_t albumIndex)
     // Pre-warm decode pipeline: request first batch of thumbnails so they're
     // decoding during the ~300ms slide animation and ready when it ends
     if (pipeline_) {
-        size_t preload = std::min(folderDetailImages_.size(), size_t(40));
+        size_t preload = std::min(folderDetail_.Size(), size_t(40));
         for (size_t i = 0; i < preload; ++i) {
-            pipeline_->RequestThumbnail(folderDetailImages_[i], Theme::ThumbnailMaxPx);
+            auto [section, offset] = folderDetail_.Locate(i);
+            pipeline_->RequestThumbnail(folderDetail_.GetSection(section).ids[offset],
+                                        Theme::ThumbnailMaxPx);
         }
     }
 
@@ -348,6 +395,16 @@ void GalleryView::EnterFolderDetail(size_t albumIndex)
     folderTransitionForward_ = true;
 }
 
+void GalleryView::FillFolderDetail(const FolderAlbum& album)
+{
+    std::vector<Core::ScannedImage> images;
+    if (const auto* folder = library_.FindFolder(album.folderPath)) {
+        images.reserve(folder->ids.size());
+        for (Core::ImageId id : folder->ids) images.push_back(library_.Image(id));
+    }
+    folderDetail_.Assign(std::move(images));
+}
+
 void GalleryView::ExitFolderDetail()
 {
     // Start navigation pop animation — data cleared on completion
@@ -492,52 +549,44 @@ GalleryView::AlbumGridLayout GalleryView::CalculateAlbumGridLayout(float viewWid
     return ag;
 }
 
-void GalleryView::ComputeSectionLayouts(const GridLayout& grid) const
+GalleryView::SectionLayoutInfo GalleryView::SectionLayout(const Core::GalleryModel& model,
+                                                          size_t section, const GridLayout& grid)
 {
-    sectionLayouts_.clear();
-    sectionLayouts_.resize(sections_.size());
-
-    float y = Theme::GalleryHeaderHeight + Theme::GalleryPadding;
-
-    for (size_t i = 0; i < sections_.size(); ++i) {
-        sectionLayouts_[i].headerY = y;
-        sectionLayouts_[i].contentY = y + Theme::SectionHeaderHeight;
-        sectionLayouts_[i].rows = static_cast<int>(
-            (sections_[i].count + grid.columns - 1) / grid.columns);
-
-        y = sectionLayouts_[i].contentY +
-            sectionLayouts_[i].rows * (grid.cellSize + grid.gap);
-
-        if (i + 1 < sections_.size()) {
-            y += Theme::SectionGap;
-        }
-    }
-
-    cachedTotalHeight_ = y + Theme::GalleryPadding;
+    // Every section above adds a header and a gap, plus its rows
+    float rowPitch = grid.cellSize + grid.gap;
+    SectionLayoutInfo layout = {};
+    layout.headerY = Theme::GalleryHeaderHeight + Theme::GalleryPadding +
+        static_cast<float>(section) * (Theme::SectionHeaderHeight + Theme::SectionGap) +
+        static_cast<float>(model.RowsBefore(section, grid.columns)) * rowPitch;
+    layout.contentY = layout.headerY + Theme::SectionHeaderHeight;
+    if (section < model.SectionCount()) {
+        layout.rows = static_cast<int>(
+            (model.GetSection(section).ids.size() + grid.columns - 1) / grid.columns);
+    }
+    return layout;
 }
 
-void GalleryView::ComputeFolderDetailSectionLayouts(const GridLayout& grid) const
+float GalleryView::GridHeight(const Core::GalleryModel& model, const GridLayout& grid)
 {
-    folderDetailSectionLayouts_.clear();
-    folderDetailSectionLayouts_.resize(folderDetailSections_.size());
-
-    float y = Theme::GalleryHeaderHeight + Theme::GalleryPadding;
-
-    for (size_t i = 0; i < folderDetailSections_.size(); ++i) {
-        folderDetailSectionLayouts_[i].headerY = y;
-        folderDetailSectionLayouts_[i].contentY = y + Theme::SectionHeaderHeight;
-        folderDetailSectionLayouts_[i].rows = static_cast<int>(
-            (folderDetailSections_[i].count + grid.columns - 1) / grid.columns);
-
-        y = folderDetailSectionLayouts_[i].contentY +
-            folderDetailSectionLayouts_[i].rows * (grid.cellSize + grid.gap);
-
-        if (i + 1 < folderDetailSections_.size()) {
-            y += Theme::SectionGap;
-        }
-    }
+    float top = Theme::GalleryHeaderHeight + Theme::GalleryPadding;
+    size_t sections = model.SectionCount();
+    if (sections == 0) return top + Theme::GalleryPadding;
+    return top + static_cast<float>(sections) * Theme::SectionHeaderHeight +
+           static_cast<float>(sections - 1) * Theme::SectionGap +
+           static_cast<float>(model.TotalRows(grid.columns)) * (grid.cellSize + grid.gap) +
+           Theme::GalleryPadding;
+}
 
-    folderDetailCachedTotalHeight_ = y + Theme::GalleryPadding;
+GalleryView::GridPosition GalleryView::GridPositionAt(const Core::GalleryModel& model, float y,
+                                                     const GridLayout& grid)
+{
+    float top = Theme::GalleryHeaderHeight + Theme::GalleryPadding;
+    float rowPitch = grid.cellSize + grid.gap;
+    size_t section = model.SectionAt(y - top, Theme::SectionHeaderHeight + Theme::SectionGap,
+                                     rowPitch, grid.columns);
+    auto sl = SectionLayout(model, section, grid);
+    int row = std::max(0, static_cast<int>((y - sl.contentY) / rowPitch));
+    return {section, row};
 }
 
 std::wstring GalleryView::FormatNumber(size_t n)
@@ -663,14 +712,13 @@ void GalleryView::Render(Rendering::Direct2DRenderer* renderer)
 }
 
 // Helper: render a section-based image grid (shared by Photos tab & Folder Detail)
-// Collects visible paths into outVisiblePaths for pipeline prioritization.
+// Collects visible image ids into outVisibleIds for pipeline prioritization.
 static void RenderImageGrid(
     ID2D1DeviceContext* ctx, ID2D1Factory* factory,
     Core::ImagePipeline* pipeline,
     const GalleryView::GridLayout& grid,
-    const std::vector<std::filesystem::path>& images,
-    const std::vector<GalleryView::SectionLayoutInfo>& layouts,
-    const std::vector<GalleryView::Section>& sections,
+    const Core::GalleryModel& model,
+    const std::wstring& listTitle,
     float scroll, float contentHeight, float viewWidth,
     float cornerRadius,
     ID2D1SolidColorBrush* cellBrush,
@@ -683,7 +731,7 @@ static void RenderImageGrid(
     std::optional<size_t> skipIndex,
     bool isFastScrolling,
     float dpiScale,
-    std::vector<std::filesystem::path>* outVisiblePaths,
+    std::vector<Core::ImageId>* outVisibleIds,
     LARGE_INTEGER budgetDeadline = {},
     LARGE_INTEGER perfFreq = {})
 {
@@ -703,10 +751,11 @@ static void RenderImageGrid(
     int cellsSinceBudgetCheck = 0;
     bool budgetExhausted = false;
 
-    for (size_t s = 0; s < sections.size(); ++s) {
-        const auto& section = sections[s];
-        if (s >= layouts.size()) break;
-        const auto& sl = layouts[s];
+    // Start at the first row of the prefetch zone rather than the top
+    auto first = GalleryView::GridPositionAt(model, scroll - prefetchMargin, grid);
+    for (size_t s = first.section; s < model.SectionCount(); ++s) {
+        const auto& section = model.GetSection(s);
+        auto sl = GalleryView::SectionLayout(model, s, grid);
 
         float sectionEndY = sl.contentY + sl.rows * (grid.cellSize + grid.gap);
         // Skip sections entirely above prefetch zone
@@ -718,15 +767,17 @@ static void RenderImageGrid(
         float headerScreenY = sl.headerY - scroll;
         if (headerScreenY + Theme::SectionHeaderHeight > 0 && headerScreenY < contentHeight) {
             if (sectionFormat && textBrush) {
+                std::wstring title = model.IsList() ? listTitle
+                                                    : SectionTitle(section.year, section.month);
                 D2D1_RECT_F headerRect = D2D1::RectF(
                     grid.paddingX, headerScreenY + 8.0f,
                     viewWidth * 0.6f, headerScreenY + Theme::SectionHeaderHeight);
-                ctx->DrawText(section.title.c_str(),
-                              static_cast<UINT32>(section.title.size()),
+                ctx->DrawText(title.c_str(),
+                              static_cast<UINT32>(title.size()),
                               sectionFormat, headerRect, textBrush);
             }
             if (countRightFormat && secondaryBrush) {
-                auto countStr = GalleryView::FormatNumber(section.count) + L" photos";
+                auto countStr = GalleryView::FormatNumber(section.ids.size()) + L" photos";
                 D2D1_RECT_F countRect = D2D1::RectF(
                     viewWidth * 0.5f, headerScreenY + 8.0f,
                     viewWidth - grid.paddingX, headerScreenY + Theme::SectionHeaderHeight);
@@ -736,7 +787,9 @@ static void RenderImageGrid(
         }
 
         // Cells
-        for (size_t i = 0; i < section.count; ++i) {
+        size_t sectionStart = model.SectionStart(s);
+        size_t firstCell = (s == first.section) ? static_cast<size_t>(first.row) * grid.columns : 0;
+        for (size_t i = firstCell; i < section.ids.size(); ++i) {
             int localRow = static_cast<int>(i) / grid.columns;
             int localCol = static_cast<int>(i) % grid.columns;
 
@@ -748,8 +801,8 @@ static void RenderImageGrid(
             // Stop past prefetch zone
             if (cellY > contentHeight + prefetchMargin) break;
 
-            size_t globalIndex = section.startIndex + i;
-            if (globalIndex >= images.size()) break;
+            size_t globalIndex = sectionStart + i;
+            Core::ImageId id = section.ids[i];
 
             bool onScreen = (cellY + grid.cellSize >= 0.0f && cellY <= contentHeight);
 
@@ -764,9 +817,9 @@ static void RenderImageGrid(
 
             if (skipIndex.has_value() && globalIndex == skipIndex.value()) continue;
 
-            // Collect visible path (only actually on-screen cells, for eviction protection)
-            if (onScreen && outVisiblePaths) {
-                outVisiblePaths->push_back(images[globalIndex]);
+            // Collect visible id (only actually on-screen cells, for eviction protection)
+            if (onScreen && outVisibleIds) {
+                outVisibleIds->push_back(id);
             }
 
             // Thumbnail: request decode for visible + prefetch zone
@@ -774,12 +827,15 @@ static void RenderImageGrid(
             if (pipeline) {
                 if (isFastScrolling) {
                     // During fast scroll: show cached thumbnails on-screen, skip prefetch
+                    // (the fling's landing zone is requested by RequestLandingZone)
                     if (onScreen) {
-                        thumbnail = pipeline->GetCachedThumbnail(images[globalIndex]);
+                        thumbnail = pipeline->GetCachedThumbnail(id);
                     }
                 } else {
-                    // Normal scroll: request for both visible and prefetch cells
-                    thumbnail = pipeline->RequestThumbnail(images[globalIndex], targetPx);
+                    // Normal scroll: request for both visible and prefetch
+                    // cells, decoded closest to the viewport first
+                    thumbnail = pipeline->RequestThumbnail(id, targetPx,
+                                                           cellY, cellY + grid.cellSize);
                 }
             }
 
@@ -819,6 +875,55 @@ static void RenderImageGrid(
     }
 }
 
+// Helper: during a fast fling, queue the cells around its predicted rest
+// point (content offset `landing`) and none of the rows it passes on the way.
+// Keyed against the landing viewport given to SetViewport.
+static void RequestLandingZone(
+    Core::ImagePipeline* pipeline,
+    const GalleryView::GridLayout& grid,
+    const Core::GalleryModel& model,
+    float scroll, float landing, float contentHeight,
+    float dpiScale)
+{
+    uint32_t targetPx = std::min(
+        static_cast<uint32_t>(grid.cellSize * dpiScale),
+        Theme::ThumbnailMaxPx);
+
+    float margin = contentHeight * Theme::LandingPrefetchScreens;
+    float zoneTop = landing - margin;
+    float zoneBottom = landing + contentHeight + margin;
+    float rowPitch = grid.cellSize + grid.gap;
+
+    for (size_t s = GalleryView::GridPositionAt(model, zoneTop, grid).section;
+         s < model.SectionCount(); ++s) {
+        const auto& section = model.GetSection(s);
+        auto sl = GalleryView::SectionLayout(model, s, grid);
+        if (sl.contentY + sl.rows * rowPitch < zoneTop) continue;
+        if (sl.contentY > zoneBottom) break;
+
+        // Jump straight to the first row inside the zone
+        int firstRow = std::max(0, static_cast<int>((zoneTop - sl.contentY) / rowPitch));
+        for (size_t i = static_cast<size_t>(firstRow) * grid.columns; i < section.ids.size(); ++i) {
+            float cellY = sl.contentY + (static_cast<int>(i) / grid.columns) * rowPitch;
+            if (cellY > zoneBottom) break;
+
+            pipeline->RequestThumbnail(section.ids[i], targetPx,
+                                       cellY - scroll, cellY - scroll + grid.cellSize);
+        }
+    }
+}
+
+std::optional<float> GalleryView::PredictScrollLanding(const Animation::SpringAnimation& spring,
+                                                       float maxScroll) const
+{
+    if (!isFastScrolling_ || isDragging_ || spring.IsFinished()) return std::nullopt;
+
+    // The spring rests where its closed form has decayed below restThreshold;
+    // a landing in overscroll is pulled back to the edge by the rubber band
+    float rest = spring.PredictValue(spring.PredictSettleTime());
+    return std::clamp(rest, 0.0f, maxScroll);
+}
+
 void GalleryView::RenderPhotosTab(Rendering::Direct2DRenderer* renderer,
                                    ID2D1DeviceContext* ctx, float contentHeight)
 {
@@ -826,10 +931,11 @@ void GalleryView::RenderPhotosTab(Rendering::Direct2DRenderer* renderer,
     cachedGrid_ = grid;
     cachedLayoutWidth_ = viewWidth_;
 
-    ComputeSectionLayouts(grid);
+    const auto& photos = Photos();
+    float totalHeight = GridHeight(photos, grid);
     // Add bottom padding so content can scroll fully above the floating glass tab bar
     float glassOverlap = Theme::GlassTabBarHeight + Theme::GlassTabBarMargin * 2;
-    maxScroll_ = std::max(0.0f, cachedTotalHeight_ - contentHeight + glassOverlap);
+    maxScroll_ = std::max(0.0f, totalHeight - contentHeight + glassOverlap);
 
     float scroll = scrollY_.GetValue();
 
@@ -837,20 +943,35 @@ void GalleryView::RenderPhotosTab(Rendering::Direct2DRenderer* renderer,
     auto* factory = renderer->GetFactory();
     float dpiScale = renderer->GetDpiX() / 96.0f;
 
-    std::vector<std::filesystem::path> visiblePaths;
+    // Scroll direction and speed order the frame's decode requests; a fast
+    // fling decodes where it will stop instead
+    auto landing = PredictScrollLanding(scrollY_, maxScroll_);
+    if (pipeline_) {
+        float velocity = isDragging_ ? scrollVelocity_ : scrollY_.GetVelocity();
+        if (landing) {
+            pipeline_->SetViewport(contentHeight, velocity, *landing - scroll);
+        } else {
+            pipeline_->SetViewport(contentHeight, velocity);
+        }
+    }
+
+    std::vector<Core::ImageId> visibleIds;
     RenderImageGrid(ctx, factory, pipeline_,
-        grid, images_, sectionLayouts_, sections_,
+        grid, photos, listTitle_,
         scroll, contentHeight, viewWidth_,
         Theme::ThumbnailCornerRadius,
         cellBrush_.Get(), textBrush_.Get(), secondaryBrush_.Get(), hoverBrush_.Get(),
         sectionFormat_.Get(), countRightFormat_.Get(),
         hoverX_, hoverY_, skipIndex_,
-        isFastScrolling_, dpiScale, &visiblePaths,
+        isFastScrolling_, dpiScale, &visibleIds,
         frameBudgetDeadline_, framePerfFreq_);
+    if (pipeline_ && landing) {
+        RequestLandingZone(pipeline_, grid, photos, scroll, *landing, contentHeight, dpiScale);
+    }
 
-    // Tell pipeline which paths are visible for prioritization
-    if (pipeline_ && !visiblePaths.empty()) {
-        pipeline_->SetVisibleRange(visiblePaths);
+    // Tell pipeline which images are visible for prioritization
+    if (pipeline_ && !visibleIds.empty()) {
+        pipeline_->SetVisibleRange(visibleIds);
     }
 
     // === Header overlay (covers scrolling content) ===
@@ -878,14 +999,14 @@ void GalleryView::RenderPhotosTab(Rendering::Direct2DRenderer* renderer,
                 ctx->DrawText(sub.c_str(), static_cast<UINT32>(sub.size()),
                               countFormat_.Get(), subtitleRect, accentBrush_.Get());
             }
-        } else if (images_.empty()) {
+        } else if (photos.Empty()) {
             if (secondaryBrush_) {
                 std::wstring sub = L"No photos found  \u00B7  Ctrl+O browse  \u00B7  Ctrl+D add folder";
                 ctx->DrawText(sub.c_str(), static_cast<UINT32>(sub.size()),
                               countFormat_.Get(), subtitleRect, secondaryBrush_.Get());
             }
         } else {
-            std::wstring sub = FormatNumber(images_.size()) + L" photos";
+            std::wstring sub = FormatNumber(photos.Size()) + L" photos";
             if (secondaryBrush_) {
                 ctx->DrawText(sub.c_str(), static_cast<UINT32>(sub.size()),
                               countFormat_.Get(), subtitleRect, secondaryBrush_.Get());
@@ -906,9 +1027,9 @@ void GalleryView::RenderPhotosTab(Rendering::Direct2DRenderer* renderer,
     }
 
     // Scroll indicator
-    if (maxScroll_ > 0.0f && cachedTotalHeight_ > 0.01f && !images_.empty()) {
+    if (maxScroll_ > 0.0f && totalHeight > 0.01f && !photos.Empty()) {
         float scrollRatio = std::max(0.0f, std::min(1.0f, scroll / maxScroll_));
-        float indicatorHeight = std::max(40.0f, contentHeight * (contentHeight / cachedTotalHeight_));
+        float indicatorHeight = std::max(40.0f, contentHeight * (contentHeight / totalHeight));
         float indicatorTop = scrollRatio * (contentHeight - indicatorHeight);
         D2D1_ROUNDED_RECT indicatorRect = {
             D2D1::RectF(viewWidth_ - 5.0f, indicatorTop + 4.0f,
@@ -921,7 +1042,7 @@ void GalleryView::RenderPhotosTab(Rendering::Direct2DRenderer* renderer,
     }
 
     // Empty state
-    if (images_.empty() && !isScanning_) {
+    if (photos.Empty() && !isScanning_) {
         float cx = viewWidth_ * 0.5f;
         float cy = contentHeight * 0.50f;
 
@@ -1045,12 +1166,12 @@ void GalleryView::RenderAlbumsTab(Rendering::Direct2DRenderer* renderer,
         Microsoft::WRL::ComPtr<ID2D1Bitmap> thumbnail;
         if (pipeline_) {
             if (isFastScrolling_) {
-                thumbnail = pipeline_->GetCachedThumbnail(folderAlbums_[i].coverImage);
+                thumbnail = pipeline_->GetCachedThumbnail(folderAlbums_[i].coverId);
             } else {
                 uint32_t albumTargetPx = std::min(
                     static_cast<uint32_t>(ag.cardWidth * (renderer ? renderer->GetDpiX() / 96.0f : 1.0f)),
                     Theme::ThumbnailMaxPx);
-                thumbnail = pipeline_->RequestThumbnail(folderAlbums_[i].coverImage, albumTargetPx);
+                thumbnail = pipeline_->RequestThumbnail(folderAlbums_[i].coverId, albumTargetPx);
             }
         }
         if (thumbnail) {
@@ -1171,9 +1292,9 @@ void GalleryView::RenderFolderDetail(Rendering::Direct2DRenderer* renderer,
     if (openFolderIndex_ >= folderAlbums_.size()) return;
 
     auto grid = CalculateGridLayout(viewWidth_);
-    ComputeFolderDetailSectionLayouts(grid);
+    float totalHeight = GridHeight(folderDetail_, grid);
     float glassOverlap = Theme::GlassTabBarHeight + Theme::GlassTabBarMargin * 2;
-    folderDetailMaxScroll_ = std::max(0.0f, folderDetailCachedTotalHeight_ - contentHeight + glassOverlap);
+    folderDetailMaxScroll_ = std::max(0.0f, totalHeight - contentHeight + glassOverlap);
 
     float scroll = folderDetailScrollY_.GetValue();
 
@@ -1181,28 +1302,41 @@ void GalleryView::RenderFolderDetail(Rendering::Direct2DRenderer* renderer,
     auto* factory = renderer->GetFactory();
     float dpiScale = renderer->GetDpiX() / 96.0f;
 
-    std::vector<std::filesystem::path> visiblePaths;
+    auto landing = PredictScrollLanding(folderDetailScrollY_, folderDetailMaxScroll_);
+    if (pipeline_) {
+        float velocity = isDragging_ ? scrollVelocity_ : folderDetailScrollY_.GetVelocity();
+        if (landing) {
+            pipeline_->SetViewport(contentHeight, velocity, *landing - scroll);
+        } else {
+            pipeline_->SetViewport(contentHeight, velocity);
+        }
+    }
+
+    std::vector<Core::ImageId> visibleIds;
     RenderImageGrid(ctx, factory, pipeline_,
-        grid, folderDetailImages_, folderDetailSectionLayouts_, folderDetailSections_,
+        grid, folderDetail_, std::wstring(),
         scroll, contentHeight, viewWidth_,
         Theme::ThumbnailCornerRadius,
         cellBrush_.Get(), textBrush_.Get(), secondaryBrush_.Get(), hoverBrush_.Get(),
         sectionFormat_.Get(), countRightFormat_.Get(),
         hoverX_, hoverY_, skipIndex_,
-        isFastScrolling_, dpiScale, &visiblePaths,
+        isFastScrolling_, dpiScale, &visibleIds,
         frameBudgetDeadline_, framePerfFreq_);
+    if (pipeline_ && landing) {
+        RequestLandingZone(pipeline_, grid, folderDetail_, scroll, *landing, contentHeight, dpiScale);
+    }
 
-    // Tell pipeline which paths are visible for prioritization
-    if (pipeline_ && !visiblePaths.empty()) {
-        pipeline_->SetVisibleRange(visiblePaths);
+    // Tell pipeline which images are visible for prioritization
+    if (pipeline_ && !visibleIds.empty()) {
+        pipeline_->SetVisibleRange(visibleIds);
     }
 
     // Header text moved to RenderGlassFolderHeader (Pass 2) for glass backing
 
     // Scroll indicator
-    if (folderDetailMaxScroll_ > 0.0f && folderDetailCachedTotalHeight_ > 0.01f) {
+    if (folderDetailMaxScroll_ > 0.0f && totalHeight > 0.01f) {
         float scrollRatio = std::max(0.0f, std::min(1.0f, scroll / folderDetailMaxScroll_));
-        float indicatorHeight = std::max(40.0f, contentHeight * (contentHeight / folderDetailCachedTotalHeight_));
+        float indicatorHeight = std::max(40.0f, contentHeight * (contentHeight / totalHeight));
         float indicatorTop = scrollRatio * (contentHeight - indicatorHeight);
         D2D1_ROUNDED_RECT indicatorRect = {
             D2D1::RectF(viewWidth_ - 5.0f, indicatorTop + 4.0f,
@@ -1600,7 +1734,7 @@ void GalleryView::RenderGlassFolderHeader(ID2D1DeviceContext* ctx, ID2D1Bitmap*
         D2D1_RECT_F subtitleRect = D2D1::RectF(
             Theme::GalleryPadding, titleY + 38.0f,
             viewWidth_ - Theme::GalleryPadding, titleY + 54.0f);
-        std::wstring sub = FormatNumber(folderDetailImages_.size()) + L" photos";
+        std::wstring sub = FormatNumber(folderDetail_.Size()) + L" photos";
         ctx->DrawText(sub.c_str(), static_cast<UINT32>(sub.size()),
                       countFormat_.Get(), subtitleRect, secondaryBrush_.Get());
     }
@@ -1754,8 +1888,7 @@ void GalleryView::Update(float deltaTime)
         if (!folderTransitionForward_) {
             // Pop animation completed — clean up
             inFolderDetail_ = false;
-            folderDetailImages_.clear();
-            folderDetailSections_.clear();
+            folderDetail_.Clear();
         }
     }
 
@@ -1913,8 +2046,7 @@ void GalleryView::OnMouseUp(float x, float y)
                 if (inFolderDetail_) {
                     inFolderDetail_ = false;
                     folderTransitionActive_ = false;
-                    folderDetailImages_.clear();
-                    folderDetailSections_.clear();
+                    folderDetail_.Clear();
                 }
             } else {
                 if (editMode_ && activeTab_ != GalleryTab::Albums) SetEditMode(false);
@@ -2049,50 +2181,36 @@ std::optional<GalleryView::HitResult> GalleryView::HitTest(float x, float y) con
 
     auto grid = CalculateGridLayout(viewWidth_);
 
-    const auto& sections = (inFolderDetail_) ? folderDetailSections_ : sections_;
-    const auto& images = (inFolderDetail_) ? folderDetailImages_ : images_;
-
-    if (inFolderDetail_) {
-        ComputeFolderDetailSectionLayouts(grid);
-    } else {
-        ComputeSectionLayouts(grid);
-    }
-
-    const auto& layouts = (inFolderDetail_) ? folderDetailSectionLayouts_ : sectionLayouts_;
+    const auto& model = (inFolderDetail_) ? folderDetail_ : Photos();
     float scroll = (inFolderDetail_) ? folderDetailScrollY_.GetValue() : scrollY_.GetValue();
 
     float worldY = y + scroll;
 
-    for (size_t s = 0; s < sections.size(); ++s) {
-        const auto& section = sections[s];
-        if (s >= layouts.size()) break;
-        const auto& sl = layouts[s];
+    auto [s, row] = GridPositionAt(model, worldY, grid);
+    if (s >= model.SectionCount()) return std::nullopt;
+    const auto& section = model.GetSection(s);
+    auto sl = SectionLayout(model, s, grid);
 
-        float contentEnd = sl.contentY + sl.rows * (grid.cellSize + grid.gap);
-        if (worldY < sl.contentY || worldY >= contentEnd) continue;
+    // In the section's header, or in the gap below its last row
+    if (worldY < sl.contentY || row >= sl.rows) return std::nullopt;
 
-        float localY = worldY - sl.contentY;
-        int row = static_cast<int>(localY / (grid.cellSize + grid.gap));
+    float cellYOffset = worldY - sl.contentY - row * (grid.cellSize + grid.gap);
+    if (cellYOffset > grid.cellSize) return std::nullopt;
 
-        float cellYOffset = localY - row * (grid.cellSize + grid.gap);
-        if (cellYOffset > grid.cellSize) continue;
+    for (int col = 0; col < grid.columns; ++col) {
+        float cellX = grid.paddingX + col * (grid.cellSize + grid.gap);
 
-        for (int col = 0; col < grid.columns; ++col) {
-            float cellX = grid.paddingX + col * (grid.cellSize + grid.gap);
+        if (x >= cellX && x <= cellX + grid.cellSize) {
+            size_t localIndex = static_cast<size_t>(row) * grid.columns + col;
+            if (localIndex >= section.ids.size()) continue;
 
-            if (x >= cellX && x <= cellX + grid.cellSize) {
-                size_t localIndex = static_cast<size_t>(row) * grid.columns + col;
-                if (localIndex >= section.count) continue;
+            size_t globalIndex = model.SectionStart(s) + localIndex;
 
-                size_t globalIndex = section.startIndex + localIndex;
-                if (globalIndex >= images.size()) continue;
-
-                float screenCellY = sl.contentY + row * (grid.cellSize + grid.gap) - scroll;
-                D2D1_RECT_F rect = D2D1::RectF(
-                    cellX, screenCellY,
-                    cellX + grid.cellSize, screenCellY + grid.cellSize);
-                return HitResult{globalIndex, rect};
-            }
+            float screenCellY = sl.contentY + row * (grid.cellSize + grid.gap) - scroll;
+            D2D1_RECT_F rect = D2D1::RectF(
+                cellX, screenCellY,
+                cellX + grid.cellSize, screenCellY + grid.cellSize);
+            return HitResult{globalIndex, rect};
         }
     }
     return std::nullopt;
@@ -2109,38 +2227,21 @@ void GalleryView::SetViewSize(float width, float height)
 
 std::optional<D2D1_RECT_F> GalleryView::GetCellScreenRect(size_t index) const
 {
-    const auto& images = (inFolderDetail_) ? folderDetailImages_ : images_;
-    const auto& sections = (inFolderDetail_) ? folderDetailSections_ : sections_;
-
-    if (index >= images.size()) return std::nullopt;
+    const auto& model = (inFolderDetail_) ? folderDetail_ : Photos();
+    if (index >= model.Size()) return std::nullopt;
 
     auto grid = CalculateGridLayout(viewWidth_);
-
-    if (inFolderDetail_) {
-        ComputeFolderDetailSectionLayouts(grid);
-    } else {
-        ComputeSectionLayouts(grid);
-    }
-
-    const auto& layouts = (inFolderDetail_) ? folderDetailSectionLayouts_ : sectionLayouts_;
     float scroll = (inFolderDetail_) ? folderDetailScrollY_.GetValue() : scrollY_.GetValue();
 
-    for (size_t s = 0; s < sections.size(); ++s) {
-        if (index >= sections[s].startIndex &&
-            index < sections[s].startIndex + sections[s].count) {
+    auto [section, localIndex] = model.Locate(index);
+    int row = static_cast<int>(localIndex) / grid.columns;
+    int col = static_cast<int>(localIndex) % grid.columns;
 
-            size_t localIndex = index - sections[s].startIndex;
-            int row = static_cast<int>(localIndex) / grid.columns;
-            int col = static_cast<int>(localIndex) % grid.columns;
+    float cellX = grid.paddingX + col * (grid.cellSize + grid.gap);
+    float cellY = SectionLayout(model, section, grid).contentY +
+        row * (grid.cellSize + grid.gap) - scroll;
 
-            float cellX = grid.paddingX + col * (grid.cellSize + grid.gap);
-            float cellY = layouts[s].contentY +
-                row * (grid.cellSize + grid.gap) - scroll;
-
-            return D2D1::RectF(cellX, cellY, cellX + grid.cellSize, cellY + grid.cellSize);
-        }
-    }
-    return std::nullopt;
+    return D2D1::RectF(cellX, cellY, cellX + grid.cellSize, cellY + grid.cellSize);
 }
 
 } // namespace UI
@@ -98,6 +98,13 @@ void ImageViewer::LoadCurrentPage()
 {
     if (!pipeline_ || images_.empty()) return;
 
+    // Keep the page and its neighbours resident while the user swipes
+    std::vector<std::filesystem::path> pages{images_[currentIndex_]};
+    if (currentIndex_ > 0) pages.push_back(images_[currentIndex_ - 1]);
+    if (currentIndex_ + 1 < images_.size()) pages.push_back(images_[currentIndex_ + 1]);
+    pipeline_->PinFullImages(pages);
+    pipeline_->RecordView(images_[currentIndex_]);
+
     currentBitmap_ = pipeline_->GetBitmap(images_[currentIndex_]);
     prevBitmap_ = (currentIndex_ > 0) ? pipeline_->GetThumbnail(images_[currentIndex_ - 1]) : nullptr;
     nextBitmap_ = (currentIndex_ + 1 < images_.size()) ? pipeline_->GetThumbnail(images_[currentIndex_ + 1]) : nullptr;
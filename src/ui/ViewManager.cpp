@@ -88,7 +88,7 @@ void ViewManager::Update(float deltaTime)
     switch (state_) {
         case ViewState::Gallery:
             galleryView_.Update(deltaTime);
-            if (!galleryView_.GetImages().empty()) {
+            if (galleryView_.GetImageCount() > 0) {
                 needsRender_ = true;  // Always re-render gallery for scroll animations
             }
             break;